@@ -18,6 +18,38 @@ MIT license
 
 #include "OpenBCI_Radios.h"
 
+// Private commands from the driver, indexed by the code after
+//  OPENBCI_HOST_PRIVATE_CMD_KEY, see hostCommandDispatch(). Const so it stays
+//  in flash, add a row here to add a command.
+const OpenBCI_Radios_Class::HostCommand OpenBCI_Radios_Class::hostCommands[OPENBCI_HOST_CMD_TABLE_SIZE] = {
+  {0, false, &OpenBCI_Radios_Class::hostCommandChannelGet},         // 0x00 OPENBCI_HOST_CMD_CHANNEL_GET
+  {1, true, &OpenBCI_Radios_Class::hostCommandChannelSet},          // 0x01 OPENBCI_HOST_CMD_CHANNEL_SET
+  {1, false, &OpenBCI_Radios_Class::hostCommandChannelSetOverride}, // 0x02 OPENBCI_HOST_CMD_CHANNEL_SET_OVERIDE
+  {0, true, &OpenBCI_Radios_Class::hostCommandPollTimeGet},         // 0x03 OPENBCI_HOST_CMD_POLL_TIME_GET
+  {1, true, &OpenBCI_Radios_Class::hostCommandPollTimeSet},         // 0x04 OPENBCI_HOST_CMD_POLL_TIME_SET
+  {0, false, &OpenBCI_Radios_Class::hostCommandBaud},               // 0x05 OPENBCI_HOST_CMD_BAUD_DEFAULT
+  {0, false, &OpenBCI_Radios_Class::hostCommandBaud},               // 0x06 OPENBCI_HOST_CMD_BAUD_FAST
+  {0, false, &OpenBCI_Radios_Class::hostCommandSysUp},              // 0x07 OPENBCI_HOST_CMD_SYS_UP
+  {0, false, NULL},                                                 // 0x08 OPENBCI_HOST_CMD_TIME_PIN_HIGH goes to the Device
+  {0, false, NULL},                                                 // 0x09 OPENBCI_HOST_CMD_TIME_PIN_LOW goes to the Device
+  {0, false, &OpenBCI_Radios_Class::hostCommandBaud},               // 0x0A OPENBCI_HOST_CMD_BAUD_HYPER
+  {0, true, &OpenBCI_Radios_Class::hostCommandUploadStart},         // 0x0B OPENBCI_HOST_CMD_UPLOAD_START
+  {0, false, &OpenBCI_Radios_Class::hostCommandFraming},            // 0x0C OPENBCI_HOST_CMD_FRAMING_ON
+  {0, false, &OpenBCI_Radios_Class::hostCommandFraming},            // 0x0D OPENBCI_HOST_CMD_FRAMING_OFF
+  {0, false, &OpenBCI_Radios_Class::hostCommandStreamDown},         // 0x0E OPENBCI_HOST_CMD_STREAM_DOWN_ON
+  {0, false, &OpenBCI_Radios_Class::hostCommandStreamDown},         // 0x0F OPENBCI_HOST_CMD_STREAM_DOWN_OFF
+  {1, true, &OpenBCI_Radios_Class::hostCommandParitySet},           // 0x10 OPENBCI_HOST_CMD_PARITY_SET
+  {0, false, &OpenBCI_Radios_Class::hostCommandParityGet},          // 0x11 OPENBCI_HOST_CMD_PARITY_GET
+  {0, false, &OpenBCI_Radios_Class::hostCommandTraceDump},          // 0x12 OPENBCI_HOST_CMD_TRACE_DUMP
+  {0, false, &OpenBCI_Radios_Class::hostCommandBatch},              // 0x13 OPENBCI_HOST_CMD_BATCH_ON
+  {0, false, &OpenBCI_Radios_Class::hostCommandBatch},              // 0x14 OPENBCI_HOST_CMD_BATCH_OFF
+  {1, true, &OpenBCI_Radios_Class::hostCommandDecimateSet},         // 0x15 OPENBCI_HOST_CMD_DECIMATE_SET
+  {1, true, &OpenBCI_Radios_Class::hostCommandLowPowerSet},         // 0x16 OPENBCI_HOST_CMD_LOW_POWER_SET
+  {0, true, &OpenBCI_Radios_Class::hostCommandLowPowerReport},      // 0x17 OPENBCI_HOST_CMD_LOW_POWER_REPORT
+  {4, true, &OpenBCI_Radios_Class::hostCommandPollTimeSetUs},       // 0x18 OPENBCI_HOST_CMD_POLL_TIME_SET_US
+  {0, false, &OpenBCI_Radios_Class::hostCommandPollTimeGetUs}       // 0x19 OPENBCI_HOST_CMD_POLL_TIME_GET_US
+};
+
 // CONSTRUCTOR
 OpenBCI_Radios_Class::OpenBCI_Radios_Class() {
   // Set defaults
@@ -28,6 +60,71 @@ OpenBCI_Radios_Class::OpenBCI_Radios_Class() {
   lastTimeHostHeardFromDevice = 0;
   lastTimeSerialRead = 0;
   systemUp = false;
+  flashCommitsPending = 0;
+  flashCommitMsgToPrint = OPENBCI_FLASH_COMMIT_NO_MSG;
+  flashCommitRetries = 0;
+  for (int i = 0; i < TIMER_EVENT_COUNT; i++) {
+    timerActive[i] = false;
+  }
+  uploadActive = false;
+  uploadReset();
+  lastTimeHostHeardStream = 0;
+  txQueueCount = 0;
+  rxQueueHead = 0;
+  rxQueueTail = 0;
+  runPending = RUN_WORK_ALL;
+  runTimeSweep = 0;
+  streamDownEnabled = false;
+  streamDownHead = 0;
+  streamSampleNextValid = false;
+  streamParityGroup = 0;
+  streamDecimate = 0;
+  bufferStreamDecimateReset();
+  linkHeard = false;
+  linkUnacked = false;
+  linkTimeSent = 0;
+  linkSearching = false;
+  linkTimeSearch = 0;
+  linkTimeDwell = 0;
+  lowPowerWaitMs = 0;
+  lowPowerReset();
+  timeOfLastPoll = 0;
+  timeOfLastStream = 0;
+  flowPaused = false;
+  pollTimeApply(OPENBCI_TIMEOUT_PACKET_POLL_MS);
+  streamParityRecovered = 0;
+  streamParityLost = 0;
+  bufferStreamParityReset();
+  for (int i = 0; i < OPENBCI_NUMBER_STREAM_HISTORY; i++) {
+    streamHistory[i][0] = 0;
+    streamHistoryResend[i] = false;
+  }
+  streamDownTail = 0;
+  serialFramingEnabled = false;
+  serialFrameState = FRAME_STATE_IDLE;
+  serialFrameComplete = false;
+  // Upload takes all of sharedBuffer until configureHost() splits it
+  outputBuffer = sharedBuffer;
+  uploadBuffer = sharedBuffer;
+  uploadLength = OPENBCI_UPLOAD_BUFFER_LENGTH;
+  outputPositionWrite = 0;
+  outputPositionRead = 0;
+  outputTimeFree = 0;
+  outputSetBaudRate(OPENBCI_BAUD_RATE_DEFAULT);
+  outputBatchEnabled = false;
+  outputBatchSequence = 0;
+  outputBatchWaiting = false;
+  timerBaudRate = OPENBCI_BAUD_RATE_DEFAULT;
+  timerBaudPosition = 0;
+#if OPENBCI_TRACE_ENABLED
+  traceCount = 0;
+  tracePaused = false;
+  traceTimeLastLoop = 0;
+  traceSending = false;
+  traceDeviceHead = 0;
+  traceDeviceTail = 0;
+  traceDeviceNext = 0;
+#endif
 }
 
 /**
@@ -100,13 +197,19 @@ void OpenBCI_Radios_Class::configure(uint8_t mode, uint32_t channelNumber) {
     }
     RFduinoGZLL.channel = getChannelNumber();
     radioChannel = getChannelNumber();
+    // No previous channel to look on until the channel is changed
+    previousRadioChannel = radioChannel;
 
     // Check to see if we need to set the poll time
     //  this is only the case on the first run of the program
     if (needToSetPollTime()) {
       setPollTime(OPENBCI_TIMEOUT_PACKET_POLL_MS);
     }
-    pollTime = getPollTime();
+    pollTimeApply(getPollTime());
+
+    // Come back up in the link state from before the reset, the Host confirms
+    //  it with the Device on first contact, see ::linkStateSync()
+    linkStateApply(getLinkState());
 
     // get the buffers ready
     bufferRadioReset(bufferRadio);
@@ -162,6 +265,11 @@ void OpenBCI_Radios_Class::configureDevice(void) {
     // END: To run host normally
   }
 
+  // The Device has no output to the driver, upload takes the whole buffer
+  outputBuffer = sharedBuffer;
+  uploadBuffer = sharedBuffer;
+  uploadLength = OPENBCI_UPLOAD_BUFFER_LENGTH;
+
   timeOfLastMultipacketSendToHost = millis();
   sendingMultiPacket = false;
   streamPacketsHaveHeads = true;
@@ -188,8 +296,15 @@ void OpenBCI_Radios_Class::configureHost(void) {
   // Turn LED on
   digitalWrite(OPENBCI_PIN_HOST_LED,HIGH);
 
-  // Open the Serial connection
-  Serial.begin(OPENBCI_BAUD_RATE_DEFAULT);
+  // Open the Serial connection at the default baud rate, the driver's serial
+  //  modes are not kept over a reset, see ::linkStateMake()
+  Serial.begin(timerBaudRate);
+  outputSetBaudRate(timerBaudRate);
+
+  // Output keeps running while uploading so the two get their own windows
+  outputBuffer = sharedBuffer;
+  uploadBuffer = sharedBuffer + OPENBCI_UPLOAD_HOST_BUFFER_LENGTH;
+  uploadLength = OPENBCI_UPLOAD_HOST_BUFFER_LENGTH;
 
   packetInTXRadioBuffer = false;
   sendSerialAck = false;
@@ -214,21 +329,54 @@ void OpenBCI_Radios_Class::configurePassThru(void) {
 }
 
 /**
-* @description Gets the channel number from non-volatile flash memory
+* @description Gets the channel number from non-volatile flash memory, or the
+*  channel number waiting in the flash commit queue if there is one.
 * @returns {uint32_t} - The channel number from non-volatile memory
 * @author AJ Keller (@pushtheworldllc)
 */
 uint32_t OpenBCI_Radios_Class::getChannelNumber(void) {
+  uint32_t channelNumber;
+  if (flashCommitGetPending(OPENBCI_FLASH_COMMIT_CHANNEL, &channelNumber)) {
+    return channelNumber;
+  }
   return *ADDRESS_OF_PAGE(RFDUINOGZLL_FLASH_MEM_ADDR);
 }
 
 /**
-* @description Gets the poll time from non-volatile flash memory
+* @description Gets the poll time from non-volatile flash memory, or the poll
+*  time waiting in the flash commit queue if there is one. It is in ms, or in
+*  uS with `OPENBCI_POLL_TIME_US_FLAG` set, see ::pollTimeToMicros(). The uS
+*  word is only taken while the ms word still matches it, see
+*  ::flashWritePollTime().
 * @returns {uint32_t} - The poll time from non-volatile memory
 * @author AJ Keller (@pushtheworldllc)
 */
 uint32_t OpenBCI_Radios_Class::getPollTime(void) {
-  return *(ADDRESS_OF_PAGE(RFDUINOGZLL_FLASH_MEM_ADDR) + 1);
+  uint32_t pollTime;
+  if (flashCommitGetPending(OPENBCI_FLASH_COMMIT_POLL_TIME, &pollTime)) {
+    return pollTime;
+  }
+  uint32_t *p = ADDRESS_OF_PAGE(RFDUINOGZLL_FLASH_MEM_ADDR);
+  uint32_t us = *(p + 3);
+  if (us != 0xFFFFFFFF && (us & OPENBCI_POLL_TIME_US_FLAG) && (pollTimeToMicros(us) + 999) / 1000 == *(p + 1)) {
+    return us;
+  }
+  return *(p + 1);
+}
+
+/**
+* @description Gets the link state from non-volatile flash memory, or the link
+*  state waiting in the flash commit queue if there is one. See
+*  ::linkStateMake() for what is in it.
+* @returns {uint32_t} - The link state, `0xFFFFFFFF` if it was never stored
+* @author AJ Keller (@pushtheworldllc)
+*/
+uint32_t OpenBCI_Radios_Class::getLinkState(void) {
+  uint32_t linkState;
+  if (flashCommitGetPending(OPENBCI_FLASH_COMMIT_LINK_STATE, &linkState)) {
+    return linkState;
+  }
+  return *(ADDRESS_OF_PAGE(RFDUINOGZLL_FLASH_MEM_ADDR) + 2);
 }
 
 /**
@@ -254,6 +402,8 @@ void OpenBCI_Radios_Class::revertToPreviousChannelNumber(void) {
   RFduinoGZLL.channel = previousRadioChannel;
   RFduinoGZLL.begin(RFDUINOGZLL_ROLE_HOST);
   radioChannel = previousRadioChannel;
+  // Undo the new channel that may be waiting to be stored
+  flashCommitAdd(OPENBCI_FLASH_COMMIT_CHANNEL, previousRadioChannel);
 }
 
 /**
@@ -287,11 +437,17 @@ boolean OpenBCI_Radios_Class::setChannelNumber(uint32_t channelNumber) {
     pollTime = getPollTime();
     willSetPollTime = true;
   }
+  uint32_t linkState = getLinkState();
 
   int rc;
   if (flashNonVolatileMemory()) {
     if (willSetPollTime) {
-      if (flashWrite(p + 1, pollTime) > 0) {
+      if (!flashWritePollTime(pollTime)) {
+        return false;
+      }
+    }
+    if (linkState != 0xFFFFFFFF) {
+      if (flashWrite(p + 2, linkState) > 0) {
         return false;
       }
     }
@@ -324,22 +480,20 @@ boolean OpenBCI_Radios_Class::setPollTime(uint32_t pollTime) {
     chan = getChannelNumber();
     willSetChannel = true;
   }
+  uint32_t linkState = getLinkState();
 
-  int rc;
   if (flashNonVolatileMemory()) {
     if (willSetChannel) {
       if (flashWrite(p,chan)) {
         return false;
       }
     }
-    rc = flashWrite(p + 1, pollTime); // Always stored 1 more than chan
-    if (rc == 0) {
-      return true;
-    } else if (rc == 1) {
-      return false;
-    } else if (rc == 2) {
-      return false;
+    if (linkState != 0xFFFFFFFF) {
+      if (flashWrite(p + 2, linkState) > 0) {
+        return false;
+      }
     }
+    return flashWritePollTime(pollTime);
   }
   return false;
 }
@@ -363,7 +517,597 @@ boolean OpenBCI_Radios_Class::flashNonVolatileMemory(void) {
   return true;
 }
 
+/**
+* @description Erases the config page and writes the channel number, the poll
+*  time and the link state to it with a single page erase. A value of
+*  `0xFFFFFFFF` is left erased.
+* @param channelNumber {uint32_t} - The channel number to store
+* @param pollTime {uint32_t} - The poll time to store
+* @param linkState {uint32_t} - The link state to store, see ::linkStateMake()
+* @return {boolean} - `true` if the page was written, `false` if not...
+* @author AJ Keller (@pushtheworldllc)
+*/
+boolean OpenBCI_Radios_Class::flashWriteConfig(uint32_t channelNumber, uint32_t pollTime, uint32_t linkState) {
+  uint32_t *p = ADDRESS_OF_PAGE(RFDUINOGZLL_FLASH_MEM_ADDR);
+
+  if (!flashNonVolatileMemory()) {
+    return false;
+  }
+  if (channelNumber != 0xFFFFFFFF) {
+    if (flashWrite(p, channelNumber) > 0) {
+      return false;
+    }
+  }
+  if (pollTime != 0xFFFFFFFF) {
+    if (!flashWritePollTime(pollTime)) {
+      return false;
+    }
+  }
+  if (linkState != 0xFFFFFFFF) {
+    if (flashWrite(p + 2, linkState) > 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/**
+* @description Writes a poll time from ::getPollTime() to the config page,
+*  which must already be erased. The word after the channel only ever holds
+*  ms, older firmware reads it as its poll time. A poll time in uS goes there
+*  rounded up to a whole ms, and as uS in the word after the link state, so
+*  older firmware polls at about the same rate rather than reading the flag as
+*  about 2^31 ms and never polling again.
+* @param pollTime {uint32_t} - The poll time in ms, or in uS with
+*  `OPENBCI_POLL_TIME_US_FLAG` set
+* @return {boolean} - `true` if the poll time was written
+* @author AJ Keller (@pushtheworldllc)
+*/
+boolean OpenBCI_Radios_Class::flashWritePollTime(uint32_t pollTime) {
+  uint32_t *p = ADDRESS_OF_PAGE(RFDUINOGZLL_FLASH_MEM_ADDR);
+  if (pollTime & OPENBCI_POLL_TIME_US_FLAG) {
+    if (flashWrite(p + 3, pollTime) > 0) {
+      return false;
+    }
+    pollTime = (pollTimeToMicros(pollTime) + 999) / 1000;
+  }
+  return flashWrite(p + 1, pollTime) == 0; // Always stored 1 more than chan
+}
+
+/**
+* @description Records a config change to be persisted to flash later from
+*  `loop()`. Safe to call from `RFduinoGZLL_onReceive`, a page erase stalls the
+*  CPU for milliseconds so it must never be done from the radio callback. A
+*  second change to the same key before the commit replaces the first.
+* @param key {uint8_t} - `OPENBCI_FLASH_COMMIT_CHANNEL`,
+*  `OPENBCI_FLASH_COMMIT_POLL_TIME` or `OPENBCI_FLASH_COMMIT_LINK_STATE`
+* @param value {uint32_t} - The value to store
+* @return {boolean} - `true` if the change was queued, `false` if the value is
+*  out of bounds or the queue is full.
+* @author AJ Keller (@pushtheworldllc)
+*/
+boolean OpenBCI_Radios_Class::flashCommitAdd(uint8_t key, uint32_t value) {
+  if (key == OPENBCI_FLASH_COMMIT_CHANNEL && value > RFDUINOGZLL_CHANNEL_LIMIT_UPPER) {
+    return false;
+  }
+  for (int i = 0; i < flashCommitsPending; i++) {
+    if (flashCommits[i].key == key) {
+      flashCommits[i].value = value;
+      runPostFromLoop(RUN_WORK_FLASH);
+      return true;
+    }
+  }
+  if (flashCommitsPending >= OPENBCI_NUMBER_FLASH_COMMITS) {
+    return false;
+  }
+  flashCommits[flashCommitsPending].key = key;
+  flashCommits[flashCommitsPending].value = value;
+  flashCommitsPending++;
+  runPostFromLoop(RUN_WORK_FLASH);
+  return true;
+}
+
+/**
+* @description Raise a confirmation message to the driver once everything in
+*  the flash commit queue has been persisted. If nothing is waiting the message
+*  is raised right away.
+* @param msg {uint8_t} - The `HOST_MESSAGE_*` to print when the commit is done
+* @author AJ Keller (@pushtheworldllc)
+*/
+void OpenBCI_Radios_Class::flashCommitConfirm(uint8_t msg) {
+  if (flashCommitHasPending()) {
+    flashCommitMsgToPrint = msg;
+  } else {
+    msgToPrint = msg;
+    printMessageToDriverFlag = true;
+  }
+}
+
+/**
+* @description Looks up a value waiting in the flash commit queue.
+* @param key {uint8_t} - The key to look for
+* @param value {uint32_t *} - Set to the pending value if there is one
+* @return {boolean} - `true` if `key` has a pending value
+* @author AJ Keller (@pushtheworldllc)
+*/
+boolean OpenBCI_Radios_Class::flashCommitGetPending(uint8_t key, uint32_t *value) {
+  for (int i = 0; i < flashCommitsPending; i++) {
+    if (flashCommits[i].key == key) {
+      *value = flashCommits[i].value;
+      return true;
+    }
+  }
+  return false;
+}
+
+/**
+* @description Used to determine if there are config changes waiting to be
+*  written to flash.
+* @return {boolean} - `true` if the flash commit queue has entries
+* @author AJ Keller (@pushtheworldllc)
+*/
+boolean OpenBCI_Radios_Class::flashCommitHasPending(void) {
+  return flashCommitsPending > 0;
+}
+
+/**
+* @description Persists the flash commit queue with one page erase. Call from
+*  `loop()`, only does work when the erase won't get in the way of the radio,
+*  see ::flashCommitRadioQuiet(). Any message held by `::flashCommitConfirm()`
+*  is raised when the write completes. After `OPENBCI_FLASH_COMMIT_RETRIES`
+*  failed writes the queue is dropped and the radio goes back to the channel
+*  in flash, so it runs on what it would come back up on, and the Host tells
+*  the driver. A channel the other radio kept is found again by
+*  ::linkProcess().
+* @return {boolean} - `true` if the queue was written to flash
+* @author AJ Keller (@pushtheworldllc)
+*/
+boolean OpenBCI_Radios_Class::flashCommitProcess(void) {
+  if (!flashCommitHasPending() || !flashCommitRadioQuiet()) {
+    return false;
+  }
+
+  // Take a snapshot, the radio callback may add to the queue while we write
+  noInterrupts();
+  OPENBCI_TRACE_MASK_START();
+  uint32_t channelNumber = getChannelNumber();
+  uint32_t newPollTime = getPollTime();
+  uint32_t linkState = getLinkState();
+  OPENBCI_TRACE_MASK_END(OPENBCI_TRACE_MASKED_FLASH_COMMIT);
+  interrupts();
+
+  boolean success = flashWriteConfig(channelNumber, newPollTime, linkState);
+  boolean outOfRetries = !success && flashCommitRetries >= OPENBCI_FLASH_COMMIT_RETRIES;
+
+  noInterrupts();
+  OPENBCI_TRACE_MASK_START();
+  if (success || flashCommitRetries >= OPENBCI_FLASH_COMMIT_RETRIES) {
+    // Drop the entries we wrote, keep any that changed during the write
+    uint8_t numberKept = 0;
+    for (int i = 0; i < flashCommitsPending; i++) {
+      uint32_t written = linkState;
+      if (flashCommits[i].key == OPENBCI_FLASH_COMMIT_CHANNEL) {
+        written = channelNumber;
+      } else if (flashCommits[i].key == OPENBCI_FLASH_COMMIT_POLL_TIME) {
+        written = newPollTime;
+      }
+      if (success && flashCommits[i].value != written) {
+        flashCommits[numberKept] = flashCommits[i];
+        numberKept++;
+      }
+    }
+    flashCommitsPending = numberKept;
+    flashCommitRetries = 0;
+  } else {
+    flashCommitRetries++;
+  }
+  OPENBCI_TRACE_MASK_END(OPENBCI_TRACE_MASKED_FLASH_COMMIT);
+  interrupts();
+
+  if (outOfRetries) {
+    // Don't run on a channel a reset wouldn't come back up on
+    uint32_t storedChannel = getChannelNumber();
+    if (storedChannel <= RFDUINOGZLL_CHANNEL_LIMIT_UPPER && storedChannel != radioChannel) {
+      previousRadioChannel = radioChannel;
+      radioChannel = storedChannel;
+      linkSetChannel(storedChannel);
+    }
+    if (radioMode == OPENBCI_MODE_HOST) {
+      msgToPrint = HOST_MESSAGE_FLASH_FAILURE;
+      printMessageToDriverFlag = true;
+    }
+    flashCommitMsgToPrint = OPENBCI_FLASH_COMMIT_NO_MSG;
+  } else if (success && flashCommitMsgToPrint != OPENBCI_FLASH_COMMIT_NO_MSG && !flashCommitHasPending()) {
+    msgToPrint = flashCommitMsgToPrint;
+    printMessageToDriverFlag = true;
+    flashCommitMsgToPrint = OPENBCI_FLASH_COMMIT_NO_MSG;
+  }
+
+  return success;
+}
+
+/**
+* @description Used to determine if a page erase can stall the CPU for
+*  `OPENBCI_FLASH_PAGE_ERASE_MS` without dropping anything. Never while a
+*  stream is running, neither radio can hold that much of it. On the Host the
+*  erase has to be done before the Device's next poll, unless polls come
+*  faster than an erase and one is going to be retried anyway, or the Device
+*  isn't polling. The Device waits for the Pic to go quiet, its UART can't
+*  take what comes in during an erase, and its own next poll just waits.
+* @return {boolean} - `true` if it is safe to write to flash
+* @author AJ Keller (@pushtheworldllc)
+*/
+boolean OpenBCI_Radios_Class::flashCommitRadioQuiet(void) {
+  if (radioMode == OPENBCI_MODE_HOST) {
+    unsigned long now = millis();
+    if (packetInTXRadioBuffer || now - lastTimeHostHeardStream <= linkHostQuietMs(false)) {
+      return false;
+    }
+    unsigned long pollMs = (pollTimeUs + 999) / 1000;
+    unsigned long sinceHeard = now - lastTimeHostHeardFromDevice;
+    return pollMs <= OPENBCI_FLASH_PAGE_ERASE_MS || sinceHeard + OPENBCI_FLASH_PAGE_ERASE_MS < pollMs || sinceHeard > linkHostQuietMs(true);
+  } else {
+    return streamPacketBufferHead == streamPacketBufferTail && !bufferSerialHasData() && (micros() - lastTimeSerialRead > (unsigned long)OPENBCI_FLASH_PAGE_ERASE_MS * 1000);
+  }
+}
+
+
+
+/********************************************/
+/********************************************/
+/**************    RUN    *******************/
+/********************************************/
+/********************************************/
+
+/**
+* @description The whole of `loop()` for both radios. Work is posted with
+*  ::runPost() by the radio callback and ::runPostFromLoop() by `loop()`, and
+*  only the handlers with work are run, stream packets first. Slow
+*  housekeeping and a look at everything, in case a post was missed, happen
+*  every `OPENBCI_TIMEOUT_RUN_SWEEP_uS`.
+* @author AJ Keller (@pushtheworldllc)
+*/
+void OpenBCI_Radios_Class::run(void) {
+  // Trace a slow pass through the loop, see OPENBCI_TRACE_ENABLED
+  OPENBCI_TRACE_LOOP();
+
+  boolean sweep = micros() - runTimeSweep >= OPENBCI_TIMEOUT_RUN_SWEEP_uS;
+  if (sweep) {
+    runTimeSweep = micros();
+    runPostFromLoop(RUN_WORK_ALL);
+    // Keep the link state for a warm start, see linkStateSave()
+    linkStateSave();
+    // Look for the other radio on the previous channel if it goes quiet
+    linkProcess();
+  }
+
+  if (radioMode == OPENBCI_MODE_HOST) {
+    runHost();
+  } else if (radioMode == OPENBCI_MODE_DEVICE) {
+    runDevice();
+  }
+
+  // Store any config changes from the radio callback while the radio is quiet
+  if (runTake(RUN_WORK_FLASH)) {
+    flashCommitProcess();
+    if (flashCommitHasPending()) {
+      runPostFromLoop(RUN_WORK_FLASH);
+    }
+  }
+
+  // Advance any timed transitions (page retry, channel or baud change)
+  if (runTake(RUN_WORK_TIMER)) {
+    timerProcess();
+    for (uint8_t event = 0; event < TIMER_EVENT_COUNT; event++) {
+      if (timerActive[event]) {
+        runPostFromLoop(RUN_WORK_TIMER);
+        break;
+      }
+    }
+  }
+}
+
+/**
+* @description One pass of ::run() on the Device. The Pic's serial port and
+*  the stream ring are looked at every pass, the rest when posted.
+* @author AJ Keller (@pushtheworldllc)
+*/
+void OpenBCI_Radios_Class::runDevice(void) {
+  // First we must ask if an emergency stop flag has been triggered, as a Device
+  //  we must frequently ask this question as we are the only one that can
+  //  initiaite a communication between back to the Driver.
+  if (bufferSerial.overflowed) {
+    // Clear the buffer holding all serial data.
+    bufferSerialReset(OPENBCI_NUMBER_SERIAL_BUFFERS);
+
+    // Reset the stream buffer
+    bufferStreamReset();
+
+#if OPENBCI_FLOW_CONTROL
+    // The Pic didn't stop for XOFF, what it sent is dropped but it keeps going
+#else
+    // Send reset message to the board
+    resetPic32();
+#endif
+
+    // Reset the last time we contacted the host to now
+    pollRefresh();
+
+    // Send emergency message to the host
+    singleCharMsg[0] = (char)ORPM_DEVICE_SERIAL_OVERFLOW;
+
+    if (RFduinoGZLL.sendToHost(singleCharMsg,1)) {
+      bufferSerial.overflowed = false;
+    }
+  } else {
+    // Stream packets from the Host go to the Pic first
+    bufferStreamDownFlush();
+
+    if (Serial.available()) { // Is there new serial data available?
+      char newChar = Serial.read();
+      // Mark the last serial as now;
+      lastTimeSerialRead = micros();
+      // Store it to serial buffer
+      bufferSerialAddChar(newChar);
+      // Get one char and process it
+      bufferStreamAddChar((streamPacketBuffer + streamPacketBufferHead), newChar);
+      // Reset the poll timer to prevent contacting the host mid read
+      pollRefresh();
+    }
+
+    // Pause the Pic before the serial buffers run out
+    flowControlProcess();
+
+    if ((streamPacketBuffer + streamPacketBufferHead)->state == STREAM_STATE_READY) { // Is there a stream packet waiting to get sent to the Host?
+      // Has 92uS passed since the last time we read from the serial port? If
+      //  the Host asked for decimation only one packet in N goes in the ring
+      if (bufferStreamTimeout() && bufferStreamDecimate(streamPacketBuffer + streamPacketBufferHead)) {
+        // We are sure this is a streaming packet.
+        streamPacketBufferHead++;
+        if (streamPacketBufferHead > (OPENBCI_NUMBER_STREAM_BUFFERS - 1)) {
+          streamPacketBufferHead = 0;
+        }
+        OPENBCI_TRACE(OPENBCI_TRACE_EVENT_RING_HEAD, streamPacketBufferHead, (streamPacketBufferHead + OPENBCI_NUMBER_STREAM_BUFFERS - streamPacketBufferTail) % OPENBCI_NUMBER_STREAM_BUFFERS);
+      }
+    }
+
+    // A finished parity group and stream packets the Host missed go before
+    //  new ones, one packet per pass
+    if (bufferStreamParitySendToHost()) {
+      // Parity sent
+    } else if (bufferStreamResendToHost()) {
+      // Resend sent
+    } else if ((streamPacketBuffer + streamPacketBufferTail)->state == STREAM_STATE_READY) { // Is there a stream packet waiting to get sent to the Host?
+      // In low power the ring fills up and goes out in bursts
+      if (streamPacketBufferHead != streamPacketBufferTail && bufferStreamBurstReady()) {
+        // Try to add the tail to the TX buffer
+        if (bufferStreamSendToHost(streamPacketBuffer + streamPacketBufferTail)) {
+          streamPacketBufferTail++;
+          if (streamPacketBufferTail > (OPENBCI_NUMBER_STREAM_BUFFERS - 1)) {
+            streamPacketBufferTail = 0;
+          }
+          OPENBCI_TRACE(OPENBCI_TRACE_EVENT_RING_TAIL, streamPacketBufferTail, (streamPacketBufferHead + OPENBCI_NUMBER_STREAM_BUFFERS - streamPacketBufferTail) % OPENBCI_NUMBER_STREAM_BUFFERS);
+        }
+      }
+    }
+  }
+
+  // Send the trace ring once the Host asks for it
+  OPENBCI_TRACE_SEND();
+
+  // Send the radio on time once the Host asks for it
+  lowPowerReportSendToHost();
+
+  if (bufferSerialHasData()) { // Is there data from the Pic waiting to get sent to Host
+    // Has 3ms passed since the last time the serial port was read. Only the
+    //  first packet get's sent from here
+    if (bufferSerialTimeout() && bufferSerial.numberOfPacketsSent == 0 ) {
+      // In order to do checksumming we must only send one packet at a time
+      //  this stands as the first time we are going to send a packet!
+      sendPacketToHost();
+    }
+  }
+
+  // Pages from the Host go to the Pic once all their packets are in
+  if (runTake(RUN_WORK_PAGE)) {
+    bufferRadioFlushBuffers();
+  }
+
+  // Write over the air upload data to the Pic and keep the Host polled
+  uploadProcess();
+
+  if (pollNow()) {  // Has more than the poll time passed? Longer when quiet in low power or streaming
+    // Refresh the poll timer
+    pollRefresh();
+    // Poll the host
+    sendPollMessageToHost();
+  }
+}
+
+/**
+* @description One pass of ::run() on the Host. Stream packets from the radio
+*  callback go to the driver first, as many as the output can take, then
+*  messages, pages and the driver's serial port.
+* @author AJ Keller (@pushtheworldllc)
+*/
+void OpenBCI_Radios_Class::runHost(void) {
+  // Handle the packets the radio callback copied in, see rxQueueProcess()
+  if (runTake(RUN_WORK_RX)) {
+    rxQueueProcess();
+  }
+
+  // Stream packets stay posted while the ring has any, a missing packet or
+  //  a batch holds them back for a while
+  if (runTake(RUN_WORK_STREAM)) {
+    uint8_t tail;
+    do {
+      tail = streamPacketBufferTail;
+      bufferStreamFlushBuffers();
+    } while (tail != streamPacketBufferTail);
+    if (streamPacketBufferTail != streamPacketBufferHead) {
+      runPostFromLoop(RUN_WORK_STREAM);
+    }
+  }
+
+  // Write what the UART can take right now to the PC/Driver
+  if (runTake(RUN_WORK_OUTPUT)) {
+    outputProcess();
+    if (outputPositionRead != outputPositionWrite) {
+      runPostFromLoop(RUN_WORK_OUTPUT);
+    }
+  }
+
+  // Messages wait until the output has room for all of one
+  if (printMessageToDriverFlag && outputFree() >= OPENBCI_OUTPUT_MESSAGE_MAX) {
+    printMessageToDriverFlag = false;
+    printMessageToDriver(msgToPrint);
+  }
+
+  // Write out trace records from the Device
+  OPENBCI_TRACE_FLUSH();
+
+  // Pages stay posted until the output can take all of one
+  if (runTake(RUN_WORK_PAGE)) {
+    bufferRadioFlushBuffers();
+    for (int i = 0; i < OPENBCI_NUMBER_RADIO_BUFFERS; i++) {
+      if (bufferRadio[i].gotAllPackets) {
+        runPostFromLoop(RUN_WORK_PAGE);
+      }
+    }
+  }
+
+  // Is there new data from the PC/Driver?
+  if (uploadActive) {
+    // Over the air upload, PC data goes straight to the upload buffer
+    uploadProcess();
+  } else if (didPCSendDataToHost()) {
+    char newChar = Serial.read();
+    // Get data and put it on the serial buffer
+    boolean success;
+    if (bufferStreamDownAddChar(newChar)) {
+      // Stream packets to the Device go out the moment the stop byte is in
+      success = true;
+    } else if (commandFastAdd(newChar)) {
+      // A lone board command while streaming rides on the very next ack
+      success = true;
+    } else if (serialFramingEnabled) {
+      // Framed pages are sent the moment the last byte is in
+      success = bufferSerialAddFramedChar(newChar);
+    } else {
+      success = bufferSerialAddChar(newChar);
+    }
+    // Save the last time serial data was read to now
+    lastTimeSerialRead = micros();
+    if (!success) {
+      outputPrint("Failure: Input too large!$$$");
+    }
+  } else if (bufferSerialFrameTimeout()) {
+    outputPrint("Failure: Incomplete frame!$$$");
+  }
+
+  // Set system to down if we experience a comms timout
+  boolean commsFailure = commsFailureTimeout();
+  if (commsFailure) {
+    // Mark the system as down
+    systemUp = false;
+    // Drop anything still waiting for an ack
+    txQueueReset();
+    // Check to see if data was left in the radio buffer from an incomplete
+    //  multi packet transfer.. i.e. a failed over the air upload
+    if (bufferRadioHasData(currentRadioBuffer)) {
+      // Reset the radio buffer flags
+      bufferRadioReset(currentRadioBuffer);
+      // Clean the buffer.. fill with zeros
+      bufferRadioClean(currentRadioBuffer);
+    }
+  }
+
+  // Move a finished single packet page to the TX queue so the next command
+  //  can be read in while it waits for an ack
+  txQueueAddSerialPage();
+
+  if (serialWriteTimeOut()) {
+    // Is the time the Device contacted the host greater than 0? This is
+    //  true if the Device has NEVER contacted the Host
+    if (lastTimeHostHeardFromDevice > 0) {
+      // Is a packet in the TX buffer
+      if (packetInTXRadioBuffer == false) {
+        if (commsFailure) {
+          bufferSerialProcessCommsFailure();
+        } else {
+          //packets in the serial buffer and there is 1 packet to send
+          if (bufferSerial.numberOfPacketsSent == 0 && bufferSerial.numberOfPacketsToSend > 0) {
+            // process with a send to device
+            processOutboundBufferForTimeSync();
+          }
+        }
+      } else {
+        // Comms time out?
+        if (commsFailure) {
+          if (isWaitingForNewChannelNumberConfirmation && !channelNumberSaveAttempted) {
+            RFduinoGZLL.end();
+            RFduinoGZLL.channel = getChannelNumber();
+            RFduinoGZLL.begin(RFDUINOGZLL_ROLE_HOST);
+            lastTimeHostHeardFromDevice = millis();
+            channelNumberSaveAttempted = true;
+          } else {
+            bufferSerialProcessCommsFailure();
+          }
+        }
+      }
+    } else { // lastTimeHostHeardFromDevice has not been changed
+      // comms time out?
+      // We here if the device never polled the host
+      if (commsFailure) {
+        bufferSerialProcessCommsFailure();
+      }
+    }
+  }
+}
+
+/**
+* @description Posts work for ::run() to do on its next pass. Only where the
+*  radio callback can't get in, `RFduinoGZLL_onReceive` itself or code that
+*  already holds it off. Everywhere else in `loop()` uses ::runPostFromLoop().
+* @param `work` {uint8_t} - One or more `RUN_WORK_*` OR'd together
+* @author AJ Keller (@pushtheworldllc)
+*/
+void OpenBCI_Radios_Class::runPost(uint8_t work) {
+  runPending |= work;
+}
+
+/**
+* @description Posts work from `loop()`. The read, OR and write of the bitmask
+*  are held together so a post the radio callback makes in the middle isn't
+*  lost. Also used by code the callback shares with `loop()`, the callback
+*  can't interrupt itself so holding it off there changes nothing.
+* @param `work` {uint8_t} - One or more `RUN_WORK_*` OR'd together
+* @author AJ Keller (@pushtheworldllc)
+*/
+void OpenBCI_Radios_Class::runPostFromLoop(uint8_t work) {
+  noInterrupts();
+  OPENBCI_TRACE_MASK_START();
+  runPending |= work;
+  OPENBCI_TRACE_MASK_END(OPENBCI_TRACE_MASKED_RUN);
+  interrupts();
+}
 
+/**
+* @description Takes posted work off the bitmask for ::run() to do. The
+*  handler posts it again if any is left.
+* @param `work` {uint8_t} - The `RUN_WORK_*` to take
+* @return {boolean} - `true` if `work` was posted
+* @author AJ Keller (@pushtheworldllc)
+*/
+boolean OpenBCI_Radios_Class::runTake(uint8_t work) {
+  noInterrupts();
+  OPENBCI_TRACE_MASK_START();
+  boolean posted = (runPending & work) != 0;
+  runPending &= ~work;
+  OPENBCI_TRACE_MASK_END(OPENBCI_TRACE_MASKED_RUN);
+  interrupts();
+  return posted;
+}
 
 /********************************************/
 /********************************************/
@@ -407,36 +1151,36 @@ boolean OpenBCI_Radios_Class::hostPacketToSend(void) {
 }
 
 void OpenBCI_Radios_Class::printChannelNumber(char c) {
-  Serial.print("Channel number: "); Serial.print((int)c); Serial.write(c);
+  outputPrint("Channel number: "); outputPrintNumber((uint8_t)c); outputAdd(&c, 1);
 }
 
 void OpenBCI_Radios_Class::printChannelNumberVerify(void) {
-  Serial.print("Verify channel number is less than 25");
+  outputPrint("Verify channel number is less than 25");
 }
 
 void OpenBCI_Radios_Class::printBaudRateChangeTo(int b) {
-  Serial.print("Switch your baud rate to ");
-  Serial.print(b);
+  outputPrint("Switch your baud rate to ");
+  outputPrintNumber(b);
 };
 
 void OpenBCI_Radios_Class::printCommsTimeout(void) {
-  Serial.print("Communications timeout - Device failed to poll Host");
+  outputPrint("Communications timeout - Device failed to poll Host");
 }
 
 void OpenBCI_Radios_Class::printEOT(void) {
-  Serial.print("$$$");
+  outputPrint("$$$");
 }
 
 void OpenBCI_Radios_Class::printFailure(void) {
-  Serial.print("Failure: ");
+  outputPrint("Failure: ");
 }
 
 void OpenBCI_Radios_Class::printPollTime(char p) {
-  Serial.print("Poll time: "); Serial.print((int)p); Serial.write(p);
+  outputPrint("Poll time: "); outputPrintNumber((uint8_t)p); outputAdd(&p, 1);
 }
 
 void OpenBCI_Radios_Class::printSuccess(void) {
-  Serial.print("Success: ");
+  outputPrint("Success: ");
 }
 
 void OpenBCI_Radios_Class::printValidatedCommsTimeout(void) {
@@ -446,8 +1190,10 @@ void OpenBCI_Radios_Class::printValidatedCommsTimeout(void) {
 }
 
 /**
-* @description Writes to the serial port a message that matches a specific code.
-* @param {uint8_t} - The code to print Serial.write()
+* @description Stages a message that matches a specific code for the driver,
+*  see ::outputProcess(). Call it once the output has room for
+*  `OPENBCI_OUTPUT_MESSAGE_MAX` bytes.
+* @param {uint8_t} - The code to print
 *  Possible options:
 *  `HOST_MESSAGE_COMMS_DOWN` - Print the comms down message
 *  `HOST_MESSAGE_COMMS_DOWN_CHAN` - Print the message when the comms when down trying to change channels.
@@ -464,6 +1210,26 @@ void OpenBCI_Radios_Class::printValidatedCommsTimeout(void) {
 *  `HOST_MESSAGE_CHAN_GET_SUCCESS` - The message to print when the Host and Device are communicating.
 *  `HOST_MESSAGE_POLL_TIME` - Prints the poll time when there is no comms.
 *  `HOST_MESSAGE_SERIAL_ACK` - Writes a serial ack (',') to the Driver/PC
+*  `HOST_MESSAGE_FLASH_FAILURE` - A deferred flash commit could not be written
+*  `HOST_MESSAGE_UPLOAD_START` - The Host and Device are in upload mode
+*  `HOST_MESSAGE_FRAMING_ON` - The Host expects framed pages from the driver
+*  `HOST_MESSAGE_FRAMING_OFF` - The Host uses the serial timeout to find pages
+*  `HOST_MESSAGE_STREAM_DOWN_ON` - The Host sends stream packets from the driver
+*  `HOST_MESSAGE_STREAM_DOWN_OFF` - Stream packets from the driver are pages
+*  `HOST_MESSAGE_PARITY` - The parity group size and what it recovered
+*  `HOST_MESSAGE_PARITY_VERIFY` - The parity group size asked for is not allowed
+*  `HOST_MESSAGE_TRACE` - The Host trace ring, see ::traceDump()
+*  `HOST_MESSAGE_BOARD_OVERFLOW` - The Device was overflowed by the Pic
+*  `HOST_MESSAGE_BATCH_ON` - Stream packets go to the driver in batches
+*  `HOST_MESSAGE_BATCH_OFF` - Stream packets go to the driver one at a time
+*  `HOST_MESSAGE_DECIMATE` - How many stream packets the Device averages into one
+*  `HOST_MESSAGE_DECIMATE_VERIFY` - The decimation asked for is not allowed
+*  `HOST_MESSAGE_LOW_POWER` - How long the Device holds stream packets for a burst
+*  `HOST_MESSAGE_LOW_POWER_VERIFY` - The burst wait asked for is not allowed
+*  `HOST_MESSAGE_LOW_POWER_REPORT` - The Device's radio on time per stream packet
+*  `HOST_MESSAGE_POLL_TIME_US` - The poll time in uS
+*  `HOST_MESSAGE_POLL_TIME_VERIFY` - The poll time asked for is not allowed
+*  `HOST_MESSAGE_TX_QUEUE_FULL` - A setting for the Device could not be queued
 * @author AJ Keller (@pushtheworldllc)
 */
 void OpenBCI_Radios_Class::printMessageToDriver(uint8_t code) {
@@ -473,55 +1239,52 @@ void OpenBCI_Radios_Class::printMessageToDriver(uint8_t code) {
     break;
     case HOST_MESSAGE_COMMS_DOWN_CHAN:
     printFailure();
-    Serial.print("Channel Change Request");
+    outputPrint("Channel Change Request");
     printCommsTimeout();
     printEOT();
     break;
     case HOST_MESSAGE_COMMS_DOWN_POLL_TIME:
     printFailure();
-    Serial.print("Poll Time Change Request");
+    outputPrint("Poll Time Change Request");
     printCommsTimeout();
     printEOT();
     break;
     case HOST_MESSAGE_SYS_UP:
     printSuccess();
-    Serial.print("System is Up");
+    outputPrint("System is Up");
     printEOT();
     break;
     case HOST_MESSAGE_SYS_DOWN:
     printFailure();
-    Serial.print("System is Down");
+    outputPrint("System is Down");
     printEOT();
     break;
     case HOST_MESSAGE_BAUD_FAST:
     printSuccess();
     printBaudRateChangeTo((int)OPENBCI_BAUD_RATE_FAST);
     printEOT();
-    delay(2);
-    // Close the current serial connection
-    Serial.end();
-    // Open the Serial connection
-    Serial.begin(OPENBCI_BAUD_RATE_FAST);
+    // Switch once the message has gone out, see ::timerProcess()
+    timerBaudRate = OPENBCI_BAUD_RATE_FAST;
+    timerBaudPosition = outputPositionWrite;
+    timerStart(TIMER_EVENT_BAUD_CHANGE, OPENBCI_TIMEOUT_BAUD_CHANGE_uS);
     break;
     case HOST_MESSAGE_BAUD_DEFAULT:
     printSuccess();
     printBaudRateChangeTo((int)OPENBCI_BAUD_RATE_DEFAULT);
     printEOT();
-    delay(2);
-    // Close the current serial connection
-    Serial.end();
-    // Open the Serial connection
-    Serial.begin(OPENBCI_BAUD_RATE_DEFAULT);
+    // Switch once the message has gone out, see ::timerProcess()
+    timerBaudRate = OPENBCI_BAUD_RATE_DEFAULT;
+    timerBaudPosition = outputPositionWrite;
+    timerStart(TIMER_EVENT_BAUD_CHANGE, OPENBCI_TIMEOUT_BAUD_CHANGE_uS);
     break;
     case HOST_MESSAGE_BAUD_HYPER:
     printSuccess();
     printBaudRateChangeTo((int)OPENBCI_BAUD_RATE_HYPER);
     printEOT();
-    delay(2);
-    // Close the current serial connection
-    Serial.end();
-    // Open the Serial connection
-    Serial.begin(OPENBCI_BAUD_RATE_HYPER);
+    // Switch once the message has gone out, see ::timerProcess()
+    timerBaudRate = OPENBCI_BAUD_RATE_HYPER;
+    timerBaudPosition = outputPositionWrite;
+    timerStart(TIMER_EVENT_BAUD_CHANGE, OPENBCI_TIMEOUT_BAUD_CHANGE_uS);
     break;
     case HOST_MESSAGE_CHAN:
     printValidatedCommsTimeout();
@@ -532,7 +1295,7 @@ void OpenBCI_Radios_Class::printMessageToDriver(uint8_t code) {
     RFduinoGZLL.channel = getChannelNumber();
     RFduinoGZLL.begin(RFDUINOGZLL_ROLE_HOST);
     printSuccess();
-    Serial.print("Host override - ");
+    outputPrint("Host override - ");
     printChannelNumber(getChannelNumber());
     printEOT();
     systemUp = false;
@@ -544,39 +1307,176 @@ void OpenBCI_Radios_Class::printMessageToDriver(uint8_t code) {
     break;
     case HOST_MESSAGE_CHAN_GET_FAILURE:
     printFailure();
-    Serial.print("Host on ");
+    outputPrint("Host on ");
     printChannelNumber(getChannelNumber());
     printEOT();
     systemUp = false;
     break;
     case HOST_MESSAGE_CHAN_GET_SUCCESS:
     printSuccess();
-    Serial.print("Host and Device on ");
+    outputPrint("Host and Device on ");
     printChannelNumber(getChannelNumber());
     printEOT();
     break;
     case HOST_MESSAGE_POLL_TIME:
     printSuccess();
-    printPollTime(radio.getPollTime());
+    if (radio.getPollTime() & OPENBCI_POLL_TIME_US_FLAG) {
+      // Doesn't fit the one byte answer
+      outputPrint("Poll time ");
+      outputPrintNumber(pollTimeUs);
+      outputPrint(" us");
+    } else {
+      printPollTime(radio.getPollTime());
+    }
+    printEOT();
+    break;
+    case HOST_MESSAGE_POLL_TIME_US:
+    printSuccess();
+    outputPrint("Poll time ");
+    outputPrintNumber(pollTimeUs);
+    outputPrint(" us");
+    printEOT();
+    break;
+    case HOST_MESSAGE_POLL_TIME_VERIFY:
+    printFailure();
+    outputPrint("Poll time must be 600 to 255000 us");
+    printEOT();
+    break;
+    case HOST_MESSAGE_TX_QUEUE_FULL:
+    printFailure();
+    outputPrint("Radio busy, nothing changed, try again");
     printEOT();
     break;
     case HOST_MESSAGE_SERIAL_ACK:
     // Messages to print
-    Serial.write(',');
+    outputPrint(",");
     break;
-    default:
+    case HOST_MESSAGE_FLASH_FAILURE:
+    printFailure();
+    outputPrint("Unable to save to non-volatile memory");
+    printEOT();
     break;
-  }
-}
-
-/**
-* @description Used to process the the serial buffer if the device fails to poll the host
-*  more than 3 * pollTime.
-* @author AJ Keller (@pushtheworldllc)
-*/
-void OpenBCI_Radios_Class::bufferSerialProcessCommsFailure(void) {
-  systemUp = false;
-  if (isWaitingForNewChannelNumberConfirmation) {
+    case HOST_MESSAGE_UPLOAD_START:
+    printSuccess();
+    outputPrint("Upload mode");
+    printEOT();
+    break;
+    case HOST_MESSAGE_FRAMING_ON:
+    printSuccess();
+    outputPrint("Framing on");
+    printEOT();
+    break;
+    case HOST_MESSAGE_FRAMING_OFF:
+    printSuccess();
+    outputPrint("Framing off");
+    printEOT();
+    break;
+    case HOST_MESSAGE_STREAM_DOWN_ON:
+    printSuccess();
+    outputPrint("Stream to Device on");
+    printEOT();
+    break;
+    case HOST_MESSAGE_STREAM_DOWN_OFF:
+    printSuccess();
+    outputPrint("Stream to Device off");
+    printEOT();
+    break;
+    case HOST_MESSAGE_PARITY:
+    printSuccess();
+    outputPrint("Parity group ");
+    outputPrintNumber(streamParityGroup);
+    outputPrint(" recovered ");
+    outputPrintNumber(streamParityRecovered);
+    outputPrint(" lost ");
+    outputPrintNumber(streamParityLost);
+    printEOT();
+    break;
+    case HOST_MESSAGE_PARITY_VERIFY:
+    printFailure();
+    outputPrint("Parity group must be 0 or 2 to 8");
+    printEOT();
+    break;
+    case HOST_MESSAGE_TRACE:
+#if OPENBCI_TRACE_ENABLED
+    traceDump();
+#else
+    printFailure();
+    outputPrint("Trace not built in");
+    printEOT();
+#endif
+    break;
+    case HOST_MESSAGE_BOARD_OVERFLOW:
+    printFailure();
+#if OPENBCI_FLOW_CONTROL
+    outputPrint("Board RFduino buffer overflowed. Data from the Board was dropped.");
+#else
+    outputPrint("Board RFduino buffer overflowed. Soft reset command sent to Board.");
+#endif
+    printEOT();
+    break;
+    case HOST_MESSAGE_BATCH_ON:
+    printSuccess();
+    outputPrint("Batching on");
+    printEOT();
+    break;
+    case HOST_MESSAGE_BATCH_OFF:
+    printSuccess();
+    outputPrint("Batching off");
+    printEOT();
+    break;
+    case HOST_MESSAGE_DECIMATE:
+    printSuccess();
+    outputPrint("Decimate by ");
+    outputPrintNumber(streamDecimate > 1 ? streamDecimate : 1);
+    printEOT();
+    break;
+    case HOST_MESSAGE_DECIMATE_VERIFY:
+    printFailure();
+    outputPrint("Decimate must be 1 to 16");
+    printEOT();
+    break;
+    case HOST_MESSAGE_LOW_POWER:
+    printSuccess();
+    if (lowPowerWaitMs > 0) {
+      outputPrint("Low power burst wait ");
+      outputPrintNumber(lowPowerWaitMs);
+      outputPrint(" ms");
+    } else {
+      outputPrint("Low power off");
+    }
+    printEOT();
+    break;
+    case HOST_MESSAGE_LOW_POWER_VERIFY:
+    printFailure();
+    outputPrint("Low power burst wait must be 0 to 100 ms");
+    printEOT();
+    break;
+    case HOST_MESSAGE_LOW_POWER_REPORT:
+    printSuccess();
+    outputPrint("Radio on ");
+    outputPrintNumber(lowPowerPackets > 0 ? lowPowerRadioOnUs / lowPowerPackets : 0);
+    outputPrint(" us per packet, ");
+    outputPrintNumber(lowPowerRadioOnUs);
+    outputPrint(" us ");
+    outputPrintNumber(lowPowerPackets);
+    outputPrint(" packets ");
+    outputPrintNumber(lowPowerWakes);
+    outputPrint(" wakes");
+    printEOT();
+    break;
+    default:
+    break;
+  }
+}
+
+/**
+* @description Used to process the the serial buffer if the device fails to poll the host
+*  more than 3 * pollTime.
+* @author AJ Keller (@pushtheworldllc)
+*/
+void OpenBCI_Radios_Class::bufferSerialProcessCommsFailure(void) {
+  systemUp = false;
+  if (isWaitingForNewChannelNumberConfirmation) {
     isWaitingForNewChannelNumberConfirmation = false;
     revertToPreviousChannelNumber();
     msgToPrint = HOST_MESSAGE_COMMS_DOWN_CHAN;
@@ -612,9 +1512,8 @@ void OpenBCI_Radios_Class::processCommsFailureSinglePacket(void) {
       printMessageToDriver(HOST_MESSAGE_COMMS_DOWN);
       break;
       case OPENBCI_HOST_CMD_CHANNEL_SET_OVERIDE:
-      if (setChannelNumber((uint32_t)bufferSerial.packetBuffer->data[OPENBCI_HOST_PRIVATE_POS_PAYLOAD])) {
-        msgToPrint = HOST_MESSAGE_CHAN_OVERRIDE;
-        printMessageToDriverFlag = true;
+      if (flashCommitAdd(OPENBCI_FLASH_COMMIT_CHANNEL, (uint32_t)bufferSerial.packetBuffer->data[OPENBCI_HOST_PRIVATE_POS_PAYLOAD])) {
+        flashCommitConfirm(HOST_MESSAGE_CHAN_OVERRIDE);
       } else {
         printMessageToDriver(HOST_MESSAGE_CHAN_VERIFY);
       }
@@ -663,13 +1562,11 @@ void OpenBCI_Radios_Class::processCommsFailureSinglePacket(void) {
 * @author AJ Keller (@pushtheworldllc)
 */
 byte OpenBCI_Radios_Class::processOutboundBuffer(PacketBuffer *buf) {
-  if (buf->positionWrite == 3) {
-    return processOutboundBufferCharDouble(buf->data);
-  } else if (buf->positionWrite == 4) {
-    return processOutboundBufferCharTriple(buf->data);
-  } else {
+  if (buf->positionWrite < OPENBCI_HOST_PRIVATE_POS_PAYLOAD) {
     return ACTION_RADIO_SEND_NORMAL;
   }
+  // Whatever follows the code is the payload, see hostCommandDispatch()
+  return hostCommandDispatch(buf->data, buf->positionWrite - OPENBCI_HOST_PRIVATE_POS_PAYLOAD);
 }
 
 /**
@@ -711,1069 +1608,3486 @@ boolean OpenBCI_Radios_Class::processOutboundBufferForTimeSync(void) {
 
 /**
 * @description Called by the Host's on_recieve function if the out bound buffer
-*      has two chars in it.
+*      has two chars in it, a private command with no payload.
 * @param buffer {char *} - The char buffer
-* @return {byte} - The action to be taken after exit:
-*                      ACTION_RADIO_SEND_NORMAL - Send a packet like normal
-*                      ACTION_RADIO_SEND_NONE - Take no action
-*                      ACTION_RADIO_SEND_SINGLE_CHAR - Send a secret radio message from singleCharMsg buffer
+* @return {byte} - The action to be taken after exit, see ::hostCommandDispatch()
 * @author AJ Keller (@pushtheworldllc)
 */
 byte OpenBCI_Radios_Class::processOutboundBufferCharDouble(char *buffer) {
-  // The first byte needs to match the command key to act on it
-  if (buffer[OPENBCI_HOST_PRIVATE_POS_KEY] == OPENBCI_HOST_PRIVATE_CMD_KEY) {
-    // Decode the char
-    switch (buffer[OPENBCI_HOST_PRIVATE_POS_CODE]) {
-      // Is the byte the command for a host channel number?
-      case OPENBCI_HOST_CMD_CHANNEL_GET:
-      if (systemUp) {
-        // Send the channel number back to the driver
-        msgToPrint = HOST_MESSAGE_CHAN_GET_SUCCESS;
-        printMessageToDriverFlag = true;
-      } else {
-        // Send the channel number back to the driver
-        msgToPrint = HOST_MESSAGE_CHAN_GET_FAILURE;
-        printMessageToDriverFlag = true;
-      }
-      // Clear the serial buffer
-      bufferSerialReset(1);
-      return ACTION_RADIO_SEND_NONE;
-      case OPENBCI_HOST_CMD_BAUD_DEFAULT:
-      msgToPrint = HOST_MESSAGE_BAUD_DEFAULT;
-      printMessageToDriverFlag = true;
-      // Clear the serial buffer
-      bufferSerialReset(1);
-      return ACTION_RADIO_SEND_NONE;
-      case OPENBCI_HOST_CMD_BAUD_FAST:
-      msgToPrint = HOST_MESSAGE_BAUD_FAST;
-      printMessageToDriverFlag = true;
-      // Clear the serial buffer
-      bufferSerialReset(1);
-      return ACTION_RADIO_SEND_NONE;
-      case OPENBCI_HOST_CMD_BAUD_HYPER:
-      msgToPrint = HOST_MESSAGE_BAUD_HYPER;
-      printMessageToDriverFlag = true;
-      // Clear the serial buffer
-      bufferSerialReset(1);
-      return ACTION_RADIO_SEND_NONE;
-      case OPENBCI_HOST_CMD_SYS_UP:
-      if (systemUp) {
-        msgToPrint = HOST_MESSAGE_SYS_UP;
-        printMessageToDriverFlag = true;
-      } else {
-        msgToPrint = HOST_MESSAGE_SYS_DOWN;
-        printMessageToDriverFlag = true;
-      }
-      // Clear the serial buffer
-      bufferSerialReset(1);
-      return ACTION_RADIO_SEND_NONE;
-      case OPENBCI_HOST_CMD_POLL_TIME_GET:
-      if (systemUp) {
-        // Send a time change request to the device
-        singleCharMsg[0] = (char)ORPM_GET_POLL_TIME;
-        // Clean the serial buffer
-        bufferSerialReset(1);
-        return ACTION_RADIO_SEND_SINGLE_CHAR;
-      } else {
-        msgToPrint = HOST_MESSAGE_COMMS_DOWN;
-        printMessageToDriverFlag = true;
-        // Clean the serial buffer
-        bufferSerialReset(1);
-        return ACTION_RADIO_SEND_NONE;
-      }
-      default:
-      if (systemUp) {
-        return ACTION_RADIO_SEND_NORMAL;
-      } else {
-        msgToPrint = HOST_MESSAGE_COMMS_DOWN;
-        printMessageToDriverFlag = true;
-        // Clean the serial buffer
-        bufferSerialReset(1);
-        return ACTION_RADIO_SEND_NONE;
-      }
-    }
-  } else {
-    return ACTION_RADIO_SEND_NORMAL;
-  }
+  return hostCommandDispatch(buffer, 0);
 }
 
 /**
 * @description Called by the Host's on_recieve function if the out bound buffer
-*      has three chars in it.
+*      has three chars in it, a private command with a one byte payload.
 * @param buffer {char *} - The char buffer
+* @return {byte} - The action to be taken after exit, see ::hostCommandDispatch()
+* @author AJ Keller (@pushtheworldllc)
+*/
+byte OpenBCI_Radios_Class::processOutboundBufferCharTriple(char *buffer) {
+  return hostCommandDispatch(buffer, 1);
+}
+
+/**
+* @description Looks up a private command from the PC/Driver in the command
+*  table by its code and runs its handler. The page must carry exactly the
+*  payload the command was registered with, anything else goes to the Device
+*  like before. Commands registered as needing the link answer
+*  `HOST_MESSAGE_COMMS_DOWN` while the system is down. The serial buffer is
+*  cleared for everything handled here.
+* @param buffer {char *} - The page, the key and code start at
+*  `OPENBCI_HOST_PRIVATE_POS_KEY`
+* @param payloadLength {uint8_t} - Bytes after the code
 * @return {byte} - The action to be taken after exit:
 *                      ACTION_RADIO_SEND_NORMAL - Send a packet like normal
 *                      ACTION_RADIO_SEND_NONE - Take no action
 *                      ACTION_RADIO_SEND_SINGLE_CHAR - Send a secret radio message from singleCharMsg buffer
 * @author AJ Keller (@pushtheworldllc)
 */
-byte OpenBCI_Radios_Class::processOutboundBufferCharTriple(char *buffer) {
+byte OpenBCI_Radios_Class::hostCommandDispatch(char *buffer, uint8_t payloadLength) {
   // The first byte needs to match the command key to act on it
-  if (buffer[OPENBCI_HOST_PRIVATE_POS_KEY] == OPENBCI_HOST_PRIVATE_CMD_KEY) {
-    switch (buffer[OPENBCI_HOST_PRIVATE_POS_CODE]) {
-      // Is the first byte equal to the channel change request?
-      case OPENBCI_HOST_CMD_CHANNEL_SET:
-      if (!systemUp) {
-        msgToPrint = HOST_MESSAGE_COMMS_DOWN;
-        printMessageToDriverFlag = true;
-        // Clean the serial buffer
-        bufferSerialReset(1);
-        return ACTION_RADIO_SEND_NONE;
-      }
-      // Make sure the channel is within bounds (<25)
-      if (buffer[3] <= RFDUINOGZLL_CHANNEL_LIMIT_UPPER) {
-        // Save requested new channel number
-        radioChannel = (uint32_t)buffer[OPENBCI_HOST_PRIVATE_POS_PAYLOAD];
-        // Save the previous channel number
-        previousRadioChannel = getChannelNumber();
-        // Send a channel change request to the device
-        singleCharMsg[0] = (char)ORPM_CHANGE_CHANNEL_HOST_REQUEST;
-        // Clear the serial buffer
-        bufferSerialReset(1);
-        // Send a single char message
-        return ACTION_RADIO_SEND_SINGLE_CHAR;
-      } else {
-        // Clear the serial buffer
-        bufferSerialReset(1);
-        // Send back error message to the PC/Driver
-        msgToPrint = HOST_MESSAGE_CHAN_VERIFY;
-        printMessageToDriverFlag = true;
-        // Don't send a single char message
-        return ACTION_RADIO_SEND_NONE;
-      }
-      case OPENBCI_HOST_CMD_POLL_TIME_SET:
-      if (systemUp) {
-        // Save the new poll time
-        pollTime = (uint32_t)buffer[OPENBCI_HOST_PRIVATE_POS_PAYLOAD];
-        // Send a time change request to the device
-        singleCharMsg[0] = (char)ORPM_CHANGE_POLL_TIME_HOST_REQUEST;
-        // Clear the serial buffer
-        bufferSerialReset(1);
-        return ACTION_RADIO_SEND_SINGLE_CHAR;
-      } else {
-        msgToPrint = HOST_MESSAGE_COMMS_DOWN;
-        printMessageToDriverFlag = true;
-        // Clean the serial buffer
-        bufferSerialReset(1);
-        return ACTION_RADIO_SEND_NONE;
-      }
-      case OPENBCI_HOST_CMD_CHANNEL_SET_OVERIDE:
-      if (setChannelNumber((uint32_t)buffer[OPENBCI_HOST_PRIVATE_POS_PAYLOAD])) {
-        radioChannel = (uint32_t)buffer[OPENBCI_HOST_PRIVATE_POS_PAYLOAD];
-        msgToPrint = HOST_MESSAGE_CHAN_OVERRIDE;
-        printMessageToDriverFlag = true;
-      } else {
-        msgToPrint = HOST_MESSAGE_CHAN_VERIFY;
-        printMessageToDriverFlag = true;
-      }
+  if (buffer[OPENBCI_HOST_PRIVATE_POS_KEY] != OPENBCI_HOST_PRIVATE_CMD_KEY) {
+    return ACTION_RADIO_SEND_NORMAL;
+  }
+  uint8_t code = (uint8_t)buffer[OPENBCI_HOST_PRIVATE_POS_CODE];
+  const HostCommand *cmd = hostCommands + code;
+  if (code >= OPENBCI_HOST_CMD_TABLE_SIZE || cmd->handler == NULL || cmd->payloadLength != payloadLength) {
+    // A code we don't know with no payload still has to go to the Device
+    if (payloadLength == 0 && !systemUp) {
+      msgToPrint = HOST_MESSAGE_COMMS_DOWN;
+      printMessageToDriverFlag = true;
+      // Clean the serial buffer
       bufferSerialReset(1);
       return ACTION_RADIO_SEND_NONE;
-      default:
-      return ACTION_RADIO_SEND_NORMAL;
     }
-  } else {
     return ACTION_RADIO_SEND_NORMAL;
   }
+  byte action;
+  if (cmd->needsLink && !systemUp) {
+    msgToPrint = HOST_MESSAGE_COMMS_DOWN;
+    printMessageToDriverFlag = true;
+    action = ACTION_RADIO_SEND_NONE;
+  } else {
+    action = (this->*cmd->handler)(buffer);
+  }
+  if (action != ACTION_RADIO_SEND_NORMAL) {
+    // Clear the serial buffer
+    bufferSerialReset(1);
+  }
+  return action;
 }
 
 /**
-* @description Called from Host's on_recieve if a packet will be sent.
-* @param `device` {device_t} - The device to send the packet to.
+* @description Reads a multi byte payload of a private command, least
+*  significant byte first.
+* @param buffer {char *} - The page handed to the command's handler
+* @param bytes {uint8_t} - How many payload bytes to read, at most 4
+* @return {uint32_t} - The payload as a number
 * @author AJ Keller (@pushtheworldllc)
 */
-void OpenBCI_Radios_Class::sendPacketToDevice(device_t device, boolean lockPacketSend) {
-  // Build byteId
-  int packetNumber = bufferSerial.numberOfPacketsToSend - bufferSerial.numberOfPacketsSent - 1;
-
-  byte radioAction = ACTION_RADIO_SEND_NORMAL;
-
-  // Is there only one packet to send and it's the first packet?
-  if (bufferSerial.numberOfPacketsToSend == 1 && packetNumber == 0) {
-    // Enter the process outbound buffer subroutine
-    radioAction = processOutboundBuffer(bufferSerial.packetBuffer);
-  }
-
-  // Make the byte id
-  char byteId;
-
-  switch (radioAction) {
-    case ACTION_RADIO_SEND_SINGLE_CHAR:
-    RFduinoGZLL.sendToDevice(device,singleCharMsg,1);
-    // Set flag
-    packetInTXRadioBuffer = true;
-    break;
-    case ACTION_RADIO_SEND_NORMAL:
-    // Save the byteId
-    byteId = byteIdMake(false,packetNumber,(bufferSerial.packetBuffer + bufferSerial.numberOfPacketsSent)->data + 1, (bufferSerial.packetBuffer + bufferSerial.numberOfPacketsSent)->positionWrite - 1);
-    // Add the byteId to the packet
-    (bufferSerial.packetBuffer + bufferSerial.numberOfPacketsSent)->data[0] = byteId;
-    // Serial.print("Sending "); Serial.print((bufferSerial.packetBuffer + bufferSerial.numberOfPacketsSent)->positionWrite); Serial.println(" bytes");
-    RFduinoGZLL.sendToDevice(device,(char *)(bufferSerial.packetBuffer + bufferSerial.numberOfPacketsSent)->data, (bufferSerial.packetBuffer + bufferSerial.numberOfPacketsSent)->positionWrite);
-    // Increment number of bytes sent
-    bufferSerial.numberOfPacketsSent++;
-    // Set flag
-    packetInTXRadioBuffer = true;
-    break;
-    default: // do nothing
-    break;
+uint32_t OpenBCI_Radios_Class::hostCommandPayload(char *buffer, uint8_t bytes) {
+  uint32_t value = 0;
+  for (uint8_t i = bytes; i > 0; i--) {
+    value = (value << 8) | (uint8_t)buffer[OPENBCI_HOST_PRIVATE_POS_PAYLOAD + i - 1];
   }
+  return value;
 }
 
-/********************************************/
-/********************************************/
-/***********    DEVICE CODE    **************/
-/********************************************/
-/********************************************/
-
 /**
-* @description Private function to handle a request to read serial as a device
-* @return {boolean} - `true` if there is data to read, `false` if not...
+* @description `0xF0 0x13` and `0xF0 0x14` turn stream batching on and off.
+* @param buffer {char *} - The page
+* @return {byte} - `ACTION_RADIO_SEND_NONE`
 * @author AJ Keller (@pushtheworldllc)
 */
-boolean OpenBCI_Radios_Class::didPicSendDeviceSerialData(void) {
-  return Serial.available() > 0;
+byte OpenBCI_Radios_Class::hostCommandBatch(char *buffer) {
+  if (buffer[OPENBCI_HOST_PRIVATE_POS_CODE] == OPENBCI_HOST_CMD_BATCH_ON) {
+    outputBatchEnabled = true;
+    outputBatchSequence = 0;
+    outputBatchWaiting = false;
+    msgToPrint = HOST_MESSAGE_BATCH_ON;
+  } else {
+    outputBatchEnabled = false;
+    msgToPrint = HOST_MESSAGE_BATCH_OFF;
+  }
+  printMessageToDriverFlag = true;
+  return ACTION_RADIO_SEND_NONE;
 }
 
 /**
-* @description Sends a null byte to the host
+* @description `0xF0 0x05`, `0xF0 0x06` and `0xF0 0x0A` change the baud rate
+*  to the driver once the message announcing it is out.
+* @param buffer {char *} - The page
+* @return {byte} - `ACTION_RADIO_SEND_NONE`
 * @author AJ Keller (@pushtheworldllc)
 */
-void OpenBCI_Radios_Class::sendPollMessageToHost(void) {
-  RFduinoGZLL.sendToHost(NULL,0);
+byte OpenBCI_Radios_Class::hostCommandBaud(char *buffer) {
+  if (buffer[OPENBCI_HOST_PRIVATE_POS_CODE] == OPENBCI_HOST_CMD_BAUD_FAST) {
+    msgToPrint = HOST_MESSAGE_BAUD_FAST;
+  } else if (buffer[OPENBCI_HOST_PRIVATE_POS_CODE] == OPENBCI_HOST_CMD_BAUD_HYPER) {
+    msgToPrint = HOST_MESSAGE_BAUD_HYPER;
+  } else {
+    msgToPrint = HOST_MESSAGE_BAUD_DEFAULT;
+  }
+  printMessageToDriverFlag = true;
+  return ACTION_RADIO_SEND_NONE;
 }
 
 /**
-* @description Sends a one byte long message to the host
-* @param msg {byte} - A single byte to send to the host
+* @description `0xF0 0x00` sends the channel number back to the driver.
+* @param buffer {char *} - The page
+* @return {byte} - `ACTION_RADIO_SEND_NONE`
 * @author AJ Keller (@pushtheworldllc)
 */
-void OpenBCI_Radios_Class::sendRadioMessageToHost(byte msg) {
-  RFduinoGZLL.sendToHost((const char*)msg,1);
+byte OpenBCI_Radios_Class::hostCommandChannelGet(char *) {
+  if (systemUp) {
+    msgToPrint = HOST_MESSAGE_CHAN_GET_SUCCESS;
+  } else {
+    msgToPrint = HOST_MESSAGE_CHAN_GET_FAILURE;
+  }
+  printMessageToDriverFlag = true;
+  return ACTION_RADIO_SEND_NONE;
 }
 
-void OpenBCI_Radios_Class::setByteIdForPacketBuffer(int packetNumber) {
-  char byteId = byteIdMake(false,packetNumber,(bufferSerial.packetBuffer + bufferSerial.numberOfPacketsSent)->data + 1, (bufferSerial.packetBuffer + bufferSerial.numberOfPacketsSent)->positionWrite - 1);
-
-  // Add the byteId to the packet
-  (bufferSerial.packetBuffer + bufferSerial.numberOfPacketsSent)->data[0] = byteId;
+/**
+* @description `0xF0 0x01 channel` asks the Device to move both radios to a
+*  new channel.
+* @param buffer {char *} - The page
+* @return {byte} - `ACTION_RADIO_SEND_SINGLE_CHAR` with the request, or
+*  `ACTION_RADIO_SEND_NONE` if the channel is out of bounds
+* @author AJ Keller (@pushtheworldllc)
+*/
+byte OpenBCI_Radios_Class::hostCommandChannelSet(char *buffer) {
+  // Make sure the channel is within bounds (<25)
+  if (buffer[OPENBCI_HOST_PRIVATE_POS_PAYLOAD] > RFDUINOGZLL_CHANNEL_LIMIT_UPPER) {
+    // Send back error message to the PC/Driver
+    msgToPrint = HOST_MESSAGE_CHAN_VERIFY;
+    printMessageToDriverFlag = true;
+    return ACTION_RADIO_SEND_NONE;
+  }
+  // Save requested new channel number
+  radioChannel = (uint32_t)buffer[OPENBCI_HOST_PRIVATE_POS_PAYLOAD];
+  // Save the previous channel number
+  previousRadioChannel = getChannelNumber();
+  // Send a channel change request to the device
+  singleCharMsg[0] = (char)ORPM_CHANGE_CHANNEL_HOST_REQUEST;
+  return ACTION_RADIO_SEND_SINGLE_CHAR;
 }
 
 /**
-* @description Called from Devices to send a packet to Host. Uses global
-*  variables to send the correct packet.
-* @returns {boolean} - The packet number sent.
+* @description `0xF0 0x02 channel` moves only the Host to a new channel.
+* @param buffer {char *} - The page
+* @return {byte} - `ACTION_RADIO_SEND_NONE`
 * @author AJ Keller (@pushtheworldllc)
 */
-boolean OpenBCI_Radios_Class::sendPacketToHost(void) {
-
-  // Reset the stream buffers
-  bufferStreamReset();
-
-  int packetNumber = bufferSerial.numberOfPacketsToSend - bufferSerial.numberOfPacketsSent - 1;
-
-  // Make the byteId
-  char byteId = byteIdMake(false,packetNumber,(bufferSerial.packetBuffer + bufferSerial.numberOfPacketsSent)->data + 1, (bufferSerial.packetBuffer + bufferSerial.numberOfPacketsSent)->positionWrite - 1);
-
-  // Add the byteId to the packet
-  (bufferSerial.packetBuffer + bufferSerial.numberOfPacketsSent)->data[0] = byteId;
-
-  if (RFduinoGZLL.sendToHost((char *)(bufferSerial.packetBuffer + bufferSerial.numberOfPacketsSent)->data, (bufferSerial.packetBuffer + bufferSerial.numberOfPacketsSent)->positionWrite)) {
-    pollRefresh();
-
-    bufferSerial.numberOfPacketsSent++;
-
-    return true;
+byte OpenBCI_Radios_Class::hostCommandChannelSetOverride(char *buffer) {
+  if (flashCommitAdd(OPENBCI_FLASH_COMMIT_CHANNEL, (uint32_t)buffer[OPENBCI_HOST_PRIVATE_POS_PAYLOAD])) {
+    radioChannel = (uint32_t)buffer[OPENBCI_HOST_PRIVATE_POS_PAYLOAD];
+    flashCommitConfirm(HOST_MESSAGE_CHAN_OVERRIDE);
+  } else {
+    msgToPrint = HOST_MESSAGE_CHAN_VERIFY;
+    printMessageToDriverFlag = true;
   }
-
-  return false;
+  return ACTION_RADIO_SEND_NONE;
 }
 
 /**
-* @description Test to see if a char follows the stream tail byte format
+* @description `0xF0 0x15 n` has the Device average every `n` stream packets
+*  into one.
+* @param buffer {char *} - The page
+* @return {byte} - `ACTION_RADIO_SEND_NONE`
 * @author AJ Keller (@pushtheworldllc)
 */
-boolean OpenBCI_Radios_Class::isATailByte(uint8_t newChar) {
-  return (newChar >> 4) == 0xC;
+byte OpenBCI_Radios_Class::hostCommandDecimateSet(char *buffer) {
+  if (buffer[OPENBCI_HOST_PRIVATE_POS_PAYLOAD] == 0 || (uint8_t)buffer[OPENBCI_HOST_PRIVATE_POS_PAYLOAD] > OPENBCI_STREAM_DECIMATE_MAX) {
+    msgToPrint = HOST_MESSAGE_DECIMATE_VERIFY;
+  } else {
+    // The Host only passes the averaged packets on, the Device does the work
+    char decimateMsg[2] = {(char)OPENBCI_STREAM_DECIMATE_BYTE_ID, buffer[OPENBCI_HOST_PRIVATE_POS_PAYLOAD]};
+    if (txQueueAdd(decimateMsg,2,TX_PRIORITY_CONTROL)) {
+      streamDecimate = (uint8_t)buffer[OPENBCI_HOST_PRIVATE_POS_PAYLOAD];
+      msgToPrint = HOST_MESSAGE_DECIMATE;
+    } else {
+      msgToPrint = HOST_MESSAGE_TX_QUEUE_FULL;
+    }
+  }
+  printMessageToDriverFlag = true;
+  return ACTION_RADIO_SEND_NONE;
 }
 
 /**
-* @description Sends a soft reset command to the Pic 32 incase of an emergency.
+* @description `0xF0 0x0C` and `0xF0 0x0D` turn serial framing on and off.
+* @param buffer {char *} - The page
+* @return {byte} - `ACTION_RADIO_SEND_NONE`
 * @author AJ Keller (@pushtheworldllc)
 */
-void OpenBCI_Radios_Class::resetPic32(void) {
-  Serial.write('v');
+byte OpenBCI_Radios_Class::hostCommandFraming(char *buffer) {
+  serialFramingEnabled = buffer[OPENBCI_HOST_PRIVATE_POS_CODE] == OPENBCI_HOST_CMD_FRAMING_ON;
+  msgToPrint = serialFramingEnabled ? HOST_MESSAGE_FRAMING_ON : HOST_MESSAGE_FRAMING_OFF;
+  printMessageToDriverFlag = true;
+  return ACTION_RADIO_SEND_NONE;
 }
 
-/********************************************/
-/********************************************/
-/*************    PASS THRU    **************/
-/********************************************/
-/********************************************/
-
 /**
-* @description Used to flash the led to indicate to the user the device is in pass through mode.
+* @description `0xF0 0x17` asks the Device for its radio on time, printed
+*  once it answers.
+* @param buffer {char *} - The page
+* @return {byte} - `ACTION_RADIO_SEND_NONE`
 * @author AJ Keller (@pushtheworldllc)
 */
-void OpenBCI_Radios_Class::ledFeedBackForPassThru(void) {
-  digitalWrite(OPENBCI_PIN_HOST_LED,HIGH);
-  delay(600);
-  digitalWrite(OPENBCI_PIN_HOST_LED,LOW);
-  delay(200);
+byte OpenBCI_Radios_Class::hostCommandLowPowerReport(char *) {
+  char lowPowerMsg[2] = {(char)OPENBCI_LOW_POWER_BYTE_ID, (char)OPENBCI_LOW_POWER_REPORT};
+  if (!txQueueAdd(lowPowerMsg,2,TX_PRIORITY_CONTROL)) {
+    msgToPrint = HOST_MESSAGE_TX_QUEUE_FULL;
+    printMessageToDriverFlag = true;
+  }
+  return ACTION_RADIO_SEND_NONE;
 }
 
-/********************************************/
-/********************************************/
-/********    COMMON MEHTOD CODE    **********/
-/********************************************/
-/********************************************/
+/**
+* @description `0xF0 0x16 ms` has the Device hold stream packets up to `ms`
+*  and send them in bursts.
+* @param buffer {char *} - The page
+* @return {byte} - `ACTION_RADIO_SEND_NONE`
+* @author AJ Keller (@pushtheworldllc)
+*/
+byte OpenBCI_Radios_Class::hostCommandLowPowerSet(char *buffer) {
+  if ((uint8_t)buffer[OPENBCI_HOST_PRIVATE_POS_PAYLOAD] > OPENBCI_LOW_POWER_WAIT_MAX_MS) {
+    msgToPrint = HOST_MESSAGE_LOW_POWER_VERIFY;
+  } else {
+    char lowPowerMsg[2] = {(char)OPENBCI_LOW_POWER_BYTE_ID, buffer[OPENBCI_HOST_PRIVATE_POS_PAYLOAD]};
+    if (txQueueAdd(lowPowerMsg,2,TX_PRIORITY_CONTROL)) {
+      lowPowerWaitMs = (uint8_t)buffer[OPENBCI_HOST_PRIVATE_POS_PAYLOAD];
+      msgToPrint = HOST_MESSAGE_LOW_POWER;
+    } else {
+      msgToPrint = HOST_MESSAGE_TX_QUEUE_FULL;
+    }
+  }
+  printMessageToDriverFlag = true;
+  return ACTION_RADIO_SEND_NONE;
+}
 
 /**
-* @description Writes a buffer to the serial port of a given length
-* @param buffer [char *] The buffer you want to write out
-* @param length [int] How many bytes to you want to write out?
+* @description `0xF0 0x11` prints the parity group and what it has recovered.
+* @param buffer {char *} - The page
+* @return {byte} - `ACTION_RADIO_SEND_NONE`
 * @author AJ Keller (@pushtheworldllc)
 */
-void OpenBCI_Radios_Class::writeBufferToSerial(char *buffer, int length) {
-  // Make sure we don't seg fault
-  if (buffer == NULL) return;
+byte OpenBCI_Radios_Class::hostCommandParityGet(char *) {
+  msgToPrint = HOST_MESSAGE_PARITY;
+  printMessageToDriverFlag = true;
+  return ACTION_RADIO_SEND_NONE;
+}
 
-  // Loop through all bytes in buffer
-  for (int i = 0; i < length; i++) {
-    Serial.write(buffer[i]);
+/**
+* @description `0xF0 0x10 n` has the Device send a parity packet after every
+*  `n` stream packets, `0` turns it off.
+* @param buffer {char *} - The page
+* @return {byte} - `ACTION_RADIO_SEND_NONE`
+* @author AJ Keller (@pushtheworldllc)
+*/
+byte OpenBCI_Radios_Class::hostCommandParitySet(char *buffer) {
+  if (buffer[OPENBCI_HOST_PRIVATE_POS_PAYLOAD] == 1 || (uint8_t)buffer[OPENBCI_HOST_PRIVATE_POS_PAYLOAD] > OPENBCI_STREAM_PARITY_GROUP_MAX) {
+    msgToPrint = HOST_MESSAGE_PARITY_VERIFY;
+  } else {
+    // Tell the Device on the next ack
+    char parityMsg[2] = {(char)OPENBCI_STREAM_PARITY_BYTE_ID, buffer[OPENBCI_HOST_PRIVATE_POS_PAYLOAD]};
+    if (txQueueAdd(parityMsg,2,TX_PRIORITY_CONTROL)) {
+      // Start counting over with the new group size
+      streamParityGroup = (uint8_t)buffer[OPENBCI_HOST_PRIVATE_POS_PAYLOAD];
+      streamParityRecovered = 0;
+      streamParityLost = 0;
+      bufferStreamParityReset();
+      msgToPrint = HOST_MESSAGE_PARITY;
+    } else {
+      msgToPrint = HOST_MESSAGE_TX_QUEUE_FULL;
+    }
   }
+  printMessageToDriverFlag = true;
+  return ACTION_RADIO_SEND_NONE;
 }
 
 /**
-* @description Private function to clear the given buffer of length
+* @description `0xF0 0x03` asks the Device for its poll time.
+* @param buffer {char *} - The page
+* @return {byte} - `ACTION_RADIO_SEND_SINGLE_CHAR`
 * @author AJ Keller (@pushtheworldllc)
 */
-void OpenBCI_Radios_Class::bufferCleanChar(char *buffer, int bufferLength) {
-  for (int i = 0; i < bufferLength; i++) {
-    buffer[i] = 0;
-  }
+byte OpenBCI_Radios_Class::hostCommandPollTimeGet(char *) {
+  // Send a time change request to the device
+  singleCharMsg[0] = (char)ORPM_GET_POLL_TIME;
+  return ACTION_RADIO_SEND_SINGLE_CHAR;
 }
 
 /**
-* @description Private function to clean a PacketBuffer.
+* @description `0xF0 0x19` tells the driver the poll time in uS. The Host
+*  keeps the same poll time as the Device so it answers without asking.
+* @param buffer {char *} - The page
+* @return {byte} - `ACTION_RADIO_SEND_NONE`
 * @author AJ Keller (@pushtheworldllc)
 */
-void OpenBCI_Radios_Class::bufferCleanPacketBuffer(PacketBuffer *packetBuffer, int numberOfPackets) {
-  for(int i = 0; i < numberOfPackets; i++) {
-    packetBuffer[i].positionRead = 0;
-    packetBuffer[i].positionWrite = 1;
+byte OpenBCI_Radios_Class::hostCommandPollTimeGetUs(char *) {
+  msgToPrint = HOST_MESSAGE_POLL_TIME_US;
+  printMessageToDriverFlag = true;
+  return ACTION_RADIO_SEND_NONE;
+}
+
+/**
+* @description `0xF0 0x04 ms` asks the Device to change both radios' poll time.
+* @param buffer {char *} - The page
+* @return {byte} - `ACTION_RADIO_SEND_SINGLE_CHAR`
+* @author AJ Keller (@pushtheworldllc)
+*/
+byte OpenBCI_Radios_Class::hostCommandPollTimeSet(char *buffer) {
+  // Save the new poll time
+  pollTimeApply((uint8_t)buffer[OPENBCI_HOST_PRIVATE_POS_PAYLOAD]);
+  // Send a time change request to the device
+  singleCharMsg[0] = (char)ORPM_CHANGE_POLL_TIME_HOST_REQUEST;
+  return ACTION_RADIO_SEND_SINGLE_CHAR;
+}
+
+/**
+* @description `0xF0 0x18 us0 us1 us2 us3` sets both radios' poll time in uS,
+*  little endian, from `OPENBCI_POLL_TIME_MIN_uS` to `OPENBCI_POLL_TIME_MAX_uS`.
+*  The Device gets it on the next ack, see ::pollInterval() for how fast it
+*  really polls.
+* @param buffer {char *} - The page
+* @return {byte} - `ACTION_RADIO_SEND_NONE`
+* @author AJ Keller (@pushtheworldllc)
+*/
+byte OpenBCI_Radios_Class::hostCommandPollTimeSetUs(char *buffer) {
+  uint32_t us = hostCommandPayload(buffer, 4);
+  if (us < OPENBCI_POLL_TIME_MIN_uS || us > OPENBCI_POLL_TIME_MAX_uS) {
+    msgToPrint = HOST_MESSAGE_POLL_TIME_VERIFY;
+  } else {
+    // Tell the Device on the next ack
+    char pollTimeMsg[OPENBCI_POLL_TIME_BYTES] = {(char)OPENBCI_POLL_TIME_BYTE_ID, (char)us, (char)(us >> 8), (char)(us >> 16), (char)(us >> 24)};
+    if (txQueueAdd(pollTimeMsg,OPENBCI_POLL_TIME_BYTES,TX_PRIORITY_CONTROL)) {
+      // Kept in flash like the one byte poll time, written from loop()
+      pollTimeApply(pollTimeFromMicros(us));
+      flashCommitAdd(OPENBCI_FLASH_COMMIT_POLL_TIME, pollTime);
+      msgToPrint = HOST_MESSAGE_POLL_TIME_US;
+    } else {
+      msgToPrint = HOST_MESSAGE_TX_QUEUE_FULL;
+    }
   }
+  printMessageToDriverFlag = true;
+  return ACTION_RADIO_SEND_NONE;
 }
 
 /**
-* @description Private function to clean a PacketBuffer.
+* @description `0xF0 0x0E` and `0xF0 0x0F` turn stream packets to the Device
+*  on and off. The Device is told too, it can't flow control the Pic while
+*  they go to it, see ::flowControlProcess().
+* @param buffer {char *} - The page
+* @return {byte} - `ACTION_RADIO_SEND_NONE`
 * @author AJ Keller (@pushtheworldllc)
 */
-void OpenBCI_Radios_Class::bufferCleanCompletePacketBuffer(PacketBuffer *packetBuffer, int numberOfPackets) {
-  for(int i = 0; i < numberOfPackets; i++) {
-    packetBuffer[i].positionRead = 0;
-    packetBuffer[i].positionWrite = 0;
+byte OpenBCI_Radios_Class::hostCommandStreamDown(char *buffer) {
+  boolean enabled = buffer[OPENBCI_HOST_PRIVATE_POS_CODE] == OPENBCI_HOST_CMD_STREAM_DOWN_ON;
+  // Tell the Device on the next ack
+  char streamDownMsg[2] = {(char)OPENBCI_STREAM_DOWN_BYTE_ID, (char)enabled};
+  if (txQueueAdd(streamDownMsg,2,TX_PRIORITY_CONTROL)) {
+    streamDownEnabled = enabled;
+    msgToPrint = streamDownEnabled ? HOST_MESSAGE_STREAM_DOWN_ON : HOST_MESSAGE_STREAM_DOWN_OFF;
+  } else {
+    msgToPrint = HOST_MESSAGE_TX_QUEUE_FULL;
   }
+  printMessageToDriverFlag = true;
+  return ACTION_RADIO_SEND_NONE;
 }
 
 /**
-* @description Private function to clean (clear/reset) a Buffer.
+* @description `0xF0 0x07` tells the driver if the Device is there.
+* @param buffer {char *} - The page
+* @return {byte} - `ACTION_RADIO_SEND_NONE`
 * @author AJ Keller (@pushtheworldllc)
 */
-void OpenBCI_Radios_Class::bufferCleanBuffer(Buffer *buffer, int numberOfPacketsToClean) {
-  bufferCleanPacketBuffer(buffer->packetBuffer,numberOfPacketsToClean);
-  buffer->numberOfPacketsToSend = 0;
-  buffer->numberOfPacketsSent = 0;
-  buffer->overflowed = false;
+byte OpenBCI_Radios_Class::hostCommandSysUp(char *) {
+  msgToPrint = systemUp ? HOST_MESSAGE_SYS_UP : HOST_MESSAGE_SYS_DOWN;
+  printMessageToDriverFlag = true;
+  return ACTION_RADIO_SEND_NONE;
 }
 
 /**
-* @description Private function to clean (clear/reset) a Buffer.
+* @description `0xF0 0x12` dumps the trace rings, see `OPENBCI_TRACE_ENABLED`.
+* @param buffer {char *} - The page
+* @return {byte} - `ACTION_RADIO_SEND_NONE`
 * @author AJ Keller (@pushtheworldllc)
 */
-void OpenBCI_Radios_Class::bufferCleanCompleteBuffer(Buffer *buffer, int numberOfPacketsToClean) {
-  bufferCleanCompletePacketBuffer(buffer->packetBuffer,numberOfPacketsToClean);
-  buffer->numberOfPacketsToSend = 0;
-  buffer->numberOfPacketsSent = 0;
-  // Serial.print("#p2s5: "); Serial.println(buffer->numberOfPacketsToSend);
+byte OpenBCI_Radios_Class::hostCommandTraceDump(char *) {
+  msgToPrint = HOST_MESSAGE_TRACE;
+  printMessageToDriverFlag = true;
+  return ACTION_RADIO_SEND_NONE;
+}
 
-  buffer->overflowed = false;
+/**
+* @description `0xF0 0x0B` asks the Device to enter upload mode, the Host
+*  follows on `ORPM_UPLOAD_READY`.
+* @param buffer {char *} - The page
+* @return {byte} - `ACTION_RADIO_SEND_SINGLE_CHAR`
+* @author AJ Keller (@pushtheworldllc)
+*/
+byte OpenBCI_Radios_Class::hostCommandUploadStart(char *) {
+  singleCharMsg[0] = (char)ORPM_UPLOAD_START;
+  return ACTION_RADIO_SEND_SINGLE_CHAR;
 }
 
 /**
-* @description Used to add a char data array to the the radio buffer. Always
-*      skips the fist
-* @param data {char *} - An array from RFduinoGZLL_onReceive
-* @param len {int} - Length of array from RFduinoGZLL_onReceive
-* @param clearBuffer {boolean} - If true then will reset the flags on the radio
-*      buffer.
-* @return {boolean} - True if the data was added to the buffer, false if the
-*      buffer was overflowed.
+* @description Called from Host's on_recieve if a packet will be sent.
+* @param `device` {device_t} - The device to send the packet to.
 * @author AJ Keller (@pushtheworldllc)
 */
-boolean OpenBCI_Radios_Class::bufferRadioAddData(BufferRadio *buf, char *data, int len, boolean lastPacket) {
-  if (lastPacket) {
-    buf->gotAllPackets = true;
+void OpenBCI_Radios_Class::sendPacketToDevice(device_t device, boolean lockPacketSend) {
+  // Build byteId
+  int packetNumber = bufferSerial.numberOfPacketsToSend - bufferSerial.numberOfPacketsSent - 1;
+
+  byte radioAction = ACTION_RADIO_SEND_NORMAL;
+
+  // Is there only one packet to send and it's the first packet?
+  if (bufferSerial.numberOfPacketsToSend == 1 && packetNumber == 0) {
+    // Enter the process outbound buffer subroutine
+    radioAction = processOutboundBuffer(bufferSerial.packetBuffer);
   }
-  // Serial.print("Pos write "); Serial.println(currentRadioBuffer->positionWrite);
+
+  // Make the byte id
+  char byteId;
+
+  switch (radioAction) {
+    case ACTION_RADIO_SEND_SINGLE_CHAR:
+    OPENBCI_TRACE_TX(RFduinoGZLL.sendToDevice(device,singleCharMsg,1), singleCharMsg[0], 1);
+    // Set flag
+    packetInTXRadioBuffer = true;
+    break;
+    case ACTION_RADIO_SEND_NORMAL:
+    // Save the byteId
+    byteId = byteIdMake(false,packetNumber,(bufferSerial.packetBuffer + bufferSerial.numberOfPacketsSent)->data + 1, (bufferSerial.packetBuffer + bufferSerial.numberOfPacketsSent)->positionWrite - 1);
+    // Add the byteId to the packet
+    (bufferSerial.packetBuffer + bufferSerial.numberOfPacketsSent)->data[0] = byteId;
+    // Serial.print("Sending "); Serial.print((bufferSerial.packetBuffer + bufferSerial.numberOfPacketsSent)->positionWrite); Serial.println(" bytes");
+    OPENBCI_TRACE_TX(RFduinoGZLL.sendToDevice(device,(char *)(bufferSerial.packetBuffer + bufferSerial.numberOfPacketsSent)->data, (bufferSerial.packetBuffer + bufferSerial.numberOfPacketsSent)->positionWrite), byteId, (bufferSerial.packetBuffer + bufferSerial.numberOfPacketsSent)->positionWrite);
+    // Increment number of bytes sent
+    bufferSerial.numberOfPacketsSent++;
+    // Set flag
+    packetInTXRadioBuffer = true;
+    break;
+    default: // do nothing
+    break;
+  }
+}
+
+/**
+* @description Used on the Host to queue a lone board command, i.e. 's' or a
+*  channel toggle, while the board is streaming. The command skips page
+*  assembly and the serial timeout and rides on the very next ack to the
+*  Device. Must be called before `lastTimeSerialRead` is updated.
+* @param newChar {char} - The new char from the PC/Driver
+* @return {boolean} - `true` if the char was queued, `false` if it should be
+*  stored in the serial buffer like normal.
+* @author AJ Keller (@pushtheworldllc)
+*/
+boolean OpenBCI_Radios_Class::commandFastAdd(char newChar) {
+  // Only while streaming, otherwise the Device poll is just as quick
+  if (!systemUp || lastTimeHostHeardStream == 0 || millis() > (lastTimeHostHeardStream + OPENBCI_TIMEOUT_STREAM_ACTIVE_MS)) {
+    return false;
+  }
+  // Private commands, time sync and framed pages have their own paths
+  if (serialFramingEnabled || newChar == (char)OPENBCI_HOST_PRIVATE_CMD_KEY || newChar == (char)OPENBCI_HOST_TIME_SYNC) {
+    return false;
+  }
+  // Must be the first char of a write with nothing in the serial buffer ahead
+  //  of it, or the Pic would see the bytes out of order
+  if (bufferSerial.numberOfPacketsToSend > 0 || micros() < (lastTimeSerialRead + OPENBCI_TIMEOUT_PACKET_NRML_uS)) {
+    return false;
+  }
+  char msg[2];
+  msg[0] = (char)OPENBCI_COMMAND_FAST_BYTE_ID;
+  msg[1] = newChar;
+  noInterrupts();
+  OPENBCI_TRACE_MASK_START();
+  boolean queued = txQueueAdd(msg, 2, TX_PRIORITY_COMMAND);
+  OPENBCI_TRACE_MASK_END(OPENBCI_TRACE_MASKED_FAST_COMMAND);
+  interrupts();
+  return queued;
+}
+
+/**
+* @description Used on the Host to tell if a packet from the Device can be
+*  handled from `loop()`. Stream packets and low power reports don't change
+*  what goes on the ack, pages, upload status and trace records do.
+* @param byteId {char} - The first byte of the packet
+* @return {boolean} - `true` if the packet can wait for ::rxQueueProcess()
+* @author AJ Keller (@pushtheworldllc)
+*/
+boolean OpenBCI_Radios_Class::rxQueueCanWait(char byteId) {
+  return byteId == (char)OPENBCI_LOW_POWER_BYTE_ID || byteIdGetIsStream(byteId);
+}
+
+/**
+* @description Called on the Host from `RFduinoGZLL_onReceive` to copy a packet
+*  for `loop()` to handle, so the callback is done with it in a copy. The
+*  callback only ever moves `rxQueueHead` and `loop()` only `rxQueueTail`, so
+*  neither holds the other off. If `loop()` has fallen `OPENBCI_NUMBER_RX_QUEUE`
+*  packets behind the new packet is dropped, the stream ring is never touched
+*  from the callback. A dropped stream packet is a gap like any lost on the
+*  air, NACKed or rebuilt from parity.
+* @param data {char *} - The packet from the Device
+* @param len {int} - The length of `data`
+* @return {boolean} - `true` if the packet was queued or dropped, `false` if it
+*  is too long
+* @author AJ Keller (@pushtheworldllc)
+*/
+boolean OpenBCI_Radios_Class::rxQueueAdd(char *data, int len) {
+  if (len <= 0 || len > OPENBCI_MAX_PACKET_SIZE_BYTES) {
+    return false;
+  }
+  uint8_t head = rxQueueHead;
+  if ((uint8_t)(head - rxQueueTail) >= OPENBCI_NUMBER_RX_QUEUE) {
+    OPENBCI_TRACE(OPENBCI_TRACE_EVENT_RX_FULL, data[0], len);
+    runPost(RUN_WORK_RX);
+    return true;
+  }
+  RxDescriptor *rx = rxQueue + (head & (OPENBCI_NUMBER_RX_QUEUE - 1));
+  rx->length = (uint8_t)len;
   for (int i = 0; i < len; i++) {
-    if (buf->positionWrite < OPENBCI_BUFFER_LENGTH_MULTI) { // Check for to prevent overflow
-      buf->data[buf->positionWrite] = data[i];
-      buf->positionWrite++;
-    } else { // We overflowed, need to return false.
-      return false;
-    }
+    rx->data[i] = data[i];
   }
+  // The copy has to be done before loop() can see it
+  OPENBCI_MEMORY_BARRIER();
+  rxQueueHead = head + 1;
+  runPost(RUN_WORK_RX);
   return true;
 }
 
 /**
-* @description Used to fill the buffer with all zeros. Should be used as
-*      frequently as possible. This is very useful if you need to ensure that
-*      no bad data is sent over the serial port.
-* @param `buf` {BufferRadio *} - The buffer to clean.
+* @description Called every `loop()` on the Host to handle the packets
+*  ::rxQueueAdd() copied in, oldest first. Only `loop()` touches the stream
+*  ring on the Host, so packets are handled with the radio callback running.
+*  It is only held off to add to the TX queue, which it shares. A NACK made
+*  here goes on the next ack if nothing else is waiting for it, where the
+*  radio callback would have put it.
+* @return {boolean} - `true` if any packet was handled
 * @author AJ Keller (@pushtheworldllc)
 */
-void OpenBCI_Radios_Class::bufferRadioClean(BufferRadio *buf) {
-  bufferCleanChar(buf->data,OPENBCI_BUFFER_LENGTH_MULTI);
+boolean OpenBCI_Radios_Class::rxQueueProcess(void) {
+  boolean processed = false;
+  uint8_t tail = rxQueueTail;
+  while (tail != rxQueueHead) {
+    // Read the copy only once the head says it's there
+    OPENBCI_MEMORY_BARRIER();
+    RxDescriptor *rx = rxQueue + (tail & (OPENBCI_NUMBER_RX_QUEUE - 1));
+    rxQueueProcessPacket(rx->data, rx->length);
+    // Done with the copy before the callback can reuse its place
+    OPENBCI_MEMORY_BARRIER();
+    tail++;
+    rxQueueTail = tail;
+    processed = true;
+  }
+  if (processed) {
+    noInterrupts();
+    OPENBCI_TRACE_MASK_START();
+    if (txQueueCount > 0 && !packetInTXRadioBuffer) {
+      txQueueSendToDevice(RFDUINOGZLL_ROLE_DEVICE);
+    }
+    runPost(RUN_WORK_STREAM);
+    OPENBCI_TRACE_MASK_END(OPENBCI_TRACE_MASKED_RX_QUEUE);
+    interrupts();
+  }
+  return processed;
 }
 
 /**
-* @description Called when all the packets have been recieved to flush the
-*       contents of the radio buffer to the serial port.
-* @param `buf` {BufferRadio *} - The buffer to flush.
+* @description Handles one packet from the RX queue, what used to be done in
+*  `RFduinoGZLL_onReceive`. A stream packet goes in the stream ring, asking for
+*  any missing ones on the next ack, and a low power report is printed.
+* @param data {char *} - The packet from the Device
+* @param len {int} - The length of `data`
 * @author AJ Keller (@pushtheworldllc)
 */
-void OpenBCI_Radios_Class::bufferRadioFlush(BufferRadio *buf) {
-  // Lock this buffer down!
-  buf->flushing = true;
-  if (debugMode) {
-    for (int j = 0; j < buf->positionWrite; j++) {
-      Serial.print(buf->data[j]);
-    }
-    Serial.println();
+void OpenBCI_Radios_Class::rxQueueProcessPacket(char *data, int len) {
+  if (data[0] == (char)OPENBCI_LOW_POWER_BYTE_ID) {
+    // The message to print is shared with the callback
+    noInterrupts();
+    OPENBCI_TRACE_MASK_START();
+    lowPowerHostProcessDevice(data, len);
+    OPENBCI_TRACE_MASK_END(OPENBCI_TRACE_MASKED_RX_QUEUE);
+    interrupts();
   } else {
-    for (int j = 0; j < buf->positionWrite; j++) {
-      Serial.write(buf->data[j]);
-    }
+    bufferStreamAddData(data);
   }
-  buf->flushing = false;
 }
 
 /**
-* @description Used to flush any radio buffer that is ready to be flushed to
-*  the serial port.
+* @description Adds a message to the Host TX queue. Messages of the same
+*  priority go out in the order they were added. Call with interrupts off
+*  from `loop()`, the radio callback can call it directly.
+* @param data {char *} - The message, a single char radio message or a packet
+*  with a byteId.
+* @param len {uint8_t} - The length of `data`
+* @param priority {uint8_t} - A `TX_PRIORITY_*`, control messages go first
+* @return {boolean} - `true` if queued, `false` if the queue is full
 * @author AJ Keller (@pushtheworldllc)
 */
-void OpenBCI_Radios_Class::bufferRadioFlushBuffers(void) {
-  for (int i = 0; i < OPENBCI_NUMBER_RADIO_BUFFERS; i++) {
-    bufferRadioProcessSingle(bufferRadio + i);
+boolean OpenBCI_Radios_Class::txQueueAdd(char *data, uint8_t len, uint8_t priority) {
+  if (txQueueCount >= OPENBCI_NUMBER_TX_QUEUE || len == 0 || len > OPENBCI_MAX_PACKET_SIZE_BYTES) {
+    return false;
+  }
+  TxQueueEntry *entry = txQueue + txQueueCount;
+  entry->priority = priority;
+  entry->length = len;
+  for (int i = 0; i < len; i++) {
+    entry->data[i] = data[i];
   }
+  entry->sent = false;
+  txQueueCount++;
+  return true;
 }
 
 /**
-* @description Used to determine if there is data in the radio buffer. Most
-*  likely this data needs to be cleared.
-* @param `buf` {BufferRadio *} - The buffer to examine.
-* @returns {boolean} - `true` if the radio buffer has data, `false` if not...
+* @description Called from the Host's `loop()` to move a finished single
+*  packet page from the serial buffer onto the TX queue, so the next command
+*  from the driver can be read in while this one waits for an ack. Multi packet
+*  pages and time sync keep the normal send path.
+* @return {boolean} - `true` if the page was taken off the serial buffer
 * @author AJ Keller (@pushtheworldllc)
 */
-boolean OpenBCI_Radios_Class::bufferRadioHasData(BufferRadio *buf) {
-  return buf->positionWrite > 0;
+boolean OpenBCI_Radios_Class::txQueueAddSerialPage(void) {
+  if (!systemUp || bufferSerial.numberOfPacketsToSend != 1 || bufferSerial.numberOfPacketsSent != 0) {
+    return false;
+  }
+  if (!serialWriteTimeOut()) {
+    return false;
+  }
+  PacketBuffer *buf = bufferSerial.packetBuffer;
+  if (buf->positionWrite == 2 && buf->data[1] == (char)OPENBCI_HOST_TIME_SYNC) {
+    return false;
+  }
+  noInterrupts();
+  OPENBCI_TRACE_MASK_START();
+  // The radio callback adds to the queue too, so check for room in here
+  if (txQueueCount >= OPENBCI_NUMBER_TX_QUEUE) {
+    OPENBCI_TRACE_MASK_END(OPENBCI_TRACE_MASKED_SERIAL_PAGE);
+    interrupts();
+    return false;
+  }
+  switch (processOutboundBuffer(buf)) {
+    case ACTION_RADIO_SEND_SINGLE_CHAR:
+    txQueueAdd(singleCharMsg, 1, TX_PRIORITY_CONTROL);
+    break;
+    case ACTION_RADIO_SEND_NORMAL:
+    buf->data[0] = byteIdMake(false, 0, buf->data + 1, buf->positionWrite - 1);
+    txQueueAdd(buf->data, buf->positionWrite, TX_PRIORITY_COMMAND);
+    bufferSerialReset(1);
+    break;
+    default: // Private command was handled and the buffer cleared
+    break;
+  }
+  OPENBCI_TRACE_MASK_END(OPENBCI_TRACE_MASKED_SERIAL_PAGE);
+  interrupts();
+  return true;
 }
 
-byte OpenBCI_Radios_Class::bufferRadioProcessPacket(char *data, int len) {
-  // The packetNumber is embedded in the first byte, the byteId
-  int packetNumber = byteIdGetPacketNumber(data[0]);
-  // Last packet
-  if (packetNumber == 0) {
-    // Current buffer has no data
-    if (bufferRadioReadyForNewPage(currentRadioBuffer)) {
-      // Take it! Mark Last
-      bufferRadioAddData(currentRadioBuffer,data+1,len-1,true);
-      // Return that this last packet was added
-      return OPENBCI_PROCESS_RADIO_PASS_LAST_SINGLE;
-
-      // Current buffer has data
-    } else {
-      // Current buffer has all packets or is flushing
-      if (currentRadioBuffer->gotAllPackets || currentRadioBuffer->flushing) {
-        // Can swtich to other buffer
-        if (bufferRadioSwitchToOtherBuffer()) {
-          // Take it! Mark Last
-          bufferRadioAddData(currentRadioBuffer,data+1,len-1,true);
-          // Return that this last packet was added
-          return OPENBCI_PROCESS_RADIO_PASS_SWITCH_LAST;
+/**
+* @description Called on the Host when the Device rejects a page. Commands
+*  from the TX queue that went out on the last ack are sent again once the page
+*  retry timer runs out.
+* @author AJ Keller (@pushtheworldllc)
+*/
+void OpenBCI_Radios_Class::txQueueRetry(void) {
+  for (uint8_t i = 0; i < txQueueCount; i++) {
+    txQueue[i].sent = false;
+  }
+}
+
+/**
+* @description Empties the Host TX queue, used when comms go down.
+* @author AJ Keller (@pushtheworldllc)
+*/
+void OpenBCI_Radios_Class::txQueueReset(void) {
+  txQueueCount = 0;
+}
+
+/**
+* @description Called from the Host's `RFduinoGZLL_onReceive` to put as much of
+*  the TX queue as fits on the ack, ahead of any page in the serial buffer. A
+*  lone message is sent as is, several are packed behind
+*  `OPENBCI_TX_QUEUE_BYTE_ID` as `[length][bytes]` for the Device to unpack.
+*  Commands for the Pic stay queued until the next packet from the Device shows
+*  they were not rejected.
+* @param `device` {device_t} - The device to send to.
+* @return {boolean} - `true` if anything was sent or commands are still
+*  waiting, either way a page from the serial buffer must wait.
+* @author AJ Keller (@pushtheworldllc)
+*/
+boolean OpenBCI_Radios_Class::txQueueSendToDevice(device_t device) {
+  // The Device didn't reject the last ack, drop the commands it carried
+  txQueueRemove(true);
+  if (txQueueCount == 0) {
+    return false;
+  }
+  // After a reject commands wait for the retry timer, control messages don't
+  boolean holdCommands = timerPending(TIMER_EVENT_PAGE_RETRY);
+  uint8_t picked[OPENBCI_NUMBER_TX_QUEUE];
+  uint8_t numberPicked = 0;
+  uint8_t length = 1;
+  boolean full = false;
+  // Highest priority first, stop at the first one that doesn't fit so
+  //  messages of the same priority never pass each other
+  for (uint8_t p = 0; p < TX_PRIORITY_COUNT && !full; p++) {
+    if (p == TX_PRIORITY_COMMAND && holdCommands) {
+      break;
+    }
+    for (uint8_t i = 0; i < txQueueCount; i++) {
+      if (txQueue[i].priority != p) {
+        continue;
+      }
+      if (numberPicked > 0 && length + 1 + txQueue[i].length > OPENBCI_MAX_PACKET_SIZE_BYTES) {
+        full = true;
+        break;
+      }
+      picked[numberPicked] = i;
+      numberPicked++;
+      length += 1 + txQueue[i].length;
+    }
+  }
+  if (numberPicked == 0) {
+    return true;
+  }
+
+  if (numberPicked == 1) {
+    OPENBCI_TRACE_TX(RFduinoGZLL.sendToDevice(device, txQueue[picked[0]].data, txQueue[picked[0]].length), txQueue[picked[0]].data[0], txQueue[picked[0]].length);
+  } else {
+    txQueueMsg[0] = (char)OPENBCI_TX_QUEUE_BYTE_ID;
+    length = 1;
+    for (uint8_t i = 0; i < numberPicked; i++) {
+      TxQueueEntry *entry = txQueue + picked[i];
+      txQueueMsg[length] = (char)entry->length;
+      length++;
+      for (uint8_t j = 0; j < entry->length; j++) {
+        txQueueMsg[length] = entry->data[j];
+        length++;
+      }
+    }
+    OPENBCI_TRACE_TX(RFduinoGZLL.sendToDevice(device, txQueueMsg, length), txQueueMsg[0], length);
+  }
+  packetInTXRadioBuffer = true;
+
+  for (uint8_t i = 0; i < numberPicked; i++) {
+    txQueue[picked[i]].sent = true;
+  }
+  // Control messages are never sent twice
+  txQueueRemove(false);
+  return true;
+}
+
+/**
+* @description Drops sent messages from the Host TX queue, keeping the order of
+*  the rest.
+* @param commands {boolean} - `true` to drop sent commands, `false` to drop
+*  sent control messages.
+* @author AJ Keller (@pushtheworldllc)
+*/
+void OpenBCI_Radios_Class::txQueueRemove(boolean commands) {
+  uint8_t kept = 0;
+  for (uint8_t i = 0; i < txQueueCount; i++) {
+    boolean isCommand = txQueue[i].priority == TX_PRIORITY_COMMAND;
+    if (txQueue[i].sent && isCommand == commands) {
+      continue;
+    }
+    if (kept != i) {
+      txQueue[kept] = txQueue[i];
+    }
+    kept++;
+  }
+  txQueueCount = kept;
+}
+
+/********************************************/
+/********************************************/
+/***********    DEVICE CODE    **************/
+/********************************************/
+/********************************************/
+
+/**
+* @description Private function to handle a request to read serial as a device
+* @return {boolean} - `true` if there is data to read, `false` if not...
+* @author AJ Keller (@pushtheworldllc)
+*/
+boolean OpenBCI_Radios_Class::didPicSendDeviceSerialData(void) {
+  return Serial.available() > 0;
+}
+
+/**
+* @description Sends a null byte to the host
+* @author AJ Keller (@pushtheworldllc)
+*/
+void OpenBCI_Radios_Class::sendPollMessageToHost(void) {
+  OPENBCI_TRACE(OPENBCI_TRACE_EVENT_POLL, 1, 0);
+  OPENBCI_TRACE_TX(RFduinoGZLL.sendToHost(NULL,0), 0, 0);
+  linkSent();
+}
+
+/**
+* @description Sends a one byte long message to the host
+* @param msg {byte} - A single byte to send to the host
+* @author AJ Keller (@pushtheworldllc)
+*/
+void OpenBCI_Radios_Class::sendRadioMessageToHost(byte msg) {
+  RFduinoGZLL.sendToHost((const char*)msg,1);
+}
+
+void OpenBCI_Radios_Class::setByteIdForPacketBuffer(int packetNumber) {
+  char byteId = byteIdMake(false,packetNumber,(bufferSerial.packetBuffer + bufferSerial.numberOfPacketsSent)->data + 1, (bufferSerial.packetBuffer + bufferSerial.numberOfPacketsSent)->positionWrite - 1);
+
+  // Add the byteId to the packet
+  (bufferSerial.packetBuffer + bufferSerial.numberOfPacketsSent)->data[0] = byteId;
+}
+
+/**
+* @description Called from Devices to send a packet to Host. Uses global
+*  variables to send the correct packet.
+* @returns {boolean} - The packet number sent.
+* @author AJ Keller (@pushtheworldllc)
+*/
+boolean OpenBCI_Radios_Class::sendPacketToHost(void) {
+
+  // Hold off while the page is being retried or the channel is switching
+  if (timerPending(TIMER_EVENT_PAGE_RETRY) || timerPending(TIMER_EVENT_CHANNEL_CHANGE)) {
+    return false;
+  }
+
+  // Reset the stream buffers
+  bufferStreamReset();
+
+  int packetNumber = bufferSerial.numberOfPacketsToSend - bufferSerial.numberOfPacketsSent - 1;
+
+  // Make the byteId
+  char byteId = byteIdMake(false,packetNumber,(bufferSerial.packetBuffer + bufferSerial.numberOfPacketsSent)->data + 1, (bufferSerial.packetBuffer + bufferSerial.numberOfPacketsSent)->positionWrite - 1);
+
+  // Add the byteId to the packet
+  (bufferSerial.packetBuffer + bufferSerial.numberOfPacketsSent)->data[0] = byteId;
+
+  if (OPENBCI_TRACE_TX(RFduinoGZLL.sendToHost((char *)(bufferSerial.packetBuffer + bufferSerial.numberOfPacketsSent)->data, (bufferSerial.packetBuffer + bufferSerial.numberOfPacketsSent)->positionWrite), byteId, (bufferSerial.packetBuffer + bufferSerial.numberOfPacketsSent)->positionWrite)) {
+    pollRefresh();
+
+    bufferSerial.numberOfPacketsSent++;
+
+    return true;
+  }
+
+  return false;
+}
+
+/**
+* @description Test to see if a char follows the stream tail byte format
+* @author AJ Keller (@pushtheworldllc)
+*/
+boolean OpenBCI_Radios_Class::isATailByte(uint8_t newChar) {
+  return (newChar >> 4) == 0xC;
+}
+
+/**
+* @description Sends a soft reset command to the Pic 32 incase of an emergency.
+* @author AJ Keller (@pushtheworldllc)
+*/
+void OpenBCI_Radios_Class::resetPic32(void) {
+  Serial.write('v');
+}
+
+/**
+* @description Called from ::run() on the Device to keep the Pic from
+*  overflowing the serial buffers. With `OPENBCI_FLOW_XOFF_PACKETS` in use the
+*  Pic is sent XOFF, it goes quiet and what it sent goes to the Host as a page,
+*  see ::bufferSerialTimeout(). Once that page is out, `OPENBCI_FLOW_XON_PACKETS`
+*  or fewer in use, XON starts it again, so a long answer from the Pic goes to
+*  the Host a page at a time. Never paused while stream packets go to the Pic,
+*  XON and XOFF would land between them, a pause already in place is ended.
+*  In upload mode the Pic is in its bootloader, a pause is forgotten without
+*  writing XON into the upload.
+* @author AJ Keller (@pushtheworldllc)
+*/
+void OpenBCI_Radios_Class::flowControlProcess(void) {
+#if OPENBCI_FLOW_CONTROL
+  if (uploadActive) {
+    flowPaused = false;
+    return;
+  }
+  if (flowPaused) {
+    if (streamDownEnabled || bufferSerial.numberOfPacketsToSend <= OPENBCI_FLOW_XON_PACKETS) {
+      Serial.write((uint8_t)OPENBCI_FLOW_XON);
+      flowPaused = false;
+    }
+  } else if (!streamDownEnabled && bufferSerial.numberOfPacketsToSend >= OPENBCI_FLOW_XOFF_PACKETS) {
+    Serial.write((uint8_t)OPENBCI_FLOW_XOFF);
+    flowPaused = true;
+  }
+#endif
+}
+
+/********************************************/
+/********************************************/
+/*************    UPLOAD CODE    ************/
+/********************************************/
+/********************************************/
+
+/**
+* @description Stores a char from the PC to the upload buffer on the Host.
+* @param newChar {char} - The new char to store
+* @return {boolean} - `true` if stored, `false` if the upload buffer is full
+*  and the char should be read again later.
+* @author AJ Keller (@pushtheworldllc)
+*/
+boolean OpenBCI_Radios_Class::uploadAddChar(char newChar) {
+  if ((uint16_t)(uploadPositionWrite - uploadPositionRead) >= uploadLength) {
+    return false;
+  }
+  uploadBuffer[uploadPositionWrite & (uploadLength - 1)] = newChar;
+  uploadPositionWrite++;
+  uploadTimeLastActivity = millis();
+  return true;
+}
+
+/**
+* @description Entered from the Device's `RFduinoGZLL_onReceive` with an
+*  upload packet. In order bytes go to the upload buffer to be written to the
+*  Pic from `loop()`, a repeat of bytes we already have is dropped and a gap
+*  marks a NACK for the next upload status.
+* @param `data` {char *} - The upload packet, see `::uploadHostSendToDevice()`
+* @param `len` {int} - The length of `data`
+* @return {boolean} - `true` if new bytes were taken
+* @author AJ Keller (@pushtheworldllc)
+*/
+boolean OpenBCI_Radios_Class::uploadDeviceProcessPacket(char *data, int len) {
+  uint16_t offset = (uint8_t)data[1] | ((uint8_t)data[2] << 8);
+  int numberOfBytes = len - OPENBCI_UPLOAD_HEADER_BYTES;
+  uint16_t skip = uploadPositionWrite - offset;
+
+  uploadTimeLastActivity = millis();
+
+  // Is the packet past what we expected? Then we missed one.
+  if (skip > uploadLength) {
+    uploadNack = true;
+    return false;
+  }
+  // Already have all of it
+  if (skip >= numberOfBytes) {
+    return false;
+  }
+  // Credit should make this impossible, let the Host resend it
+  if (numberOfBytes - skip > uploadFree()) {
+    return false;
+  }
+  for (int i = skip; i < numberOfBytes; i++) {
+    uploadBuffer[uploadPositionWrite & (uploadLength - 1)] = data[OPENBCI_UPLOAD_HEADER_BYTES + i];
+    uploadPositionWrite++;
+  }
+  uploadNack = false;
+  return true;
+}
+
+/**
+* @description Sends the Device's upload status to the Host, this is both the
+*  ack and the poll that gives the Host a chance to send the next packets.
+*    Byte 0 - `OPENBCI_UPLOAD_BYTE_ID` or `OPENBCI_UPLOAD_BYTE_ID_NACK`
+*    Bytes 1-2 - The next byte offset expected, little endian
+*    Bytes 3-4 - Free bytes in the upload buffer, little endian
+* @return {boolean} - `true` if the status made it on the TX buffer
+* @author AJ Keller (@pushtheworldllc)
+*/
+boolean OpenBCI_Radios_Class::uploadDeviceSendStatus(void) {
+  char status[OPENBCI_UPLOAD_STATUS_BYTES];
+  uint16_t ack = uploadPositionWrite;
+  uint16_t credit = uploadFree();
+
+  status[0] = uploadNack ? (char)OPENBCI_UPLOAD_BYTE_ID_NACK : (char)OPENBCI_UPLOAD_BYTE_ID;
+  status[1] = (char)(ack & 0xFF);
+  status[2] = (char)(ack >> 8);
+  status[3] = (char)(credit & 0xFF);
+  status[4] = (char)(credit >> 8);
+
+  if (RFduinoGZLL.sendToHost(status, OPENBCI_UPLOAD_STATUS_BYTES)) {
+    uploadTimeLastStatus = micros();
+    pollRefresh();
+    return true;
+  }
+  return false;
+}
+
+/**
+* @description Number of bytes the upload buffer can still take.
+* @return {uint16_t} - Free bytes
+* @author AJ Keller (@pushtheworldllc)
+*/
+uint16_t OpenBCI_Radios_Class::uploadFree(void) {
+  return uploadLength - (uint16_t)(uploadPositionWrite - uploadPositionRead);
+}
+
+/**
+* @description Entered from the Host's `RFduinoGZLL_onReceive` with an upload
+*  status from the Device. Frees acked bytes and goes back to the ack on a
+*  NACK or when the ack stopped moving for `OPENBCI_TIMEOUT_UPLOAD_RESEND_uS`.
+* @param `data` {char *} - The upload status, see `::uploadDeviceSendStatus()`
+* @param `len` {int} - The length of `data`
+* @author AJ Keller (@pushtheworldllc)
+*/
+void OpenBCI_Radios_Class::uploadHostProcessStatus(char *data, int len) {
+  if (len < OPENBCI_UPLOAD_STATUS_BYTES) {
+    return;
+  }
+  uint16_t ack = (uint8_t)data[1] | ((uint8_t)data[2] << 8);
+  uploadCredit = (uint8_t)data[3] | ((uint8_t)data[4] << 8);
+
+  if (ack != uploadPositionRead) {
+    uploadPositionRead = ack;
+    uploadTimeLastAck = micros();
+  }
+  // Never let send fall behind the ack
+  if ((uint16_t)(uploadPositionSend - uploadPositionRead) > uploadLength) {
+    uploadPositionSend = uploadPositionRead;
+  }
+
+  if (uploadPositionSend != uploadPositionRead) {
+    // Rewind once per NACK'd ack, the packets already in the TX FIFO will NACK too
+    if (data[0] == (char)OPENBCI_UPLOAD_BYTE_ID_NACK && uploadPositionRewind != ack) {
+      uploadPositionSend = ack;
+      uploadPositionRewind = ack;
+    } else if (micros() - uploadTimeLastAck > OPENBCI_TIMEOUT_UPLOAD_RESEND_uS) {
+      uploadPositionSend = ack;
+      uploadTimeLastAck = micros();
+    }
+  }
+}
+
+/**
+* @description Fills the Host's TX FIFO with upload packets. There is no idle
+*  gap or page, whatever is in the upload buffer goes out limited by the
+*  credit the Device sent with its last status.
+*    Byte 0 - `OPENBCI_UPLOAD_BYTE_ID`
+*    Bytes 1-2 - Byte offset of the first data byte, little endian
+*    Bytes 3-31 - Data
+* @param `device` {device_t} - The device to send the packets to.
+* @author AJ Keller (@pushtheworldllc)
+*/
+void OpenBCI_Radios_Class::uploadHostSendToDevice(device_t device) {
+  char packet[OPENBCI_MAX_PACKET_SIZE_BYTES];
+
+  for (int i = 0; i < RFDUINOGZLL_MAX_PACKETS_ON_TX_BUFFER; i++) {
+    uint16_t available = uploadPositionWrite - uploadPositionSend;
+    uint16_t inFlight = uploadPositionSend - uploadPositionRead;
+    if (available == 0 || inFlight >= uploadCredit) {
+      return;
+    }
+    uint16_t numberOfBytes = OPENBCI_MAX_PACKET_SIZE_BYTES - OPENBCI_UPLOAD_HEADER_BYTES;
+    if (numberOfBytes > available) {
+      numberOfBytes = available;
+    }
+    if (numberOfBytes > uploadCredit - inFlight) {
+      numberOfBytes = uploadCredit - inFlight;
+    }
+
+    packet[0] = (char)OPENBCI_UPLOAD_BYTE_ID;
+    packet[1] = (char)(uploadPositionSend & 0xFF);
+    packet[2] = (char)(uploadPositionSend >> 8);
+    for (int j = 0; j < numberOfBytes; j++) {
+      packet[OPENBCI_UPLOAD_HEADER_BYTES + j] = uploadBuffer[(uploadPositionSend + j) & (uploadLength - 1)];
+    }
+    if (!RFduinoGZLL.sendToDevice(device, packet, OPENBCI_UPLOAD_HEADER_BYTES + numberOfBytes)) {
+      return;
+    }
+    uploadPositionSend += numberOfBytes;
+  }
+}
+
+/**
+* @description Runs upload mode from `loop()`.
+*  Host - Moves bytes from the PC into the upload buffer and leaves upload
+*    mode once the PC has been quiet for `OPENBCI_TIMEOUT_UPLOAD_IDLE_MS` and
+*    everything has been acked, or the Device stopped talking.
+*  Device - Writes bytes to the Pic while the next packets are in the air and
+*    keeps the upload status going to the Host.
+* @author AJ Keller (@pushtheworldllc)
+*/
+void OpenBCI_Radios_Class::uploadProcess(void) {
+  if (!uploadActive) {
+    return;
+  }
+  if (radioMode == OPENBCI_MODE_HOST) {
+    while (didPCSendDataToHost()) {
+      if ((uint16_t)(uploadPositionWrite - uploadPositionRead) >= uploadLength) {
+        break;
+      }
+      uploadAddChar(Serial.read());
+    }
+    if (commsFailureTimeout()) {
+      uploadActive = false;
+    } else if (millis() - uploadTimeLastActivity > OPENBCI_TIMEOUT_UPLOAD_IDLE_MS && uploadPositionRead == uploadPositionWrite) {
+      singleCharMsg[0] = (char)ORPM_UPLOAD_END;
+      if (RFduinoGZLL.sendToDevice(DEVICE0, singleCharMsg, 1)) {
+        uploadActive = false;
+      }
+    }
+  } else {
+    // One packet worth per pass so the status keeps going
+    for (int i = 0; i < OPENBCI_MAX_PACKET_SIZE_BYTES && uploadPositionRead != uploadPositionWrite; i++) {
+      Serial.write(uploadBuffer[uploadPositionRead & (uploadLength - 1)]);
+      uploadPositionRead++;
+    }
+    if (micros() - uploadTimeLastStatus > OPENBCI_TIMEOUT_UPLOAD_STATUS_uS) {
+      uploadDeviceSendStatus();
+    }
+    // The Host stopped sending, give up on upload mode
+    if (millis() - uploadTimeLastActivity > 2 * OPENBCI_TIMEOUT_UPLOAD_IDLE_MS && uploadPositionRead == uploadPositionWrite) {
+      uploadActive = false;
+    }
+  }
+}
+
+/**
+* @description Resets the positions of the upload buffer.
+* @author AJ Keller (@pushtheworldllc)
+*/
+void OpenBCI_Radios_Class::uploadReset(void) {
+  uploadNack = false;
+  uploadPositionWrite = 0;
+  uploadPositionRead = 0;
+  uploadPositionSend = 0;
+  uploadPositionRewind = 0xFFFF;
+  uploadCredit = 0;
+  uploadTimeLastAck = micros();
+  uploadTimeLastStatus = 0;
+  uploadTimeLastActivity = millis();
+}
+
+/********************************************/
+/********************************************/
+/*************    PASS THRU    **************/
+/********************************************/
+/********************************************/
+
+/**
+* @description Used to flash the led to indicate to the user the device is in pass through mode.
+* @author AJ Keller (@pushtheworldllc)
+*/
+void OpenBCI_Radios_Class::ledFeedBackForPassThru(void) {
+  digitalWrite(OPENBCI_PIN_HOST_LED,HIGH);
+  delay(600);
+  digitalWrite(OPENBCI_PIN_HOST_LED,LOW);
+  delay(200);
+}
+
+/********************************************/
+/********************************************/
+/**************    LINK    ******************/
+/********************************************/
+/********************************************/
+
+/**
+* @description Called from `RFduinoGZLL_onReceive` on both radios with every
+*  packet or ack from the other radio.
+* @author AJ Keller (@pushtheworldllc)
+*/
+void OpenBCI_Radios_Class::linkAck(void) {
+  linkHeard = true;
+  linkUnacked = false;
+}
+
+/**
+* @description Called every `loop()` on both radios to notice a lost link well
+*  before `OPENBCI_TIMEOUT_COMMS_MS` and find the other radio again. The
+*  Device counts the link as lost when a send has gone `OPENBCI_TIMEOUT_LINK_LOST_MS`
+*  without an ack, the Host when a stream has gone quiet that long past the
+*  longest gap it expects, see ::linkHostQuietMs(). A stream that ended isn't
+*  looked for, the Device's next poll tells the Host it ended. Each then
+*  tries its previous channel and its stored one in turn, the Device polling
+*  for `OPENBCI_LINK_DWELL_DEVICE_MS` on each and the Host listening for the
+*  longer `OPENBCI_LINK_DWELL_HOST_MS`, so a Device going round both channels
+*  always lands on the one the Host is on. Found on the previous channel, that
+*  channel is stored again. Only done once a channel change left a previous
+*  channel to try, a lost link on the same channel is left to Gazell's retries.
+* @author AJ Keller (@pushtheworldllc)
+*/
+void OpenBCI_Radios_Class::linkProcess(void) {
+  uint32_t storedChannel = getChannelNumber();
+  if (!linkSearching) {
+    if (previousRadioChannel == storedChannel || previousRadioChannel > RFDUINOGZLL_CHANNEL_LIMIT_UPPER || timerPending(TIMER_EVENT_CHANNEL_CHANGE) || uploadActive) {
+      return;
+    }
+    if (radioMode == OPENBCI_MODE_DEVICE) {
+      if (!linkUnacked || millis() - linkTimeSent <= OPENBCI_TIMEOUT_LINK_LOST_MS) {
+        return;
+      }
+    } else {
+      // The Host only knows to expect something while streaming
+      if (isWaitingForNewChannelNumberConfirmation || lastTimeHostHeardFromDevice == 0) {
+        return;
+      }
+      // Heard a poll after the stream, it ended
+      if ((long)(lastTimeHostHeardFromDevice - lastTimeHostHeardStream) > (long)linkHostQuietMs(false)) {
+        return;
+      }
+      // Once a loss, or was already looked for
+      if (millis() - lastTimeHostHeardFromDevice <= linkHostQuietMs(true) || (long)(lastTimeHostHeardFromDevice - linkTimeSearch) < 0) {
+        return;
+      }
+    }
+    OPENBCI_TRACE(OPENBCI_TRACE_EVENT_LINK, 1, RFduinoGZLL.channel);
+    linkSearching = true;
+    linkHeard = false;
+    linkTimeSearch = millis();
+    linkTimeDwell = millis();
+    // The stored channel just failed, start on the other one
+    linkSetChannel(previousRadioChannel);
+    return;
+  }
+
+  if (linkHeard) {
+    linkSearching = false;
+    if ((uint32_t)RFduinoGZLL.channel != storedChannel) {
+      // The other radio never left the previous channel, stay here
+      previousRadioChannel = storedChannel;
+      radioChannel = RFduinoGZLL.channel;
+      flashCommitAdd(OPENBCI_FLASH_COMMIT_CHANNEL, radioChannel);
+    }
+    OPENBCI_TRACE(OPENBCI_TRACE_EVENT_LINK, 0, RFduinoGZLL.channel);
+  } else if (millis() - linkTimeSearch > OPENBCI_TIMEOUT_LINK_SEARCH_MS) {
+    // Give up and go back to normal, the comms timeout takes it from here
+    linkSearching = false;
+    linkUnacked = false;
+    linkSetChannel(storedChannel);
+  } else if (millis() - linkTimeDwell >= (radioMode == OPENBCI_MODE_DEVICE ? OPENBCI_LINK_DWELL_DEVICE_MS : OPENBCI_LINK_DWELL_HOST_MS)) {
+    linkTimeDwell = millis();
+    linkSetChannel((uint32_t)RFduinoGZLL.channel == storedChannel ? previousRadioChannel : storedChannel);
+  }
+}
+
+/**
+* @description Used on the Host by ::linkProcess() for how long the Device can
+*  be quiet before something is wrong. While streaming, stream packets are at
+*  most a decimated sample or a low power burst apart. A stream that stops
+*  looks the same until the Device's next poll, so a loss is only called once
+*  a poll is overdue too. Both get `OPENBCI_TIMEOUT_LINK_LOST_MS` on top.
+* @param `lost` {boolean} - `true` for the quiet that means a lost link,
+*  `false` for the longest gap between stream packets
+* @returns {unsigned long} - The time in ms
+* @author AJ Keller (@pushtheworldllc)
+*/
+unsigned long OpenBCI_Radios_Class::linkHostQuietMs(boolean lost) {
+  unsigned long gap = OPENBCI_LINK_SAMPLE_MS;
+  if (streamDecimate > 1) {
+    gap *= streamDecimate;
+  }
+  if (lowPowerWaitMs > gap) {
+    gap = lowPowerWaitMs;
+  }
+  if (lost) {
+    unsigned long pollMs = (pollTimeUs + 999) / 1000;
+    if (pollMs > gap) {
+      gap = pollMs;
+    }
+  }
+  return gap + OPENBCI_TIMEOUT_LINK_LOST_MS;
+}
+
+/**
+* @description Called on the Device after each send that needs an ack, starts
+*  the clock on ::linkProcess() if nothing was waiting for one already.
+* @author AJ Keller (@pushtheworldllc)
+*/
+void OpenBCI_Radios_Class::linkSent(void) {
+  if (!linkUnacked) {
+    linkUnacked = true;
+    linkTimeSent = millis();
+  }
+}
+
+/**
+* @description Moves the radio to a channel while looking for the other radio,
+*  the Device polls on it straight away.
+* @param `channel` {uint32_t} - The channel to try
+* @author AJ Keller (@pushtheworldllc)
+*/
+void OpenBCI_Radios_Class::linkSetChannel(uint32_t channel) {
+  OPENBCI_TRACE(OPENBCI_TRACE_EVENT_LINK, 2, channel);
+  RFduinoGZLL.end();
+  RFduinoGZLL.channel = channel;
+  if (radioMode == OPENBCI_MODE_DEVICE) {
+    RFduinoGZLL.begin(RFDUINOGZLL_ROLE_DEVICE);
+    pollHost();
+  } else {
+    RFduinoGZLL.begin(RFDUINOGZLL_ROLE_HOST);
+  }
+}
+
+/**
+* @description Puts the radio into a link state made by ::linkStateMake(),
+*  from flash in `configure()` or from the Host in a
+*  `OPENBCI_LINK_STATE_BYTE_ID` message. The reserved byte is skipped, so a
+*  word stored with the Host's serial flags by older firmware doesn't bring
+*  them back. Settings that are out of bounds or already in place are left
+*  alone, so their counters keep going.
+* @param `linkState` {uint32_t} - The link state, `0xFFFFFFFF` is the default
+* @author AJ Keller (@pushtheworldllc)
+*/
+void OpenBCI_Radios_Class::linkStateApply(uint32_t linkState) {
+  if (linkState == 0xFFFFFFFF) {
+    linkState = OPENBCI_LINK_STATE_DEFAULT;
+  }
+  uint8_t parityGroup = (uint8_t)(linkState >> OPENBCI_LINK_STATE_SHIFT_PARITY);
+  if (parityGroup != 1 && parityGroup <= OPENBCI_STREAM_PARITY_GROUP_MAX && parityGroup != streamParityGroup) {
+    streamParityGroup = parityGroup;
+    bufferStreamParityReset();
+  }
+  uint8_t decimate = (uint8_t)(linkState >> OPENBCI_LINK_STATE_SHIFT_DECIMATE);
+  if (decimate <= OPENBCI_STREAM_DECIMATE_MAX && decimate != streamDecimate) {
+    streamDecimate = decimate;
+    bufferStreamDecimateReset();
+  }
+  uint8_t waitMs = (uint8_t)(linkState >> OPENBCI_LINK_STATE_SHIFT_LOW_POWER);
+  if (waitMs <= OPENBCI_LOW_POWER_WAIT_MAX_MS && waitMs != lowPowerWaitMs) {
+    lowPowerWaitMs = waitMs;
+    lowPowerReset();
+  }
+}
+
+/**
+* @description Packs the radio side settings the driver negotiated into one
+*  word for flash, a byte each of parity group, decimation and low power wait
+*  above a reserved byte of 0. The channel and poll time are kept on their own.
+*  The Host's baud rate, framing, stream down and batching are left out on
+*  purpose: a driver that lost the Host in a reset opens it at the default
+*  baud and expects plain serial, so the Host comes back up that way.
+* @returns {uint32_t} - The link state, `OPENBCI_LINK_STATE_DEFAULT` when
+*  nothing was changed
+* @author AJ Keller (@pushtheworldllc)
+*/
+uint32_t OpenBCI_Radios_Class::linkStateMake(void) {
+  uint32_t linkState = OPENBCI_LINK_STATE_DEFAULT;
+  linkState |= (uint32_t)streamParityGroup << OPENBCI_LINK_STATE_SHIFT_PARITY;
+  linkState |= (uint32_t)streamDecimate << OPENBCI_LINK_STATE_SHIFT_DECIMATE;
+  linkState |= (uint32_t)lowPowerWaitMs << OPENBCI_LINK_STATE_SHIFT_LOW_POWER;
+  return linkState;
+}
+
+/**
+* @description Called from `loop()` on the Host and the Device to queue the
+*  link state for flash when it is no longer the one stored, so a brownout
+*  comes back up in it. ::flashCommitProcess() writes it once the radio is
+*  quiet. Nothing is written while everything is at its default.
+* @returns {boolean} - `true` if a new link state was queued
+* @author AJ Keller (@pushtheworldllc)
+*/
+boolean OpenBCI_Radios_Class::linkStateSave(void) {
+  noInterrupts();
+  OPENBCI_TRACE_MASK_START();
+  uint32_t linkState = linkStateMake();
+  uint32_t saved = getLinkState();
+  if (saved == 0xFFFFFFFF) {
+    saved = OPENBCI_LINK_STATE_DEFAULT;
+  }
+  boolean queued = linkState != saved && flashCommitAdd(OPENBCI_FLASH_COMMIT_LINK_STATE, linkState);
+  OPENBCI_TRACE_MASK_END(OPENBCI_TRACE_MASKED_LINK_STATE);
+  interrupts();
+  return queued;
+}
+
+/**
+* @description Called on the Host from `RFduinoGZLL_onReceive` when the system
+*  comes up, after a reset or a comms timeout. Sends the Host's link state to
+*  the Device on the next ack so the two agree without the driver setting
+*  anything up again. The Device came up in its own saved state and only
+*  changes what differs.
+* @author AJ Keller (@pushtheworldllc)
+*/
+void OpenBCI_Radios_Class::linkStateSync(void) {
+  uint32_t linkState = linkStateMake();
+  char msg[OPENBCI_LINK_STATE_BYTES];
+  msg[0] = (char)OPENBCI_LINK_STATE_BYTE_ID;
+  for (int i = 0; i < 4; i++) {
+    msg[1 + i] = (char)(linkState >> (8 * i));
+  }
+  txQueueAdd(msg,OPENBCI_LINK_STATE_BYTES,TX_PRIORITY_CONTROL);
+}
+
+/********************************************/
+/********************************************/
+/************    LOW POWER    ***************/
+/********************************************/
+/********************************************/
+
+/**
+* @description Called on the Device from `RFduinoGZLL_onReceive` with every ack
+*  from the Host. Acks closer together than `OPENBCI_LOW_POWER_WAKE_GAP_uS` are
+*  counted as one wake of the radio, which was on from before the first packet
+*  to the last ack. The first packet of each wake and the start up are not
+*  seen, `OPENBCI_LOW_POWER_EXCHANGE_uS` and `OPENBCI_LOW_POWER_WAKE_uS` stand
+*  in for them. Lost packets that are never acked are not counted.
+* @param `len` {int} - The length of the ack payload, more than 0 if the Host
+*  sent something
+* @author AJ Keller (@pushtheworldllc)
+*/
+void OpenBCI_Radios_Class::lowPowerAck(int len) {
+  unsigned long now = micros();
+  if (len > 0) {
+    lowPowerTimeActive = millis();
+  }
+  if (lowPowerWakes == 0 || now - lowPowerTimeAck > OPENBCI_LOW_POWER_WAKE_GAP_uS) {
+    lowPowerWakes++;
+    lowPowerRadioOnUs += OPENBCI_LOW_POWER_WAKE_uS + OPENBCI_LOW_POWER_EXCHANGE_uS;
+  } else {
+    lowPowerRadioOnUs += now - lowPowerTimeAck;
+  }
+  lowPowerTimeAck = now;
+}
+
+/**
+* @description Used on the Host with a low power report from the Device, the
+*  numbers are kept for `HOST_MESSAGE_LOW_POWER_REPORT` to print from `loop()`.
+* @param `data` {char *} - `OPENBCI_LOW_POWER_BYTE_ID` then the stream packets
+*  sent, radio on time in microseconds and wakes, each 32 bits little endian
+* @param `len` {int} - The length of `data`
+* @author AJ Keller (@pushtheworldllc)
+*/
+void OpenBCI_Radios_Class::lowPowerHostProcessDevice(char *data, int len) {
+  if (len < OPENBCI_LOW_POWER_REPORT_BYTES) {
+    return;
+  }
+  uint32_t values[3];
+  for (int i = 0; i < 3; i++) {
+    char *value = data + 1 + i * 4;
+    values[i] = (uint32_t)(uint8_t)value[0] | ((uint32_t)(uint8_t)value[1] << 8) | ((uint32_t)(uint8_t)value[2] << 16) | ((uint32_t)(uint8_t)value[3] << 24);
+  }
+  lowPowerPackets = values[0];
+  lowPowerRadioOnUs = values[1];
+  lowPowerWakes = values[2];
+  msgToPrint = HOST_MESSAGE_LOW_POWER_REPORT;
+  printMessageToDriverFlag = true;
+}
+
+/**
+* @description The poll time to use on the Device. With low power on, a
+*  Device that has heard nothing from the Pic or the Host for
+*  `OPENBCI_TIMEOUT_LOW_POWER_IDLE_MS` stretches its polls out to
+*  `OPENBCI_LOW_POWER_POLL_IDLE_MS`, still inside the Host's comms timeout.
+* @returns {uint32_t} - The poll time in uS
+* @author AJ Keller (@pushtheworldllc)
+*/
+uint32_t OpenBCI_Radios_Class::lowPowerPollTime(void) {
+  if (lowPowerWaitMs == 0 || pollTimeUs >= (uint32_t)OPENBCI_LOW_POWER_POLL_IDLE_MS * 1000) {
+    return pollTimeUs;
+  }
+  if (millis() - lowPowerTimeActive < OPENBCI_TIMEOUT_LOW_POWER_IDLE_MS) {
+    return pollTimeUs;
+  }
+  if (micros() - lastTimeSerialRead < (unsigned long)OPENBCI_TIMEOUT_LOW_POWER_IDLE_MS * 1000) {
+    return pollTimeUs;
+  }
+  return (uint32_t)OPENBCI_LOW_POWER_POLL_IDLE_MS * 1000;
+}
+
+/**
+* @description Sends the Host the low power report it asked for with
+*  `OPENBCI_LOW_POWER_BYTE_ID` and `OPENBCI_LOW_POWER_REPORT`. Tried from the
+*  Device `loop()` until it goes in the TX FIFO.
+* @returns {boolean} - `true` if the report was sent
+* @author AJ Keller (@pushtheworldllc)
+*/
+boolean OpenBCI_Radios_Class::lowPowerReportSendToHost(void) {
+  if (!lowPowerReportPending) {
+    return false;
+  }
+  char report[OPENBCI_LOW_POWER_REPORT_BYTES];
+  uint32_t values[3] = {lowPowerPackets, lowPowerRadioOnUs, lowPowerWakes};
+  report[0] = (char)OPENBCI_LOW_POWER_BYTE_ID;
+  for (int i = 0; i < 3; i++) {
+    char *value = report + 1 + i * 4;
+    value[0] = (char)values[i];
+    value[1] = (char)(values[i] >> 8);
+    value[2] = (char)(values[i] >> 16);
+    value[3] = (char)(values[i] >> 24);
+  }
+  if (RFduinoGZLL.sendToHost(report, OPENBCI_LOW_POWER_REPORT_BYTES)) {
+    pollRefresh();
+    lowPowerReportPending = false;
+    return true;
+  }
+  return false;
+}
+
+/**
+* @description Ends any burst and starts the radio on counts over, used when
+*  the Host sets the burst wait.
+* @author AJ Keller (@pushtheworldllc)
+*/
+void OpenBCI_Radios_Class::lowPowerReset(void) {
+  lowPowerBursting = false;
+  lowPowerWaiting = false;
+  lowPowerBurstEnd = 0;
+  lowPowerTimeFirst = 0;
+  lowPowerTimeActive = millis();
+  lowPowerTimeAck = 0;
+  lowPowerReportPending = false;
+  lowPowerPackets = 0;
+  lowPowerRadioOnUs = 0;
+  lowPowerWakes = 0;
+}
+
+/********************************************/
+/********************************************/
+/********    COMMON MEHTOD CODE    **********/
+/********************************************/
+/********************************************/
+
+/**
+* @description Writes a buffer to the serial port of a given length
+* @param buffer [char *] The buffer you want to write out
+* @param length [int] How many bytes to you want to write out?
+* @author AJ Keller (@pushtheworldllc)
+*/
+void OpenBCI_Radios_Class::writeBufferToSerial(char *buffer, int length) {
+  // Make sure we don't seg fault
+  if (buffer == NULL) return;
+
+  // Loop through all bytes in buffer
+  for (int i = 0; i < length; i++) {
+    Serial.write(buffer[i]);
+  }
+}
+
+/**
+* @description Private function to clear the given buffer of length
+* @author AJ Keller (@pushtheworldllc)
+*/
+void OpenBCI_Radios_Class::bufferCleanChar(char *buffer, int bufferLength) {
+  for (int i = 0; i < bufferLength; i++) {
+    buffer[i] = 0;
+  }
+}
+
+/**
+* @description Private function to clean a PacketBuffer.
+* @author AJ Keller (@pushtheworldllc)
+*/
+void OpenBCI_Radios_Class::bufferCleanPacketBuffer(PacketBuffer *packetBuffer, int numberOfPackets) {
+  for(int i = 0; i < numberOfPackets; i++) {
+    packetBuffer[i].positionRead = 0;
+    packetBuffer[i].positionWrite = 1;
+  }
+}
+
+/**
+* @description Private function to clean a PacketBuffer.
+* @author AJ Keller (@pushtheworldllc)
+*/
+void OpenBCI_Radios_Class::bufferCleanCompletePacketBuffer(PacketBuffer *packetBuffer, int numberOfPackets) {
+  for(int i = 0; i < numberOfPackets; i++) {
+    packetBuffer[i].positionRead = 0;
+    packetBuffer[i].positionWrite = 0;
+  }
+}
+
+/**
+* @description Private function to clean (clear/reset) a Buffer.
+* @author AJ Keller (@pushtheworldllc)
+*/
+void OpenBCI_Radios_Class::bufferCleanBuffer(Buffer *buffer, int numberOfPacketsToClean) {
+  bufferCleanPacketBuffer(buffer->packetBuffer,numberOfPacketsToClean);
+  buffer->numberOfPacketsToSend = 0;
+  buffer->numberOfPacketsSent = 0;
+  buffer->overflowed = false;
+}
+
+/**
+* @description Private function to clean (clear/reset) a Buffer.
+* @author AJ Keller (@pushtheworldllc)
+*/
+void OpenBCI_Radios_Class::bufferCleanCompleteBuffer(Buffer *buffer, int numberOfPacketsToClean) {
+  bufferCleanCompletePacketBuffer(buffer->packetBuffer,numberOfPacketsToClean);
+  buffer->numberOfPacketsToSend = 0;
+  buffer->numberOfPacketsSent = 0;
+  // Serial.print("#p2s5: "); Serial.println(buffer->numberOfPacketsToSend);
+
+  buffer->overflowed = false;
+}
+
+/**
+* @description Used to add a char data array to the the radio buffer. Always
+*      skips the fist
+* @param data {char *} - An array from RFduinoGZLL_onReceive
+* @param len {int} - Length of array from RFduinoGZLL_onReceive
+* @param clearBuffer {boolean} - If true then will reset the flags on the radio
+*      buffer.
+* @return {boolean} - True if the data was added to the buffer, false if the
+*      buffer was overflowed.
+* @author AJ Keller (@pushtheworldllc)
+*/
+boolean OpenBCI_Radios_Class::bufferRadioAddData(BufferRadio *buf, char *data, int len, boolean lastPacket) {
+  if (lastPacket) {
+    buf->gotAllPackets = true;
+    runPostFromLoop(RUN_WORK_PAGE);
+  }
+  // Serial.print("Pos write "); Serial.println(currentRadioBuffer->positionWrite);
+  for (int i = 0; i < len; i++) {
+    if (buf->positionWrite < OPENBCI_BUFFER_LENGTH_MULTI) { // Check for to prevent overflow
+      buf->data[buf->positionWrite] = data[i];
+      buf->positionWrite++;
+    } else { // We overflowed, need to return false.
+      return false;
+    }
+  }
+  return true;
+}
+
+/**
+* @description Used to fill the buffer with all zeros. Should be used as
+*      frequently as possible. This is very useful if you need to ensure that
+*      no bad data is sent over the serial port.
+* @param `buf` {BufferRadio *} - The buffer to clean.
+* @author AJ Keller (@pushtheworldllc)
+*/
+void OpenBCI_Radios_Class::bufferRadioClean(BufferRadio *buf) {
+  bufferCleanChar(buf->data,OPENBCI_BUFFER_LENGTH_MULTI);
+}
+
+/**
+* @description Called when all the packets have been recieved to flush the
+*       contents of the radio buffer to the serial port, or to the output on
+*       the Host, see ::outputProcess().
+* @param `buf` {BufferRadio *} - The buffer to flush.
+* @author AJ Keller (@pushtheworldllc)
+*/
+void OpenBCI_Radios_Class::bufferRadioFlush(BufferRadio *buf) {
+  // Lock this buffer down!
+  buf->flushing = true;
+  OPENBCI_TRACE(OPENBCI_TRACE_EVENT_FLUSH_START, 0, buf->positionWrite);
+  if (radioMode == OPENBCI_MODE_HOST) {
+    // Staged whole, see ::bufferRadioProcessSingle()
+    outputAdd(buf->data, buf->positionWrite);
+  } else if (debugMode) {
+    for (int j = 0; j < buf->positionWrite; j++) {
+      Serial.print(buf->data[j]);
+    }
+    Serial.println();
+  } else {
+    for (int j = 0; j < buf->positionWrite; j++) {
+      Serial.write(buf->data[j]);
+    }
+  }
+  OPENBCI_TRACE(OPENBCI_TRACE_EVENT_FLUSH_END, 0, buf->positionWrite);
+  buf->flushing = false;
+}
+
+/**
+* @description Used to flush any radio buffer that is ready to be flushed to
+*  the serial port.
+* @author AJ Keller (@pushtheworldllc)
+*/
+void OpenBCI_Radios_Class::bufferRadioFlushBuffers(void) {
+  for (int i = 0; i < OPENBCI_NUMBER_RADIO_BUFFERS; i++) {
+    bufferRadioProcessSingle(bufferRadio + i);
+  }
+}
+
+/**
+* @description Used to determine if there is data in the radio buffer. Most
+*  likely this data needs to be cleared.
+* @param `buf` {BufferRadio *} - The buffer to examine.
+* @returns {boolean} - `true` if the radio buffer has data, `false` if not...
+* @author AJ Keller (@pushtheworldllc)
+*/
+boolean OpenBCI_Radios_Class::bufferRadioHasData(BufferRadio *buf) {
+  return buf->positionWrite > 0;
+}
+
+byte OpenBCI_Radios_Class::bufferRadioProcessPacket(char *data, int len) {
+  // The packetNumber is embedded in the first byte, the byteId
+  int packetNumber = byteIdGetPacketNumber(data[0]);
+  // Last packet
+  if (packetNumber == 0) {
+    // Current buffer has no data
+    if (bufferRadioReadyForNewPage(currentRadioBuffer)) {
+      // Take it! Mark Last
+      bufferRadioAddData(currentRadioBuffer,data+1,len-1,true);
+      // Return that this last packet was added
+      return OPENBCI_PROCESS_RADIO_PASS_LAST_SINGLE;
+
+      // Current buffer has data
+    } else {
+      // Current buffer has all packets or is flushing
+      if (currentRadioBuffer->gotAllPackets || currentRadioBuffer->flushing) {
+        // Can swtich to other buffer
+        if (bufferRadioSwitchToOtherBuffer()) {
+          // Take it! Mark Last
+          bufferRadioAddData(currentRadioBuffer,data+1,len-1,true);
+          // Return that this last packet was added
+          return OPENBCI_PROCESS_RADIO_PASS_SWITCH_LAST;
+
+          // Cannot switch to other buffer
+        } else {
+          // Serial.println("Last packet / Current buffer has data / Current buffer has all packets / Cannot switch to other buffer");
+          // Reject it!
+          return OPENBCI_PROCESS_RADIO_FAIL_SWITCH_LAST;
+        }
+        // Current buffer does not have all packets
+      } else {
+        // Previous packet number == packetNumber + 1
+        if (currentRadioBuffer->previousPacketNumber - packetNumber == 1) {
+          // Serial.println("Last packet / Current buffer has data / Current buffer does not have all packets / Previous packet number == packetNumber + 1");
+          // Take it! Mark last.
+          bufferRadioAddData(currentRadioBuffer,data+1,len-1,true);
+          // Return that this last packet was added
+          return OPENBCI_PROCESS_RADIO_PASS_LAST_MULTI;
+
+          // Missed a packet
+        } else {
+          // Reject it!
+          return OPENBCI_PROCESS_RADIO_FAIL_MISSED_LAST;
+        }
+      }
+    }
+    // Not last packet
+  } else {
+    // Current buffer has no data
+    if (bufferRadioReadyForNewPage(currentRadioBuffer)) {
+      // Serial.println("Not last packet / Current buffer has no data");
+      // Take it, not last
+      bufferRadioAddData(currentRadioBuffer,data+1,len-1,false);
+
+      // Update the previous packet number
+      currentRadioBuffer->previousPacketNumber = packetNumber;
+
+      // Return that a packet that was not last was added
+      return OPENBCI_PROCESS_RADIO_PASS_NOT_LAST_FIRST;
+
+      // Current buffer has data
+    } else {
+      // Current buffer has all packets
+      if (currentRadioBuffer->gotAllPackets) {
+        // Can switch to other buffer
+        if (bufferRadioSwitchToOtherBuffer()) {
+          // Take it! Not last
+          bufferRadioAddData(currentRadioBuffer,data+1,len-1,false);
+
+          // Update the previous packet number
+          currentRadioBuffer->previousPacketNumber = packetNumber;
+
+          // Return that a packet that was not last was added
+          return OPENBCI_PROCESS_RADIO_PASS_SWITCH_NOT_LAST;
 
           // Cannot switch to other buffer
         } else {
-          // Serial.println("Last packet / Current buffer has data / Current buffer has all packets / Cannot switch to other buffer");
           // Reject it!
-          return OPENBCI_PROCESS_RADIO_FAIL_SWITCH_LAST;
+          return OPENBCI_PROCESS_RADIO_FAIL_SWITCH_NOT_LAST;
+        }
+        // Current buffer does not have all packets
+      } else {
+        // Previous packet number == packetNumber + 1
+        if (currentRadioBuffer->previousPacketNumber - packetNumber == 1) {
+          // Take it! Not last.
+          bufferRadioAddData(currentRadioBuffer,data+1,len-1,false);
+
+          // Update the previous packet number
+          currentRadioBuffer->previousPacketNumber = packetNumber;
+
+          // Return that a packet that was not last was added
+          return OPENBCI_PROCESS_RADIO_PASS_NOT_LAST_MIDDLE;
+
+          // Missed a packet
+        } else {
+          // Reject it! Reset current buffer
+          return OPENBCI_PROCESS_RADIO_FAIL_MISSED_NOT_LAST;
+        }
+      }
+    }
+  }
+}
+
+/**
+* @description Should only flush a buffer if it has data in it and has gotten all
+*  of it's packets. This function will be called every loop so it's important to
+*  make sure we don't flush a buffer unless it's really ready!
+* @author AJ Keller (@pushtheworldllc)
+*/
+void OpenBCI_Radios_Class::bufferRadioProcessSingle(BufferRadio *buf) {
+  // The Host holds the page until the output can take all of it
+  if (radioMode == OPENBCI_MODE_HOST && outputFree() < buf->positionWrite) {
+    return;
+  }
+  if (bufferRadioHasData(buf) && buf->gotAllPackets) {
+    // Flush radio buffer to the driver
+    bufferRadioFlush(buf);
+    // Reset the radio buffer flags
+    bufferRadioReset(buf);
+  }
+}
+
+/**
+* @description Used to determing if the buffer radio `buf` is in a locked state.
+* @param `buf` {BufferRadio *} - The buffer to examine.
+* @returns {boolen} - `true` if there is no lock on `buf`
+* @author AJ Keller (@pushtheworldllc)
+*/
+boolean OpenBCI_Radios_Class::bufferRadioReadyForNewPage(BufferRadio *buf) {
+  return !buf->flushing && !bufferRadioHasData(buf);
+}
+
+/**
+* @description Used to reset the flags and positions of the radio buffer.
+* @param `buf` {BufferRadio *} - The buffer to reset.
+* @author AJ Keller (@pushtheworldllc)
+*/
+void OpenBCI_Radios_Class::bufferRadioReset(BufferRadio *buf) {
+  buf->flushing = false;
+  buf->gotAllPackets = false;
+  buf->positionWrite = 0;
+  buf->previousPacketNumber = 0;
+}
+
+/**
+* @description Used to safely swap the global buffers!
+* @returns {boolean} - `true` if the current radio buffer has been swapped,
+*  `false` if the swap was not able to occur.
+* @author AJ Keller (@pushtheworldllc)
+*/
+boolean OpenBCI_Radios_Class::bufferRadioSwitchToOtherBuffer(void) {
+  if (OPENBCI_NUMBER_RADIO_BUFFERS == 2) {
+    // current radio buffer is set to the first one
+    if (currentRadioBuffer == bufferRadio) {
+      if (bufferRadioReadyForNewPage(bufferRadio + 1)) {
+        currentRadioBuffer++;
+        return true;
+      }
+      // current radio buffer is set to the second one
+    } else {
+      if (bufferRadioReadyForNewPage(bufferRadio)) {
+        currentRadioBuffer--;
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+/**
+* @description Stores a char to the serial buffer. Used by both the Device and
+*  the Host.
+* @param newChar {char} - The new char to store to the serial buffer.
+* @return {boolean} - `true` if the new char was added to the serial buffer,
+*  `false` on serial buffer overflow.
+* @author AJ Keller (@pushtheworldllc)
+*/
+boolean OpenBCI_Radios_Class::bufferSerialAddChar(char newChar) {
+  // Is the serial buffer overflowed?
+  if (bufferSerial.overflowed) {
+    // End the subroutine
+    // Serial.println("OVR");
+    return false;
+  } else {
+    // Is the current buffer's write position less than max size of 32?
+    if (currentPacketBufferSerial->positionWrite < OPENBCI_MAX_PACKET_SIZE_BYTES) {
+      // Store the char into the serial buffer at the write position
+      currentPacketBufferSerial->data[currentPacketBufferSerial->positionWrite] = newChar;
+      // Increment the write position
+      currentPacketBufferSerial->positionWrite++;
+      // Set the number of packets to 1 initally, it will only grow
+      if (bufferSerial.numberOfPacketsToSend == 0) {
+        bufferSerial.numberOfPacketsToSend = 1;
+      }
+      // end successful subroutine read
+      return true;
+
+    } else {
+      // Are we out of serial buffers?
+      if (bufferSerial.numberOfPacketsToSend == OPENBCI_NUMBER_SERIAL_BUFFERS) {
+        // Set the overflowed flag equal to true
+        bufferSerial.overflowed = true;
+        // Serial.println("OVR");
+        // End the subroutine with a failure
+        return false;
+
+      } else {
+        // Increment the current buffer pointer to the next one
+        currentPacketBufferSerial++;
+        // Increment the number of packets to send
+        bufferSerial.numberOfPacketsToSend++;
+        // Serial.print("#p2s1: "); Serial.println(bufferSerial.numberOfPacketsToSend);
+
+        // Store the char into the serial buffer at the write position
+        currentPacketBufferSerial->data[currentPacketBufferSerial->positionWrite] = newChar;
+        // Increment the write position
+        currentPacketBufferSerial->positionWrite++;
+        // End the subroutine with success
+        return true;
+      }
+    }
+  }
+}
+
+/**
+* @description Stores a char from the driver on the Host when framing is on.
+*  A page starts with `OPENBCI_FRAME_BYTE_START` followed by the page length
+*  as 16 bits little endian, the page is dispatched the moment its last byte
+*  arrives instead of after `OPENBCI_TIMEOUT_PACKET_NRML_uS` of silence. A char
+*  outside of a frame is stored like normal and found by the timeout.
+* @param newChar {char} - The new char from the driver.
+* @return {boolean} - `true` if the char was taken, `false` on serial buffer
+*  overflow or a frame length that does not fit.
+* @author AJ Keller (@pushtheworldllc)
+*/
+boolean OpenBCI_Radios_Class::bufferSerialAddFramedChar(char newChar) {
+  switch (serialFrameState) {
+    case FRAME_STATE_LENGTH_LOW:
+    serialFrameBytesLeft = (uint8_t)newChar;
+    serialFrameState = FRAME_STATE_LENGTH_HIGH;
+    return true;
+    case FRAME_STATE_LENGTH_HIGH:
+    serialFrameBytesLeft |= (uint16_t)((uint8_t)newChar) << 8;
+    if (serialFrameBytesLeft == 0 || serialFrameBytesLeft > OPENBCI_FRAME_LENGTH_MAX) {
+      serialFrameState = FRAME_STATE_IDLE;
+      return false;
+    }
+    serialFrameState = FRAME_STATE_PAYLOAD;
+    return true;
+    case FRAME_STATE_PAYLOAD:
+    if (!bufferSerialAddChar(newChar)) {
+      serialFrameState = FRAME_STATE_IDLE;
+      return false;
+    }
+    serialFrameBytesLeft--;
+    if (serialFrameBytesLeft == 0) {
+      serialFrameState = FRAME_STATE_IDLE;
+      serialFrameComplete = true;
+      bufferSerialFrameDispatch();
+    }
+    return true;
+    case FRAME_STATE_IDLE:
+    default:
+    // Only start a frame on an empty serial buffer
+    if (newChar == (char)OPENBCI_FRAME_BYTE_START && bufferSerial.numberOfPacketsToSend == 0) {
+      serialFrameState = FRAME_STATE_LENGTH_LOW;
+      return true;
+    }
+    return bufferSerialAddChar(newChar);
+  }
+}
+
+/**
+* @description Called on the Host from `loop()` when the last byte of a framed
+*  page arrives. Private commands are acted on right away and a single packet
+*  page goes on the TX queue so it rides on the next ack. A multi packet page
+*  is left for the normal send path, which no longer waits.
+* @author AJ Keller (@pushtheworldllc)
+*/
+void OpenBCI_Radios_Class::bufferSerialFrameDispatch(void) {
+  if (!systemUp || bufferSerial.numberOfPacketsToSend != 1) {
+    return;
+  }
+  // Time sync needs the ack flag so take the existing path
+  if (!packetInTXRadioBuffer && processOutboundBufferForTimeSync()) {
+    return;
+  }
+  txQueueAddSerialPage();
+}
+
+/**
+* @description Used to drop a framed page that stopped coming in mid-write,
+*  i.e. a byte was lost on the way from the driver.
+* @return {boolean} - `true` if a partial frame was dropped
+* @author AJ Keller (@pushtheworldllc)
+*/
+boolean OpenBCI_Radios_Class::bufferSerialFrameTimeout(void) {
+  if (serialFrameState == FRAME_STATE_IDLE) {
+    return false;
+  }
+  if (micros() - lastTimeSerialRead < OPENBCI_TIMEOUT_FRAME_uS) {
+    return false;
+  }
+  serialFrameState = FRAME_STATE_IDLE;
+  bufferSerialReset(bufferSerial.numberOfPacketsToSend);
+  return true;
+}
+
+/**
+* @description If there are packets to be sent in the serial buffer.
+* @return {boolean} - `true` if there are packets waiting to be sent from the
+*  serial buffer, `false` if not...
+* @author AJ Keller (@pushtheworldllc)
+*/
+boolean OpenBCI_Radios_Class::bufferSerialHasData(void) {
+  return bufferSerial.numberOfPacketsSent < bufferSerial.numberOfPacketsToSend;
+}
+
+/**
+* @description Function to clean (clear/reset) the bufferSerial.
+* @param - `n` - {uint8_t} - The number of packets you want to
+*      clean, for example, on init, we would clean all packets, but on cleaning
+*      from the RFduinoGZLL_onReceive() we would only clean the number of
+*      packets actually used.
+* @author AJ Keller (@pushtheworldllc)
+*/
+void OpenBCI_Radios_Class::bufferSerialReset(uint8_t n) {
+  bufferCleanBuffer(&bufferSerial, n);
+  currentPacketBufferSerial = bufferSerial.packetBuffer;
+  serialFrameComplete = false;
+  // previousPacketNumber = 0;
+}
+
+/**
+* @description Based off the last time the serial port was read from, Determines
+*  if enough time has passed to qualify this data as a full serial page.
+* @returns {boolean} - `true` if enough time has passed, `false` if not.
+* @author AJ Keller (@pushtheworldllc)
+*/
+boolean OpenBCI_Radios_Class::bufferSerialTimeout(void) {
+  return micros() > (lastTimeSerialRead + OPENBCI_TIMEOUT_PACKET_NRML_uS);
+}
+
+/**
+* @description Process a char from the serial port on the Device. Enters the char
+*  into the stream state machine.
+* @param `buf` {StreamPacketBuffer *} - The stream packet buffer to add the char to.
+* @param `newChar` {char} - A new char to process
+* @author AJ Keller (@pushtheworldllc)
+*/
+void OpenBCI_Radios_Class::bufferStreamAddChar(StreamPacketBuffer *buf, char newChar) {
+  // Process the new char
+  switch (buf->state) {
+    case STREAM_STATE_TAIL:
+    // Is the current char equal to 0xCX where X is 0-F?
+    if (isATailByte(newChar)) {
+      // Set the type byte
+      buf->typeByte = newChar;
+      // Change the state to ready
+      buf->state = STREAM_STATE_READY;
+      // Serial.print(33); Serial.print(" state: "); Serial.print("READY-");
+      // Serial.println((streamPacketBuffer + streamPacketBufferHead)->state);
+    } else {
+      // Reset the state machine
+      buf->state = STREAM_STATE_INIT;
+      // Set bytes in to 0
+      buf->bytesIn = 0;
+      // Test to see if this byte is a head byte, maybe if it's not a
+      //  tail byte then that's because a byte was dropped on the way
+      //  over from the Pic.
+      if (newChar == OPENBCI_STREAM_PACKET_HEAD) {
+        // Move the state
+        buf->state = STREAM_STATE_STORING;
+        // Store to the streamPacketBuffer
+        buf->data[0] = newChar;
+        // Set to 1
+        buf->bytesIn = 1;
+      }
+    }
+    break;
+    case STREAM_STATE_STORING:
+    // Store to the stream packet buffer
+    buf->data[buf->bytesIn] = newChar;
+    // Increment the number of bytes read in
+    buf->bytesIn++;
+
+    if (buf->bytesIn == OPENBCI_MAX_PACKET_SIZE_BYTES) {
+      buf->state = STREAM_STATE_TAIL;
+    }
+
+    break;
+    // We have called the function before we were able to send the stream
+    //  packet which means this is not a stream packet, it's part of a
+    //  bigger message
+    case STREAM_STATE_READY:
+    // Got a 34th byte, go back to start
+    buf->state = STREAM_STATE_INIT;
+    // Set bytes in to 0
+    buf->bytesIn = 0;
+
+    break;
+    case STREAM_STATE_INIT:
+    if (newChar == OPENBCI_STREAM_PACKET_HEAD) {
+      // Move the state
+      buf->state = STREAM_STATE_STORING;
+      // Store to the streamPacketBuffer
+      buf->data[0] = newChar;
+      // Set to 1
+      buf->bytesIn = 1;
+    }
+    break;
+    default:
+    // // Reset the state
+    buf->state = STREAM_STATE_INIT;
+    break;
+
+  }
+}
+
+/**
+* @description Used to add a packet to the of steaming data to the current
+*  `streamPacketBufferHead` and then increment the head. Will wrap around if
+*  need be to avoid moving the head past `OPENBCI_NUMBER_STREAM_BUFFERS`.
+* @param `data` {char *} - The data packet you want to add of length
+*  `OPENBCI_MAX_PACKET_SIZE_BYTES` (32)
+* @returns {boolean} - `true` if able to add it. Currently this func will always
+*  return `true`, however this allows for greater flexiblity in the future.
+* @author AJ Keller (@pushtheworldllc)
+*/
+boolean OpenBCI_Radios_Class::bufferStreamAddData(char *data) {
+  if (streamParityGroup > 0 && byteIdGetStreamPacketType(data[0]) == OPENBCI_STREAM_PACKET_TYPE_PARITY) {
+    return bufferStreamParityCheck(data);
+  }
+
+  // The sample number is the first byte after the byteId
+  uint8_t sampleNumber = (uint8_t)data[1];
+
+  if (streamSampleNextValid) {
+    uint8_t ahead = sampleNumber - streamSampleNext;
+    uint8_t behind = streamSampleNext - 1 - sampleNumber;
+    if (ahead >= 0x80 && behind < OPENBCI_NUMBER_STREAM_HISTORY) {
+      // A resent packet goes back in its place, anything else is a duplicate
+      return bufferStreamFillMissing(data);
+    }
+    if (ahead > 0 && ahead <= OPENBCI_STREAM_GAP_MAX) {
+      // Hold a place for each missing packet and ask the Device for them
+      char nack[OPENBCI_STREAM_GAP_MAX + 1];
+      nack[0] = (char)OPENBCI_STREAM_NACK_BYTE_ID;
+      for (uint8_t i = 0; i < ahead; i++) {
+        StreamPacketBuffer *missing = streamPacketBuffer + streamPacketBufferHead;
+        bufferStreamReset(missing);
+        missing->state = STREAM_STATE_MISSING;
+        missing->data[0] = (char)(streamSampleNext + i);
+        nack[i + 1] = missing->data[0];
+        streamPacketBufferHead++;
+        if (streamPacketBufferHead > (OPENBCI_NUMBER_STREAM_BUFFERS - 1)) {
+          streamPacketBufferHead = 0;
         }
-        // Current buffer does not have all packets
-      } else {
-        // Previous packet number == packetNumber + 1
-        if (currentRadioBuffer->previousPacketNumber - packetNumber == 1) {
-          // Serial.println("Last packet / Current buffer has data / Current buffer does not have all packets / Previous packet number == packetNumber + 1");
-          // Take it! Mark last.
-          bufferRadioAddData(currentRadioBuffer,data+1,len-1,true);
-          // Return that this last packet was added
-          return OPENBCI_PROCESS_RADIO_PASS_LAST_MULTI;
+      }
+      // With parity on the missing packets are rebuilt instead. Called from
+      //  loop(), the TX queue is shared with the radio callback
+      if (streamParityGroup == 0) {
+        noInterrupts();
+        OPENBCI_TRACE_MASK_START();
+        txQueueAdd(nack, ahead + 1, TX_PRIORITY_CONTROL);
+        OPENBCI_TRACE_MASK_END(OPENBCI_TRACE_MASKED_RX_QUEUE);
+        interrupts();
+      }
+    }
+  }
+  // Bigger jumps are a new stream, nothing to ask for
+  boolean newStream = !streamSampleNextValid || (uint8_t)(sampleNumber - streamSampleNext) > OPENBCI_STREAM_GAP_MAX;
+  streamSampleNext = sampleNumber + 1;
+  streamSampleNextValid = true;
+
+  if (streamParityGroup > 0) {
+    bufferStreamParityBoundary(sampleNumber, newStream);
+    bufferStreamParityAdd(data);
+  }
+
+  bufferStreamStoreData(streamPacketBuffer + streamPacketBufferHead, data);
+
+  streamPacketBufferHead++;
+  if (streamPacketBufferHead > (OPENBCI_NUMBER_STREAM_BUFFERS - 1)) {
+    streamPacketBufferHead = 0;
+  }
+  OPENBCI_TRACE(OPENBCI_TRACE_EVENT_RING_HEAD, streamPacketBufferHead, (streamPacketBufferHead + OPENBCI_NUMBER_STREAM_BUFFERS - streamPacketBufferTail) % OPENBCI_NUMBER_STREAM_BUFFERS);
+
+  return true;
+}
+
+/**
+* @description Called on the Host with a stream packet the Device resent after
+*  a NACK. It goes in the place held for it so packets reach the driver in
+*  order.
+* @param data {char *} - The packet, a byteId and 31 bytes
+* @return {boolean} - `true` if a place was waiting for it, `false` if it came
+*  too late or is a duplicate and was dropped.
+* @author AJ Keller (@pushtheworldllc)
+*/
+boolean OpenBCI_Radios_Class::bufferStreamFillMissing(char *data) {
+  uint8_t i = streamPacketBufferTail;
+  while (i != streamPacketBufferHead) {
+    StreamPacketBuffer *buf = streamPacketBuffer + i;
+    if (buf->state == STREAM_STATE_MISSING && buf->data[0] == data[1]) {
+      bufferStreamStoreData(buf, data);
+      buf->state = STREAM_STATE_READY;
+      return true;
+    }
+    i++;
+    if (i > (OPENBCI_NUMBER_STREAM_BUFFERS - 1)) {
+      i = 0;
+    }
+  }
+  return false;
+}
+
+/**
+* @description Used on the Device before sending the stream packet at the tail
+*  of the ring. With low power on, packets are held in the ring until
+*  `OPENBCI_LOW_POWER_BURST_PACKETS` are waiting or the oldest has waited the
+*  burst wait set by the Host, then all of them go out back to back so the
+*  radio wakes once for the lot instead of once a packet.
+* @returns {boolean} - `true` if the tail can be sent now
+* @author AJ Keller (@pushtheworldllc)
+*/
+boolean OpenBCI_Radios_Class::bufferStreamBurstReady(void) {
+  if (lowPowerWaitMs == 0) {
+    return true;
+  }
+  if (lowPowerBursting) {
+    if (streamPacketBufferTail != lowPowerBurstEnd) {
+      return true;
+    }
+    // Packets that came in during the burst wait for the next one
+    lowPowerBursting = false;
+    lowPowerWaiting = false;
+  }
+  if (streamPacketBufferHead == streamPacketBufferTail) {
+    return false;
+  }
+  if (!lowPowerWaiting) {
+    lowPowerWaiting = true;
+    lowPowerTimeFirst = millis();
+  }
+  uint8_t waiting = (streamPacketBufferHead + OPENBCI_NUMBER_STREAM_BUFFERS - streamPacketBufferTail) % OPENBCI_NUMBER_STREAM_BUFFERS;
+  if (waiting >= OPENBCI_LOW_POWER_BURST_PACKETS || millis() - lowPowerTimeFirst >= lowPowerWaitMs) {
+    // Everything in the ring now goes in this burst
+    lowPowerBursting = true;
+    lowPowerWaiting = false;
+    lowPowerBurstEnd = streamPacketBufferHead;
+    return true;
+  }
+  // The held packets went in the serial buffer too, don't let them go out as
+  //  a page, see ::bufferStreamSendToHost()
+  if (bufferSerialHasData()) {
+    bufferSerialReset(bufferSerial.numberOfPacketsToSend);
+  }
+  return false;
+}
+
+/**
+* @description Called on the Device with each stream packet from the Pic before
+*  it goes in the ring, once the Host has set a decimation of 2 or more with
+*  `OPENBCI_STREAM_DECIMATE_BYTE_ID`. Only standard `0xC0` packets are
+*  averaged. With a Daisy odd and even samples carry different channels, so
+*  each has its own average: the 24 bit channel values of every N even packets
+*  are averaged into the last of them, and the same for odd packets. An
+*  average gets its own sample number counting up by one and the stop byte type
+*  `OPENBCI_STREAM_PACKET_TYPE_DECIMATED`, and the aux bytes are the last
+*  packet's. The other packets are dropped, so only one in N takes up air
+*  time. Averaging starts on an even sample so the averages keep the Pic's
+*  order. Packets of any other type, like time stamped ones, go in the ring as
+*  they are but for the sample number, which carries on the count so the Host
+*  doesn't see a gap.
+* @param `buf` {StreamPacketBuffer *} - A stream packet in the ready state
+* @returns {boolean} - `true` if `buf` should go in the ring, `false` if it was
+*  added to the average and reset
+* @author AJ Keller (@pushtheworldllc)
+*/
+boolean OpenBCI_Radios_Class::bufferStreamDecimate(StreamPacketBuffer *buf) {
+  if (streamDecimate < 2) {
+    return true;
+  }
+  if (buf->typeByte != OPENBCI_STREAM_BYTE_STOP) {
+    buf->data[1] = (char)streamDecimateSample;
+    streamDecimateSample++;
+    return true;
+  }
+  uint8_t half = (uint8_t)buf->data[1] & 0x01;
+  if (half == 1 && streamDecimateCount[0] == 0 && streamDecimateCount[1] == 0) {
+    // Wait for an even sample to start on, its bytes went in the serial buffer
+    bufferSerialReset(bufferSerial.numberOfPacketsToSend);
+    bufferStreamReset(buf);
+    return false;
+  }
+  for (int i = 0; i < OPENBCI_STREAM_CHANNELS; i++) {
+    char *value = buf->data + 2 + i * 3;
+    int32_t channel = ((int32_t)(uint8_t)value[0] << 16) | ((int32_t)(uint8_t)value[1] << 8) | (uint8_t)value[2];
+    // Sign extend
+    if (channel & 0x800000) {
+      channel -= 0x1000000;
+    }
+    streamDecimateSum[half][i] = streamDecimateCount[half] == 0 ? channel : streamDecimateSum[half][i] + channel;
+  }
+  streamDecimateCount[half]++;
+  if (streamDecimateCount[half] < streamDecimate) {
+    // Its bytes went in the serial buffer too
+    bufferSerialReset(bufferSerial.numberOfPacketsToSend);
+    bufferStreamReset(buf);
+    return false;
+  }
+  for (int i = 0; i < OPENBCI_STREAM_CHANNELS; i++) {
+    int32_t average = streamDecimateSum[half][i] / streamDecimateCount[half];
+    char *value = buf->data + 2 + i * 3;
+    value[0] = (char)(average >> 16);
+    value[1] = (char)(average >> 8);
+    value[2] = (char)average;
+  }
+  buf->data[1] = (char)streamDecimateSample;
+  buf->typeByte = (char)(OPENBCI_STREAM_BYTE_STOP | OPENBCI_STREAM_PACKET_TYPE_DECIMATED);
+  streamDecimateSample++;
+  streamDecimateCount[half] = 0;
+  return true;
+}
+
+/**
+* @description Starts the averages of ::bufferStreamDecimate() over, from an
+*  even sample and with sample number 0.
+* @author AJ Keller (@pushtheworldllc)
+*/
+void OpenBCI_Radios_Class::bufferStreamDecimateReset(void) {
+  streamDecimateCount[0] = 0;
+  streamDecimateCount[1] = 0;
+  streamDecimateSample = 0;
+}
+
+/**
+* @description Used on the Host once the driver turns on the stream to the
+*  Device with `0xF0 0x0E`. A stream packet from the driver looks just like
+*  one from the Pic, `OPENBCI_STREAM_BYTE_START`, 31 bytes and a stop byte
+*  `0xCX`, and is put on the TX queue ahead of everything else the moment its
+*  stop byte is in. There is no page assembly and no serial timeout.
+* @param newChar {char} - The new char from the PC/Driver
+* @return {boolean} - `true` if the char was part of a stream packet, `false`
+*  if it should be stored like normal.
+* @author AJ Keller (@pushtheworldllc)
+*/
+boolean OpenBCI_Radios_Class::bufferStreamDownAddChar(char newChar) {
+  if (serialFrameState == FRAME_STATE_STREAM) {
+    if (serialFrameBytesLeft > 0) {
+      streamDownPacket[OPENBCI_MAX_PACKET_SIZE_BYTES - serialFrameBytesLeft] = newChar;
+      serialFrameBytesLeft--;
+      return true;
+    }
+    serialFrameState = FRAME_STATE_IDLE;
+    // Drop a packet that doesn't end with a stop byte, same as from the Pic
+    if (isATailByte((uint8_t)newChar)) {
+      streamDownPacket[0] = byteIdMake(true,byteIdMakeStreamPacketType((uint8_t)newChar),streamDownPacket + 1,OPENBCI_MAX_DATA_BYTES_IN_PACKET);
+      noInterrupts();
+      OPENBCI_TRACE_MASK_START();
+      txQueueAdd(streamDownPacket,OPENBCI_MAX_PACKET_SIZE_BYTES,TX_PRIORITY_STREAM);
+      OPENBCI_TRACE_MASK_END(OPENBCI_TRACE_MASKED_STREAM_DOWN);
+      interrupts();
+    }
+    return true;
+  }
+  // A stream packet can only start between pages
+  if (!streamDownEnabled || serialFrameState != FRAME_STATE_IDLE || bufferSerial.numberOfPacketsToSend > 0) {
+    return false;
+  }
+  if (newChar != (char)OPENBCI_STREAM_BYTE_START) {
+    return false;
+  }
+  serialFrameState = FRAME_STATE_STREAM;
+  serialFrameBytesLeft = OPENBCI_MAX_DATA_BYTES_IN_PACKET;
+  return true;
+}
+
+/**
+* @description Called from the Device's `RFduinoGZLL_onReceive` with a stream
+*  packet from the Host. It is written to the Pic from `loop()`.
+* @param `data` {char *} - The packet, a byteId and 31 bytes
+* @param `len` {int} - The length of `data`
+* @return {boolean} - `true` if stored, `false` if the ring was full and the
+*  packet was dropped.
+* @author AJ Keller (@pushtheworldllc)
+*/
+boolean OpenBCI_Radios_Class::bufferStreamDownAddData(char *data, int len) {
+  // Stream down is on even if a reset lost the Host's message saying so
+  streamDownEnabled = true;
+  uint8_t next = streamDownHead + 1;
+  if (next >= OPENBCI_NUMBER_STREAM_DOWN_BUFFERS) {
+    next = 0;
+  }
+  if (next == streamDownTail || len != OPENBCI_MAX_PACKET_SIZE_BYTES) {
+    return false;
+  }
+  for (int i = 0; i < len; i++) {
+    streamDownBuffer[streamDownHead][i] = data[i];
+  }
+  streamDownHead = next;
+  return true;
+}
+
+/**
+* @description Called from the Device's `loop()` to write stream packets from
+*  the Host to the Pic with the same start and stop bytes the driver sent.
+* @author AJ Keller (@pushtheworldllc)
+*/
+void OpenBCI_Radios_Class::bufferStreamDownFlush(void) {
+  while (streamDownTail != streamDownHead) {
+    char *packet = streamDownBuffer[streamDownTail];
+    Serial.write((uint8_t)OPENBCI_STREAM_BYTE_START);
+    for (int i = 1; i < OPENBCI_MAX_PACKET_SIZE_BYTES; i++) {
+      Serial.write(packet[i]);
+    }
+    Serial.write(outputGetStopByteFromByteId(packet[0]));
+    uint8_t next = streamDownTail + 1;
+    if (next >= OPENBCI_NUMBER_STREAM_DOWN_BUFFERS) {
+      next = 0;
+    }
+    streamDownTail = next;
+  }
+}
+
+/**
+* @description Used to flush a StreamPacketBuffer to the output with a
+*  head byte and a formated tail byte based off the `typeByte`, see
+*  ::outputProcess().
+* @param `buf` {StreamPacketBuffer *} - The stream packet buffer to add the char to.
+* @author AJ Keller (@pushtheworldllc)
+**/
+void OpenBCI_Radios_Class::bufferStreamFlush(StreamPacketBuffer *buf) {
+  buf->flushing = true;
+  OPENBCI_TRACE(OPENBCI_TRACE_EVENT_FLUSH_START, buf->data[0], OPENBCI_MAX_PACKET_SIZE_STREAM_BYTES);
+  // Staged whole so nothing else can land in the middle of it
+  char packet[OPENBCI_MAX_PACKET_SIZE_STREAM_BYTES];
+  packet[0] = (char)0xA0;
+  for (int i = 0; i < OPENBCI_MAX_DATA_BYTES_IN_PACKET; i++) {
+    packet[i + 1] = buf->data[i];
+  }
+  packet[OPENBCI_MAX_PACKET_SIZE_STREAM_BYTES - 1] = buf->typeByte;
+  outputAdd(packet, OPENBCI_MAX_PACKET_SIZE_STREAM_BYTES);
+  OPENBCI_TRACE(OPENBCI_TRACE_EVENT_FLUSH_END, buf->data[0], OPENBCI_MAX_PACKET_SIZE_STREAM_BYTES);
+  buf->flushing = false;
+}
+
+/**
+* @description Used on the Host once the driver turns batching on with
+*  `OPENBCI_HOST_CMD_BATCH_ON`. Stages the ready stream packets at the tail of
+*  the ring, up to `OPENBCI_BATCH_PACKETS_MAX`, as one batch for the driver,
+*  see `OPENBCI_BATCH_BYTE_START`. A short batch waits up to
+*  `OPENBCI_TIMEOUT_BATCH_uS` for more packets, and the whole batch waits in
+*  the ring until the output can take it.
+* @author AJ Keller (@pushtheworldllc)
+**/
+void OpenBCI_Radios_Class::bufferStreamFlushBatch(void) {
+  // Count the ready packets from the tail up to the head or a missing one
+  uint8_t count = 0;
+  uint8_t position = streamPacketBufferTail;
+  while (count < OPENBCI_BATCH_PACKETS_MAX && position != streamPacketBufferHead && (streamPacketBuffer + position)->state != STREAM_STATE_MISSING) {
+    count++;
+    position++;
+    if (position > (OPENBCI_NUMBER_STREAM_BUFFERS - 1)) {
+      position = 0;
+    }
+  }
+  if (count < OPENBCI_BATCH_PACKETS_MAX) {
+    if (!outputBatchWaiting) {
+      outputBatchWaiting = true;
+      outputBatchTimeFirst = micros();
+      return;
+    }
+    if (micros() - outputBatchTimeFirst < OPENBCI_TIMEOUT_BATCH_uS) {
+      return;
+    }
+  }
+  uint16_t length = count * OPENBCI_BATCH_PACKET_BYTES;
+  if (outputFree() < OPENBCI_BATCH_HEADER_BYTES + length + OPENBCI_BATCH_CRC_BYTES) {
+    return;
+  }
+  outputBatchWaiting = false;
+
+  char batch[OPENBCI_BATCH_HEADER_BYTES + OPENBCI_BATCH_PACKETS_MAX * OPENBCI_BATCH_PACKET_BYTES + OPENBCI_BATCH_CRC_BYTES];
+  batch[0] = (char)OPENBCI_BATCH_BYTE_START;
+  batch[1] = (char)length;
+  batch[2] = (char)(length >> 8);
+  batch[3] = (char)count;
+  batch[4] = (char)outputBatchSequence;
+  batch[5] = (char)(outputBatchSequence >> 8);
+  char *packet = batch + OPENBCI_BATCH_HEADER_BYTES;
+  OPENBCI_TRACE(OPENBCI_TRACE_EVENT_FLUSH_START, (streamPacketBuffer + streamPacketBufferTail)->data[0], length);
+  for (uint8_t i = 0; i < count; i++) {
+    StreamPacketBuffer *buf = streamPacketBuffer + streamPacketBufferTail;
+    for (int j = 0; j < OPENBCI_MAX_DATA_BYTES_IN_PACKET; j++) {
+      packet[j] = buf->data[j];
+    }
+    packet[OPENBCI_BATCH_PACKET_BYTES - 1] = buf->typeByte;
+    packet += OPENBCI_BATCH_PACKET_BYTES;
+    bufferStreamReset(buf);
+    streamPacketBufferTail++;
+    if (streamPacketBufferTail > (OPENBCI_NUMBER_STREAM_BUFFERS - 1)) {
+      streamPacketBufferTail = 0;
+    }
+  }
+  uint16_t crc = outputCrcUpdate(0xFFFF, batch + 1, OPENBCI_BATCH_HEADER_BYTES - 1 + length);
+  packet[0] = (char)crc;
+  packet[1] = (char)(crc >> 8);
+  outputAdd(batch, OPENBCI_BATCH_HEADER_BYTES + length + OPENBCI_BATCH_CRC_BYTES);
+  outputBatchSequence++;
+  OPENBCI_TRACE(OPENBCI_TRACE_EVENT_FLUSH_END, count, length);
+  OPENBCI_TRACE(OPENBCI_TRACE_EVENT_RING_TAIL, streamPacketBufferTail, (streamPacketBufferHead + OPENBCI_NUMBER_STREAM_BUFFERS - streamPacketBufferTail) % OPENBCI_NUMBER_STREAM_BUFFERS);
+}
+
+/**
+* @description Used to flush a StreamPacketBuffer if the `streamPacketBufferTail`
+*  is not equal to the `streamPacketBufferHead`. This function will also reset
+*  the buffer after the buffer is flushed. Further it will increment `streamPacketBufferTail`
+*  and wrap that around if necessary.
+* @author AJ Keller (@pushtheworldllc)
+**/
+void OpenBCI_Radios_Class::bufferStreamFlushBuffers(void) {
+  if (streamPacketBufferTail != streamPacketBufferHead) {
+    // Hold back everything behind a missing packet until it's resent
+    if ((streamPacketBuffer + streamPacketBufferTail)->state == STREAM_STATE_MISSING) {
+      if (!timerActive[TIMER_EVENT_STREAM_GAP]) {
+        timerStart(TIMER_EVENT_STREAM_GAP, OPENBCI_TIMEOUT_STREAM_GAP_uS);
+      }
+      return;
+    }
+    timerActive[TIMER_EVENT_STREAM_GAP] = false;
+    if (outputBatchEnabled) {
+      bufferStreamFlushBatch();
+      return;
+    }
+    // Stays in the ring until the output can take all of it
+    if (outputFree() < OPENBCI_MAX_PACKET_SIZE_STREAM_BYTES) {
+      return;
+    }
+    bufferStreamFlush(streamPacketBuffer + streamPacketBufferTail);
+    bufferStreamReset(streamPacketBuffer + streamPacketBufferTail);
+    streamPacketBufferTail++;
+    if (streamPacketBufferTail > (OPENBCI_NUMBER_STREAM_BUFFERS - 1)) {
+      streamPacketBufferTail = 0;
+    }
+    OPENBCI_TRACE(OPENBCI_TRACE_EVENT_RING_TAIL, streamPacketBufferTail, (streamPacketBufferHead + OPENBCI_NUMBER_STREAM_BUFFERS - streamPacketBufferTail) % OPENBCI_NUMBER_STREAM_BUFFERS);
+  }
+}
+
+/**
+* @description Used to determine if a stream packet buffer is ready for a new packet
+*  this function is no longer being used with the head/tail system. Will look to
+*  deprecate it soon.
+* @param `buf` {StreamPacketBuffer *} - The stream packet buffer to add the char to.
+* @author AJ Keller (@pushtheworldllc)
+**/
+boolean OpenBCI_Radios_Class::bufferStreamReadyForNewPacket(StreamPacketBuffer *buf) {
+  return buf->bytesIn == 0 && !buf->flushing;
+}
+
+/**
+* @description Utility function to return `true` if the the streamPacketBuffer
+*   is in the STREAM_STATE_READY. Normally used for determining if a stream
+*   packet is ready to be sent.
+* @param `buf` {StreamPacketBuffer *} - The stream packet buffer to send to the Host.
+* @returns {boolean} - `true` is the `buf` is in the ready state, `false` otherwise.
+* @author AJ Keller (@pushtheworldllc)
+*/
+boolean OpenBCI_Radios_Class::bufferStreamReadyToSendToHost(StreamPacketBuffer *buf) {
+  return radio.streamPacketBuffer->state == radio.STREAM_STATE_READY;
+}
 
-          // Missed a packet
-        } else {
-          // Reject it!
-          return OPENBCI_PROCESS_RADIO_FAIL_MISSED_LAST;
-        }
+/**
+* @description Resets the stream packet buffer to default settings
+* @author AJ Keller (@pushtheworldllc)
+*/
+void OpenBCI_Radios_Class::bufferStreamReset(void) {
+  for (int i = 0; i < OPENBCI_NUMBER_STREAM_BUFFERS; i++) {
+    bufferStreamReset(streamPacketBuffer + i);
+  }
+  streamPacketBufferHead = 0;
+  streamPacketBufferTail = 0;
+  streamSampleNextValid = false;
+  bufferStreamParityReset();
+}
+
+/**
+* @description Resets the stream packet buffer to default settings
+* @param `buf` {StreamPacketBuffer *} - Pointer to a stream packet buffer to reset
+* @author AJ Keller (@pushtheworldllc)
+*/
+void OpenBCI_Radios_Class::bufferStreamReset(StreamPacketBuffer *buf) {
+  buf->flushing = false;
+  buf->bytesIn = 0;
+  buf->typeByte = 0;
+  buf->state = STREAM_STATE_INIT;
+}
+
+/**
+* @description XORs a stream packet into the running parity of the group. Used
+*  by the Device on each stream packet it sends and by the Host on each one it
+*  gets.
+* @param data {char *} - The packet, a byteId and 31 bytes
+* @author AJ Keller (@pushtheworldllc)
+*/
+void OpenBCI_Radios_Class::bufferStreamParityAdd(char *data) {
+  for (int i = 1; i < OPENBCI_MAX_PACKET_SIZE_BYTES; i++) {
+    streamParity[i] ^= data[i];
+  }
+  streamParityType = byteIdGetStreamPacketType(data[0]);
+  streamParityCount++;
+}
+
+/**
+* @description Called on the Host with each stream packet while parity is on,
+*  before it goes into the running parity. A group ends at its sample number
+*  boundary even when its parity packet never comes, so a lost parity packet
+*  doesn't run one group into the next. What that group was missing can't be
+*  rebuilt and is counted in `streamParityLost`.
+* @param sampleNumber {uint8_t} - The packet's sample number
+* @param newStream {boolean} - `true` if the packet doesn't follow the last
+*  one, the group starts over at it
+* @author AJ Keller (@pushtheworldllc)
+*/
+void OpenBCI_Radios_Class::bufferStreamParityBoundary(uint8_t sampleNumber, boolean newStream) {
+  uint8_t first = sampleNumber;
+  if (streamParityFirstValid && !newStream) {
+    uint8_t into = sampleNumber - streamParityFirst;
+    if (into < streamParityGroup) {
+      return;
+    }
+    // Whole groups went by without their parity packet
+    uint8_t ended = into - into % streamParityGroup;
+    streamParityLost += ended - streamParityCount;
+    first = streamParityFirst + ended;
+  }
+  bufferStreamParityReset();
+  streamParityFirst = first;
+  streamParityFirstValid = true;
+}
+
+/**
+* @description Called on the Host with a parity packet from the Device. The
+*  size of the group is in the low 3 bits of the byteId. If exactly one packet
+*  of the group is missing it is rebuilt from the parity and put in its place.
+* @param data {char *} - The parity packet, a byteId and 31 bytes
+* @return {boolean} - `true` if a missing packet was rebuilt
+* @author AJ Keller (@pushtheworldllc)
+*/
+boolean OpenBCI_Radios_Class::bufferStreamParityCheck(char *data) {
+  uint8_t groupSize = ((uint8_t)data[0] & 0x07) + 1;
+  boolean recovered = false;
+
+  if (streamParityCount + 1 == groupSize) {
+    char packet[OPENBCI_MAX_PACKET_SIZE_BYTES];
+    packet[0] = byteIdMake(true,streamParityType,packet + 1,OPENBCI_MAX_DATA_BYTES_IN_PACKET);
+    for (int i = 1; i < OPENBCI_MAX_PACKET_SIZE_BYTES; i++) {
+      packet[i] = streamParity[i] ^ data[i];
+    }
+    if (streamSampleNextValid && (uint8_t)packet[1] == streamSampleNext) {
+      // The last packet of the group, nothing came after it yet
+      recovered = bufferStreamAddData(packet);
+    } else {
+      recovered = bufferStreamFillMissing(packet);
+    }
+    if (recovered) {
+      streamParityRecovered++;
+    } else {
+      streamParityLost++;
+    }
+  } else if (streamParityCount < groupSize) {
+    streamParityLost += groupSize - streamParityCount;
+  }
+
+  // The next group starts at the boundary, or after the last packet if the
+  //  Host's group started before the Device's did
+  uint8_t first = streamParityFirst + groupSize;
+  if (streamSampleNextValid && (uint8_t)(streamSampleNext - first) < 0x80) {
+    first = streamSampleNext;
+  }
+  boolean firstValid = streamParityFirstValid;
+  bufferStreamParityReset();
+  streamParityFirst = first;
+  streamParityFirstValid = firstValid;
+  return recovered;
+}
+
+/**
+* @description Clears the running parity to start a new group.
+* @author AJ Keller (@pushtheworldllc)
+*/
+void OpenBCI_Radios_Class::bufferStreamParityReset(void) {
+  for (int i = 0; i < OPENBCI_MAX_PACKET_SIZE_BYTES; i++) {
+    streamParity[i] = 0;
+  }
+  streamParityCount = 0;
+  streamParityPending = false;
+  streamParityFirstValid = false;
+}
+
+/**
+* @description Called on the Device from `loop()` to send the parity packet
+*  once a group is full. It goes out ahead of the next stream packet.
+* @return {boolean} - `true` if the parity packet was sent
+* @author AJ Keller (@pushtheworldllc)
+*/
+boolean OpenBCI_Radios_Class::bufferStreamParitySendToHost(void) {
+  if (!streamParityPending || timerPending(TIMER_EVENT_CHANNEL_CHANGE)) {
+    return false;
+  }
+  streamParity[0] = byteIdMake(true,OPENBCI_STREAM_PACKET_TYPE_PARITY,streamParity + 1,OPENBCI_MAX_DATA_BYTES_IN_PACKET) | ((streamParityCount - 1) & 0x07);
+  if (OPENBCI_TRACE_TX(RFduinoGZLL.sendToHost(streamParity, OPENBCI_MAX_PACKET_SIZE_BYTES), streamParity[0], OPENBCI_MAX_PACKET_SIZE_BYTES)) {
+    pollRefresh();
+    bufferStreamParityReset();
+    return true;
+  }
+  return false;
+}
+
+/**
+* @description Called on the Device from `loop()` to resend one stream packet
+*  the Host asked for, ahead of any new ones.
+* @return {boolean} - `true` if a packet was resent
+* @author AJ Keller (@pushtheworldllc)
+*/
+boolean OpenBCI_Radios_Class::bufferStreamResendToHost(void) {
+  if (timerPending(TIMER_EVENT_CHANNEL_CHANGE)) {
+    return false;
+  }
+  for (int i = 0; i < OPENBCI_NUMBER_STREAM_HISTORY; i++) {
+    if (streamHistoryResend[i]) {
+      if (!OPENBCI_TRACE_TX(RFduinoGZLL.sendToHost(streamHistory[i], OPENBCI_MAX_PACKET_SIZE_BYTES), streamHistory[i][0], OPENBCI_MAX_PACKET_SIZE_BYTES)) {
+        return false;
       }
+      streamHistoryResend[i] = false;
+      pollRefresh();
+      return true;
     }
-    // Not last packet
-  } else {
-    // Current buffer has no data
-    if (bufferRadioReadyForNewPage(currentRadioBuffer)) {
-      // Serial.println("Not last packet / Current buffer has no data");
-      // Take it, not last
-      bufferRadioAddData(currentRadioBuffer,data+1,len-1,false);
+  }
+  return false;
+}
 
-      // Update the previous packet number
-      currentRadioBuffer->previousPacketNumber = packetNumber;
+/**
+* @description Called on the Host when a missing stream packet was not resent
+*  in time, drops its place so the packets behind it go to the driver.
+* @author AJ Keller (@pushtheworldllc)
+*/
+void OpenBCI_Radios_Class::bufferStreamSkipMissing(void) {
+  while (streamPacketBufferTail != streamPacketBufferHead && (streamPacketBuffer + streamPacketBufferTail)->state == STREAM_STATE_MISSING) {
+    bufferStreamReset(streamPacketBuffer + streamPacketBufferTail);
+    streamPacketBufferTail++;
+    if (streamPacketBufferTail > (OPENBCI_NUMBER_STREAM_BUFFERS - 1)) {
+      streamPacketBufferTail = 0;
+    }
+  }
+}
 
-      // Return that a packet that was not last was added
-      return OPENBCI_PROCESS_RADIO_PASS_NOT_LAST_FIRST;
+/**
+* @description Sends the contents of the `streamPacketBuffer` to the HOST,
+*  sends as stream packet with the proper byteId.
+* @returns {boolean} - `true` when the packet has been added to the TX buffer
+* @author AJ Keller (@pushtheworldllc)
+*/
+boolean OpenBCI_Radios_Class::bufferStreamSendToHost(StreamPacketBuffer *buf) {
 
-      // Current buffer has data
-    } else {
-      // Current buffer has all packets
-      if (currentRadioBuffer->gotAllPackets) {
-        // Can switch to other buffer
-        if (bufferRadioSwitchToOtherBuffer()) {
-          // Take it! Not last
-          bufferRadioAddData(currentRadioBuffer,data+1,len-1,false);
+  // Keep it in the ring until we are on the new channel
+  if (timerPending(TIMER_EVENT_CHANNEL_CHANGE)) {
+    return false;
+  }
 
-          // Update the previous packet number
-          currentRadioBuffer->previousPacketNumber = packetNumber;
+  byte packetType = byteIdMakeStreamPacketType(buf->typeByte);
 
-          // Return that a packet that was not last was added
-          return OPENBCI_PROCESS_RADIO_PASS_SWITCH_NOT_LAST;
+  // The parity packet goes before the next group, and a group only holds one
+  //  packet type so the Host knows the type of a packet it rebuilds
+  if (streamParityGroup > 0 && streamParityCount > 0 && packetType != streamParityType) {
+    streamParityPending = true;
+  }
+  if (streamParityPending) {
+    return false;
+  }
 
-          // Cannot switch to other buffer
-        } else {
-          // Reject it!
-          return OPENBCI_PROCESS_RADIO_FAIL_SWITCH_NOT_LAST;
-        }
-        // Current buffer does not have all packets
-      } else {
-        // Previous packet number == packetNumber + 1
-        if (currentRadioBuffer->previousPacketNumber - packetNumber == 1) {
-          // Take it! Not last.
-          bufferRadioAddData(currentRadioBuffer,data+1,len-1,false);
+  char byteId = byteIdMake(true,packetType,buf->data + 1, OPENBCI_MAX_DATA_BYTES_IN_PACKET); // 31 bytes
 
-          // Update the previous packet number
-          currentRadioBuffer->previousPacketNumber = packetNumber;
+  // Add the byteId to the packet
+  buf->data[0] = byteId;
 
-          // Return that a packet that was not last was added
-          return OPENBCI_PROCESS_RADIO_PASS_NOT_LAST_MIDDLE;
+  // Clean the serial buffer (because these bytes got added to it too)
+  bufferSerialReset(bufferSerial.numberOfPacketsToSend);
 
-          // Missed a packet
-        } else {
-          // Reject it! Reset current buffer
-          return OPENBCI_PROCESS_RADIO_FAIL_MISSED_NOT_LAST;
-        }
+  if (OPENBCI_TRACE_TX(RFduinoGZLL.sendToHost((char *)buf->data, OPENBCI_MAX_PACKET_SIZE_BYTES), buf->data[0], OPENBCI_MAX_PACKET_SIZE_BYTES)) {
+    // Refresh the poll timeout timer because we just polled the Host by sending
+    //  that last packet
+    pollRefresh();
+    timeOfLastStream = timeOfLastPoll;
+    linkSent();
+    lowPowerPackets++;
+
+    // Keep a copy in case the Host asks for it again
+    char *history = streamHistory[(uint8_t)buf->data[1] % OPENBCI_NUMBER_STREAM_HISTORY];
+    for (int i = 0; i < OPENBCI_MAX_PACKET_SIZE_BYTES; i++) {
+      history[i] = buf->data[i];
+    }
+
+    if (streamParityGroup > 0) {
+      bufferStreamParityAdd(buf->data);
+      if (streamParityCount >= streamParityGroup) {
+        streamParityPending = true;
       }
     }
+
+    // Clean the stream packet buffer
+    bufferStreamReset(buf);
+
+    return true;
+  }
+
+  return false;
+}
+
+/**
+* @description Used to flush a StreamPacketBuffer to the serial port with a
+*  head byte and a formated tail byte based off the `typeByte`.
+* @param `buf` {StreamPacketBuffer *} - The stream packet buffer to add the char to.
+* @param `data` {char *} - A stream packet buffer in raw char buffer form fresh
+*   from the radio.
+* @author AJ Keller (@pushtheworldllc)
+**/
+void OpenBCI_Radios_Class::bufferStreamStoreData(StreamPacketBuffer *buf, char *data) {
+  buf->bytesIn = OPENBCI_MAX_DATA_BYTES_IN_PACKET;
+  buf->typeByte = outputGetStopByteFromByteId(data[0]);
+  for (int i = 0; i < OPENBCI_MAX_DATA_BYTES_IN_PACKET; i++) {
+    buf->data[i] = data[i+1];
+  }
+}
+
+/**
+* @description Based off the last time the serial port was read from, determines
+*  if enough time has passed to qualify this data as a stream packet.
+* @returns {boolean} - `true` if enough time has passed, `false` if not.
+* @author AJ Keller (@pushtheworldllc)
+*/
+boolean OpenBCI_Radios_Class::bufferStreamTimeout(void) {
+  return micros() > (lastTimeSerialRead + OPENBCI_TIMEOUT_PACKET_STREAM_uS);
+}
+
+/**
+* @description Creates a byteId for sending data over the RFduinoGZLL
+* @param isStreamPacket [boolean] Set true if this is a streaming packet
+* @param packetNumber {uint8_t} What number packet are you trying to send?
+* @param data [char *] The data you want to send. NOTE: Do not send the address
+*           of the entire buffer, send this method address of buffer + 1
+* @param length [int] The length of the data buffer
+* @returns [char] The newly formed byteId where a byteId is defined as
+*           Bit 7 - Streaming byte packet
+*           Bits[6:3] - Packet count
+*           Bits[2:0] - The check sum
+* @author AJ Keller (@pushtheworldllc)
+*/
+char OpenBCI_Radios_Class::byteIdMake(boolean isStreamPacket, uint8_t packetNumber, char *data, uint8_t length) {
+  // Set output initially equal to 0
+  char output = 0x00;
+
+  // Set first bit if this is a streaming packet
+  if  (isStreamPacket) output = output | 0x80;
+
+  // Set packet count bits Bits[6:3] NOTE: 0xFF is error
+  // convert int to char then shift then or
+  output = output | ((packetNumber & 0x0F) << 3);
+
+  return output;
+}
+
+/**
+* @description Determines if this byteId is a stream byte
+* @param byteId [char] a byteId (see ::byteIdMake for description of bits)
+* @returns [int] the check sum
+* @author AJ Keller (@pushtheworldllc)
+*/
+boolean OpenBCI_Radios_Class::byteIdGetIsStream(uint8_t byteId) {
+  return byteId > 0x7F;
+}
+
+/**
+* @description Determines if this byteId starts a stream control message from
+*  the Host, see ::processDeviceRadioCharStreamControl(). These are never
+*  written to the Pic.
+* @param byteId [uint8_t] a byteId
+* @returns [boolean] `true` for a stream control message
+* @author AJ Keller (@pushtheworldllc)
+*/
+boolean OpenBCI_Radios_Class::byteIdGetIsStreamControl(uint8_t byteId) {
+  switch (byteId) {
+    case OPENBCI_STREAM_NACK_BYTE_ID:
+    case OPENBCI_STREAM_PARITY_BYTE_ID:
+    case OPENBCI_STREAM_DECIMATE_BYTE_ID:
+    case OPENBCI_LOW_POWER_BYTE_ID:
+    case OPENBCI_LINK_STATE_BYTE_ID:
+    case OPENBCI_POLL_TIME_BYTE_ID:
+    case OPENBCI_STREAM_DOWN_BYTE_ID:
+    case OPENBCI_TRACE_BYTE_ID:
+    return true;
+    default:
+    return false;
   }
 }
 
 /**
-* @description Should only flush a buffer if it has data in it and has gotten all
-*  of it's packets. This function will be called every loop so it's important to
-*  make sure we don't flush a buffer unless it's really ready!
+* @description Strips and gets the packet number from a byteId
+* @param byteId [char] a byteId (see ::byteIdMake for description of bits)
+* @returns [int] the packetNumber
+* @author AJ Keller (@pushtheworldllc)
+*/
+int OpenBCI_Radios_Class::byteIdGetPacketNumber(uint8_t byteId) {
+  return (int)((byteId & 0x78) >> 3);
+}
+
+/**
+* @description Strips and gets the packet number from a byteId
+* @param byteId [char] a byteId (see ::byteIdMake for description of bits)
+* @returns [byte] the packet type
+* @author AJ Keller (@pushtheworldllc)
+*/
+byte OpenBCI_Radios_Class::byteIdGetStreamPacketType(uint8_t byteId) {
+  return (byte)((byteId & 0x78) >> 3);
+}
+
+/**
+* @description Strips and gets the packet number from a byteId
+* @returns [byte] the packet type
 * @author AJ Keller (@pushtheworldllc)
 */
-void OpenBCI_Radios_Class::bufferRadioProcessSingle(BufferRadio *buf) {
-  if (bufferRadioHasData(buf) && buf->gotAllPackets) {
-    // Flush radio buffer to the driver
-    bufferRadioFlush(buf);
-    // Reset the radio buffer flags
-    bufferRadioReset(buf);
-  }
+byte OpenBCI_Radios_Class::byteIdMakeStreamPacketType(uint8_t typeByte) {
+  return typeByte & 0x0F;
 }
 
 /**
-* @description Used to determing if the buffer radio `buf` is in a locked state.
-* @param `buf` {BufferRadio *} - The buffer to examine.
-* @returns {boolen} - `true` if there is no lock on `buf`
+* @description Send a NULL packet to the HOST
 * @author AJ Keller (@pushtheworldllc)
 */
-boolean OpenBCI_Radios_Class::bufferRadioReadyForNewPage(BufferRadio *buf) {
-  return !buf->flushing && !bufferRadioHasData(buf);
+void OpenBCI_Radios_Class::pollHost(void) {
+  OPENBCI_TRACE(OPENBCI_TRACE_EVENT_POLL, 0, 0);
+  OPENBCI_TRACE_TX(RFduinoGZLL.sendToHost(NULL,0), 0, 0);
+  linkSent();
+  pollRefresh();
 }
 
 /**
-* @description Used to reset the flags and positions of the radio buffer.
-* @param `buf` {BufferRadio *} - The buffer to reset.
+* @description The time the Device waits between polls. Never shorter than
+*  `OPENBCI_POLL_TIME_MIN_uS`, a poll can't go out faster than the one before
+*  it is acked. While stream packets are in the ring or went out in the last
+*  `OPENBCI_TIMEOUT_STREAM_ACTIVE_MS` never shorter than
+*  `OPENBCI_POLL_TIME_STREAM_MIN_uS` either, the acks to the stream packets
+*  carry the Host's messages already and a poll would only take a turn on the
+*  radio from them. Longer when quiet in low power, see ::lowPowerPollTime().
+* @return {unsigned long} - The time between polls in uS
 * @author AJ Keller (@pushtheworldllc)
 */
-void OpenBCI_Radios_Class::bufferRadioReset(BufferRadio *buf) {
-  buf->flushing = false;
-  buf->gotAllPackets = false;
-  buf->positionWrite = 0;
-  buf->previousPacketNumber = 0;
+unsigned long OpenBCI_Radios_Class::pollInterval(void) {
+  unsigned long interval = lowPowerPollTime();
+  if (interval < OPENBCI_POLL_TIME_MIN_uS) {
+    interval = OPENBCI_POLL_TIME_MIN_uS;
+  }
+  if (interval < OPENBCI_POLL_TIME_STREAM_MIN_uS) {
+    if (streamPacketBufferHead != streamPacketBufferTail || micros() - timeOfLastStream < (unsigned long)OPENBCI_TIMEOUT_STREAM_ACTIVE_MS * 1000) {
+      interval = OPENBCI_POLL_TIME_STREAM_MIN_uS;
+    }
+  }
+  return interval;
 }
 
 /**
-* @description Used to safely swap the global buffers!
-* @returns {boolean} - `true` if the current radio buffer has been swapped,
-*  `false` if the swap was not able to occur.
+* @description Has enough time passed since the last poll, see ::pollInterval()
+* @return [boolean]
 * @author AJ Keller (@pushtheworldllc)
 */
-boolean OpenBCI_Radios_Class::bufferRadioSwitchToOtherBuffer(void) {
-  if (OPENBCI_NUMBER_RADIO_BUFFERS == 2) {
-    // current radio buffer is set to the first one
-    if (currentRadioBuffer == bufferRadio) {
-      if (bufferRadioReadyForNewPage(bufferRadio + 1)) {
-        currentRadioBuffer++;
-        return true;
-      }
-      // current radio buffer is set to the second one
-    } else {
-      if (bufferRadioReadyForNewPage(bufferRadio)) {
-        currentRadioBuffer--;
-        return true;
-      }
-    }
-  }
-  return false;
+boolean OpenBCI_Radios_Class::pollNow(void) {
+  return micros() - timeOfLastPoll > pollInterval();
 }
 
 /**
-* @description Stores a char to the serial buffer. Used by both the Device and
-*  the Host.
-* @param newChar {char} - The new char to store to the serial buffer.
-* @return {boolean} - `true` if the new char was added to the serial buffer,
-*  `false` on serial buffer overflow.
+* @description Used to determine if a timed transition has been started and
+*  its time has not run out yet.
+* @param `event` {uint8_t} - The `TIMER_EVENT_*` to check
+* @return {boolean} - `true` if `event` is still waiting
 * @author AJ Keller (@pushtheworldllc)
 */
-boolean OpenBCI_Radios_Class::bufferSerialAddChar(char newChar) {
-  // Is the serial buffer overflowed?
-  if (bufferSerial.overflowed) {
-    // End the subroutine
-    // Serial.println("OVR");
+boolean OpenBCI_Radios_Class::timerPending(uint8_t event) {
+  if (!timerActive[event]) {
     return false;
-  } else {
-    // Is the current buffer's write position less than max size of 32?
-    if (currentPacketBufferSerial->positionWrite < OPENBCI_MAX_PACKET_SIZE_BYTES) {
-      // Store the char into the serial buffer at the write position
-      currentPacketBufferSerial->data[currentPacketBufferSerial->positionWrite] = newChar;
-      // Increment the write position
-      currentPacketBufferSerial->positionWrite++;
-      // Set the number of packets to 1 initally, it will only grow
-      if (bufferSerial.numberOfPacketsToSend == 0) {
-        bufferSerial.numberOfPacketsToSend = 1;
-      }
-      // end successful subroutine read
-      return true;
+  }
+  return (long)(micros() - timerDeadline[event]) < 0;
+}
 
-    } else {
-      // Are we out of serial buffers?
-      if (bufferSerial.numberOfPacketsToSend == OPENBCI_NUMBER_SERIAL_BUFFERS) {
-        // Set the overflowed flag equal to true
-        bufferSerial.overflowed = true;
-        // Serial.println("OVR");
-        // End the subroutine with a failure
-        return false;
+/**
+* @description Advances any timed transitions whose time has run out. Replaces
+*  the blocking `delay()`s that used to sit on the radio paths, must be called
+*  every `loop()`.
+*    `TIMER_EVENT_PAGE_RETRY` - Nothing to do, the page is resent by the
+*      normal send paths once this is no longer pending.
+*    `TIMER_EVENT_CHANNEL_CHANGE` - The radio switches to `timerChannelNumber`
+*    `TIMER_EVENT_BAUD_CHANGE` - Host re-opens the serial port at `timerBaudRate`
+* @author AJ Keller (@pushtheworldllc)
+*/
+void OpenBCI_Radios_Class::timerProcess(void) {
+  for (uint8_t event = 0; event < TIMER_EVENT_COUNT; event++) {
+    if (!timerActive[event] || timerPending(event)) {
+      continue;
+    }
+    timerActive[event] = false;
 
+    switch (event) {
+      case TIMER_EVENT_CHANNEL_CHANGE:
+      // Change radio channel
+      RFduinoGZLL.end();
+      RFduinoGZLL.channel = timerChannelNumber;
+      if (radioMode == OPENBCI_MODE_DEVICE) {
+        RFduinoGZLL.begin(RFDUINOGZLL_ROLE_DEVICE);
+        pollRefresh();
       } else {
-        // Increment the current buffer pointer to the next one
-        currentPacketBufferSerial++;
-        // Increment the number of packets to send
-        bufferSerial.numberOfPacketsToSend++;
-        // Serial.print("#p2s1: "); Serial.println(bufferSerial.numberOfPacketsToSend);
-
-        // Store the char into the serial buffer at the write position
-        currentPacketBufferSerial->data[currentPacketBufferSerial->positionWrite] = newChar;
-        // Increment the write position
-        currentPacketBufferSerial->positionWrite++;
-        // End the subroutine with success
-        return true;
+        RFduinoGZLL.begin(RFDUINOGZLL_ROLE_HOST);
+      }
+      break;
+      case TIMER_EVENT_BAUD_CHANGE:
+      // Wait again until the message is out of the output
+      if ((int16_t)(timerBaudPosition - outputPositionRead) > 0) {
+        timerStart(TIMER_EVENT_BAUD_CHANGE, OPENBCI_TIMEOUT_BAUD_CHANGE_uS);
+        break;
       }
+      // Close the current serial connection
+      Serial.end();
+      // Open the Serial connection
+      Serial.begin(timerBaudRate);
+      outputSetBaudRate(timerBaudRate);
+      break;
+      case TIMER_EVENT_STREAM_GAP:
+      // The missing stream packet never came, stop holding back the rest
+      bufferStreamSkipMissing();
+      break;
+      default:
+      break;
     }
   }
 }
 
 /**
-* @description If there are packets to be sent in the serial buffer.
-* @return {boolean} - `true` if there are packets waiting to be sent from the
-*  serial buffer, `false` if not...
+* @description Starts a timed transition that `::timerProcess()` will advance
+*  from `loop()` once `duration` has passed. Safe to call from
+*  `RFduinoGZLL_onReceive`. Starting an event that is already pending restarts it.
+* @param `event` {uint8_t} - The `TIMER_EVENT_*` to start
+* @param `duration` {unsigned long} - Microseconds until the transition
 * @author AJ Keller (@pushtheworldllc)
 */
-boolean OpenBCI_Radios_Class::bufferSerialHasData(void) {
-  return bufferSerial.numberOfPacketsSent < bufferSerial.numberOfPacketsToSend;
+void OpenBCI_Radios_Class::timerStart(uint8_t event, unsigned long duration) {
+  timerDeadline[event] = micros() + duration;
+  timerActive[event] = true;
+  runPostFromLoop(RUN_WORK_TIMER);
 }
 
+#if OPENBCI_TRACE_ENABLED
 /**
-* @description Function to clean (clear/reset) the bufferSerial.
-* @param - `n` - {uint8_t} - The number of packets you want to
-*      clean, for example, on init, we would clean all packets, but on cleaning
-*      from the RFduinoGZLL_onReceive() we would only clean the number of
-*      packets actually used.
+* @description Adds a record with the time in micros to the trace ring, the
+*  oldest record is written over once the ring is full. Safe to call from
+*  `RFduinoGZLL_onReceive`, though a record made there can land on top of one
+*  being made in `loop()`, so a trace may lose a record now and then. Call it
+*  through `OPENBCI_TRACE()` so it compiles to nothing unless
+*  `OPENBCI_TRACE_ENABLED` is 1.
+* @param `event` {uint8_t} - One of `OPENBCI_TRACE_EVENT_*`
+* @param `arg` {uint8_t} - What the event is about, see the definitions
+* @param `value` {uint16_t} - A count or time that goes with the event
 * @author AJ Keller (@pushtheworldllc)
 */
-void OpenBCI_Radios_Class::bufferSerialReset(uint8_t n) {
-  bufferCleanBuffer(&bufferSerial, n);
-  currentPacketBufferSerial = bufferSerial.packetBuffer;
-  // previousPacketNumber = 0;
+void OpenBCI_Radios_Class::traceAdd(uint8_t event, uint8_t arg, uint16_t value) {
+  if (tracePaused) {
+    return;
+  }
+  TraceRecord *record = traceRing + (traceCount & (OPENBCI_TRACE_RING_SIZE - 1));
+  record->time = micros();
+  record->event = event;
+  record->arg = arg;
+  record->value = value;
+  traceCount++;
 }
 
 /**
-* @description Based off the last time the serial port was read from, Determines
-*  if enough time has passed to qualify this data as a full serial page.
-* @returns {boolean} - `true` if enough time has passed, `false` if not.
+* @description Starts writing the Host trace ring to the driver with a header
+*  line, the records follow from ::traceFlush() as the output has room. The
+*  ring is held still while it's written.
 * @author AJ Keller (@pushtheworldllc)
 */
-boolean OpenBCI_Radios_Class::bufferSerialTimeout(void) {
-  return micros() > (lastTimeSerialRead + OPENBCI_TIMEOUT_PACKET_NRML_uS);
+void OpenBCI_Radios_Class::traceDump(void) {
+  tracePaused = true;
+  traceSendTotal = traceCount < OPENBCI_TRACE_RING_SIZE ? traceCount : OPENBCI_TRACE_RING_SIZE;
+  traceSendFirst = traceCount - traceSendTotal;
+  traceSendPosition = 0;
+  traceSending = true;
+  printSuccess();
+  outputPrint("Trace host ");
+  outputPrintNumber(traceSendTotal);
+  outputPrint(" of ");
+  outputPrintNumber(traceCount);
+  outputPrint("\r\n");
 }
 
 /**
-* @description Process a char from the serial port on the Device. Enters the char
-*  into the stream state machine.
-* @param `buf` {StreamPacketBuffer *} - The stream packet buffer to add the char to.
-* @param `newChar` {char} - A new char to process
+* @description Called from `loop()` on the Host to write out trace records as
+*  the output has room, one line per record, see ::traceWriteRecord(). The
+*  Host's own records go first with an `H` in front, then the Device is asked
+*  for its records, which are written with a `D` in front. The first packet of
+*  the Device's starts with a header line and the last one ends with the EOT.
 * @author AJ Keller (@pushtheworldllc)
 */
-void OpenBCI_Radios_Class::bufferStreamAddChar(StreamPacketBuffer *buf, char newChar) {
-  // Process the new char
-  switch (buf->state) {
-    case STREAM_STATE_TAIL:
-    // Is the current char equal to 0xCX where X is 0-F?
-    if (isATailByte(newChar)) {
-      // Set the type byte
-      buf->typeByte = newChar;
-      // Change the state to ready
-      buf->state = STREAM_STATE_READY;
-      // Serial.print(33); Serial.print(" state: "); Serial.print("READY-");
-      // Serial.println((streamPacketBuffer + streamPacketBufferHead)->state);
-    } else {
-      // Reset the state machine
-      buf->state = STREAM_STATE_INIT;
-      // Set bytes in to 0
-      buf->bytesIn = 0;
-      // Test to see if this byte is a head byte, maybe if it's not a
-      //  tail byte then that's because a byte was dropped on the way
-      //  over from the Pic.
-      if (newChar == OPENBCI_STREAM_PACKET_HEAD) {
-        // Move the state
-        buf->state = STREAM_STATE_STORING;
-        // Store to the streamPacketBuffer
-        buf->data[0] = newChar;
-        // Set to 1
-        buf->bytesIn = 1;
+void OpenBCI_Radios_Class::traceFlush(void) {
+  char traceMsg[2] = {(char)OPENBCI_TRACE_BYTE_ID, 0};
+  while (traceSending && outputFree() >= OPENBCI_TRACE_LINE_BYTES) {
+    if (traceSendPosition >= traceSendTotal) {
+      printEOT();
+      traceSending = false;
+      tracePaused = false;
+      if (systemUp) {
+        // Ask the Device for its first packet of records
+        txQueueAdd(traceMsg,2,TX_PRIORITY_CONTROL);
       }
+      break;
     }
-    break;
-    case STREAM_STATE_STORING:
-    // Store to the stream packet buffer
-    buf->data[buf->bytesIn] = newChar;
-    // Increment the number of bytes read in
-    buf->bytesIn++;
-
-    if (buf->bytesIn == OPENBCI_MAX_PACKET_SIZE_BYTES) {
-      buf->state = STREAM_STATE_TAIL;
+    char record[OPENBCI_TRACE_RECORD_BYTES];
+    tracePackRecord(traceSendFirst + traceSendPosition, record);
+    traceWriteRecord('H', record);
+    traceSendPosition++;
+  }
+  while (!traceSending && traceDeviceTail != traceDeviceHead && outputFree() >= OPENBCI_OUTPUT_MESSAGE_MAX + OPENBCI_TRACE_RECORDS_PER_PACKET * OPENBCI_TRACE_LINE_BYTES) {
+    char *packet = traceDevicePackets[traceDeviceTail];
+    uint8_t first = (uint8_t)packet[1];
+    uint8_t total = (uint8_t)packet[2];
+    uint8_t numberOfRecords = (traceDeviceLength[traceDeviceTail] - 3) / OPENBCI_TRACE_RECORD_BYTES;
+    if (first == 0) {
+      printSuccess();
+      outputPrint("Trace device ");
+      outputPrintNumber(total);
+      outputPrint("\r\n");
     }
-
-    break;
-    // We have called the function before we were able to send the stream
-    //  packet which means this is not a stream packet, it's part of a
-    //  bigger message
-    case STREAM_STATE_READY:
-    // Got a 34th byte, go back to start
-    buf->state = STREAM_STATE_INIT;
-    // Set bytes in to 0
-    buf->bytesIn = 0;
-
-    break;
-    case STREAM_STATE_INIT:
-    if (newChar == OPENBCI_STREAM_PACKET_HEAD) {
-      // Move the state
-      buf->state = STREAM_STATE_STORING;
-      // Store to the streamPacketBuffer
-      buf->data[0] = newChar;
-      // Set to 1
-      buf->bytesIn = 1;
+    for (uint8_t i = 0; i < numberOfRecords; i++) {
+      traceWriteRecord('D', packet + 3 + i * OPENBCI_TRACE_RECORD_BYTES);
+    }
+    if (first + numberOfRecords >= total) {
+      printEOT();
+    }
+    traceDeviceTail = (traceDeviceTail + 1) % OPENBCI_TRACE_DEVICE_BUFFERS;
+    if (traceDeviceNext > 0) {
+      // There is room for the packet that was held back now
+      traceMsg[1] = (char)traceDeviceNext;
+      traceDeviceNext = 0;
+      txQueueAdd(traceMsg,2,TX_PRIORITY_CONTROL);
     }
-    break;
-    default:
-    // // Reset the state
-    buf->state = STREAM_STATE_INIT;
-    break;
-
   }
 }
 
 /**
-* @description Used to add a packet to the of steaming data to the current
-*  `streamPacketBufferHead` and then increment the head. Will wrap around if
-*  need be to avoid moving the head past `OPENBCI_NUMBER_STREAM_BUFFERS`.
-* @param `data` {char *} - The data packet you want to add of length
-*  `OPENBCI_MAX_PACKET_SIZE_BYTES` (32)
-* @returns {boolean} - `true` if able to add it. Currently this func will always
-*  return `true`, however this allows for greater flexiblity in the future.
+* @description Called on the Host with a packet of Device trace records, it's
+*  held until ::traceFlush() writes it out from `loop()`. The Device only
+*  sends a packet when asked, one is only asked for when it has somewhere to
+*  go. Dropped if `OPENBCI_TRACE_DEVICE_BUFFERS` packets are already waiting.
+* @param `data` {char *} - `OPENBCI_TRACE_BYTE_ID`, the number of the first
+*  record, the number of records in the dump and up to
+*  `OPENBCI_TRACE_RECORDS_PER_PACKET` records
+* @param `len` {int} - The length of `data`
 * @author AJ Keller (@pushtheworldllc)
 */
-boolean OpenBCI_Radios_Class::bufferStreamAddData(char *data) {
-
-  bufferStreamStoreData(streamPacketBuffer + streamPacketBufferHead, data);
-
-  streamPacketBufferHead++;
-  if (streamPacketBufferHead > (OPENBCI_NUMBER_STREAM_BUFFERS - 1)) {
-    streamPacketBufferHead = 0;
+void OpenBCI_Radios_Class::traceHostProcessDevice(char *data, int len) {
+  uint8_t next = (traceDeviceHead + 1) % OPENBCI_TRACE_DEVICE_BUFFERS;
+  if (len < 3 || next == traceDeviceTail) {
+    return;
   }
-
-  return true;
-}
-
-/**
-* @description Used to flush a StreamPacketBuffer to the serial port with a
-*  head byte and a formated tail byte based off the `typeByte`.
-* @param `buf` {StreamPacketBuffer *} - The stream packet buffer to add the char to.
-* @author AJ Keller (@pushtheworldllc)
-**/
-void OpenBCI_Radios_Class::bufferStreamFlush(StreamPacketBuffer *buf) {
-  buf->flushing = true;
-  Serial.write(0xA0);
-  for (int i = 0; i < OPENBCI_MAX_DATA_BYTES_IN_PACKET; i++) {
-    Serial.write(buf->data[i]);
+  for (int i = 0; i < len; i++) {
+    traceDevicePackets[traceDeviceHead][i] = data[i];
   }
-  Serial.write(buf->typeByte);
-  buf->flushing = false;
-}
-
-/**
-* @description Used to flush a StreamPacketBuffer if the `streamPacketBufferTail`
-*  is not equal to the `streamPacketBufferHead`. This function will also reset
-*  the buffer after the buffer is flushed. Further it will increment `streamPacketBufferTail`
-*  and wrap that around if necessary.
-* @author AJ Keller (@pushtheworldllc)
-**/
-void OpenBCI_Radios_Class::bufferStreamFlushBuffers(void) {
-  if (streamPacketBufferTail != streamPacketBufferHead) {
-    bufferStreamFlush(streamPacketBuffer + streamPacketBufferTail);
-    bufferStreamReset(streamPacketBuffer + streamPacketBufferTail);
-    streamPacketBufferTail++;
-    if (streamPacketBufferTail > (OPENBCI_NUMBER_STREAM_BUFFERS - 1)) {
-      streamPacketBufferTail = 0;
+  traceDeviceLength[traceDeviceHead] = len;
+  traceDeviceHead = next;
+  // Ask for the next packet in the ack to this one, unless it would have
+  //  nowhere to go, then ::traceFlush() asks once there is room
+  uint8_t following = (uint8_t)data[1] + (len - 3) / OPENBCI_TRACE_RECORD_BYTES;
+  if (following < (uint8_t)data[2]) {
+    if ((next + 1) % OPENBCI_TRACE_DEVICE_BUFFERS != traceDeviceTail) {
+      char traceMsg[2] = {(char)OPENBCI_TRACE_BYTE_ID, (char)following};
+      txQueueAdd(traceMsg,2,TX_PRIORITY_CONTROL);
+    } else {
+      traceDeviceNext = following;
     }
   }
 }
-
-/**
-* @description Used to determine if a stream packet buffer is ready for a new packet
-*  this function is no longer being used with the head/tail system. Will look to
-*  deprecate it soon.
-* @param `buf` {StreamPacketBuffer *} - The stream packet buffer to add the char to.
+
+/**
+* @description Call first thing in `loop()`, through `OPENBCI_TRACE_LOOP()`.
+*  Traces the last pass through `loop()` if it took longer than
+*  `OPENBCI_TRACE_LOOP_SLOW_uS`.
 * @author AJ Keller (@pushtheworldllc)
-**/
-boolean OpenBCI_Radios_Class::bufferStreamReadyForNewPacket(StreamPacketBuffer *buf) {
-  return buf->bytesIn == 0 && !buf->flushing;
+*/
+void OpenBCI_Radios_Class::traceLoop(void) {
+  unsigned long now = micros();
+  unsigned long duration = now - traceTimeLastLoop;
+  if (traceTimeLastLoop > 0 && duration > OPENBCI_TRACE_LOOP_SLOW_uS) {
+    traceAdd(OPENBCI_TRACE_EVENT_LOOP, 0, duration > 0xFFFF ? 0xFFFF : duration);
+  }
+  traceTimeLastLoop = now;
 }
 
 /**
-* @description Utility function to return `true` if the the streamPacketBuffer
-*   is in the STREAM_STATE_READY. Normally used for determining if a stream
-*   packet is ready to be sent.
-* @param `buf` {StreamPacketBuffer *} - The stream packet buffer to send to the Host.
-* @returns {boolean} - `true` is the `buf` is in the ready state, `false` otherwise.
+* @description Call from `loop()` straight after `noInterrupts()`, through
+*  `OPENBCI_TRACE_MASK_START()`, to time how long the radio callback is held
+*  off.
 * @author AJ Keller (@pushtheworldllc)
 */
-boolean OpenBCI_Radios_Class::bufferStreamReadyToSendToHost(StreamPacketBuffer *buf) {
-  return radio.streamPacketBuffer->state == radio.STREAM_STATE_READY;
+void OpenBCI_Radios_Class::traceMaskStart(void) {
+  traceTimeMasked = micros();
 }
 
 /**
-* @description Resets the stream packet buffer to default settings
+* @description Call from `loop()` just before `interrupts()`, through
+*  `OPENBCI_TRACE_MASK_END()`. Traces the window if the radio callback was held
+*  off longer than `OPENBCI_TRACE_MASKED_SLOW_uS`, a callback that came in
+*  meanwhile started that much late.
+* @param `where` {uint8_t} - An `OPENBCI_TRACE_MASKED_*`
 * @author AJ Keller (@pushtheworldllc)
 */
-void OpenBCI_Radios_Class::bufferStreamReset(void) {
-  for (int i = 0; i < OPENBCI_NUMBER_STREAM_BUFFERS; i++) {
-    bufferStreamReset(streamPacketBuffer + i);
+void OpenBCI_Radios_Class::traceMaskEnd(uint8_t where) {
+  unsigned long duration = micros() - traceTimeMasked;
+  if (duration > OPENBCI_TRACE_MASKED_SLOW_uS) {
+    traceAdd(OPENBCI_TRACE_EVENT_MASKED, where, duration > 0xFFFF ? 0xFFFF : duration);
   }
-  streamPacketBufferHead = 0;
-  streamPacketBufferTail = 0;
 }
 
 /**
-* @description Resets the stream packet buffer to default settings
-* @param `buf` {StreamPacketBuffer *} - Pointer to a stream packet buffer to reset
+* @description Copies a record out of the trace ring as
+*  `OPENBCI_TRACE_RECORD_BYTES` bytes, the time, event, arg and value with
+*  the time and value big endian.
+* @param `number` {uint32_t} - How many records were added before this one
+* @param `output` {char *} - Where the record goes
 * @author AJ Keller (@pushtheworldllc)
 */
-void OpenBCI_Radios_Class::bufferStreamReset(StreamPacketBuffer *buf) {
-  buf->flushing = false;
-  buf->bytesIn = 0;
-  buf->typeByte = 0;
-  buf->state = STREAM_STATE_INIT;
+void OpenBCI_Radios_Class::tracePackRecord(uint32_t number, char *output) {
+  TraceRecord *record = traceRing + (number & (OPENBCI_TRACE_RING_SIZE - 1));
+  output[0] = (char)(record->time >> 24);
+  output[1] = (char)(record->time >> 16);
+  output[2] = (char)(record->time >> 8);
+  output[3] = (char)record->time;
+  output[4] = (char)record->event;
+  output[5] = (char)record->arg;
+  output[6] = (char)(record->value >> 8);
+  output[7] = (char)record->value;
 }
 
 /**
-* @description Sends the contents of the `streamPacketBuffer` to the HOST,
-*  sends as stream packet with the proper byteId.
-* @returns {boolean} - `true` when the packet has been added to the TX buffer
+* @description Called from `loop()` on the Device, through
+*  `OPENBCI_TRACE_SEND()`, to send trace records to the Host after it asked
+*  for them. Sends `OPENBCI_TRACE_RECORDS_PER_PACKET` records from the one
+*  asked for behind `OPENBCI_TRACE_BYTE_ID`, the number of the first and the
+*  number in the dump, then waits for the Host to ask again. Stream packets
+*  waiting in the ring go first. The ring is held still until the last record
+*  is sent.
+* @returns {boolean} - `true` if a packet went on the TX FIFO
 * @author AJ Keller (@pushtheworldllc)
 */
-boolean OpenBCI_Radios_Class::bufferStreamSendToHost(StreamPacketBuffer *buf) {
-
-  byte packetType = byteIdMakeStreamPacketType(buf->typeByte);
-
-  char byteId = byteIdMake(true,packetType,buf->data + 1, OPENBCI_MAX_DATA_BYTES_IN_PACKET); // 31 bytes
-
-  // Add the byteId to the packet
-  buf->data[0] = byteId;
-
-  // Clean the serial buffer (because these bytes got added to it too)
-  bufferSerialReset(bufferSerial.numberOfPacketsToSend);
-
-  if (RFduinoGZLL.sendToHost((char *)buf->data, OPENBCI_MAX_PACKET_SIZE_BYTES)) {
-    // Refresh the poll timeout timer because we just polled the Host by sending
-    //  that last packet
-    pollRefresh();
-
-    // Clean the stream packet buffer
-    bufferStreamReset(buf);
-
-    return true;
+boolean OpenBCI_Radios_Class::traceSendToHost(void) {
+  if (!traceSending || streamPacketBufferHead != streamPacketBufferTail) {
+    return false;
+  }
+  char packet[OPENBCI_MAX_PACKET_SIZE_BYTES];
+  packet[0] = (char)OPENBCI_TRACE_BYTE_ID;
+  packet[1] = (char)traceSendPosition;
+  packet[2] = (char)traceSendTotal;
+  uint8_t numberOfRecords = 0;
+  while (numberOfRecords < OPENBCI_TRACE_RECORDS_PER_PACKET && traceSendPosition + numberOfRecords < traceSendTotal) {
+    tracePackRecord(traceSendFirst + traceSendPosition + numberOfRecords, packet + 3 + numberOfRecords * OPENBCI_TRACE_RECORD_BYTES);
+    numberOfRecords++;
+  }
+  if (!RFduinoGZLL.sendToHost(packet, 3 + numberOfRecords * OPENBCI_TRACE_RECORD_BYTES)) {
+    return false;
+  }
+  pollRefresh();
+  traceSending = false;
+  if (traceSendPosition + numberOfRecords >= traceSendTotal) {
+    tracePaused = false;
   }
+  return true;
+}
 
-  return false;
+/**
+* @description Traces the result of a send to the other radio, through
+*  `OPENBCI_TRACE_TX()` which wraps the call to `sendToHost` or `sendToDevice`.
+* @param `sent` {boolean} - What the send returned
+* @param `byteId` {uint8_t} - The first byte of the packet, 0 for a poll
+* @param `length` {uint8_t} - The length of the packet
+* @returns {boolean} - `sent`
+* @author AJ Keller (@pushtheworldllc)
+*/
+boolean OpenBCI_Radios_Class::traceSent(boolean sent, uint8_t byteId, uint8_t length) {
+  traceAdd(sent ? OPENBCI_TRACE_EVENT_TX_OK : OPENBCI_TRACE_EVENT_TX_FAIL, byteId, length);
+  return sent;
 }
 
 /**
-* @description Used to flush a StreamPacketBuffer to the serial port with a
-*  head byte and a formated tail byte based off the `typeByte`.
-* @param `buf` {StreamPacketBuffer *} - The stream packet buffer to add the char to.
-* @param `data` {char *} - A stream packet buffer in raw char buffer form fresh
-*   from the radio.
+* @description Stages one trace record for the driver as a line of hex, the
+*  side, time in micros, event, arg and value, e.g. `D 0001e240 03 41 0020`.
+* @param `side` {char} - `H` for the Host or `D` for the Device
+* @param `record` {char *} - A record from ::tracePackRecord()
 * @author AJ Keller (@pushtheworldllc)
-**/
-void OpenBCI_Radios_Class::bufferStreamStoreData(StreamPacketBuffer *buf, char *data) {
-  buf->bytesIn = OPENBCI_MAX_DATA_BYTES_IN_PACKET;
-  buf->typeByte = outputGetStopByteFromByteId(data[0]);
-  for (int i = 0; i < OPENBCI_MAX_DATA_BYTES_IN_PACKET; i++) {
-    buf->data[i] = data[i+1];
+*/
+void OpenBCI_Radios_Class::traceWriteRecord(char side, char *record) {
+  const char hex[] = "0123456789abcdef";
+  char line[OPENBCI_TRACE_LINE_BYTES];
+  uint8_t position = 0;
+  line[position++] = side;
+  for (int i = 0; i < OPENBCI_TRACE_RECORD_BYTES; i++) {
+    if (i == 0 || i == 4 || i == 5 || i == 6) {
+      line[position++] = ' ';
+    }
+    line[position++] = hex[(uint8_t)record[i] >> 4];
+    line[position++] = hex[(uint8_t)record[i] & 0x0F];
   }
+  line[position++] = '\n';
+  outputAdd(line, position);
 }
+#endif
 
 /**
-* @description Based off the last time the serial port was read from, determines
-*  if enough time has passed to qualify this data as a stream packet.
-* @returns {boolean} - `true` if enough time has passed, `false` if not.
+* @description Reset the time since last packent sent to HOST. Very important with polling.
 * @author AJ Keller (@pushtheworldllc)
 */
-boolean OpenBCI_Radios_Class::bufferStreamTimeout(void) {
-  return micros() > (lastTimeSerialRead + OPENBCI_TIMEOUT_PACKET_STREAM_uS);
+void OpenBCI_Radios_Class::pollRefresh(void) {
+  timeOfLastPoll = micros();
 }
 
 /**
-* @description Creates a byteId for sending data over the RFduinoGZLL
-* @param isStreamPacket [boolean] Set true if this is a streaming packet
-* @param packetNumber {uint8_t} What number packet are you trying to send?
-* @param data [char *] The data you want to send. NOTE: Do not send the address
-*           of the entire buffer, send this method address of buffer + 1
-* @param length [int] The length of the data buffer
-* @returns [char] The newly formed byteId where a byteId is defined as
-*           Bit 7 - Streaming byte packet
-*           Bits[6:3] - Packet count
-*           Bits[2:0] - The check sum
+* @description Takes a poll time as it is stored in flash, see ::getPollTime(),
+*  as the one to use from now on.
+* @param `stored` {uint32_t} - The poll time in ms, or in uS with
+*  `OPENBCI_POLL_TIME_US_FLAG` set
 * @author AJ Keller (@pushtheworldllc)
 */
-char OpenBCI_Radios_Class::byteIdMake(boolean isStreamPacket, uint8_t packetNumber, char *data, uint8_t length) {
-  // Set output initially equal to 0
-  char output = 0x00;
-
-  // Set first bit if this is a streaming packet
-  if  (isStreamPacket) output = output | 0x80;
+void OpenBCI_Radios_Class::pollTimeApply(uint32_t stored) {
+  pollTime = stored;
+  pollTimeUs = pollTimeToMicros(stored);
+}
 
-  // Set packet count bits Bits[6:3] NOTE: 0xFF is error
-  // convert int to char then shift then or
-  output = output | ((packetNumber & 0x0F) << 3);
+/**
+* @description Makes the poll time to store in flash from one in uS. A whole
+*  number of ms is kept as ms, just like the one byte poll time command.
+*  Anything else is kept in uS with `OPENBCI_POLL_TIME_US_FLAG` set, which
+*  older firmware can't read, see ::flashWritePollTime() for how it is
+*  stored so that it doesn't have to.
+* @param `us` {uint32_t} - The poll time in uS
+* @return {uint32_t} - The poll time to store
+* @author AJ Keller (@pushtheworldllc)
+*/
+uint32_t OpenBCI_Radios_Class::pollTimeFromMicros(uint32_t us) {
+  if (us % 1000 == 0) {
+    return us / 1000;
+  }
+  return us | OPENBCI_POLL_TIME_US_FLAG;
+}
 
-  return output;
+/**
+* @description Reads a poll time as it is stored in flash, see
+*  ::pollTimeFromMicros().
+* @param `stored` {uint32_t} - The poll time in ms, or in uS with
+*  `OPENBCI_POLL_TIME_US_FLAG` set
+* @return {uint32_t} - The poll time in uS
+* @author AJ Keller (@pushtheworldllc)
+*/
+uint32_t OpenBCI_Radios_Class::pollTimeToMicros(uint32_t stored) {
+  if (stored & OPENBCI_POLL_TIME_US_FLAG) {
+    return stored & ~OPENBCI_POLL_TIME_US_FLAG;
+  }
+  return stored * 1000;
 }
 
 /**
-* @description Determines if this byteId is a stream byte
-* @param byteId [char] a byteId (see ::byteIdMake for description of bits)
-* @returns [int] the check sum
+* @description Takes a byteId and converts to a Stop Byte for a streaming packet
+* @param `byteId` - [byte] - A byteId with packet type in bits 6-3
+* @return - [byte] - A stop byte with 1100 as the MSBs with packet type in the
+*          four LSBs
+* @example byteId == 0b10111000 returns 0b11000111
 * @author AJ Keller (@pushtheworldllc)
 */
-boolean OpenBCI_Radios_Class::byteIdGetIsStream(uint8_t byteId) {
-  return byteId > 0x7F;
+byte OpenBCI_Radios_Class::outputGetStopByteFromByteId(char byteId) {
+  return byteIdGetStreamPacketType(byteId) | 0xC0;
 }
 
 /**
-* @description Strips and gets the packet number from a byteId
-* @param byteId [char] a byteId (see ::byteIdMake for description of bits)
-* @returns [int] the packetNumber
+* @description Stages bytes for the driver on the Host, they are written from
+*  `loop()` by ::outputProcess(). All of `data` goes in or none of it, so a
+*  stream packet or message is never split by another writer.
+* @param `data` {const char *} - The bytes to write
+* @param `len` {uint16_t} - How many
+* @return {boolean} - `true` if staged, `false` if the output can't take all
+*  of it
 * @author AJ Keller (@pushtheworldllc)
 */
-int OpenBCI_Radios_Class::byteIdGetPacketNumber(uint8_t byteId) {
-  return (int)((byteId & 0x78) >> 3);
+boolean OpenBCI_Radios_Class::outputAdd(const char *data, uint16_t len) {
+  if (len > outputFree()) {
+    return false;
+  }
+  for (uint16_t i = 0; i < len; i++) {
+    outputBuffer[outputPositionWrite & (OPENBCI_OUTPUT_BUFFER_LENGTH - 1)] = data[i];
+    outputPositionWrite++;
+  }
+  runPostFromLoop(RUN_WORK_OUTPUT);
+  return true;
 }
 
 /**
-* @description Strips and gets the packet number from a byteId
-* @param byteId [char] a byteId (see ::byteIdMake for description of bits)
-* @returns [byte] the packet type
+* @description Runs `data` through a CRC-16/CCITT-FALSE, polynomial 0x1021,
+*  bit by bit so it needs no table. Start with 0xFFFF.
+* @param `crc` {uint16_t} - The CRC so far
+* @param `data` {const char *} - The bytes to add
+* @param `len` {uint16_t} - How many
+* @return {uint16_t} - The CRC with `data` added
 * @author AJ Keller (@pushtheworldllc)
 */
-byte OpenBCI_Radios_Class::byteIdGetStreamPacketType(uint8_t byteId) {
-  return (byte)((byteId & 0x78) >> 3);
+uint16_t OpenBCI_Radios_Class::outputCrcUpdate(uint16_t crc, const char *data, uint16_t len) {
+  for (uint16_t i = 0; i < len; i++) {
+    crc ^= (uint16_t)(uint8_t)data[i] << 8;
+    for (uint8_t bit = 0; bit < 8; bit++) {
+      crc = crc & 0x8000 ? (crc << 1) ^ 0x1021 : crc << 1;
+    }
+  }
+  return crc;
 }
 
 /**
-* @description Strips and gets the packet number from a byteId
-* @returns [byte] the packet type
+* @description Number of bytes the output can still take.
+* @return {uint16_t} - Free bytes
 * @author AJ Keller (@pushtheworldllc)
 */
-byte OpenBCI_Radios_Class::byteIdMakeStreamPacketType(uint8_t typeByte) {
-  return typeByte & 0x0F;
+uint16_t OpenBCI_Radios_Class::outputFree(void) {
+  return OPENBCI_OUTPUT_BUFFER_LENGTH - (uint16_t)(outputPositionWrite - outputPositionRead);
 }
 
 /**
-* @description Send a NULL packet to the HOST
+* @description Stages a string for the driver, see ::outputAdd().
+* @param `str` {const char *} - A null terminated string
 * @author AJ Keller (@pushtheworldllc)
 */
-void OpenBCI_Radios_Class::pollHost(void) {
-  RFduinoGZLL.sendToHost(NULL,0);
-  pollRefresh();
+void OpenBCI_Radios_Class::outputPrint(const char *str) {
+  outputAdd(str, strlen(str));
 }
 
 /**
-* @description Has enough time passed since the last poll
-* @return [boolean]
+* @description Stages a number for the driver in decimal, like `Serial.print()`.
+* @param `number` {uint32_t} - The number
 * @author AJ Keller (@pushtheworldllc)
 */
-boolean OpenBCI_Radios_Class::pollNow(void) {
-  return millis() - timeOfLastPoll > pollTime;
+void OpenBCI_Radios_Class::outputPrintNumber(uint32_t number) {
+  char digits[10];
+  uint8_t start = sizeof(digits);
+  do {
+    digits[--start] = '0' + number % 10;
+    number /= 10;
+  } while (number > 0);
+  outputAdd(digits + start, sizeof(digits) - start);
 }
 
 /**
-* @description Reset the time since last packent sent to HOST. Very important with polling.
+* @description Called every pass through `loop()` on the Host to write staged
+*  bytes to the driver. The UART is modeled from the baud rate rather than
+*  asked, a byte takes 10 bits, and only as much is written as it can take
+*  without a pass waiting more than `OPENBCI_OUTPUT_WAIT_MAX_uS` on a full
+*  UART, so a slow driver backs up the output and never blocks the radio.
 * @author AJ Keller (@pushtheworldllc)
 */
-void OpenBCI_Radios_Class::pollRefresh(void) {
-  timeOfLastPoll = millis();
+void OpenBCI_Radios_Class::outputProcess(void) {
+  unsigned long now = micros();
+  // Everything written before has already gone out
+  if ((long)(outputTimeFree - now) < 0) {
+    outputTimeFree = now;
+  }
+  while (outputPositionRead != outputPositionWrite && outputTimeFree - now < (unsigned long)OPENBCI_OUTPUT_UART_FIFO_BYTES * outputByteTimeUs + OPENBCI_OUTPUT_WAIT_MAX_uS) {
+    Serial.write(outputBuffer[outputPositionRead & (OPENBCI_OUTPUT_BUFFER_LENGTH - 1)]);
+    outputPositionRead++;
+    outputTimeFree += outputByteTimeUs;
+  }
 }
 
 /**
-* @description Takes a byteId and converts to a Stop Byte for a streaming packet
-* @param `byteId` - [byte] - A byteId with packet type in bits 6-3
-* @return - [byte] - A stop byte with 1100 as the MSBs with packet type in the
-*          four LSBs
-* @example byteId == 0b10111000 returns 0b11000111
+* @description Sets how long ::outputProcess() takes a byte to be on the wire.
+*  Call it whenever `Serial` is opened at a new baud rate.
+* @param `baudRate` {uint32_t} - The baud rate of `Serial`
 * @author AJ Keller (@pushtheworldllc)
 */
-byte OpenBCI_Radios_Class::outputGetStopByteFromByteId(char byteId) {
-  return byteIdGetStreamPacketType(byteId) | 0xC0;
+void OpenBCI_Radios_Class::outputSetBaudRate(uint32_t baudRate) {
+  outputByteTimeUs = (10000000UL + baudRate - 1) / baudRate;
 }
 
 OpenBCI_Radios_Class radio;
@@ -1792,18 +5106,23 @@ OpenBCI_Radios_Class radio;
 * @return {boolean} - True if a packet should be sent from the serial buffer
 * @author AJ Keller (@pushtheworldllc)
 */
-boolean OpenBCI_Radios_Class::processRadioCharHost(device_t device, char newChar) {
+boolean OpenBCI_Radios_Class::processRadioCharHost(char newChar) {
 
   switch (newChar) {
     case ORPM_PACKET_PAGE_REJECT:
+    OPENBCI_TRACE(OPENBCI_TRACE_EVENT_PAGE_REJECT, 0, 0);
     // Start the page transmission over again
     bufferSerial.numberOfPacketsSent = 0;
-    // Wait a little bit to let the Device finish
-    delay(10);
+    // Send any queued commands from the last ack again too
+    txQueueRetry();
+    // Give the Device a little bit to finish, the page is resent on the
+    //  first poll after the timer runs out
+    timerStart(TIMER_EVENT_PAGE_RETRY, OPENBCI_TIMEOUT_PAGE_RETRY_uS);
 
-    return true;
+    return false;
 
     case ORPM_PACKET_MISSED:
+    OPENBCI_TRACE(OPENBCI_TRACE_EVENT_PAGE_MISSED, 0, 0);
     // Start the page transmission over again
     bufferSerial.numberOfPacketsSent = 0;
 
@@ -1811,48 +5130,56 @@ boolean OpenBCI_Radios_Class::processRadioCharHost(device_t device, char newChar
 
     case ORPM_CHANGE_CHANNEL_DEVICE_READY:
     // We are the Host, and the device is ready to change it's channel number to what every we want
-    if (setChannelNumber(radioChannel)) { // Returns true if successful
+    //  the flash write is deferred to loop() so the ack goes out right away
+    if (flashCommitAdd(OPENBCI_FLASH_COMMIT_CHANNEL, radioChannel)) { // Returns true if queued
       // send back the radio channel
       singleCharMsg[0] = (char)radioChannel;
       isWaitingForNewChannelNumberConfirmation = true;
       channelNumberSaveAttempted = false;
-      RFduinoGZLL.sendToDevice(device,singleCharMsg,1);
-      packetInTXRadioBuffer = true;
+      txQueueAdd(singleCharMsg,1,TX_PRIORITY_CONTROL);
 
     } else {
       // Tell device to switch to the previous channel number
       radioChannel = getChannelNumber();
       singleCharMsg[0] = (char)radioChannel;
-      RFduinoGZLL.sendToDevice(device,singleCharMsg,1);
-      packetInTXRadioBuffer = true;
+      txQueueAdd(singleCharMsg,1,TX_PRIORITY_CONTROL);
     }
     return false;
 
     case ORPM_CHANGE_POLL_TIME_DEVICE_READY:
     // Get the poll time from memory... should have been stored here before
     singleCharMsg[0] = (char)pollTime;
-    setPollTime(pollTime);
-    RFduinoGZLL.sendToDevice(device,singleCharMsg,1);
-    packetInTXRadioBuffer = true;
+    flashCommitAdd(OPENBCI_FLASH_COMMIT_POLL_TIME, pollTime);
+    txQueueAdd(singleCharMsg,1,TX_PRIORITY_CONTROL);
     isWaitingForNewPollTimeConfirmation = true;
     return false;
 
     case ORPM_DEVICE_SERIAL_OVERFLOW:
-    Serial.print("Failure: Board RFduino buffer overflowed. Soft reset command sent to Board.$$$");
+    // Written from loop() so it can't land in the middle of a stream packet
+    msgToPrint = HOST_MESSAGE_BOARD_OVERFLOW;
+    printMessageToDriverFlag = true;
     // TODO : Decide if this is a good idea
     // singleCharMsg[0] = 'v';
     // RFduinoGZLL.sendToDevice(device,singleCharMsg,1);
     packetInTXRadioBuffer = true;
     return false;
 
+    case ORPM_UPLOAD_READY:
+    // The Device is ready for upload packets, everything from the PC goes
+    //  into the upload buffer from now on
+    uploadReset();
+    uploadActive = true;
+    msgToPrint = HOST_MESSAGE_UPLOAD_START;
+    printMessageToDriverFlag = true;
+    return false;
+
     case ORPM_INVALID_CODE_RECEIVED:
     // Working theory
     return false;
 
     default:
     singleCharMsg[0] = (char)ORPM_INVALID_CODE_RECEIVED;
-    RFduinoGZLL.sendToDevice(device,singleCharMsg,1);
-    packetInTXRadioBuffer = true;
+    txQueueAdd(singleCharMsg,1,TX_PRIORITY_CONTROL);
     return false;
   }
 
@@ -1870,17 +5197,16 @@ boolean OpenBCI_Radios_Class::processRadioCharDevice(char newChar) {
     isWaitingForNewChannelNumber = false;
     // Refresh poll
     pollRefresh();
-    // Set the new channel number
-    boolean success = setChannelNumber((uint32_t)newChar);
+    // Look here again if the Host never makes it to the new channel
+    previousRadioChannel = getChannelNumber();
+    // Queue the new channel number, it's written to flash from loop()
+    boolean success = flashCommitAdd(OPENBCI_FLASH_COMMIT_CHANNEL, (uint32_t)newChar);
     if (success) {
       // Poll the host, which will swap after this...
       pollHost();
-      delay(30);
-      // Change Device radio channel
-      RFduinoGZLL.end();
-      RFduinoGZLL.channel = (uint32_t)newChar;
-      RFduinoGZLL.begin(RFDUINOGZLL_ROLE_DEVICE);
-
+      // Change Device radio channel from loop() after the Host swapped
+      timerChannelNumber = (uint32_t)newChar;
+      timerStart(TIMER_EVENT_CHANNEL_CHANGE, OPENBCI_TIMEOUT_CHANNEL_CHANGE_uS);
     }
     return false;
 
@@ -1888,11 +5214,11 @@ boolean OpenBCI_Radios_Class::processRadioCharDevice(char newChar) {
     isWaitingForNewPollTime = false;
     // Refresh poll
     pollRefresh();
-    // Set the new poll time
-    boolean success = setPollTime((uint32_t)newChar);
+    // Queue the new poll time, it's written to flash from loop()
+    boolean success = flashCommitAdd(OPENBCI_FLASH_COMMIT_POLL_TIME, (uint32_t)newChar);
     if (success) {
       // Change Device poll time
-      pollTime = getPollTime();
+      pollTimeApply(getPollTime());
       // Poll the host
       pollHost();
     }
@@ -1901,14 +5227,17 @@ boolean OpenBCI_Radios_Class::processRadioCharDevice(char newChar) {
   } else {
     switch (newChar) {
       case ORPM_PACKET_PAGE_REJECT:
+      OPENBCI_TRACE(OPENBCI_TRACE_EVENT_PAGE_REJECT, 0, 0);
       // Start the page transmission over again
       bufferSerial.numberOfPacketsSent = 0;
-      // Wait a little bit to let the Host finish
-      delay(10);
+      // Give the Host a little bit to finish, loop() resends the page when
+      //  the timer runs out
+      timerStart(TIMER_EVENT_PAGE_RETRY, OPENBCI_TIMEOUT_PAGE_RETRY_uS);
 
-      return true;
+      return false;
 
       case ORPM_PACKET_MISSED:
+      OPENBCI_TRACE(OPENBCI_TRACE_EVENT_PAGE_MISSED, 0, 0);
       // Start the page transmission over again
       bufferSerial.numberOfPacketsSent = 0;
       return true;
@@ -1948,13 +5277,29 @@ boolean OpenBCI_Radios_Class::processRadioCharDevice(char newChar) {
       bufferSerialAddChar(' ');
       bufferSerialAddChar('0');
       bufferSerialAddChar('x');
-      bufferSerialAddChar((char)getPollTime());
+      // A poll time in uS goes back rounded up to whole ms
+      bufferSerialAddChar((char)((pollTimeToMicros(getPollTime()) + 999) / 1000));
       bufferSerialAddChar('$');
       bufferSerialAddChar('$');
       bufferSerialAddChar('$');
       pollRefresh();
       return true;
 
+      case ORPM_UPLOAD_START:
+      // Everything the Host sends is written straight to the Pic from now on
+      uploadReset();
+      uploadActive = true;
+      // The Pic restarts into its bootloader, nothing is left paused
+      flowPaused = false;
+      singleCharMsg[0] = (char)ORPM_UPLOAD_READY;
+      RFduinoGZLL.sendToHost(singleCharMsg,1);
+      pollRefresh();
+      return false;
+
+      case ORPM_UPLOAD_END:
+      uploadActive = false;
+      return false;
+
       case ORPM_INVALID_CODE_RECEIVED:
       // Working theory
       return false;
@@ -1976,7 +5321,7 @@ boolean OpenBCI_Radios_Class::processRadioCharDevice(char newChar) {
 * @author AJ Keller (@pushtheworldllc)
 */
 boolean OpenBCI_Radios_Class::packetToSend(void) {
-  return packetsInSerialBuffer() && serialWriteTimeOut();
+  return packetsInSerialBuffer() && serialWriteTimeOut() && !timerPending(TIMER_EVENT_PAGE_RETRY);
 }
 
 /**
@@ -1995,6 +5340,14 @@ boolean OpenBCI_Radios_Class::packetsInSerialBuffer(void) {
 * @author AJ Keller (@pushtheworldllc)
 */
 boolean OpenBCI_Radios_Class::serialWriteTimeOut(void) {
+  // A framed page is done the moment its last byte is in
+  if (serialFrameComplete) {
+    return true;
+  }
+  // Never split a framed page because the PC paused mid-write
+  if (serialFrameState != FRAME_STATE_IDLE) {
+    return false;
+  }
   return micros() > (lastTimeSerialRead + OPENBCI_TIMEOUT_PACKET_NRML_uS);
 }
 
@@ -2014,9 +5367,22 @@ boolean OpenBCI_Radios_Class::processDeviceRadioCharData(char *data, int len) {
   // The packetNumber is embedded in the first byte, the byteId
   int packetNumber = byteIdGetPacketNumber(data[0]);
 
+  if (uploadActive && data[0] == (char)OPENBCI_UPLOAD_BYTE_ID) {
+    uploadDeviceProcessPacket(data, len);
+    return false;
+  }
+
+  if (data[0] == (char)OPENBCI_TX_QUEUE_BYTE_ID || data[0] == (char)OPENBCI_COMMAND_FAST_BYTE_ID) {
+    return processDeviceRadioCharQueue(data,len);
+  }
+
+  if (processDeviceRadioCharStreamControl(data,len)) {
+    return packetToSend();
+  }
+
   if (byteIdGetIsStream(data[0])) {
-    // Send any stream packet that comes back, back!
-    // RFduinoGZLL.sendToHost((const char*)data,len);
+    // Stimulus or trigger data from the driver, written to the Pic from loop()
+    bufferStreamDownAddData(data,len);
     // Check to see if there is a packet to send back
     return packetToSend();
   }
@@ -2026,6 +5392,7 @@ boolean OpenBCI_Radios_Class::processDeviceRadioCharData(char *data, int len) {
     case OPENBCI_PROCESS_RADIO_FAIL_SWITCH_NOT_LAST:
     singleCharMsg[0] = (char)ORPM_PACKET_PAGE_REJECT;
     RFduinoGZLL.sendToHost(singleCharMsg,1);
+    OPENBCI_TRACE(OPENBCI_TRACE_EVENT_PAGE_REJECT, 1, 0);
     return false;
 
     case OPENBCI_PROCESS_RADIO_FAIL_MISSED_LAST:
@@ -2033,6 +5400,7 @@ boolean OpenBCI_Radios_Class::processDeviceRadioCharData(char *data, int len) {
     // Not able to process the packet
     singleCharMsg[0] = (char)ORPM_PACKET_MISSED;
     RFduinoGZLL.sendToHost(singleCharMsg,1);
+    OPENBCI_TRACE(OPENBCI_TRACE_EVENT_PAGE_MISSED, 1, 0);
     bufferRadioReset(currentRadioBuffer);
     return false;
 
@@ -2051,6 +5419,171 @@ boolean OpenBCI_Radios_Class::processDeviceRadioCharData(char *data, int len) {
   }
 }
 
+/**
+* @description Entered from `processDeviceRadioCharData` with a stream control
+*  message from the Host. A NACK marks each sample number still in the history
+*  to be resent from `loop()`. A parity message sets how many stream packets
+*  go in each parity group. A decimation message sets how many stream packets
+*  are averaged into one, see ::bufferStreamDecimate(). A low power message
+*  sets how long stream packets are held for a burst, see
+*  ::bufferStreamBurstReady(), or asks for a report. A link state message
+*  brings the Device into the Host's link state, see ::linkStateSync(). A poll
+*  time message sets the time between polls, see ::pollInterval(). A stream
+*  down message says if stream packets go to the Pic, see
+*  ::flowControlProcess(). A trace
+*  message sends the Host a packet of trace records, the first one asks for the
+*  ring to be held, see ::traceSendToHost().
+* @param `data` {char *} - `OPENBCI_STREAM_NACK_BYTE_ID` and sample numbers,
+*  `OPENBCI_STREAM_PARITY_BYTE_ID` and the group size,
+*  `OPENBCI_STREAM_DECIMATE_BYTE_ID` and N, `OPENBCI_LOW_POWER_BYTE_ID` and the
+*  burst wait or `OPENBCI_LOW_POWER_REPORT`, `OPENBCI_LINK_STATE_BYTE_ID` and
+*  the Host's link state, `OPENBCI_POLL_TIME_BYTE_ID` and the poll time in uS,
+*  `OPENBCI_STREAM_DOWN_BYTE_ID` and 1 or 0, or `OPENBCI_TRACE_BYTE_ID` and the
+*  number of the first record
+* @param `len` {int} - The length of `data`
+* @return {boolean} - `true` if `data` was a stream control message, see
+*  ::byteIdGetIsStreamControl()
+* @author AJ Keller (@pushtheworldllc)
+*/
+boolean OpenBCI_Radios_Class::processDeviceRadioCharStreamControl(char *data, int len) {
+  // The same check keeps these out of the radio buffer, see processDeviceRadioCharQueue()
+  if (!byteIdGetIsStreamControl((uint8_t)data[0])) {
+    return false;
+  }
+  switch (data[0]) {
+    case (char)OPENBCI_STREAM_NACK_BYTE_ID:
+    for (int i = 1; i < len; i++) {
+      uint8_t slot = (uint8_t)data[i] % OPENBCI_NUMBER_STREAM_HISTORY;
+      // Already written over by a newer packet?
+      if (streamHistory[slot][1] == data[i]) {
+        streamHistoryResend[slot] = true;
+      }
+    }
+    return true;
+    case (char)OPENBCI_STREAM_PARITY_BYTE_ID:
+    if ((uint8_t)data[1] <= OPENBCI_STREAM_PARITY_GROUP_MAX) {
+      streamParityGroup = (uint8_t)data[1];
+      bufferStreamParityReset();
+    }
+    return true;
+    case (char)OPENBCI_STREAM_DECIMATE_BYTE_ID:
+    if ((uint8_t)data[1] <= OPENBCI_STREAM_DECIMATE_MAX) {
+      streamDecimate = (uint8_t)data[1];
+      bufferStreamDecimateReset();
+    }
+    return true;
+    case (char)OPENBCI_LOW_POWER_BYTE_ID:
+    if ((uint8_t)data[1] == OPENBCI_LOW_POWER_REPORT) {
+      lowPowerReportPending = true;
+    } else if ((uint8_t)data[1] <= OPENBCI_LOW_POWER_WAIT_MAX_MS) {
+      lowPowerWaitMs = (uint8_t)data[1];
+      lowPowerReset();
+    }
+    return true;
+    case (char)OPENBCI_LINK_STATE_BYTE_ID:
+    if (len >= OPENBCI_LINK_STATE_BYTES) {
+      linkStateApply((uint32_t)(uint8_t)data[1] | ((uint32_t)(uint8_t)data[2] << 8) | ((uint32_t)(uint8_t)data[3] << 16) | ((uint32_t)(uint8_t)data[4] << 24));
+    }
+    return true;
+    case (char)OPENBCI_POLL_TIME_BYTE_ID:
+    if (len >= OPENBCI_POLL_TIME_BYTES) {
+      uint32_t us = (uint32_t)(uint8_t)data[1] | ((uint32_t)(uint8_t)data[2] << 8) | ((uint32_t)(uint8_t)data[3] << 16) | ((uint32_t)(uint8_t)data[4] << 24);
+      // Written to flash from loop(), like the one byte poll time
+      if (us >= OPENBCI_POLL_TIME_MIN_uS && us <= OPENBCI_POLL_TIME_MAX_uS && flashCommitAdd(OPENBCI_FLASH_COMMIT_POLL_TIME, pollTimeFromMicros(us))) {
+        pollTimeApply(getPollTime());
+      }
+    }
+    return true;
+    case (char)OPENBCI_STREAM_DOWN_BYTE_ID:
+    streamDownEnabled = data[1] != 0;
+    return true;
+    case (char)OPENBCI_TRACE_BYTE_ID:
+#if OPENBCI_TRACE_ENABLED
+    if (data[1] == 0) {
+      // Hold the ring still until it has all gone out
+      tracePaused = true;
+      traceSendTotal = traceCount < OPENBCI_TRACE_RING_SIZE ? traceCount : OPENBCI_TRACE_RING_SIZE;
+      traceSendFirst = traceCount - traceSendTotal;
+    }
+    traceSendPosition = (uint8_t)data[1];
+    traceSending = true;
+#endif
+    return true;
+    default:
+    return false;
+  }
+}
+
+/**
+* @description Entered from `processDeviceRadioCharData` for a packet from the
+*  Host TX queue, either a lone fast command or several messages packed as
+*  `[length][bytes]` behind `OPENBCI_TX_QUEUE_BYTE_ID`. Single char radio
+*  messages are handled right away. Commands for the Pic, pages and fast
+*  commands, all go in the radio buffer together so they reach the Pic in
+*  order, or are all rejected for the Host to send again.
+* @param `data` {char *} - The packet from the Host.
+* @param `len` {int} - The length of `data`
+* @returns {boolean} - `true` if there is a packet to send to the Host.
+* @author AJ Keller (@pushtheworldllc)
+*/
+boolean OpenBCI_Radios_Class::processDeviceRadioCharQueue(char *data, int len) {
+  // A lone fast command has the same layout as a packed one minus the length
+  int numberOfBytes = 0;
+  int position;
+  if (data[0] == (char)OPENBCI_COMMAND_FAST_BYTE_ID) {
+    numberOfBytes = len - 1;
+  } else {
+    position = 1;
+    while (position < len) {
+      int length = (uint8_t)data[position];
+      position++;
+      if (length == 0 || position + length > len) {
+        break;
+      }
+      if (length == 1) {
+        processRadioCharDevice(data[position]);
+      } else if (!processDeviceRadioCharStreamControl(data+position,length)) {
+        numberOfBytes += length - 1;
+      }
+      position += length;
+    }
+  }
+
+  if (numberOfBytes > 0) {
+    if (!bufferRadioReadyForNewPage(currentRadioBuffer)) {
+      singleCharMsg[0] = (char)ORPM_PACKET_PAGE_REJECT;
+      RFduinoGZLL.sendToHost(singleCharMsg,1);
+      OPENBCI_TRACE(OPENBCI_TRACE_EVENT_PAGE_REJECT, 1, 0);
+      return false;
+    }
+    if (data[0] == (char)OPENBCI_COMMAND_FAST_BYTE_ID) {
+      bufferRadioAddData(currentRadioBuffer,data+1,len-1,true);
+    } else {
+      position = 1;
+      while (position < len) {
+        int length = (uint8_t)data[position];
+        position++;
+        if (length == 0 || position + length > len) {
+          break;
+        }
+        if (length > 1 && !byteIdGetIsStreamControl((uint8_t)data[position])) {
+          // Skip the byteId, the Pic only gets the bytes behind it
+          bufferRadioAddData(currentRadioBuffer,data+position+1,length-1,false);
+        }
+        position += length;
+      }
+      currentRadioBuffer->gotAllPackets = true;
+      runPost(RUN_WORK_PAGE);
+    }
+  }
+
+  if (packetToSend()) {
+    return true;
+  }
+  pollHost();
+  return false;
+}
+
 /**
 * @description Entered from RFduinoGZLL_onReceive if the Host receives a
 *  packet of length greater than 1.
@@ -2062,11 +5595,28 @@ boolean OpenBCI_Radios_Class::processDeviceRadioCharData(char *data, int len) {
 */
 boolean OpenBCI_Radios_Class::processHostRadioCharData(device_t device, char *data, int len) {
 
+  if (uploadActive && (data[0] == (char)OPENBCI_UPLOAD_BYTE_ID || data[0] == (char)OPENBCI_UPLOAD_BYTE_ID_NACK)) {
+    uploadHostProcessStatus(data, len);
+    // Fill the TX FIFO so the next polls carry upload packets back
+    uploadHostSendToDevice(device);
+    return false;
+  }
+
+#if OPENBCI_TRACE_ENABLED
+  if (data[0] == (char)OPENBCI_TRACE_BYTE_ID) {
+    traceHostProcessDevice(data, len);
+    return hostPacketToSend();
+  }
+#endif
+
   if (byteIdGetIsStream(data[0])) {
-    // We don't actually read to serial port yet, we simply move it
-    //  into a buffer in an effort to not write to the Serial port
-    //  from an ISR.
-    bufferStreamAddData(data);
+    // Fast commands are only sent while streaming
+    lastTimeHostHeardStream = millis();
+  }
+
+  // Keep the callback short, stream packets are only copied here and go in
+  //  the stream ring from loop(), see ::rxQueueProcess()
+  if (rxQueueCanWait(data[0]) && rxQueueAdd(data, len)) {
     // Check to see if there is a packet to send back
     return hostPacketToSend();
   }
@@ -2075,14 +5625,16 @@ boolean OpenBCI_Radios_Class::processHostRadioCharData(device_t device, char *da
     case OPENBCI_PROCESS_RADIO_FAIL_SWITCH_LAST:
     case OPENBCI_PROCESS_RADIO_FAIL_SWITCH_NOT_LAST:
     singleCharMsg[0] = (char)ORPM_PACKET_PAGE_REJECT;
-    RFduinoGZLL.sendToDevice(device,singleCharMsg,1);
+    txQueueAdd(singleCharMsg,1,TX_PRIORITY_CONTROL);
+    OPENBCI_TRACE(OPENBCI_TRACE_EVENT_PAGE_REJECT, 1, 0);
     return false;
 
     case OPENBCI_PROCESS_RADIO_FAIL_MISSED_LAST:
     case OPENBCI_PROCESS_RADIO_FAIL_MISSED_NOT_LAST:
     // Not able to process the packet
     singleCharMsg[0] = (char)ORPM_PACKET_MISSED;
-    RFduinoGZLL.sendToDevice(device,singleCharMsg,1);
+    txQueueAdd(singleCharMsg,1,TX_PRIORITY_CONTROL);
+    OPENBCI_TRACE(OPENBCI_TRACE_EVENT_PAGE_MISSED, 1, 0);
     bufferRadioReset(currentRadioBuffer);
     return false;
 
@@ -2098,5 +5650,5 @@ boolean OpenBCI_Radios_Class::processHostRadioCharData(device_t device, char *da
     bufferSerialReset(bufferSerial.numberOfPacketsSent);
     return false;
   }
-
+  return false;
 }
@@ -32,7 +32,8 @@ public:
         STREAM_STATE_INIT,
         STREAM_STATE_STORING,
         STREAM_STATE_TAIL,
-        STREAM_STATE_READY
+        STREAM_STATE_READY,
+        STREAM_STATE_MISSING
     };
     typedef enum HOST_MESSAGE {
         HOST_MESSAGE_SERIAL_ACK,
@@ -49,7 +50,56 @@ public:
         HOST_MESSAGE_CHAN_VERIFY,
         HOST_MESSAGE_CHAN_GET_FAILURE,
         HOST_MESSAGE_CHAN_GET_SUCCESS,
-        HOST_MESSAGE_POLL_TIME
+        HOST_MESSAGE_POLL_TIME,
+        HOST_MESSAGE_FLASH_FAILURE,
+        HOST_MESSAGE_UPLOAD_START,
+        HOST_MESSAGE_FRAMING_ON,
+        HOST_MESSAGE_FRAMING_OFF,
+        HOST_MESSAGE_STREAM_DOWN_ON,
+        HOST_MESSAGE_STREAM_DOWN_OFF,
+        HOST_MESSAGE_PARITY,
+        HOST_MESSAGE_PARITY_VERIFY,
+        HOST_MESSAGE_TRACE,
+        HOST_MESSAGE_BOARD_OVERFLOW,
+        HOST_MESSAGE_BATCH_ON,
+        HOST_MESSAGE_BATCH_OFF,
+        HOST_MESSAGE_DECIMATE,
+        HOST_MESSAGE_DECIMATE_VERIFY,
+        HOST_MESSAGE_LOW_POWER,
+        HOST_MESSAGE_LOW_POWER_VERIFY,
+        HOST_MESSAGE_LOW_POWER_REPORT,
+        HOST_MESSAGE_POLL_TIME_US,
+        HOST_MESSAGE_POLL_TIME_VERIFY,
+        HOST_MESSAGE_TX_QUEUE_FULL
+    };
+    typedef enum FRAME_STATE {
+        FRAME_STATE_IDLE,
+        FRAME_STATE_LENGTH_LOW,
+        FRAME_STATE_LENGTH_HIGH,
+        FRAME_STATE_PAYLOAD,
+        FRAME_STATE_STREAM
+    };
+    typedef enum TX_PRIORITY {
+        TX_PRIORITY_STREAM,
+        TX_PRIORITY_CONTROL,
+        TX_PRIORITY_COMMAND,
+        TX_PRIORITY_COUNT
+    };
+    typedef enum TIMER_EVENT {
+        TIMER_EVENT_PAGE_RETRY,
+        TIMER_EVENT_CHANNEL_CHANGE,
+        TIMER_EVENT_BAUD_CHANGE,
+        TIMER_EVENT_STREAM_GAP,
+        TIMER_EVENT_COUNT
+    };
+    typedef enum RUN_WORK {
+        RUN_WORK_RX = 0x01,
+        RUN_WORK_STREAM = 0x02,
+        RUN_WORK_OUTPUT = 0x04,
+        RUN_WORK_PAGE = 0x08,
+        RUN_WORK_FLASH = 0x10,
+        RUN_WORK_TIMER = 0x20,
+        RUN_WORK_ALL = 0x3F
     };
     // STRUCTS
     typedef struct {
@@ -81,6 +131,38 @@ public:
         uint8_t previousPacketNumber;
     } BufferRadio;
 
+    typedef struct {
+        uint8_t  key;
+        uint32_t value;
+    } FlashCommit;
+
+    typedef struct {
+        uint8_t priority;
+        uint8_t length;
+        boolean sent;
+        char    data[OPENBCI_MAX_PACKET_SIZE_BYTES];
+    } TxQueueEntry;
+
+    typedef struct {
+        uint8_t length;
+        char    data[OPENBCI_MAX_PACKET_SIZE_BYTES];
+    } RxDescriptor;
+
+    typedef byte (OpenBCI_Radios_Class::*HostCommandHandler)(char *);
+
+    typedef struct {
+        uint8_t             payloadLength;
+        boolean             needsLink;
+        HostCommandHandler  handler;
+    } HostCommand;
+
+    typedef struct {
+        uint32_t time;
+        uint8_t  event;
+        uint8_t  arg;
+        uint16_t value;
+    } TraceRecord;
+
 // SHARED
     OpenBCI_Radios_Class();
     void        begin(uint8_t);
@@ -105,26 +187,46 @@ public:
     boolean     bufferRadioSwitchToOtherBuffer(void);
     void        bufferResetStreamPacketBuffer(void);
     boolean     bufferSerialAddChar(char);
+    boolean     bufferSerialAddFramedChar(char);
+    void        bufferSerialFrameDispatch(void);
+    boolean     bufferSerialFrameTimeout(void);
     boolean     bufferSerialHasData(void);
     void        bufferSerialProcessCommsFailure(void);
     void        bufferSerialReset(uint8_t);
     boolean     bufferSerialTimeout(void);
     void        bufferStreamAddChar(StreamPacketBuffer *, char);
     boolean     bufferStreamAddData(char *);
+    boolean     bufferStreamBurstReady(void);
+    boolean     bufferStreamDecimate(StreamPacketBuffer *);
+    void        bufferStreamDecimateReset(void);
+    boolean     bufferStreamDownAddChar(char);
+    boolean     bufferStreamDownAddData(char *, int);
+    void        bufferStreamDownFlush(void);
+    boolean     bufferStreamFillMissing(char *);
     void        bufferStreamFlush(StreamPacketBuffer *);
+    void        bufferStreamFlushBatch(void);
     void        bufferStreamFlushBuffers(void);
+    void        bufferStreamParityAdd(char *);
+    void        bufferStreamParityBoundary(uint8_t, boolean);
+    boolean     bufferStreamParityCheck(char *);
+    void        bufferStreamParityReset(void);
+    boolean     bufferStreamParitySendToHost(void);
     boolean     bufferStreamReadyForNewPacket(StreamPacketBuffer *);
     boolean     bufferStreamReadyToSendToHost(StreamPacketBuffer *buf);
     void        bufferStreamReset(void);
     void        bufferStreamReset(StreamPacketBuffer *);
+    boolean     bufferStreamResendToHost(void);
+    void        bufferStreamSkipMissing(void);
     boolean     bufferStreamSendToHost(StreamPacketBuffer *buf);
     void        bufferStreamStoreData(StreamPacketBuffer *, char *);
     boolean     bufferStreamTimeout(void);
     boolean     byteIdGetIsStream(uint8_t);
+    boolean     byteIdGetIsStreamControl(uint8_t);
     int         byteIdGetPacketNumber(uint8_t);
     byte        byteIdGetStreamPacketType(uint8_t);
     char        byteIdMake(boolean, uint8_t, char *, uint8_t);
     byte        byteIdMakeStreamPacketType(uint8_t);
+    boolean     commandFastAdd(char);
     boolean     commsFailureTimeout(void);
     void        configure(uint8_t,uint32_t);
     void        configureDevice(void);
@@ -132,22 +234,78 @@ public:
     void        configurePassThru(void);
     boolean     didPCSendDataToHost(void);
     boolean     didPicSendDeviceSerialData(void);
+    boolean     flashCommitAdd(uint8_t, uint32_t);
+    void        flashCommitConfirm(uint8_t);
+    boolean     flashCommitGetPending(uint8_t, uint32_t *);
+    boolean     flashCommitHasPending(void);
+    boolean     flashCommitProcess(void);
+    boolean     flashCommitRadioQuiet(void);
     boolean     flashNonVolatileMemory(void);
+    boolean     flashWriteConfig(uint32_t, uint32_t, uint32_t);
+    boolean     flashWritePollTime(uint32_t);
+    void        flowControlProcess(void);
     uint32_t    getChannelNumber(void);
+    uint32_t    getLinkState(void);
     uint32_t    getPollTime(void);
     boolean     hasStreamPacket(void);
+    byte        hostCommandBatch(char *);
+    byte        hostCommandBaud(char *);
+    byte        hostCommandChannelGet(char *);
+    byte        hostCommandChannelSet(char *);
+    byte        hostCommandChannelSetOverride(char *);
+    byte        hostCommandDecimateSet(char *);
+    byte        hostCommandDispatch(char *, uint8_t);
+    byte        hostCommandFraming(char *);
+    byte        hostCommandLowPowerReport(char *);
+    byte        hostCommandLowPowerSet(char *);
+    byte        hostCommandParityGet(char *);
+    byte        hostCommandParitySet(char *);
+    uint32_t    hostCommandPayload(char *, uint8_t);
+    byte        hostCommandPollTimeGet(char *);
+    byte        hostCommandPollTimeGetUs(char *);
+    byte        hostCommandPollTimeSet(char *);
+    byte        hostCommandPollTimeSetUs(char *);
+    byte        hostCommandStreamDown(char *);
+    byte        hostCommandSysUp(char *);
+    byte        hostCommandTraceDump(char *);
+    byte        hostCommandUploadStart(char *);
     boolean     hostPacketToSend(void);
     boolean     isATailByte(uint8_t);
     void        ledFeedBackForPassThru(void);
+    void        linkAck(void);
+    unsigned long linkHostQuietMs(boolean);
+    void        linkProcess(void);
+    void        linkSent(void);
+    void        linkSetChannel(uint32_t);
+    void        linkStateApply(uint32_t);
+    uint32_t    linkStateMake(void);
+    boolean     linkStateSave(void);
+    void        linkStateSync(void);
+    void        lowPowerAck(int);
+    void        lowPowerHostProcessDevice(char *, int);
+    uint32_t    lowPowerPollTime(void);
+    boolean     lowPowerReportSendToHost(void);
+    void        lowPowerReset(void);
     // void        moveStreamPacketToTempBuffer(volatile char *data);
     boolean     needToSetChannelNumber(void);
     boolean     needToSetPollTime(void);
+    boolean     outputAdd(const char *, uint16_t);
+    uint16_t    outputCrcUpdate(uint16_t, const char *, uint16_t);
+    uint16_t    outputFree(void);
     byte        outputGetStopByteFromByteId(char);
+    void        outputPrint(const char *);
+    void        outputPrintNumber(uint32_t);
+    void        outputProcess(void);
+    void        outputSetBaudRate(uint32_t);
     void        pollHost(void);
+    unsigned long pollInterval(void);
     boolean     pollNow(void);
     boolean     packetToSend(void);
     boolean     packetsInSerialBuffer(void);
     void        pollRefresh(void);
+    void        pollTimeApply(uint32_t);
+    uint32_t    pollTimeFromMicros(uint32_t);
+    uint32_t    pollTimeToMicros(uint32_t);
     void        pushRadioBuffer(void);
     void        printBaudRateChangeTo(int);
     void        printChannelNumber(char);
@@ -161,16 +319,28 @@ public:
     void        printValidatedCommsTimeout(void);
     void        processCommsFailureSinglePacket(void);
     boolean     processDeviceRadioCharData(char *, int);
+    boolean     processDeviceRadioCharQueue(char *, int);
+    boolean     processDeviceRadioCharStreamControl(char *, int);
     boolean     processHostRadioCharData(device_t, char *, int);
     byte        processOutboundBuffer(PacketBuffer *);
     byte        processOutboundBufferCharDouble(char *);
     byte        processOutboundBufferCharTriple(char *);
     boolean     processOutboundBufferForTimeSync(void);
     boolean     processRadioCharDevice(char);
-    boolean     processRadioCharHost(device_t, char);
+    boolean     processRadioCharHost(char);
     void        resetPic32(void);
     boolean     revertToDefaultPollTime(void);
     void        revertToPreviousChannelNumber(void);
+    void        run(void);
+    void        runDevice(void);
+    void        runHost(void);
+    void        runPost(uint8_t);
+    void        runPostFromLoop(uint8_t);
+    boolean     runTake(uint8_t);
+    boolean     rxQueueAdd(char *, int);
+    boolean     rxQueueCanWait(char);
+    boolean     rxQueueProcess(void);
+    void        rxQueueProcessPacket(char *, int);
     void        sendPacketToDevice(volatile device_t, boolean);
     boolean     sendPacketToHost(void);
     void        sendPollMessageToHost(void);
@@ -180,6 +350,36 @@ public:
     void        setByteIdForPacketBuffer(int);
     boolean     setChannelNumber(uint32_t);
     boolean     setPollTime(uint32_t);
+    boolean     timerPending(uint8_t);
+    boolean     uploadAddChar(char);
+    boolean     uploadDeviceProcessPacket(char *, int);
+    boolean     uploadDeviceSendStatus(void);
+    uint16_t    uploadFree(void);
+    void        uploadHostProcessStatus(char *, int);
+    void        uploadHostSendToDevice(device_t);
+    void        uploadProcess(void);
+    void        uploadReset(void);
+    void        timerProcess(void);
+    boolean     txQueueAdd(char *, uint8_t, uint8_t);
+    boolean     txQueueAddSerialPage(void);
+    void        txQueueRemove(boolean);
+    void        txQueueReset(void);
+    void        txQueueRetry(void);
+    boolean     txQueueSendToDevice(device_t);
+    void        timerStart(uint8_t, unsigned long);
+#if OPENBCI_TRACE_ENABLED
+    void        traceAdd(uint8_t, uint8_t, uint16_t);
+    void        traceDump(void);
+    void        traceFlush(void);
+    void        traceHostProcessDevice(char *, int);
+    void        traceLoop(void);
+    void        traceMaskEnd(uint8_t);
+    void        traceMaskStart(void);
+    void        tracePackRecord(uint32_t, char *);
+    boolean     traceSendToHost(void);
+    boolean     traceSent(boolean, uint8_t, uint8_t);
+    void        traceWriteRecord(char, char *);
+#endif
     void        writeBufferToSerial(char *,int);
 
     //////////////////////
@@ -200,10 +400,96 @@ public:
     char singlePayLoad[1];
 
     StreamPacketBuffer streamPacketBuffer[OPENBCI_NUMBER_STREAM_BUFFERS];
+    char streamHistory[OPENBCI_NUMBER_STREAM_HISTORY][OPENBCI_MAX_PACKET_SIZE_BYTES];
+    volatile boolean streamHistoryResend[OPENBCI_NUMBER_STREAM_HISTORY];
+    volatile uint8_t streamSampleNext;
+    volatile boolean streamSampleNextValid;
+    uint8_t streamParityGroup;
+    char streamParity[OPENBCI_MAX_PACKET_SIZE_BYTES];
+    volatile uint8_t streamParityCount;
+    volatile uint8_t streamParityType;
+    volatile uint8_t streamParityFirst;
+    volatile boolean streamParityFirstValid;
+    volatile boolean streamParityPending;
+    volatile uint32_t streamParityRecovered;
+    volatile uint32_t streamParityLost;
+    volatile uint8_t streamDecimate;
+    uint8_t streamDecimateCount[2];
+    int32_t streamDecimateSum[2][OPENBCI_STREAM_CHANNELS];
+    uint8_t streamDecimateSample;
+    volatile boolean linkHeard;
+    volatile boolean linkUnacked;
+    volatile unsigned long linkTimeSent;
+    boolean linkSearching;
+    unsigned long linkTimeSearch;
+    unsigned long linkTimeDwell;
+    volatile uint8_t lowPowerWaitMs;
+    boolean lowPowerBursting;
+    boolean lowPowerWaiting;
+    uint8_t lowPowerBurstEnd;
+    unsigned long lowPowerTimeFirst;
+    volatile unsigned long lowPowerTimeActive;
+    volatile unsigned long lowPowerTimeAck;
+    volatile boolean lowPowerReportPending;
+    volatile uint32_t lowPowerPackets;
+    volatile uint32_t lowPowerRadioOnUs;
+    volatile uint32_t lowPowerWakes;
+    FlashCommit flashCommits[OPENBCI_NUMBER_FLASH_COMMITS];
+    volatile uint8_t flashCommitsPending;
+    volatile uint8_t flashCommitMsgToPrint;
+    uint8_t flashCommitRetries;
+    volatile boolean timerActive[TIMER_EVENT_COUNT];
+    volatile unsigned long timerDeadline[TIMER_EVENT_COUNT];
+    volatile uint32_t timerChannelNumber;
+    uint32_t timerBaudRate;
+    uint16_t timerBaudPosition;
+    char *outputBuffer;
+    uint16_t outputPositionWrite;
+    uint16_t outputPositionRead;
+    unsigned long outputTimeFree;
+    uint16_t outputByteTimeUs;
+    boolean outputBatchEnabled;
+    uint16_t outputBatchSequence;
+    boolean outputBatchWaiting;
+    unsigned long outputBatchTimeFirst;
+    char sharedBuffer[OPENBCI_UPLOAD_BUFFER_LENGTH]; // Upload on the Device, output and upload on the Host
+    char *uploadBuffer;
+    uint16_t uploadLength;
+    volatile boolean uploadActive;
+    volatile boolean uploadNack;
+    volatile uint16_t uploadPositionWrite;
+    volatile uint16_t uploadPositionRead;
+    volatile uint16_t uploadPositionSend;
+    volatile uint16_t uploadPositionRewind;
+    volatile uint16_t uploadCredit;
+    volatile unsigned long uploadTimeLastAck;
+    unsigned long uploadTimeLastStatus;
+    volatile unsigned long uploadTimeLastActivity;
+    volatile unsigned long lastTimeHostHeardStream;
+    TxQueueEntry txQueue[OPENBCI_NUMBER_TX_QUEUE];
+    volatile uint8_t txQueueCount;
+    RxDescriptor rxQueue[OPENBCI_NUMBER_RX_QUEUE];
+    static const HostCommand hostCommands[OPENBCI_HOST_CMD_TABLE_SIZE];
+    volatile uint8_t rxQueueHead;
+    volatile uint8_t rxQueueTail;
+    volatile uint8_t runPending;
+    unsigned long runTimeSweep;
+    char txQueueMsg[OPENBCI_MAX_PACKET_SIZE_BYTES];
+    boolean streamDownEnabled;
+    char streamDownPacket[OPENBCI_MAX_PACKET_SIZE_BYTES];
+    char streamDownBuffer[OPENBCI_NUMBER_STREAM_DOWN_BUFFERS][OPENBCI_MAX_PACKET_SIZE_BYTES];
+    volatile uint8_t streamDownHead;
+    volatile uint8_t streamDownTail;
+    boolean serialFramingEnabled;
+    FRAME_STATE serialFrameState;
+    uint16_t serialFrameBytesLeft;
+    volatile boolean serialFrameComplete;
     volatile boolean sendingMultiPacket;
     volatile boolean isWaitingForNewChannelNumber;
     volatile boolean isWaitingForNewPollTime;
     volatile unsigned long timeOfLastPoll;
+    volatile unsigned long timeOfLastStream;
+    boolean flowPaused;
     unsigned long timeOfLastMultipacketSendToHost;
 
     boolean channelNumberSaveAttempted;
@@ -228,9 +514,55 @@ public:
     uint32_t radioChannel;
     uint32_t previousRadioChannel;
     uint32_t pollTime;
+    volatile uint32_t pollTimeUs;
+
+#if OPENBCI_TRACE_ENABLED
+    TraceRecord traceRing[OPENBCI_TRACE_RING_SIZE];
+    volatile uint32_t traceCount;
+    volatile boolean tracePaused;
+    unsigned long traceTimeLastLoop;
+    unsigned long traceTimeMasked;
+    // Writing the ring out, to the Host on the Device or to the driver on
+    //  the Host
+    volatile boolean traceSending;
+    volatile uint32_t traceSendFirst;
+    volatile uint8_t traceSendPosition;
+    volatile uint8_t traceSendTotal;
+    // Host
+    char traceDevicePackets[OPENBCI_TRACE_DEVICE_BUFFERS][OPENBCI_MAX_PACKET_SIZE_BYTES];
+    volatile uint8_t traceDeviceLength[OPENBCI_TRACE_DEVICE_BUFFERS];
+    volatile uint8_t traceDeviceHead;
+    volatile uint8_t traceDeviceTail;
+    volatile uint8_t traceDeviceNext;
+#endif
 };
 
 // Very important, major key to success #christmas
 extern OpenBCI_Radios_Class radio;
 
+// Keeps the compiler from moving memory reads and writes across it, for data
+//  handed between loop() and the radio callback without holding either off.
+//  The Cortex-M0 doesn't reorder them itself.
+#define OPENBCI_MEMORY_BARRIER() __asm__ __volatile__("" ::: "memory")
+
+// Trace points compile to nothing unless OPENBCI_TRACE_ENABLED is 1, see
+//  OpenBCI_Radios_Class::traceAdd()
+#if OPENBCI_TRACE_ENABLED
+#define OPENBCI_TRACE(event, arg, value) radio.traceAdd((event), (arg), (value))
+#define OPENBCI_TRACE_TX(sent, byteId, length) radio.traceSent((sent), (byteId), (length))
+#define OPENBCI_TRACE_LOOP() radio.traceLoop()
+#define OPENBCI_TRACE_MASK_START() radio.traceMaskStart()
+#define OPENBCI_TRACE_MASK_END(where) radio.traceMaskEnd(where)
+#define OPENBCI_TRACE_FLUSH() radio.traceFlush()
+#define OPENBCI_TRACE_SEND() radio.traceSendToHost()
+#else
+#define OPENBCI_TRACE(event, arg, value)
+#define OPENBCI_TRACE_TX(sent, byteId, length) (sent)
+#define OPENBCI_TRACE_LOOP()
+#define OPENBCI_TRACE_MASK_START()
+#define OPENBCI_TRACE_MASK_END(where)
+#define OPENBCI_TRACE_FLUSH()
+#define OPENBCI_TRACE_SEND()
+#endif
+
 #endif // OPENBCI_RADIO_H
@@ -22,6 +22,25 @@
 #define OPENBCI_TIMEOUT_PACKET_STREAM_uS 88 // Slightly longer than it takes to send a serial byte at 115200
 #define OPENBCI_TIMEOUT_PACKET_POLL_MS 48 // Poll time out length for sending null packet from device to host
 #define OPENBCI_TIMEOUT_COMMS_MS 270 // Comms failure time out length. Used only by Host.
+#define OPENBCI_FLASH_PAGE_ERASE_MS 22 // A page erase stops the CPU, and the radio with it, this long
+#define OPENBCI_TIMEOUT_PAGE_RETRY_uS 10000 // Wait after a page reject to let the other radio finish
+#define OPENBCI_TIMEOUT_CHANNEL_CHANGE_uS 30000 // Wait after the last poll on the old channel before switching
+#define OPENBCI_TIMEOUT_BAUD_CHANGE_uS 2000 // Let the baud change message drain before switching
+#define OPENBCI_TIMEOUT_UPLOAD_STATUS_uS 600 // Device sends an upload status at least this often, one GZLL timeslot
+#define OPENBCI_TIMEOUT_UPLOAD_RESEND_uS 20000 // Host goes back to the last ack if it stops moving this long
+#define OPENBCI_TIMEOUT_UPLOAD_IDLE_MS 5000 // Upload mode ends after the PC is quiet this long
+#define OPENBCI_TIMEOUT_FRAME_uS 100000 // A framed page that stops mid-write is dropped after this long
+#define OPENBCI_TIMEOUT_STREAM_ACTIVE_MS 20 // Host counts as streaming if a stream packet came in this recently
+#define OPENBCI_TIMEOUT_STREAM_GAP_uS 20000 // Host holds back stream packets behind a missing one this long
+#define OPENBCI_TIMEOUT_BATCH_uS 8000 // Host holds a stream packet this long waiting for a full batch
+#define OPENBCI_TIMEOUT_RUN_SWEEP_uS 1000 // run() looks at all its work and the slow housekeeping this often
+#define OPENBCI_TIMEOUT_LOW_POWER_IDLE_MS 2000 // Device in low power counts as quiet after nothing from the Pic or Host this long
+#define OPENBCI_TIMEOUT_LINK_LOST_MS 20 // Link is lost after a Device send unacked or a Host stream quiet this long
+#define OPENBCI_TIMEOUT_LINK_SEARCH_MS 1000 // Stop looking on the previous channel after this long
+
+// Framed pages from the driver, start byte then 16 bit length little endian
+#define OPENBCI_FRAME_BYTE_START 0xFA
+#define OPENBCI_FRAME_LENGTH_MAX (OPENBCI_NUMBER_SERIAL_BUFFERS * OPENBCI_MAX_DATA_BYTES_IN_PACKET)
 
 // Stream byte stuff
 #define OPENBCI_STREAM_BYTE_START 0xA0
@@ -30,10 +49,152 @@
 // Max buffer lengths
 #define OPENBCI_BUFFER_LENGTH_MULTI 528 // 16 * 33
 
+// Host output to the driver, must be a power of two that divides 65536 and
+//  can take a whole page
+#ifndef OPENBCI_OUTPUT_BUFFER_LENGTH
+#define OPENBCI_OUTPUT_BUFFER_LENGTH 1024
+#endif
+#ifndef OPENBCI_OUTPUT_UART_FIFO_BYTES
+#define OPENBCI_OUTPUT_UART_FIFO_BYTES 1 // Bytes the UART takes without making a write wait
+#endif
+#define OPENBCI_OUTPUT_WAIT_MAX_uS 100 // Longest a pass through loop() waits on the UART
+#define OPENBCI_OUTPUT_MESSAGE_MAX 96 // Room the longest message to the driver needs
+
+// Batched stream packets to the driver, start byte, 16 bit length and count
+//  of the packets, 16 bit sequence, the packets without their 0xA0 and a
+//  CRC-16/CCITT-FALSE of everything after the start byte, all little endian
+#define OPENBCI_BATCH_BYTE_START 0xFB
+#define OPENBCI_BATCH_HEADER_BYTES 6
+#define OPENBCI_BATCH_CRC_BYTES 2
+#define OPENBCI_BATCH_PACKET_BYTES 32 // 31 data bytes and the stop byte
+#ifndef OPENBCI_BATCH_PACKETS_MAX
+#define OPENBCI_BATCH_PACKETS_MAX 8 // Less than the stream ring
+#endif
+
+// Upload mode, must be a power of two that divides 65536. The Device uploads
+//  through all of it, the Host's output buffer takes the front of it and the
+//  Host uploads through the half after that
+#define OPENBCI_UPLOAD_BUFFER_LENGTH 2048
+#define OPENBCI_UPLOAD_HOST_BUFFER_LENGTH (OPENBCI_UPLOAD_BUFFER_LENGTH / 2)
+#if OPENBCI_OUTPUT_BUFFER_LENGTH > OPENBCI_UPLOAD_HOST_BUFFER_LENGTH
+#error "OPENBCI_OUTPUT_BUFFER_LENGTH has to fit in front of the Host's upload buffer"
+#endif
+#define OPENBCI_UPLOAD_HEADER_BYTES 3 // byteId + 16 bit byte offset
+#define OPENBCI_UPLOAD_STATUS_BYTES 5 // byteId + 16 bit byte offset + 16 bit credit
+// Reserved byteIds below 0x80 need a low bit set, byteIdMake only makes multiples of 8 for pages
+#define OPENBCI_UPLOAD_BYTE_ID 0x7F // Never made by byteIdMake, checksum bits are always 0
+#define OPENBCI_UPLOAD_BYTE_ID_NACK 0x7E
+#define OPENBCI_COMMAND_FAST_BYTE_ID 0x7D // Single byte board command, never made by byteIdMake
+#define OPENBCI_TX_QUEUE_BYTE_ID 0x7C // Several Host messages in one ack, each as [length][bytes]
+#define OPENBCI_STREAM_NACK_BYTE_ID 0x7B // Host asks for stream packets again, followed by sample numbers
+#define OPENBCI_STREAM_PARITY_BYTE_ID 0x7A // Host sets the parity group size, followed by the size (0 is off)
+#define OPENBCI_TRACE_BYTE_ID 0x79 // Host asks for Device trace records from a number, Device answers with them
+#define OPENBCI_STREAM_DECIMATE_BYTE_ID 0x74 // Host sets the decimation, followed by N (0 or 1 is off). Not 0x78, the first packet of a 16 packet page
+#define OPENBCI_LOW_POWER_BYTE_ID 0x77 // Host sets the burst wait in ms (0 is off) or asks for a report, Device answers with the report
+#define OPENBCI_LINK_STATE_BYTE_ID 0x76 // Host brings the Device into its saved link state, followed by the 32 bit state
+#define OPENBCI_POLL_TIME_BYTE_ID 0x75 // Host sets the Device's poll time, followed by the 32 bit time in uS
+#define OPENBCI_STREAM_DOWN_BYTE_ID 0x73 // Host turns stream packets to the Pic on or off, followed by 1 or 0
+
 // Number of buffers
 #define OPENBCI_NUMBER_RADIO_BUFFERS 1
 #define OPENBCI_NUMBER_SERIAL_BUFFERS 16
+#ifndef OPENBCI_NUMBER_STREAM_BUFFERS // Can be set at build time, the simulator uses this to try ring depths
 #define OPENBCI_NUMBER_STREAM_BUFFERS 25 // This should be at least one greater than poll time divided by packet interval to allow for the ack counter.
+#endif
+#define OPENBCI_NUMBER_TX_QUEUE 4 // Host messages waiting for an ack to the Device
+#define OPENBCI_NUMBER_RX_QUEUE 8 // Packets from the radio callback waiting for loop(), a power of two
+#define OPENBCI_NUMBER_STREAM_DOWN_BUFFERS 4 // Stream packets from the Host waiting to be written to the Pic
+#define OPENBCI_NUMBER_STREAM_HISTORY 8 // Stream packets the Device keeps to resend, indexed by sample number
+#define OPENBCI_STREAM_GAP_MAX 4 // Most missing stream packets the Host asks for at once
+#define OPENBCI_STREAM_PARITY_GROUP_MAX 8 // The group size rides in the low 3 bits of the parity byteId
+#define OPENBCI_STREAM_PACKET_TYPE_PARITY 0x0F // 0xCF from the Pic can't be used while parity is on
+#define OPENBCI_STREAM_DECIMATE_MAX 16 // Most stream packets averaged into one
+#define OPENBCI_STREAM_PACKET_TYPE_DECIMATED 0x0E // Stop byte 0xCE, the average of N packets from the Pic
+#define OPENBCI_STREAM_CHANNELS 8 // 24 bit big endian channel values behind the sample number
+
+// Finding the other radio again after the link is lost
+#define OPENBCI_LINK_DWELL_DEVICE_MS 5 // Device polls on each channel this long
+#define OPENBCI_LINK_DWELL_HOST_MS 15 // Host listens on each channel this long, longer than a round of the Device's
+#define OPENBCI_LINK_SAMPLE_MS 4 // Longest between samples from the Pic the Host expects, 250 Hz
+
+// Poll time, kept as ms or as uS with OPENBCI_POLL_TIME_US_FLAG set. Flash
+//  has the ms, rounded up, where older firmware reads them and the uS in the
+//  word after the link state, see flashWritePollTime()
+#define OPENBCI_POLL_TIME_US_FLAG 0x80000000 // Set on a poll time in uS, an erased word is still 0xFFFFFFFF
+#define OPENBCI_POLL_TIME_MIN_uS 600 // Shortest poll time, about one packet, the turnaround and its ack
+#define OPENBCI_POLL_TIME_MAX_uS 255000 // Longest poll time, the most the one byte ms command could set
+#define OPENBCI_POLL_TIME_STREAM_MIN_uS 5000 // Shortest poll time while stream packets go out, longer than the gap between them at 250Hz
+#define OPENBCI_POLL_TIME_BYTES 5 // byteId then the poll time in uS, 32 bits little endian
+
+// Flow control toward the Pic, XON/XOFF on the Device's serial port. Built with
+//  OPENBCI_FLOW_CONTROL set to 0 the Device soft resets the Pic on an overflow
+//  instead, for Pic firmware that doesn't stop for XOFF
+#ifndef OPENBCI_FLOW_CONTROL
+#define OPENBCI_FLOW_CONTROL 1
+#endif
+#define OPENBCI_FLOW_XON 0x11
+#define OPENBCI_FLOW_XOFF 0x13
+#define OPENBCI_FLOW_XOFF_PACKETS (OPENBCI_NUMBER_SERIAL_BUFFERS - 2) // Pause the Pic with this many serial buffers in use, the rest take what it sends before it stops
+#define OPENBCI_FLOW_XON_PACKETS 0 // Start the Pic again with this many in use, once the page has gone to the Host
+
+// Low power on the Device
+#define OPENBCI_LOW_POWER_WAIT_MAX_MS 100 // Longest a stream packet is held back for a burst
+#define OPENBCI_LOW_POWER_BURST_PACKETS 8 // A burst goes out once this many stream packets are waiting
+#define OPENBCI_LOW_POWER_POLL_IDLE_MS 255 // Poll time of a quiet Device, under OPENBCI_TIMEOUT_COMMS_MS
+#define OPENBCI_LOW_POWER_REPORT 0xFF // Sent behind OPENBCI_LOW_POWER_BYTE_ID to ask for a report
+#define OPENBCI_LOW_POWER_REPORT_BYTES 13 // byteId then packets, radio on uS and wakes, 32 bits little endian
+#define OPENBCI_LOW_POWER_WAKE_GAP_uS 1000 // Acks further apart than this are separate wakes of the radio
+#define OPENBCI_LOW_POWER_EXCHANGE_uS 600 // A packet, the turnaround and its ack, counted for the first ack of a wake
+#define OPENBCI_LOW_POWER_WAKE_uS 400 // Clock and radio start up, counted for each wake
+
+// Link state kept in flash for a warm start, radio side settings only: a byte
+//  each of parity group, decimation and low power wait above a reserved low
+//  byte, which older firmware used for the Host's serial modes
+#define OPENBCI_LINK_STATE_DEFAULT 0x00000000 // Everything off, an erased word reads as this
+#define OPENBCI_LINK_STATE_SHIFT_PARITY 8
+#define OPENBCI_LINK_STATE_SHIFT_DECIMATE 16
+#define OPENBCI_LINK_STATE_SHIFT_LOW_POWER 24
+#define OPENBCI_LINK_STATE_BYTES 5 // byteId then the state, 32 bits little endian
+
+// Trace points, off unless built with OPENBCI_TRACE_ENABLED set to 1
+#ifndef OPENBCI_TRACE_ENABLED
+#define OPENBCI_TRACE_ENABLED 0
+#endif
+#ifndef OPENBCI_TRACE_RING_SIZE
+#define OPENBCI_TRACE_RING_SIZE 64 // Records kept, a power of two no bigger than 128
+#endif
+#define OPENBCI_TRACE_RECORD_BYTES 8 // 32 bit micros, event, arg, 16 bit value
+#define OPENBCI_TRACE_RECORDS_PER_PACKET 3 // Device records per packet behind byteId, first and total
+#define OPENBCI_TRACE_LINE_BYTES 22 // A record written to the driver, with its side and newline
+#define OPENBCI_TRACE_DEVICE_BUFFERS 4 // Device trace packets waiting on the Host to be written out
+#define OPENBCI_TRACE_LOOP_SLOW_uS 1000 // Passes through loop() longer than this are traced
+#define OPENBCI_TRACE_MASKED_SLOW_uS 20 // Radio callback held off longer than this is traced
+
+// Trace events, what arg and value hold is next to each
+#define OPENBCI_TRACE_EVENT_RX_ENTER 0x01 // byteId, length
+#define OPENBCI_TRACE_EVENT_RX_EXIT 0x02 // 1 if a packet was sent back, 0
+#define OPENBCI_TRACE_EVENT_TX_OK 0x03 // byteId, length
+#define OPENBCI_TRACE_EVENT_TX_FAIL 0x04 // byteId, length
+#define OPENBCI_TRACE_EVENT_RING_HEAD 0x05 // new head, packets in the ring
+#define OPENBCI_TRACE_EVENT_RING_TAIL 0x06 // new tail, packets in the ring
+#define OPENBCI_TRACE_EVENT_PAGE_REJECT 0x07 // 1 if sent, 0 if received, 0
+#define OPENBCI_TRACE_EVENT_PAGE_MISSED 0x08 // 1 if sent, 0 if received, 0
+#define OPENBCI_TRACE_EVENT_POLL 0x09 // 1 from loop(), 0 from the radio callback, 0
+#define OPENBCI_TRACE_EVENT_FLUSH_START 0x0A // sample number or 0 for a page, bytes
+#define OPENBCI_TRACE_EVENT_FLUSH_END 0x0B // sample number or 0 for a page, bytes
+#define OPENBCI_TRACE_EVENT_LOOP 0x0C // 0, uS the last pass took
+#define OPENBCI_TRACE_EVENT_LINK 0x0D // 1 lost, 2 trying a channel, 0 found, channel
+#define OPENBCI_TRACE_EVENT_MASKED 0x0E // where from below, uS loop() held the radio callback off
+#define OPENBCI_TRACE_EVENT_RX_FULL 0x0F // byteId, length of a packet dropped with the RX queue full
+
+// Where loop() held the radio callback off, for OPENBCI_TRACE_EVENT_MASKED
+#define OPENBCI_TRACE_MASKED_RUN 0x01
+#define OPENBCI_TRACE_MASKED_RX_QUEUE 0x02
+#define OPENBCI_TRACE_MASKED_SERIAL_PAGE 0x03
+#define OPENBCI_TRACE_MASKED_FAST_COMMAND 0x04
+#define OPENBCI_TRACE_MASKED_STREAM_DOWN 0x05
+#define OPENBCI_TRACE_MASKED_LINK_STATE 0x06
+#define OPENBCI_TRACE_MASKED_FLASH_COMMIT 0x07
 
 // These are the three different possible configuration modes for this library
 #define OPENBCI_MODE_DEVICE 0
@@ -58,6 +219,14 @@
 // flash memory address for RFdunioGZLL
 #define RFDUINOGZLL_FLASH_MEM_ADDR 251
 
+// Deferred flash commits
+#define OPENBCI_NUMBER_FLASH_COMMITS 4
+#define OPENBCI_FLASH_COMMIT_CHANNEL 0x00
+#define OPENBCI_FLASH_COMMIT_POLL_TIME 0x01
+#define OPENBCI_FLASH_COMMIT_LINK_STATE 0x02
+#define OPENBCI_FLASH_COMMIT_RETRIES 3
+#define OPENBCI_FLASH_COMMIT_NO_MSG 0xFF
+
 // Max number of packets on the TX buffer
 #define RFDUINOGZLL_MAX_PACKETS_ON_TX_BUFFER 2
 
@@ -78,6 +247,9 @@
 #define ORPM_CHANGE_POLL_TIME_HOST_REQUEST 0x07 //
 #define ORPM_CHANGE_POLL_TIME_DEVICE_READY 0x08 //
 #define ORPM_GET_POLL_TIME 0x09 //
+#define ORPM_UPLOAD_START 0x0A // Host wants to enter upload mode
+#define ORPM_UPLOAD_READY 0x0B // Device is in upload mode
+#define ORPM_UPLOAD_END 0x0C // Host is leaving upload mode
 
 // Used to determine what to send after a proccess out bound buffer
 #define ACTION_RADIO_SEND_NONE 0x00
@@ -120,6 +292,22 @@
 #define OPENBCI_HOST_CMD_TIME_PIN_HIGH          0x08
 #define OPENBCI_HOST_CMD_TIME_PIN_LOW           0x09
 #define OPENBCI_HOST_CMD_BAUD_HYPER             0x0A
+#define OPENBCI_HOST_CMD_UPLOAD_START           0x0B
+#define OPENBCI_HOST_CMD_FRAMING_ON             0x0C
+#define OPENBCI_HOST_CMD_FRAMING_OFF            0x0D
+#define OPENBCI_HOST_CMD_STREAM_DOWN_ON         0x0E
+#define OPENBCI_HOST_CMD_STREAM_DOWN_OFF        0x0F
+#define OPENBCI_HOST_CMD_PARITY_SET             0x10
+#define OPENBCI_HOST_CMD_PARITY_GET             0x11
+#define OPENBCI_HOST_CMD_TRACE_DUMP             0x12
+#define OPENBCI_HOST_CMD_BATCH_ON               0x13
+#define OPENBCI_HOST_CMD_BATCH_OFF              0x14
+#define OPENBCI_HOST_CMD_DECIMATE_SET           0x15
+#define OPENBCI_HOST_CMD_LOW_POWER_SET          0x16
+#define OPENBCI_HOST_CMD_LOW_POWER_REPORT       0x17
+#define OPENBCI_HOST_CMD_POLL_TIME_SET_US       0x18
+#define OPENBCI_HOST_CMD_POLL_TIME_GET_US       0x19
+#define OPENBCI_HOST_CMD_TABLE_SIZE             32 // Rows in OpenBCI_Radios_Class::hostCommands, codes past the last row go to the Device
 
 // Raw data packet types/codes
 #define OPENBCI_PACKET_TYPE_RAW_AUX      = 3; // 0011
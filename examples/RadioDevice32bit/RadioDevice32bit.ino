@@ -23,84 +23,8 @@ void setup() {
 }
 
 void loop() {
-
-  // First we must ask if an emergency stop flag has been triggered, as a Device
-  //  we must frequently ask this question as we are the only one that can
-  //  initiaite a communication between back to the Driver.
-  if (radio.bufferSerial.overflowed) {
-    // Clear the buffer holding all serial data.
-    radio.bufferSerialReset(OPENBCI_NUMBER_SERIAL_BUFFERS);
-
-    // Reset the stream buffer
-    radio.bufferStreamReset();
-
-    // Send reset message to the board
-    radio.resetPic32();
-
-    // Reset the last time we contacted the host to now
-    radio.pollRefresh();
-
-    // Send emergency message to the host
-    radio.singleCharMsg[0] = (char)ORPM_DEVICE_SERIAL_OVERFLOW;
-
-    if (RFduinoGZLL.sendToHost(radio.singleCharMsg,1)) {
-      radio.bufferSerial.overflowed = false;  
-    }
-  } else {
-    if (Serial.available()) { // Is there new serial data available?
-      char newChar = Serial.read();
-      // Mark the last serial as now;
-      radio.lastTimeSerialRead = micros();
-      // Store it to serial buffer
-      radio.bufferSerialAddChar(newChar);
-      // Get one char and process it
-      radio.bufferStreamAddChar((radio.streamPacketBuffer + radio.streamPacketBufferHead), newChar);
-      // Reset the poll timer to prevent contacting the host mid read
-      radio.pollRefresh();
-    }
-
-    if ((radio.streamPacketBuffer + radio.streamPacketBufferHead)->state == radio.STREAM_STATE_READY) { // Is there a stream packet waiting to get sent to the Host?
-      // Has 92uS passed since the last time we read from the serial port?
-      if (radio.bufferStreamTimeout()) {
-        // We are sure this is a streaming packet.
-        radio.streamPacketBufferHead++;
-        if (radio.streamPacketBufferHead > (OPENBCI_NUMBER_STREAM_BUFFERS - 1)) {
-          radio.streamPacketBufferHead = 0;
-        }
-      }
-    }
-
-    if ((radio.streamPacketBuffer + radio.streamPacketBufferTail)->state == radio.STREAM_STATE_READY) { // Is there a stream packet waiting to get sent to the Host?
-      if (radio.streamPacketBufferHead != radio.streamPacketBufferTail) {
-        // Try to add the tail to the TX buffer
-        if (radio.bufferStreamSendToHost(radio.streamPacketBuffer + radio.streamPacketBufferTail)) {
-          radio.streamPacketBufferTail++;
-          if (radio.streamPacketBufferTail > (OPENBCI_NUMBER_STREAM_BUFFERS - 1)) {
-            radio.streamPacketBufferTail = 0;
-          }
-        }
-      }
-    }
-
-    if (radio.bufferSerialHasData()) { // Is there data from the Pic waiting to get sent to Host
-      // Has 3ms passed since the last time the serial port was read. Only the
-      //  first packet get's sent from here
-      if (radio.bufferSerialTimeout() && radio.bufferSerial.numberOfPacketsSent == 0 ) {
-        // In order to do checksumming we must only send one packet at a time
-        //  this stands as the first time we are going to send a packet!
-        radio.sendPacketToHost();
-      }
-    }
-
-    radio.bufferRadioFlushBuffers();
-
-    if (millis() > (radio.timeOfLastPoll + radio.pollTime)) {  // Has more than the poll time passed?
-      // Refresh the poll timer
-      radio.pollRefresh();
-      // Poll the host
-      radio.sendPollMessageToHost();
-    }
-  }
+  // Stream packets, messages, pages, serial and timers, see run()
+  radio.run();
 }
 
 /**
@@ -114,6 +38,11 @@ void loop() {
 * @param len {int} - The length of the `data` packet
 */
 void RFduinoGZLL_onReceive(device_t device, int rssi, char *data, int len) {
+  // Trace the packet coming in, see OPENBCI_TRACE_ENABLED
+  OPENBCI_TRACE(OPENBCI_TRACE_EVENT_RX_ENTER, len > 0 ? data[0] : 0, len);
+  // Count the radio on time, every packet sent gets here with its ack
+  radio.lowPowerAck(len);
+  radio.linkAck();
   // Set send data packet flag to false
   boolean sendDataPacket = false;
   // Is the length of the packer equal to one?
@@ -139,4 +68,5 @@ void RFduinoGZLL_onReceive(device_t device, int rssi, char *data, int len) {
   if (sendDataPacket) {
     radio.sendPacketToHost();
   }
+  OPENBCI_TRACE(OPENBCI_TRACE_EVENT_RX_EXIT, sendDataPacket, 0);
 }
@@ -31,81 +31,8 @@ void setup() {
 }
 
 void loop() {
-  
-  if (radio.printMessageToDriverFlag) {
-    radio.printMessageToDriverFlag = false;
-    radio.printMessageToDriver(radio.msgToPrint);
-  }
-
-  radio.bufferStreamFlushBuffers();
-
-  radio.bufferRadioFlushBuffers();
-
-  // Is there new data from the PC/Driver?
-  // While loop to read successive bytes
-  if (radio.didPCSendDataToHost()) {
-    char newChar = Serial.read();
-    // Save the last time serial data was read to now
-    radio.lastTimeSerialRead = micros();
-    // Get data and put it on the serial buffer
-    boolean success = radio.bufferSerialAddChar(newChar);
-    if (!success) {
-      Serial.print("Failure: Input too large!$$$");
-    }
-  }
-
-  // Set system to down if we experience a comms timout
-  if (radio.commsFailureTimeout()) {
-    // Mark the system as down
-    radio.systemUp = false;
-    // Check to see if data was left in the radio buffer from an incomplete
-    //  multi packet transfer.. i.e. a failed over the air upload
-    if (radio.bufferRadioHasData(radio.currentRadioBuffer)) {
-      // Reset the radio buffer flags
-      radio.bufferRadioReset(radio.currentRadioBuffer);
-      // Clean the buffer.. fill with zeros
-      radio.bufferRadioClean(radio.currentRadioBuffer);
-    }
-  }
-
-  if (radio.serialWriteTimeOut()) {
-    // Is the time the Device contacted the host greater than 0? This is
-    //  true if the Device has NEVER contacted the Host
-    if (radio.lastTimeHostHeardFromDevice > 0) {
-      // Is a packet in the TX buffer
-      if (radio.packetInTXRadioBuffer == false) {
-        if (radio.commsFailureTimeout()) {
-          radio.bufferSerialProcessCommsFailure();
-        } else {
-          //packets in the serial buffer and there is 1 packet to send
-          if (radio.bufferSerial.numberOfPacketsSent == 0 && radio.bufferSerial.numberOfPacketsToSend > 0) {
-            // process with a send to device
-            radio.processOutboundBufferForTimeSync();
-          }
-        }
-      } else {
-        // Comms time out?
-        if (radio.commsFailureTimeout()) {
-          if (radio.isWaitingForNewChannelNumberConfirmation && !radio.channelNumberSaveAttempted) {
-            RFduinoGZLL.end();
-            RFduinoGZLL.channel = radio.getChannelNumber();
-            RFduinoGZLL.begin(RFDUINOGZLL_ROLE_HOST);
-            radio.lastTimeHostHeardFromDevice = millis();
-            radio.channelNumberSaveAttempted = true;
-          } else {
-            radio.bufferSerialProcessCommsFailure();
-          }
-        }
-      }
-    } else { // lastTimeHostHeardFromDevice has not been changed
-      // comms time out?
-      // We here if the device never polled the host
-      if (radio.commsFailureTimeout()) {
-        radio.bufferSerialProcessCommsFailure();
-      }
-    }
-  }
-
+  // Stream packets, messages, pages, serial and timers, see run()
+  radio.run();
 }
 
 /**
@@ -119,6 +46,8 @@ void loop() {
 * @param len {int} - The length of the `data` packet
 */
 void RFduinoGZLL_onReceive(device_t device, int rssi, char *data, int len) {
+  // Trace the packet coming in, see OPENBCI_TRACE_ENABLED
+  OPENBCI_TRACE(OPENBCI_TRACE_EVENT_RX_ENTER, len > 0 ? data[0] : 0, len);
   // We know that the last packet was just sent
   if (radio.packetInTXRadioBuffer) {
     radio.packetInTXRadioBuffer = false;
@@ -129,17 +58,22 @@ void RFduinoGZLL_onReceive(device_t device, int rssi, char *data, int len) {
     radio.printMessageToDriverFlag = true;
     radio.msgToPrint = radio.HOST_MESSAGE_SERIAL_ACK;
   }
-  // If system is not up, set it up!
+  // If system is not up, set it up! The Device gets the Host's link state
+  //  on the way up, see linkStateSync()
+  if (!radio.systemUp) {
+    radio.linkStateSync();
+  }
   radio.systemUp = true;
 
   // Reset the last time heard from host timer
   radio.lastTimeHostHeardFromDevice = millis();
+  radio.linkAck();
   // Set send data packet flag to false
   boolean sendDataPacket = false;
   // Is the length of the packer equal to one?
   if (len == 1) {
     // Enter process single char subroutine
-    sendDataPacket = radio.processRadioCharHost(device,data[0]);
+    sendDataPacket = radio.processRadioCharHost(data[0]);
     // Is the length of the packet greater than one?
   } else if (len > 1) {
     // Enter process char data packet subroutine
@@ -149,16 +83,16 @@ void RFduinoGZLL_onReceive(device_t device, int rssi, char *data, int len) {
     // Condition
     if (radio.isWaitingForNewChannelNumberConfirmation) {
       if (!radio.channelNumberSaveAttempted) {
-        RFduinoGZLL.end();
-        RFduinoGZLL.channel = radio.getChannelNumber();
-        RFduinoGZLL.begin(RFDUINOGZLL_ROLE_HOST);
+        // Switch channels from loop(), see timerProcess()
+        radio.timerChannelNumber = radio.getChannelNumber();
+        radio.timerStart(radio.TIMER_EVENT_CHANNEL_CHANGE, 0);
       }
-      radio.msgToPrint = radio.HOST_MESSAGE_CHAN_GET_SUCCESS;
-      radio.printMessageToDriverFlag = true;
+      // Confirm to the driver once the new channel is stored
+      radio.flashCommitConfirm(radio.HOST_MESSAGE_CHAN_GET_SUCCESS);
       radio.isWaitingForNewChannelNumberConfirmation = false;
     } else if (radio.isWaitingForNewPollTimeConfirmation) {
-      radio.msgToPrint = radio.HOST_MESSAGE_POLL_TIME;
-      radio.printMessageToDriverFlag = true;
+      // Confirm to the driver once the new poll time is stored
+      radio.flashCommitConfirm(radio.HOST_MESSAGE_POLL_TIME);
       radio.isWaitingForNewPollTimeConfirmation = false;
     }
     // Are there packets waiting to be sent and was the Serial port read
@@ -171,8 +105,14 @@ void RFduinoGZLL_onReceive(device_t device, int rssi, char *data, int len) {
     }
   }
 
+  // Queued messages go ahead of any page, which waits for the next ack
+  if (radio.txQueueSendToDevice(device)) {
+    sendDataPacket = false;
+  }
+
   // Is the send data packet flag set to true
   if (sendDataPacket) {
     radio.sendPacketToDevice(device, false);
   }
+  OPENBCI_TRACE(OPENBCI_TRACE_EVENT_RX_EXIT, sendDataPacket, 0);
 }
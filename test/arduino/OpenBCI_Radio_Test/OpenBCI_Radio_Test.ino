@@ -26,6 +26,7 @@ void go() {
     testByteId();
     testOutput();
     testBuffer();
+    testUpload();
     // testNonVolatileFunctions();
 
     test.end();
@@ -175,6 +176,17 @@ void testNonVolatileFlashNonVolatileMemory() {
     // Verify the channel number is still set
     test.assertEqualInt((int)radio.getChannelNumber(),(int)newChannelNumber,"Channel number still set correctly");
 
+    test.describe("setPollTime in uS");
+    expectedPollTime = 750 | OPENBCI_POLL_TIME_US_FLAG;
+    test.assertBoolean(radio.setPollTime(expectedPollTime),true,"Set poll time in uS");
+    // Verify the poll time reads back in uS
+    test.assertEqualInt((int)radio.getPollTime(),(int)expectedPollTime,"Poll time in uS set correctly");
+    // Verify older firmware reads a whole ms
+    test.assertEqualInt((int)*(ADDRESS_OF_PAGE(RFDUINOGZLL_FLASH_MEM_ADDR) + 1),1,"Poll time in ms rounded up");
+    // Set a whole ms again
+    test.assertBoolean(radio.setPollTime(expectedPollTime = 100),true,"Set poll time in ms");
+    test.assertEqualInt((int)radio.getPollTime(),(int)expectedPollTime,"Poll time in ms set correctly");
+
 }
 
 void testBuffer() {
@@ -893,6 +905,7 @@ void testBufferStreamCleanUp() {
     }
     radio.streamPacketBufferHead = 0;
     radio.streamPacketBufferTail = 0;
+    radio.streamSampleNextValid = false;
 }
 
 void testBufferStreamReadyForNewPacket() {
@@ -959,3 +972,82 @@ void testBufferStreamStoreData() {
     test.assertEqualByte(radio.streamPacketBuffer->typeByte,packetType | OPENBCI_STREAM_BYTE_STOP,"should store the packetNumber OR'd with a stop byte", __LINE__);
 
 }
+
+void testUpload() {
+    testUploadDeviceProcessPacket();
+    testUploadHostProcessStatus();
+}
+
+void testUploadDeviceProcessPacket() {
+    test.describe("uploadDeviceProcessPacket");
+    char packet[OPENBCI_MAX_PACKET_SIZE_BYTES];
+    packet[0] = (char)OPENBCI_UPLOAD_BYTE_ID;
+    for (int i = OPENBCI_UPLOAD_HEADER_BYTES; i < OPENBCI_MAX_PACKET_SIZE_BYTES; i++) {
+        packet[i] = (char)i;
+    }
+
+    test.it("should take an in order packet");
+    radio.uploadReset();
+    packet[1] = 0x00;
+    packet[2] = 0x00;
+    test.assertBoolean(radio.uploadDeviceProcessPacket(packet,OPENBCI_MAX_PACKET_SIZE_BYTES),true,"should take the packet",__LINE__);
+    test.assertEqualInt(radio.uploadPositionWrite,29,"should move the write position by 29",__LINE__);
+    test.assertEqualInt(radio.uploadFree(),radio.uploadLength - 29,"should have less room",__LINE__);
+
+    test.it("should drop a repeat without a NACK");
+    test.assertBoolean(radio.uploadDeviceProcessPacket(packet,OPENBCI_MAX_PACKET_SIZE_BYTES),false,"should not take the packet",__LINE__);
+    test.assertEqualInt(radio.uploadPositionWrite,29,"should not move the write position",__LINE__);
+    test.assertBoolean(radio.uploadNack,false,"should not NACK",__LINE__);
+
+    test.it("should NACK a gap");
+    packet[1] = 58;
+    test.assertBoolean(radio.uploadDeviceProcessPacket(packet,OPENBCI_MAX_PACKET_SIZE_BYTES),false,"should not take the packet",__LINE__);
+    test.assertBoolean(radio.uploadNack,true,"should NACK",__LINE__);
+
+    test.it("should take only the new part of an overlapping packet");
+    packet[1] = 19;
+    test.assertBoolean(radio.uploadDeviceProcessPacket(packet,OPENBCI_MAX_PACKET_SIZE_BYTES),true,"should take the packet",__LINE__);
+    test.assertEqualInt(radio.uploadPositionWrite,48,"should move the write position to the end of the packet",__LINE__);
+    test.assertEqualChar(radio.uploadBuffer[29],packet[OPENBCI_UPLOAD_HEADER_BYTES + 10],"should line up the new bytes",__LINE__);
+    test.assertBoolean(radio.uploadNack,false,"should clear the NACK",__LINE__);
+
+    radio.uploadReset();
+}
+
+void testUploadHostProcessStatus() {
+    test.describe("uploadHostProcessStatus");
+    char status[OPENBCI_UPLOAD_STATUS_BYTES];
+
+    test.it("should free acked bytes and take the credit");
+    radio.uploadReset();
+    for (int i = 0; i < 100; i++) {
+        radio.uploadAddChar((char)i);
+    }
+    radio.uploadPositionSend = 87;
+    status[0] = (char)OPENBCI_UPLOAD_BYTE_ID;
+    status[1] = 29;
+    status[2] = 0x00;
+    status[3] = 0x00;
+    status[4] = 0x08;
+    radio.uploadHostProcessStatus(status,OPENBCI_UPLOAD_STATUS_BYTES);
+    test.assertEqualInt(radio.uploadPositionRead,29,"should move the read position to the ack",__LINE__);
+    test.assertEqualInt(radio.uploadCredit,2048,"should store the credit",__LINE__);
+    test.assertEqualInt(radio.uploadPositionSend,87,"should not rewind",__LINE__);
+
+    test.it("should go back to the ack once on a NACK");
+    status[0] = (char)OPENBCI_UPLOAD_BYTE_ID_NACK;
+    radio.uploadHostProcessStatus(status,OPENBCI_UPLOAD_STATUS_BYTES);
+    test.assertEqualInt(radio.uploadPositionSend,29,"should rewind to the ack",__LINE__);
+    radio.uploadPositionSend = 58;
+    radio.uploadHostProcessStatus(status,OPENBCI_UPLOAD_STATUS_BYTES);
+    test.assertEqualInt(radio.uploadPositionSend,58,"should not rewind twice for the same ack",__LINE__);
+
+    test.it("should refuse a char when the buffer is full");
+    radio.uploadReset();
+    for (int i = 0; i < radio.uploadLength; i++) {
+        radio.uploadAddChar((char)i);
+    }
+    test.assertBoolean(radio.uploadAddChar('A'),false,"should not store past the length",__LINE__);
+
+    radio.uploadReset();
+}
@@ -146,6 +146,7 @@ void testProcessChar() {
     testProcessCharStreamPackets();
     testProcessCharNotStreamPacket();
     testProcessCharOverflow();
+    testFlowControl();
 }
 
 void testIsATailByte() {
@@ -328,6 +329,68 @@ void testProcessCharOverflow() {
     testProcessChar_CleanUp();
 }
 
+void testFlowControl() {
+    test.describe("flowControlProcess - XON/XOFF to the Pic");
+    radio.bufferSerialReset(OPENBCI_NUMBER_SERIAL_BUFFERS);
+    radio.flowPaused = false;
+
+    test.it("should let the Pic go on below the high watermark");
+    for (int i = 0; i < (OPENBCI_FLOW_XOFF_PACKETS - 1) * OPENBCI_MAX_DATA_BYTES_IN_PACKET; i++) {
+        radio.bufferSerialAddChar(0x00);
+    }
+    radio.flowControlProcess();
+    test.assertBoolean(radio.flowPaused,false,"should not pause",__LINE__);
+
+    test.it("should pause the Pic at the high watermark");
+    for (int i = 0; i < OPENBCI_MAX_DATA_BYTES_IN_PACKET; i++) {
+        radio.bufferSerialAddChar(0x00);
+    }
+    radio.flowControlProcess();
+    test.assertBoolean(radio.flowPaused,true,"should send XOFF",__LINE__);
+    test.assertBoolean(radio.bufferSerial.overflowed,false,"should still have room",__LINE__);
+
+    test.it("should start the Pic again once the page is out");
+    radio.bufferSerialReset(OPENBCI_NUMBER_SERIAL_BUFFERS);
+    radio.flowControlProcess();
+    test.assertBoolean(radio.flowPaused,false,"should send XON",__LINE__);
+
+    test.it("should not pause the Pic in upload mode");
+    radio.flowPaused = true;
+    radio.uploadActive = true;
+    for (int i = 0; i < OPENBCI_FLOW_XOFF_PACKETS * OPENBCI_MAX_DATA_BYTES_IN_PACKET; i++) {
+        radio.bufferSerialAddChar(0x00);
+    }
+    radio.flowControlProcess();
+    test.assertBoolean(radio.flowPaused,false,"should forget the pause",__LINE__);
+    radio.uploadActive = false;
+
+    test.it("should not pause the Pic while stream packets go to it");
+    char streamDownMsg[2] = {(char)OPENBCI_STREAM_DOWN_BYTE_ID, 1};
+    test.assertBoolean(radio.processDeviceRadioCharStreamControl(streamDownMsg,2),true,"should take the message",__LINE__);
+    test.assertBoolean(radio.streamDownEnabled,true,"should turn stream down on",__LINE__);
+    radio.flowControlProcess();
+    test.assertBoolean(radio.flowPaused,false,"should not send XOFF",__LINE__);
+
+    test.it("should pause the Pic again once stream down is off");
+    streamDownMsg[1] = 0;
+    radio.processDeviceRadioCharStreamControl(streamDownMsg,2);
+    test.assertBoolean(radio.streamDownEnabled,false,"should turn stream down off",__LINE__);
+    radio.flowControlProcess();
+    test.assertBoolean(radio.flowPaused,true,"should send XOFF",__LINE__);
+
+    test.it("should start the Pic when a stream packet comes down");
+    char streamDownPacket[OPENBCI_MAX_PACKET_SIZE_BYTES] = {(char)0xC0};
+    radio.bufferStreamDownAddData(streamDownPacket,OPENBCI_MAX_PACKET_SIZE_BYTES);
+    radio.flowControlProcess();
+    test.assertBoolean(radio.flowPaused,false,"should send XON",__LINE__);
+    radio.streamDownEnabled = false;
+    radio.flowPaused = false;
+    radio.streamDownHead = 0;
+    radio.streamDownTail = 0;
+
+    testProcessChar_CleanUp();
+}
+
 void testProcessChar_CleanUp() {
     // Clear the buffers
     radio.bufferSerialReset(OPENBCI_NUMBER_SERIAL_BUFFERS);
@@ -341,6 +404,18 @@ void testProcessChar_CleanUp() {
 /********************************************/
 void testProcessRadioChar() {
     testPacketToSend();
+    testProcessRadioCharPageReject();
+    testProcessDeviceRadioCharDataCommandFast();
+    testProcessDeviceRadioCharDataTxQueue();
+    testProcessDeviceRadioCharDataStream();
+    testProcessDeviceRadioCharDataFullPage();
+    testProcessDeviceRadioCharDataStreamNack();
+    testProcessDeviceRadioCharDataStreamParity();
+    testProcessDeviceRadioCharDataStreamDecimate();
+    testProcessDeviceRadioCharDataLowPower();
+    testLinkProcess();
+    testProcessDeviceRadioCharDataLinkState();
+    testProcessDeviceRadioCharDataPollTime();
 }
 
 // This is used to determine if there is in fact a packet waiting to be sent
@@ -365,6 +440,423 @@ void testPacketToSend() {
 
 }
 
+void testProcessDeviceRadioCharDataCommandFast() {
+    test.describe("processDeviceRadioCharData - OPENBCI_COMMAND_FAST_BYTE_ID");
+    radio.bufferSerialReset(OPENBCI_NUMBER_SERIAL_BUFFERS);
+    radio.bufferRadioReset(radio.currentRadioBuffer);
+    char data[2];
+    data[0] = (char)OPENBCI_COMMAND_FAST_BYTE_ID;
+    data[1] = 's';
+
+    test.it("should put the command in the radio buffer for the Pic");
+    radio.processDeviceRadioCharData(data,2);
+    test.assertEqualInt(radio.currentRadioBuffer->positionWrite,1,"should add one byte",__LINE__);
+    test.assertEqualChar(radio.currentRadioBuffer->data[0],'s',"should store the command",__LINE__);
+    test.assertBoolean(radio.currentRadioBuffer->gotAllPackets,true,"should be ready to flush",__LINE__);
+
+    radio.bufferRadioReset(radio.currentRadioBuffer);
+}
+
+void testProcessDeviceRadioCharDataTxQueue() {
+    test.describe("processDeviceRadioCharData - OPENBCI_TX_QUEUE_BYTE_ID");
+    radio.bufferSerialReset(OPENBCI_NUMBER_SERIAL_BUFFERS);
+    radio.bufferRadioReset(radio.currentRadioBuffer);
+    char data[9];
+    data[0] = (char)OPENBCI_TX_QUEUE_BYTE_ID;
+    data[1] = 3;
+    data[2] = 0x00;
+    data[3] = 'a';
+    data[4] = 'b';
+    data[5] = 2;
+    data[6] = (char)OPENBCI_COMMAND_FAST_BYTE_ID;
+    data[7] = 's';
+    data[8] = 0;
+
+    test.it("should put every command in the radio buffer in order");
+    radio.processDeviceRadioCharData(data,8);
+    test.assertEqualInt(radio.currentRadioBuffer->positionWrite,3,"should skip the byteIds",__LINE__);
+    test.assertEqualChar(radio.currentRadioBuffer->data[0],'a',"should put the page first",__LINE__);
+    test.assertEqualChar(radio.currentRadioBuffer->data[2],'s',"should put the fast command last",__LINE__);
+    test.assertBoolean(radio.currentRadioBuffer->gotAllPackets,true,"should be ready to flush",__LINE__);
+
+    test.it("should reject all the commands if the radio buffer is busy");
+    radio.processDeviceRadioCharData(data,8);
+    test.assertEqualInt(radio.currentRadioBuffer->positionWrite,3,"should not add to a full page",__LINE__);
+
+    test.it("should keep a stream control message in the same ack out of the page");
+    radio.bufferRadioReset(radio.currentRadioBuffer);
+    radio.streamDownEnabled = false;
+    data[1] = 2;
+    data[2] = (char)OPENBCI_STREAM_DOWN_BYTE_ID;
+    data[3] = 1;
+    data[4] = 2;
+    data[5] = 0x00;
+    data[6] = 'b';
+    radio.processDeviceRadioCharData(data,7);
+    test.assertBoolean(radio.streamDownEnabled,true,"should turn stream down on",__LINE__);
+    test.assertEqualInt(radio.currentRadioBuffer->positionWrite,1,"should only take the page",__LINE__);
+    test.assertEqualChar(radio.currentRadioBuffer->data[0],'b',"should not write the 1 to the Pic",__LINE__);
+
+    radio.streamDownEnabled = false;
+    radio.bufferRadioReset(radio.currentRadioBuffer);
+}
+
+void testProcessDeviceRadioCharDataFullPage() {
+    test.describe("processDeviceRadioCharData - a page of OPENBCI_NUMBER_SERIAL_BUFFERS packets");
+    radio.bufferSerialReset(OPENBCI_NUMBER_SERIAL_BUFFERS);
+    radio.bufferRadioReset(radio.currentRadioBuffer);
+    radio.streamDecimate = 0;
+    char data[OPENBCI_MAX_PACKET_SIZE_BYTES];
+
+    test.it("should not take the first packet for a stream control message");
+    for (int packetNumber = OPENBCI_NUMBER_SERIAL_BUFFERS - 1; packetNumber >= 0; packetNumber--) {
+        for (int i = 1; i < OPENBCI_MAX_PACKET_SIZE_BYTES; i++) {
+            data[i] = 2;
+        }
+        data[0] = radio.byteIdMake(false,packetNumber,data + 1,OPENBCI_MAX_DATA_BYTES_IN_PACKET);
+        radio.processDeviceRadioCharData(data,OPENBCI_MAX_PACKET_SIZE_BYTES);
+    }
+    test.assertEqualByte(radio.streamDecimate,0,"should not turn decimation on",__LINE__);
+    test.assertEqualInt(radio.currentRadioBuffer->positionWrite,OPENBCI_NUMBER_SERIAL_BUFFERS * OPENBCI_MAX_DATA_BYTES_IN_PACKET,"should keep every packet",__LINE__);
+    test.assertBoolean(radio.currentRadioBuffer->gotAllPackets,true,"should be ready to flush",__LINE__);
+
+    radio.bufferRadioReset(radio.currentRadioBuffer);
+}
+
+void testProcessDeviceRadioCharDataStream() {
+    test.describe("processDeviceRadioCharData - stream packet from the Host");
+    radio.streamDownHead = 0;
+    radio.streamDownTail = 0;
+    char data[OPENBCI_MAX_PACKET_SIZE_BYTES];
+    data[0] = radio.byteIdMake(true,3,data + 1,OPENBCI_MAX_DATA_BYTES_IN_PACKET);
+    for (int i = 1; i < OPENBCI_MAX_PACKET_SIZE_BYTES; i++) {
+        data[i] = (char)i;
+    }
+
+    test.it("should hold the packet for the Pic");
+    radio.processDeviceRadioCharData(data,OPENBCI_MAX_PACKET_SIZE_BYTES);
+    test.assertEqualByte(radio.streamDownHead,1,"should add to the ring",__LINE__);
+    test.assertEqualByte(radio.streamDownBuffer[0][31],31,"should copy the packet",__LINE__);
+    test.assertEqualByte(radio.outputGetStopByteFromByteId(radio.streamDownBuffer[0][0]),0xC3,"should keep the packet type",__LINE__);
+
+    test.it("should drop packets when the ring is full");
+    for (int i = 0; i < OPENBCI_NUMBER_STREAM_DOWN_BUFFERS; i++) {
+        radio.bufferStreamDownAddData(data,OPENBCI_MAX_PACKET_SIZE_BYTES);
+    }
+    test.assertBoolean(radio.bufferStreamDownAddData(data,OPENBCI_MAX_PACKET_SIZE_BYTES),false,"should not overwrite",__LINE__);
+
+    radio.streamDownEnabled = false;
+    radio.streamDownHead = 0;
+    radio.streamDownTail = 0;
+}
+
+void testProcessDeviceRadioCharDataStreamNack() {
+    test.describe("processDeviceRadioCharData - stream NACK from the Host");
+    char nack[] = {(char)OPENBCI_STREAM_NACK_BYTE_ID, 11, 12};
+    for (int i = 0; i < OPENBCI_NUMBER_STREAM_HISTORY; i++) {
+        radio.streamHistory[i][1] = 0;
+        radio.streamHistoryResend[i] = false;
+    }
+    radio.streamHistory[11 % OPENBCI_NUMBER_STREAM_HISTORY][1] = 11;
+
+    test.it("should mark packets still in the history to be resent");
+    radio.processDeviceRadioCharData(nack,3);
+    test.assertBoolean(radio.streamHistoryResend[11 % OPENBCI_NUMBER_STREAM_HISTORY],true,"should resend sample 11",__LINE__);
+    test.assertBoolean(radio.streamHistoryResend[12 % OPENBCI_NUMBER_STREAM_HISTORY],false,"should not resend a sample it no longer has",__LINE__);
+
+    radio.streamHistoryResend[11 % OPENBCI_NUMBER_STREAM_HISTORY] = false;
+}
+
+void testProcessDeviceRadioCharDataStreamParity() {
+    test.describe("processDeviceRadioCharData - stream parity group from the Host");
+    char msg[] = {(char)OPENBCI_STREAM_PARITY_BYTE_ID, 4};
+    radio.streamParityCount = 3;
+
+    test.it("should set the group size and start a new group");
+    radio.processDeviceRadioCharData(msg,2);
+    test.assertEqualByte(radio.streamParityGroup,4,"should set the group size",__LINE__);
+    test.assertEqualByte(radio.streamParityCount,0,"should start a new group",__LINE__);
+
+    test.it("should turn parity off with 0");
+    msg[1] = 0;
+    radio.processDeviceRadioCharData(msg,2);
+    test.assertEqualByte(radio.streamParityGroup,0,"should turn parity off",__LINE__);
+}
+
+void testProcessDeviceRadioCharDataStreamDecimate() {
+    test.describe("bufferStreamDecimate - averaging stream packets");
+    char msg[] = {(char)OPENBCI_STREAM_DECIMATE_BYTE_ID, 2};
+    OpenBCI_Radios_Class::StreamPacketBuffer *buf = radio.streamPacketBuffer;
+    radio.streamDecimateCount[0] = 1;
+
+    test.it("should set the decimation from the Host and start over");
+    radio.processDeviceRadioCharData(msg,2);
+    test.assertEqualByte(radio.streamDecimate,2,"should set N",__LINE__);
+    test.assertEqualByte(radio.streamDecimateCount[0],0,"should start a new average",__LINE__);
+
+    test.it("should drop the first packet and keep it in the average");
+    radio.bufferStreamReset(buf);
+    buf->state = radio.STREAM_STATE_READY;
+    buf->typeByte = 0xC0;
+    for (int i = 0; i < OPENBCI_MAX_PACKET_SIZE_BYTES; i++) {
+        buf->data[i] = 0;
+    }
+    // Channel 1 is 10, channel 2 is -10
+    buf->data[4] = 10;
+    buf->data[5] = 0xFF; buf->data[6] = 0xFF; buf->data[7] = 0xF6;
+    test.assertBoolean(radio.bufferStreamDecimate(buf),false,"should not go in the ring",__LINE__);
+    test.assertEqualByte(buf->state,radio.STREAM_STATE_INIT,"should reset the packet",__LINE__);
+
+    test.it("should write the average into the second packet");
+    buf->state = radio.STREAM_STATE_READY;
+    buf->typeByte = 0xC0;
+    buf->data[1] = 2;
+    // Channel 1 is 20, channel 2 is -30
+    buf->data[4] = 20;
+    buf->data[5] = 0xFF; buf->data[6] = 0xFF; buf->data[7] = 0xE2;
+    test.assertBoolean(radio.bufferStreamDecimate(buf),true,"should go in the ring",__LINE__);
+    test.assertEqualByte(buf->data[4],15,"should average channel 1",__LINE__);
+    test.assertEqualByte(buf->data[5],0xFF,"should keep the sign of channel 2",__LINE__);
+    test.assertEqualByte(buf->data[7],0xEC,"should average channel 2 to -20",__LINE__);
+    test.assertEqualByte(buf->data[1],0,"should number the averaged packets from 0",__LINE__);
+    test.assertEqualByte(buf->typeByte,0xCE,"should mark the packet as decimated",__LINE__);
+    test.assertEqualByte(radio.streamDecimateSample,1,"should count the averaged packet",__LINE__);
+
+    test.it("should keep odd samples, a Daisy's channels, in an average of their own");
+    radio.bufferStreamDecimateReset();
+    for (int i = 0; i < 4; i++) {
+        radio.bufferStreamReset(buf);
+        buf->state = radio.STREAM_STATE_READY;
+        buf->typeByte = 0xC0;
+        for (int j = 0; j < OPENBCI_MAX_PACKET_SIZE_BYTES; j++) {
+            buf->data[j] = 0;
+        }
+        buf->data[1] = (char)i;
+        // Board channel 1 is 10 on even samples, Daisy channel 9 is 100 on odd
+        buf->data[4] = (i & 0x01) ? 100 : 10;
+        test.assertBoolean(radio.bufferStreamDecimate(buf),i >= 2,"should go in the ring with the second of each",__LINE__);
+        if (i >= 2) {
+            test.assertEqualByte(buf->data[4],(i & 0x01) ? 100 : 10,"should not mix the board and the Daisy",__LINE__);
+            test.assertEqualByte(buf->data[1],i - 2,"should keep the Pic's order",__LINE__);
+        }
+    }
+
+    test.it("should pass a time stamped packet through with the next sample number");
+    radio.bufferStreamReset(buf);
+    buf->state = radio.STREAM_STATE_READY;
+    buf->typeByte = 0xC4;
+    buf->data[1] = 55;
+    buf->data[4] = 33;
+    test.assertBoolean(radio.bufferStreamDecimate(buf),true,"should go in the ring",__LINE__);
+    test.assertEqualByte(buf->typeByte,0xC4,"should keep its type",__LINE__);
+    test.assertEqualByte(buf->data[4],33,"should keep its data",__LINE__);
+    test.assertEqualByte(buf->data[1],2,"should carry on the count",__LINE__);
+
+    test.it("should start on an even sample");
+    radio.bufferStreamDecimateReset();
+    radio.bufferStreamReset(buf);
+    buf->state = radio.STREAM_STATE_READY;
+    buf->typeByte = 0xC0;
+    buf->data[1] = 9;
+    test.assertBoolean(radio.bufferStreamDecimate(buf),false,"should drop it",__LINE__);
+    test.assertEqualByte(radio.streamDecimateCount[1],0,"should not start the odd average",__LINE__);
+
+    test.it("should pass packets through with 0");
+    msg[1] = 0;
+    radio.processDeviceRadioCharData(msg,2);
+    buf->typeByte = 0xC0;
+    test.assertBoolean(radio.bufferStreamDecimate(buf),true,"should go in the ring",__LINE__);
+    test.assertEqualByte(buf->typeByte,0xC0,"should not change the packet",__LINE__);
+
+    radio.bufferStreamReset(buf);
+}
+
+void testProcessDeviceRadioCharDataLowPower() {
+    test.describe("bufferStreamBurstReady - low power bursts");
+    char msg[] = {(char)OPENBCI_LOW_POWER_BYTE_ID, 20};
+    radio.bufferStreamReset();
+
+    test.it("should set the burst wait from the Host and start the counts over");
+    radio.lowPowerWakes = 5;
+    radio.processDeviceRadioCharData(msg,2);
+    test.assertEqualByte(radio.lowPowerWaitMs,20,"should set the wait",__LINE__);
+    test.assertEqualInt(radio.lowPowerWakes,0,"should start the counts over",__LINE__);
+
+    test.it("should hold the first packets");
+    radio.streamPacketBufferHead = 3;
+    test.assertBoolean(radio.bufferStreamBurstReady(),false,"should hold 3 packets",__LINE__);
+
+    test.it("should send them all once enough are waiting");
+    radio.streamPacketBufferHead = OPENBCI_LOW_POWER_BURST_PACKETS;
+    test.assertBoolean(radio.bufferStreamBurstReady(),true,"should start a burst",__LINE__);
+    radio.streamPacketBufferTail = OPENBCI_LOW_POWER_BURST_PACKETS - 1;
+    radio.streamPacketBufferHead = OPENBCI_LOW_POWER_BURST_PACKETS + 1;
+    test.assertBoolean(radio.bufferStreamBurstReady(),true,"should keep going to the end of the burst",__LINE__);
+
+    test.it("should hold packets that came in during the burst until the wait is over");
+    radio.streamPacketBufferTail = OPENBCI_LOW_POWER_BURST_PACKETS;
+    test.assertBoolean(radio.bufferStreamBurstReady(),false,"should end the burst",__LINE__);
+    radio.lowPowerTimeFirst = millis() - 20;
+    test.assertBoolean(radio.bufferStreamBurstReady(),true,"should send once the wait is over",__LINE__);
+
+    test.it("should count acks close together as one wake");
+    radio.lowPowerReset();
+    radio.lowPowerAck(0);
+    radio.lowPowerAck(0);
+    test.assertEqualInt(radio.lowPowerWakes,1,"should be one wake",__LINE__);
+    test.assertBoolean(radio.lowPowerRadioOnUs >= OPENBCI_LOW_POWER_WAKE_uS + OPENBCI_LOW_POWER_EXCHANGE_uS,true,"should count the radio on",__LINE__);
+    delayMicroseconds(OPENBCI_LOW_POWER_WAKE_GAP_uS + 100);
+    radio.lowPowerAck(0);
+    test.assertEqualInt(radio.lowPowerWakes,2,"should be a second wake",__LINE__);
+
+    test.it("should queue the report when the Host asks for it");
+    msg[1] = (char)OPENBCI_LOW_POWER_REPORT;
+    radio.processDeviceRadioCharData(msg,2);
+    test.assertBoolean(radio.lowPowerReportPending,true,"should want to send the report",__LINE__);
+    test.assertEqualByte(radio.lowPowerWaitMs,20,"should keep the wait",__LINE__);
+
+    test.it("should pass packets through with 0");
+    msg[1] = 0;
+    radio.processDeviceRadioCharData(msg,2);
+    test.assertBoolean(radio.bufferStreamBurstReady(),true,"should send right away",__LINE__);
+
+    radio.bufferStreamReset();
+}
+
+void testProcessDeviceRadioCharDataPollTime() {
+    test.describe("processDeviceRadioCharData - poll time in uS from the Host");
+    char msg[OPENBCI_POLL_TIME_BYTES] = {(char)OPENBCI_POLL_TIME_BYTE_ID, (char)0xEE, 0x02, 0, 0};
+    uint32_t storedPollTime = radio.getPollTime();
+    radio.bufferStreamReset();
+    radio.timeOfLastStream = micros() - (unsigned long)OPENBCI_TIMEOUT_STREAM_ACTIVE_MS * 1000 - 1;
+
+    test.it("should take the poll time and keep it in flash");
+    radio.processDeviceRadioCharData(msg,OPENBCI_POLL_TIME_BYTES);
+    test.assertEqualInt(radio.pollTimeUs,750,"should set the poll time",__LINE__);
+    test.assertEqualInt(radio.getPollTime(),750 | OPENBCI_POLL_TIME_US_FLAG,"should store it in uS",__LINE__);
+    test.assertEqualInt(radio.pollInterval(),750,"should poll that often when quiet",__LINE__);
+
+    test.it("should not poll faster than OPENBCI_POLL_TIME_STREAM_MIN_uS while streaming");
+    radio.streamPacketBufferHead = 1;
+    test.assertEqualInt(radio.pollInterval(),OPENBCI_POLL_TIME_STREAM_MIN_uS,"should wait with packets in the ring",__LINE__);
+    radio.streamPacketBufferHead = 0;
+    radio.timeOfLastStream = micros();
+    test.assertEqualInt(radio.pollInterval(),OPENBCI_POLL_TIME_STREAM_MIN_uS,"should wait right after a stream packet",__LINE__);
+
+    test.it("should not take a poll time under OPENBCI_POLL_TIME_MIN_uS");
+    msg[1] = 0x64;
+    msg[2] = 0;
+    radio.processDeviceRadioCharData(msg,OPENBCI_POLL_TIME_BYTES);
+    test.assertEqualInt(radio.pollTimeUs,750,"should keep the poll time",__LINE__);
+
+    // Put the poll time back
+    radio.flashCommitAdd(OPENBCI_FLASH_COMMIT_POLL_TIME, storedPollTime);
+    radio.lastTimeSerialRead = micros() - (unsigned long)OPENBCI_FLASH_PAGE_ERASE_MS * 1000 - 1;
+    radio.flashCommitProcess();
+    radio.pollTimeApply(storedPollTime);
+    radio.bufferStreamReset();
+}
+
+void testProcessDeviceRadioCharDataLinkState() {
+    test.describe("processDeviceRadioCharData - link state from the Host");
+    char msg[OPENBCI_LINK_STATE_BYTES] = {(char)OPENBCI_LINK_STATE_BYTE_ID, 0x11, 4, 2, 20};
+    radio.streamParityGroup = 0;
+    radio.streamDecimate = 0;
+    radio.lowPowerWaitMs = 0;
+
+    test.it("should take the Host's parity group, decimation and wait");
+    radio.processDeviceRadioCharData(msg,OPENBCI_LINK_STATE_BYTES);
+    test.assertEqualByte(radio.streamParityGroup,4,"should set the parity group",__LINE__);
+    test.assertEqualByte(radio.streamDecimate,2,"should set the decimation",__LINE__);
+    test.assertEqualByte(radio.lowPowerWaitMs,20,"should set the wait",__LINE__);
+    test.assertEqualInt(radio.linkStateMake(),0x14020400,"should leave out the Host's flags",__LINE__);
+
+    test.it("should keep counting when the state is already in place");
+    radio.streamDecimateCount[0] = 1;
+    radio.lowPowerWakes = 3;
+    radio.processDeviceRadioCharData(msg,OPENBCI_LINK_STATE_BYTES);
+    test.assertEqualByte(radio.streamDecimateCount[0],1,"should not start the decimation over",__LINE__);
+    test.assertEqualInt(radio.lowPowerWakes,3,"should not start the counts over",__LINE__);
+
+    test.it("should leave out of bounds settings alone");
+    msg[2] = 1;
+    msg[3] = OPENBCI_STREAM_DECIMATE_MAX + 1;
+    msg[4] = 0;
+    radio.processDeviceRadioCharData(msg,OPENBCI_LINK_STATE_BYTES);
+    test.assertEqualByte(radio.streamParityGroup,4,"should keep the parity group",__LINE__);
+    test.assertEqualByte(radio.streamDecimate,2,"should keep the decimation",__LINE__);
+    test.assertEqualByte(radio.lowPowerWaitMs,0,"should turn low power off",__LINE__);
+
+    radio.linkStateApply(OPENBCI_LINK_STATE_DEFAULT);
+    radio.bufferStreamReset();
+}
+
+void testLinkProcess() {
+    test.describe("linkProcess - finding the Host on the previous channel");
+    uint32_t storedChannel = radio.getChannelNumber();
+    uint32_t otherChannel = (storedChannel + 1) % (RFDUINOGZLL_CHANNEL_LIMIT_UPPER + 1);
+    radio.linkSearching = false;
+
+    test.it("should leave a lost link alone without a previous channel");
+    radio.previousRadioChannel = storedChannel;
+    radio.linkUnacked = true;
+    radio.linkTimeSent = millis() - OPENBCI_TIMEOUT_LINK_LOST_MS - 1;
+    radio.linkProcess();
+    test.assertBoolean(radio.linkSearching,false,"should not look",__LINE__);
+
+    test.it("should try the previous channel once a send goes unacked");
+    radio.previousRadioChannel = otherChannel;
+    radio.linkProcess();
+    test.assertBoolean(radio.linkSearching,true,"should start looking",__LINE__);
+    test.assertEqualInt(RFduinoGZLL.channel,otherChannel,"should move to the previous channel",__LINE__);
+
+    test.it("should go back to the stored channel after a dwell");
+    radio.linkTimeDwell = millis() - OPENBCI_LINK_DWELL_DEVICE_MS;
+    radio.linkProcess();
+    test.assertEqualInt(RFduinoGZLL.channel,storedChannel,"should move back",__LINE__);
+
+    test.it("should keep the previous channel once the Host answers on it");
+    radio.linkTimeDwell = millis() - OPENBCI_LINK_DWELL_DEVICE_MS;
+    radio.linkProcess();
+    radio.linkAck();
+    radio.linkProcess();
+    test.assertBoolean(radio.linkSearching,false,"should stop looking",__LINE__);
+    test.assertEqualInt(radio.getChannelNumber(),otherChannel,"should store the channel the Host is on",__LINE__);
+    test.assertEqualInt(radio.previousRadioChannel,storedChannel,"should keep the old one as previous",__LINE__);
+
+    // Put the channel back
+    radio.flashCommitAdd(OPENBCI_FLASH_COMMIT_CHANNEL, storedChannel);
+    radio.flashCommitProcess();
+    radio.linkSetChannel(storedChannel);
+    radio.previousRadioChannel = storedChannel;
+    radio.linkUnacked = false;
+}
+
+void testProcessRadioCharPageReject() {
+    test.describe("processRadioCharDevice - ORPM_PACKET_PAGE_REJECT");
+    radio.bufferSerialReset(OPENBCI_NUMBER_SERIAL_BUFFERS);
+    radio.lastTimeSerialRead = micros();
+    radio.bufferSerialAddChar('A');
+    delayMicroseconds(3000);
+    radio.bufferSerial.numberOfPacketsSent = 1;
+
+    test.it("should restart the page without blocking and hold the resend on a timer");
+    unsigned long start = micros();
+    test.assertBoolean(radio.processRadioCharDevice((char)ORPM_PACKET_PAGE_REJECT),false,"should not send from the callback",__LINE__);
+    test.assertLessThanInt((int)(micros() - start),1000,"should not block",__LINE__);
+    test.assertEqualByte(radio.bufferSerial.numberOfPacketsSent,0,"should start the page over",__LINE__);
+    test.assertBoolean(radio.timerPending(radio.TIMER_EVENT_PAGE_RETRY),true,"should start the page retry timer",__LINE__);
+    test.assertBoolean(radio.packetToSend(),false,"should hold the page while the timer runs",__LINE__);
+
+    test.it("should allow the resend once the timer runs out");
+    delayMicroseconds(OPENBCI_TIMEOUT_PAGE_RETRY_uS);
+    radio.timerProcess();
+    test.assertBoolean(radio.timerPending(radio.TIMER_EVENT_PAGE_RETRY),false,"should no longer be pending",__LINE__);
+    test.assertBoolean(radio.packetToSend(),true,"should be able to send the page again",__LINE__);
+
+    radio.bufferSerialReset(OPENBCI_NUMBER_SERIAL_BUFFERS);
+}
+
 void testByteIdMakeStreamPacketType() {
     test.describe("byteIdMakeStreamPacketType");
 
@@ -23,16 +23,451 @@ void loop() {
 void go() {
     // Start the test
     test.begin();
+    radio.radioMode = OPENBCI_MODE_HOST;
     radio.bufferSerialReset(OPENBCI_NUMBER_SERIAL_BUFFERS);
     digitalWrite(ledPin, HIGH);
 
     testOutboundBuffer();
     testProcessCommsFailure();
+    testFlashCommit();
+    testBufferSerialAddFramedChar();
+    testCommandFast();
+    testTxQueue();
+    testRxQueue();
+    testRunPost();
+    testBufferStreamDownAddChar();
+    testBufferStreamNack();
+    testBufferStreamParity();
+    testOutput();
+    testBufferStreamFlushBatch();
+    testDecimateSet();
+    testLowPower();
+    testLinkState();
+    testPollTimeUs();
+    testLinkHostQuiet();
 
     digitalWrite(ledPin, LOW);
     test.end();
 }
 
+void flashCommitFlush() {
+    // Make the radio look quiet so the commit goes through
+    radio.packetInTXRadioBuffer = false;
+    radio.lastTimeHostHeardFromDevice = 0;
+    radio.flashCommitProcess();
+}
+
+void testFlashCommit() {
+    test.describe("flashCommit");
+
+    test.it("should not write to flash from add and should read back the pending value");
+    flashCommitFlush();
+    radio.setChannelNumber(2);
+    test.assertBoolean(radio.flashCommitAdd(OPENBCI_FLASH_COMMIT_CHANNEL,7),true,"should queue the channel", __LINE__);
+    test.assertBoolean(radio.flashCommitHasPending(),true,"should have a pending commit", __LINE__);
+    test.assertEqualInt((int)*ADDRESS_OF_PAGE(RFDUINOGZLL_FLASH_MEM_ADDR),2,"should not have touched flash yet", __LINE__);
+    test.assertEqualInt((int)radio.getChannelNumber(),7,"should get the pending channel", __LINE__);
+
+    test.it("should coalesce commits to the same key");
+    test.assertBoolean(radio.flashCommitAdd(OPENBCI_FLASH_COMMIT_CHANNEL,9),true,"should queue the channel", __LINE__);
+    test.assertEqualByte(radio.flashCommitsPending,1,"should only have one entry", __LINE__);
+    test.assertEqualInt((int)radio.getChannelNumber(),9,"should get the newest pending channel", __LINE__);
+
+    test.it("should reject a channel out of bounds");
+    test.assertBoolean(radio.flashCommitAdd(OPENBCI_FLASH_COMMIT_CHANNEL,26),false,"should not queue the channel", __LINE__);
+
+    test.it("should wait for a stream to end");
+    radio.packetInTXRadioBuffer = false;
+    radio.lastTimeHostHeardFromDevice = 0;
+    radio.lastTimeHostHeardStream = millis();
+    test.assertBoolean(radio.flashCommitProcess(),false,"should not commit while streaming", __LINE__);
+    test.assertBoolean(radio.flashCommitHasPending(),true,"should still be pending", __LINE__);
+
+    test.it("should not run an erase into the Device's next poll");
+    radio.lastTimeHostHeardStream = millis() - radio.linkHostQuietMs(false) - 1;
+    radio.lastTimeHostHeardFromDevice = millis() - (radio.pollTimeUs / 1000 - OPENBCI_FLASH_PAGE_ERASE_MS);
+    test.assertBoolean(radio.flashCommitProcess(),false,"should wait for the poll", __LINE__);
+    radio.lastTimeHostHeardFromDevice = millis();
+    test.assertBoolean(radio.flashCommitRadioQuiet(),true,"should go right after a poll", __LINE__);
+
+    test.it("should write channel and poll time with one commit and raise the held message");
+    radio.printMessageToDriverFlag = false;
+    radio.msgToPrint = 25;
+    radio.flashCommitAdd(OPENBCI_FLASH_COMMIT_POLL_TIME,60);
+    radio.flashCommitConfirm(radio.HOST_MESSAGE_CHAN_GET_SUCCESS);
+    test.assertBoolean(radio.printMessageToDriverFlag,false,"should hold the message", __LINE__);
+    radio.lastTimeHostHeardFromDevice = 0;
+    test.assertBoolean(radio.flashCommitProcess(),true,"should commit", __LINE__);
+    test.assertBoolean(radio.flashCommitHasPending(),false,"should empty the queue", __LINE__);
+    test.assertEqualInt((int)*ADDRESS_OF_PAGE(RFDUINOGZLL_FLASH_MEM_ADDR),9,"should have stored the channel", __LINE__);
+    test.assertEqualInt((int)*(ADDRESS_OF_PAGE(RFDUINOGZLL_FLASH_MEM_ADDR) + 1),60,"should have stored the poll time", __LINE__);
+    test.assertEqualByte(radio.msgToPrint,radio.HOST_MESSAGE_CHAN_GET_SUCCESS,"should raise the held message", __LINE__);
+    test.assertBoolean(radio.printMessageToDriverFlag,true,"should set the print flag", __LINE__);
+
+    test.it("should raise the message right away if nothing is pending");
+    radio.printMessageToDriverFlag = false;
+    radio.flashCommitConfirm(radio.HOST_MESSAGE_POLL_TIME);
+    test.assertEqualByte(radio.msgToPrint,radio.HOST_MESSAGE_POLL_TIME,"should raise the message", __LINE__);
+    test.assertBoolean(radio.printMessageToDriverFlag,true,"should set the print flag", __LINE__);
+
+    // Put memory back to default
+    radio.revertToDefaultPollTime();
+}
+
+void testBufferSerialAddFramedChar() {
+    test.describe("bufferSerialAddFramedChar");
+
+    test.it("should turn framing on and off with a private command");
+    radio.bufferSerialReset(OPENBCI_NUMBER_SERIAL_BUFFERS);
+    radio.serialFramingEnabled = false;
+    radio.bufferSerialAddChar((char)OPENBCI_HOST_PRIVATE_CMD_KEY);
+    radio.bufferSerialAddChar((char)OPENBCI_HOST_CMD_FRAMING_ON);
+    test.assertEqualByte(radio.processOutboundBuffer(radio.bufferSerial.packetBuffer),ACTION_RADIO_SEND_NONE,"should not send anything", __LINE__);
+    test.assertBoolean(radio.serialFramingEnabled,true,"should turn framing on", __LINE__);
+    test.assertEqualByte(radio.msgToPrint,radio.HOST_MESSAGE_FRAMING_ON,"should print framing on", __LINE__);
+
+    test.it("should not time out in the middle of a frame");
+    radio.systemUp = false;
+    radio.bufferSerialReset(OPENBCI_NUMBER_SERIAL_BUFFERS);
+    radio.lastTimeSerialRead = micros();
+    test.assertBoolean(radio.bufferSerialAddFramedChar((char)OPENBCI_FRAME_BYTE_START),true,"should take the start byte", __LINE__);
+    test.assertBoolean(radio.bufferSerialAddFramedChar((char)0x03),true,"should take the length low byte", __LINE__);
+    test.assertBoolean(radio.bufferSerialAddFramedChar((char)0x00),true,"should take the length high byte", __LINE__);
+    test.assertBoolean(radio.bufferSerialAddFramedChar('a'),true,"should take the first payload byte", __LINE__);
+    delayMicroseconds(OPENBCI_TIMEOUT_PACKET_NRML_uS + 100);
+    test.assertBoolean(radio.serialWriteTimeOut(),false,"should wait for the rest of the frame", __LINE__);
+
+    test.it("should mark the page ready on the last byte without waiting");
+    radio.bufferSerialAddFramedChar('b');
+    radio.lastTimeSerialRead = micros();
+    radio.bufferSerialAddFramedChar('c');
+    test.assertBoolean(radio.serialWriteTimeOut(),true,"should be ready right away", __LINE__);
+    test.assertEqualByte(radio.bufferSerial.packetBuffer->positionWrite,4,"should have the payload in the serial buffer", __LINE__);
+    test.assertEqualChar(radio.bufferSerial.packetBuffer->data[1],'a',"should not store the header", __LINE__);
+
+    test.it("should reject a frame longer than the serial buffer");
+    radio.bufferSerialReset(OPENBCI_NUMBER_SERIAL_BUFFERS);
+    radio.bufferSerialAddFramedChar((char)OPENBCI_FRAME_BYTE_START);
+    radio.bufferSerialAddFramedChar((char)0xFF);
+    test.assertBoolean(radio.bufferSerialAddFramedChar((char)0xFF),false,"should reject the length", __LINE__);
+    test.assertEqualByte(radio.serialFrameState,radio.FRAME_STATE_IDLE,"should go back to idle", __LINE__);
+
+    radio.serialFramingEnabled = false;
+    radio.bufferSerialReset(OPENBCI_NUMBER_SERIAL_BUFFERS);
+}
+
+void testCommandFast() {
+    test.describe("commandFastAdd");
+    radio.bufferSerialReset(OPENBCI_NUMBER_SERIAL_BUFFERS);
+    radio.txQueueReset();
+    radio.serialFramingEnabled = false;
+    radio.systemUp = true;
+    radio.lastTimeSerialRead = micros();
+    delayMicroseconds(OPENBCI_TIMEOUT_PACKET_NRML_uS + 100);
+
+    test.it("should not take a command when not streaming");
+    radio.lastTimeHostHeardStream = 0;
+    test.assertBoolean(radio.commandFastAdd('s'),false,"should use the serial buffer", __LINE__);
+
+    test.it("should queue a lone command while streaming");
+    radio.lastTimeHostHeardStream = millis();
+    test.assertBoolean(radio.commandFastAdd((char)OPENBCI_HOST_PRIVATE_CMD_KEY),false,"should not take a private command", __LINE__);
+    test.assertBoolean(radio.commandFastAdd('s'),true,"should take the command", __LINE__);
+    test.assertEqualByte(radio.txQueueCount,1,"should add to the TX queue", __LINE__);
+    test.assertEqualByte(radio.txQueue[0].priority,radio.TX_PRIORITY_COMMAND,"should queue as a command", __LINE__);
+    test.assertEqualByte(radio.txQueue[0].data[0],OPENBCI_COMMAND_FAST_BYTE_ID,"should set the fast byteId", __LINE__);
+    test.assertEqualChar(radio.txQueue[0].data[1],'s',"should store the command", __LINE__);
+
+    test.it("should not take a command behind a page in the serial buffer");
+    radio.bufferSerialAddChar('x');
+    test.assertBoolean(radio.commandFastAdd('s'),false,"should keep the bytes in order", __LINE__);
+
+    radio.lastTimeHostHeardStream = 0;
+    radio.systemUp = false;
+    radio.txQueueReset();
+    radio.bufferSerialReset(OPENBCI_NUMBER_SERIAL_BUFFERS);
+}
+
+void testTxQueue() {
+    test.describe("txQueueSendToDevice");
+    char page[3];
+    page[0] = 0x00;
+    page[1] = 'a';
+    page[2] = 'b';
+    radio.txQueueReset();
+    radio.timerActive[radio.TIMER_EVENT_PAGE_RETRY] = false;
+    radio.packetInTXRadioBuffer = false;
+
+    test.it("should send nothing from an empty queue");
+    test.assertBoolean(radio.txQueueSendToDevice(DEVICE0),false,"should let a page go", __LINE__);
+
+    test.it("should send a lone message as is");
+    radio.singleCharMsg[0] = (char)ORPM_GET_POLL_TIME;
+    radio.txQueueAdd(radio.singleCharMsg,1,radio.TX_PRIORITY_CONTROL);
+    test.assertBoolean(radio.txQueueSendToDevice(DEVICE0),true,"should send", __LINE__);
+    test.assertBoolean(radio.packetInTXRadioBuffer,true,"should mark the TX buffer", __LINE__);
+    test.assertEqualByte(radio.txQueueCount,0,"should drop a sent control message", __LINE__);
+
+    test.it("should pack several messages in one ack with control first");
+    radio.txQueueAdd(page,3,radio.TX_PRIORITY_COMMAND);
+    radio.txQueueAdd(radio.singleCharMsg,1,radio.TX_PRIORITY_CONTROL);
+    radio.txQueueAdd(page,3,radio.TX_PRIORITY_COMMAND);
+    test.assertBoolean(radio.txQueueSendToDevice(DEVICE0),true,"should send", __LINE__);
+    test.assertEqualByte(radio.txQueueMsg[0],OPENBCI_TX_QUEUE_BYTE_ID,"should set the queue byteId", __LINE__);
+    test.assertEqualByte(radio.txQueueMsg[1],1,"should put the control message length first", __LINE__);
+    test.assertEqualByte(radio.txQueueMsg[2],ORPM_GET_POLL_TIME,"should put the control message first", __LINE__);
+    test.assertEqualByte(radio.txQueueMsg[3],3,"should put the page length next", __LINE__);
+    test.assertEqualChar(radio.txQueueMsg[5],'a',"should copy the page", __LINE__);
+    test.assertEqualByte(radio.txQueueCount,2,"should hold the commands until the next packet", __LINE__);
+
+    test.it("should send the commands again after a reject");
+    radio.txQueueRetry();
+    radio.timerStart(radio.TIMER_EVENT_PAGE_RETRY, OPENBCI_TIMEOUT_PAGE_RETRY_uS);
+    test.assertBoolean(radio.txQueueSendToDevice(DEVICE0),true,"should hold a page while the retry timer runs", __LINE__);
+    test.assertEqualByte(radio.txQueue[0].sent,false,"should not send while the retry timer runs", __LINE__);
+    radio.timerActive[radio.TIMER_EVENT_PAGE_RETRY] = false;
+    radio.txQueueSendToDevice(DEVICE0);
+    test.assertEqualByte(radio.txQueue[0].sent,true,"should send once the timer is done", __LINE__);
+
+    test.it("should drop the commands once the next packet comes in");
+    test.assertBoolean(radio.txQueueSendToDevice(DEVICE0),false,"should let a page go", __LINE__);
+    test.assertEqualByte(radio.txQueueCount,0,"should empty the queue", __LINE__);
+
+    radio.packetInTXRadioBuffer = false;
+}
+
+void testBufferStreamDownAddChar() {
+    test.describe("bufferStreamDownAddChar");
+    radio.bufferSerialReset(OPENBCI_NUMBER_SERIAL_BUFFERS);
+    radio.txQueueReset();
+    radio.serialFrameState = radio.FRAME_STATE_IDLE;
+
+    test.it("should turn the stream to the Device on with a private command");
+    radio.bufferSerialAddChar((char)OPENBCI_HOST_PRIVATE_CMD_KEY);
+    radio.bufferSerialAddChar((char)OPENBCI_HOST_CMD_STREAM_DOWN_ON);
+    test.assertEqualByte(radio.processOutboundBuffer(radio.bufferSerial.packetBuffer),ACTION_RADIO_SEND_NONE,"should not send anything", __LINE__);
+    test.assertBoolean(radio.streamDownEnabled,true,"should turn the stream on", __LINE__);
+
+    test.it("should queue a stream packet the moment the stop byte is in");
+    test.assertBoolean(radio.bufferStreamDownAddChar('s'),false,"should leave a command alone", __LINE__);
+    test.assertBoolean(radio.bufferStreamDownAddChar((char)OPENBCI_STREAM_BYTE_START),true,"should take the start byte", __LINE__);
+    for (int i = 0; i < OPENBCI_MAX_DATA_BYTES_IN_PACKET; i++) {
+        radio.bufferStreamDownAddChar((char)i);
+    }
+    test.assertEqualByte(radio.txQueueCount,0,"should wait for the stop byte", __LINE__);
+    test.assertBoolean(radio.serialWriteTimeOut(),false,"should not let a page go mid packet", __LINE__);
+    test.assertBoolean(radio.bufferStreamDownAddChar((char)0xC3),true,"should take the stop byte", __LINE__);
+    test.assertEqualByte(radio.txQueueCount,1,"should queue the packet", __LINE__);
+    test.assertEqualByte(radio.txQueue[0].priority,radio.TX_PRIORITY_STREAM,"should go ahead of everything else", __LINE__);
+    test.assertEqualByte(radio.txQueue[0].length,OPENBCI_MAX_PACKET_SIZE_BYTES,"should be a full packet", __LINE__);
+    test.assertEqualByte(radio.txQueue[0].data[0],0x98,"should set the stream bit and packet type", __LINE__);
+    test.assertEqualByte(radio.txQueue[0].data[31],30,"should copy the data", __LINE__);
+
+    test.it("should drop a packet without a stop byte");
+    radio.txQueueReset();
+    radio.bufferStreamDownAddChar((char)OPENBCI_STREAM_BYTE_START);
+    for (int i = 0; i <= OPENBCI_MAX_DATA_BYTES_IN_PACKET; i++) {
+        radio.bufferStreamDownAddChar('a');
+    }
+    test.assertEqualByte(radio.txQueueCount,0,"should not queue the packet", __LINE__);
+
+    radio.streamDownEnabled = false;
+    radio.bufferSerialReset(OPENBCI_NUMBER_SERIAL_BUFFERS);
+}
+
+void testRxQueue() {
+    test.describe("rxQueueProcess - stream packets from the radio callback");
+    radio.bufferStreamReset();
+    radio.txQueueReset();
+    radio.packetInTXRadioBuffer = false;
+    char data[OPENBCI_MAX_PACKET_SIZE_BYTES];
+    data[0] = radio.byteIdMake(true,0,data + 1,OPENBCI_MAX_DATA_BYTES_IN_PACKET);
+    for (int i = 2; i < OPENBCI_MAX_PACKET_SIZE_BYTES; i++) {
+        data[i] = (char)i;
+    }
+
+    test.it("should only copy a stream packet in the callback");
+    data[1] = 20;
+    radio.processHostRadioCharData(DEVICE0,data,OPENBCI_MAX_PACKET_SIZE_BYTES);
+    test.assertEqualByte(radio.streamPacketBufferHead,0,"should not touch the ring",__LINE__);
+    test.assertEqualByte((uint8_t)(radio.rxQueueHead - radio.rxQueueTail),1,"should queue the packet",__LINE__);
+
+    test.it("should put it in the ring from loop()");
+    test.assertBoolean(radio.rxQueueProcess(),true,"should handle the packet",__LINE__);
+    test.assertEqualByte(radio.streamPacketBufferHead,1,"should add the packet",__LINE__);
+    test.assertEqualByte(radio.streamPacketBuffer->data[0],20,"should store the sample number",__LINE__);
+    test.assertBoolean(radio.rxQueueProcess(),false,"should have nothing left",__LINE__);
+
+    test.it("should send a NACK made in loop() on the next ack");
+    data[1] = 22;
+    radio.processHostRadioCharData(DEVICE0,data,OPENBCI_MAX_PACKET_SIZE_BYTES);
+    radio.rxQueueProcess();
+    test.assertBoolean(radio.packetInTXRadioBuffer,true,"should send the NACK",__LINE__);
+    test.assertEqualByte(radio.txQueueCount,0,"should drop the sent NACK",__LINE__);
+
+    test.it("should drop the newest, not touch the ring, when loop() falls behind");
+    radio.bufferStreamReset();
+    radio.txQueueReset();
+    radio.packetInTXRadioBuffer = false;
+    for (int i = 0; i <= OPENBCI_NUMBER_RX_QUEUE; i++) {
+        data[1] = 30 + i;
+        test.assertBoolean(radio.rxQueueAdd(data,OPENBCI_MAX_PACKET_SIZE_BYTES),true,"should take the packet",__LINE__);
+    }
+    test.assertEqualByte((uint8_t)(radio.rxQueueHead - radio.rxQueueTail),OPENBCI_NUMBER_RX_QUEUE,"should stay full",__LINE__);
+    test.assertEqualByte(radio.streamPacketBufferHead,0,"should not touch the ring",__LINE__);
+    radio.rxQueueProcess();
+    test.assertEqualByte(radio.streamPacketBufferHead,OPENBCI_NUMBER_RX_QUEUE,"should add the queued ones in order",__LINE__);
+    test.assertEqualByte((radio.streamPacketBuffer + OPENBCI_NUMBER_RX_QUEUE - 1)->data[0],30 + OPENBCI_NUMBER_RX_QUEUE - 1,"should keep the order",__LINE__);
+
+    test.it("should NACK the dropped packet like one lost on the air");
+    data[1] = 30 + OPENBCI_NUMBER_RX_QUEUE + 1;
+    radio.rxQueueAdd(data,OPENBCI_MAX_PACKET_SIZE_BYTES);
+    radio.rxQueueProcess();
+    test.assertEqualByte((radio.streamPacketBuffer + OPENBCI_NUMBER_RX_QUEUE)->state,radio.STREAM_STATE_MISSING,"should hold its place",__LINE__);
+    test.assertBoolean(radio.packetInTXRadioBuffer,true,"should send the NACK",__LINE__);
+
+    radio.bufferStreamReset();
+    radio.txQueueReset();
+    radio.packetInTXRadioBuffer = false;
+}
+
+void testRunPost() {
+    test.describe("runPost - work for run() to do");
+    radio.bufferStreamReset();
+    radio.runTake(radio.RUN_WORK_ALL);
+    char data[OPENBCI_MAX_PACKET_SIZE_BYTES];
+    data[0] = radio.byteIdMake(true,0,data + 1,OPENBCI_MAX_DATA_BYTES_IN_PACKET);
+    data[1] = 40;
+
+    test.it("should post a packet from the radio callback");
+    radio.processHostRadioCharData(DEVICE0,data,OPENBCI_MAX_PACKET_SIZE_BYTES);
+    test.assertEqualByte(radio.runPending,radio.RUN_WORK_RX,"should post only the rx queue",__LINE__);
+    test.assertBoolean(radio.runTake(radio.RUN_WORK_RX),true,"should take it",__LINE__);
+    test.assertBoolean(radio.runTake(radio.RUN_WORK_RX),false,"should take it once",__LINE__);
+
+    test.it("should post the stream once the packet is in the ring");
+    radio.rxQueueProcess();
+    test.assertEqualByte(radio.runPending & radio.RUN_WORK_STREAM,radio.RUN_WORK_STREAM,"should post the stream",__LINE__);
+
+    test.it("should post timers and flash commits");
+    radio.runTake(radio.RUN_WORK_ALL);
+    radio.timerStart(radio.TIMER_EVENT_PAGE_RETRY,OPENBCI_TIMEOUT_PAGE_RETRY_uS);
+    test.assertEqualByte(radio.runPending,radio.RUN_WORK_TIMER,"should post the timer",__LINE__);
+    radio.flashCommitAdd(OPENBCI_FLASH_COMMIT_POLL_TIME,radio.getPollTime());
+    test.assertEqualByte(radio.runPending,radio.RUN_WORK_TIMER | radio.RUN_WORK_FLASH,"should post the flash commit",__LINE__);
+
+    test.it("should add to the posts from loop()");
+    radio.runPostFromLoop(radio.RUN_WORK_OUTPUT);
+    test.assertEqualByte(radio.runPending,radio.RUN_WORK_TIMER | radio.RUN_WORK_FLASH | radio.RUN_WORK_OUTPUT,"should keep the others",__LINE__);
+
+    radio.timerActive[radio.TIMER_EVENT_PAGE_RETRY] = false;
+    flashCommitFlush();
+    radio.bufferStreamReset();
+    radio.txQueueReset();
+    radio.packetInTXRadioBuffer = false;
+    radio.runPost(radio.RUN_WORK_ALL);
+}
+
+void testBufferStreamNack() {
+    test.describe("bufferStreamAddData - gaps in the sample numbers");
+    radio.bufferStreamReset();
+    radio.txQueueReset();
+    char data[OPENBCI_MAX_PACKET_SIZE_BYTES];
+    data[0] = radio.byteIdMake(true,0,data + 1,OPENBCI_MAX_DATA_BYTES_IN_PACKET);
+    for (int i = 2; i < OPENBCI_MAX_PACKET_SIZE_BYTES; i++) {
+        data[i] = (char)i;
+    }
+
+    test.it("should hold a place for a missing packet and ask for it");
+    data[1] = 10;
+    radio.bufferStreamAddData(data);
+    data[1] = 12;
+    radio.bufferStreamAddData(data);
+    test.assertEqualByte(radio.streamPacketBufferHead,3,"should add the packet behind the place",__LINE__);
+    test.assertEqualByte((radio.streamPacketBuffer + 1)->state,radio.STREAM_STATE_MISSING,"should mark the place missing",__LINE__);
+    test.assertEqualByte(radio.txQueueCount,1,"should queue a NACK",__LINE__);
+    test.assertEqualByte(radio.txQueue[0].data[0],OPENBCI_STREAM_NACK_BYTE_ID,"should be a NACK",__LINE__);
+    test.assertEqualByte(radio.txQueue[0].data[1],11,"should ask for the missing sample",__LINE__);
+
+    test.it("should put the resent packet in its place");
+    data[1] = 11;
+    test.assertBoolean(radio.bufferStreamAddData(data),true,"should take the packet",__LINE__);
+    test.assertEqualByte(radio.streamPacketBufferHead,3,"should not move the head",__LINE__);
+    test.assertEqualByte((radio.streamPacketBuffer + 1)->state,radio.STREAM_STATE_READY,"should be ready to flush",__LINE__);
+    test.assertEqualByte((radio.streamPacketBuffer + 1)->data[0],11,"should store the packet",__LINE__);
+    test.assertBoolean(radio.bufferStreamAddData(data),false,"should drop a duplicate",__LINE__);
+
+    test.it("should skip places that were never filled");
+    data[1] = 15;
+    radio.bufferStreamAddData(data);
+    radio.streamPacketBufferTail = 3;
+    radio.bufferStreamSkipMissing();
+    test.assertEqualByte(radio.streamPacketBufferTail,5,"should move the tail past both places",__LINE__);
+
+    radio.bufferStreamReset();
+    radio.txQueueReset();
+}
+
+void testBufferStreamParity() {
+    test.describe("bufferStreamParityCheck");
+    radio.bufferStreamReset();
+    radio.streamParityGroup = 2;
+    radio.streamParityRecovered = 0;
+    radio.streamParityLost = 0;
+    char first[OPENBCI_MAX_PACKET_SIZE_BYTES];
+    char second[OPENBCI_MAX_PACKET_SIZE_BYTES];
+    char parity[OPENBCI_MAX_PACKET_SIZE_BYTES];
+    first[0] = radio.byteIdMake(true,0,first + 1,OPENBCI_MAX_DATA_BYTES_IN_PACKET);
+    second[0] = first[0];
+    first[1] = 20;
+    second[1] = 21;
+    for (int i = 2; i < OPENBCI_MAX_PACKET_SIZE_BYTES; i++) {
+        first[i] = (char)i;
+        second[i] = (char)(i * 3);
+    }
+    for (int i = 1; i < OPENBCI_MAX_PACKET_SIZE_BYTES; i++) {
+        parity[i] = first[i] ^ second[i];
+    }
+    parity[0] = radio.byteIdMake(true,OPENBCI_STREAM_PACKET_TYPE_PARITY,parity + 1,OPENBCI_MAX_DATA_BYTES_IN_PACKET) | 0x01;
+
+    test.it("should rebuild the one missing packet of a group");
+    radio.bufferStreamAddData(first);
+    test.assertBoolean(radio.bufferStreamAddData(parity),true,"should rebuild the packet",__LINE__);
+    test.assertEqualByte(radio.streamPacketBufferHead,2,"should add the rebuilt packet",__LINE__);
+    test.assertEqualBuffer((radio.streamPacketBuffer + 1)->data,second + 1,OPENBCI_MAX_DATA_BYTES_IN_PACKET,"should match the lost packet",__LINE__);
+    test.assertEqualByte(radio.streamParityRecovered,1,"should count it as recovered",__LINE__);
+
+    test.it("should count packets it can't rebuild");
+    parity[0] = radio.byteIdMake(true,OPENBCI_STREAM_PACKET_TYPE_PARITY,parity + 1,OPENBCI_MAX_DATA_BYTES_IN_PACKET) | 0x02;
+    first[1] = 22;
+    radio.bufferStreamAddData(first);
+    test.assertBoolean(radio.bufferStreamAddData(parity),false,"should not rebuild",__LINE__);
+    test.assertEqualByte(radio.streamParityLost,2,"should count both as lost",__LINE__);
+    test.assertEqualByte(radio.streamParityCount,0,"should start a new group",__LINE__);
+
+    test.it("should end a group at its sample number when its parity packet is lost");
+    radio.bufferStreamReset();
+    radio.streamParityRecovered = 0;
+    radio.streamParityLost = 0;
+    first[1] = 30;
+    radio.bufferStreamAddData(first);
+    first[1] = 32;
+    second[1] = 33;
+    radio.bufferStreamAddData(first);
+    test.assertEqualByte(radio.streamParityLost,1,"should count the packet the group can't get back",__LINE__);
+    test.assertEqualByte(radio.streamParityCount,1,"should start the next group with this packet",__LINE__);
+    test.assertEqualByte(radio.streamParityFirst,32,"should start the next group on its boundary",__LINE__);
+    for (int i = 1; i < OPENBCI_MAX_PACKET_SIZE_BYTES; i++) {
+        parity[i] = first[i] ^ second[i];
+    }
+    parity[0] = radio.byteIdMake(true,OPENBCI_STREAM_PACKET_TYPE_PARITY,parity + 1,OPENBCI_MAX_DATA_BYTES_IN_PACKET) | 0x01;
+    test.assertBoolean(radio.bufferStreamAddData(parity),true,"should still rebuild from the next group's parity",__LINE__);
+    test.assertEqualByte(radio.streamParityRecovered,1,"should count it as recovered",__LINE__);
+
+    radio.streamParityGroup = 0;
+    radio.bufferStreamReset();
+}
+
 void testProcessCommsFailure() {
     test.describe("bufferSerialProcessCommsFailure");
     uint32_t prevChannelNumber = 2;
@@ -173,6 +608,9 @@ void testProcessCommsFailure() {
     test.assertEqualByte(radio.bufferSerial.packetBuffer->positionWrite,4,"should have the position write to 4",__LINE__);
     radio.bufferSerialProcessCommsFailure();
     test.assertEqualInt((int)radio.radioChannel, newChannelNumber,"should capture new radio channel number", __LINE__);
+    test.assertBoolean(radio.flashCommitHasPending(),true,"should queue the channel for a flash commit", __LINE__);
+    test.assertEqualByte(radio.flashCommitMsgToPrint,radio.HOST_MESSAGE_CHAN_OVERRIDE, "should hold the override message until the commit", __LINE__);
+    flashCommitFlush();
     test.assertEqualByte(radio.msgToPrint,radio.HOST_MESSAGE_CHAN_OVERRIDE, "should change message to print to host channel override", __LINE__);
     test.assertBoolean(radio.printMessageToDriverFlag,true,"should change the print flag to true", __LINE__);
     test.assertEqualInt(radio.bufferSerial.packetBuffer->positionWrite,0x01, "should reset serial buffer", __LINE__);
@@ -219,6 +657,55 @@ void testOutboundBuffer() {
     testProcessOutboundBufferForTimeSync();
     testProcessOutboundBufferCharDouble();
     testProcessOutboundBufferCharTriple();
+    testHostCommand();
+}
+
+void testHostCommand() {
+    test.describe("hostCommandDispatch - the private command table");
+    radio.bufferSerialReset(OPENBCI_NUMBER_SERIAL_BUFFERS);
+    radio.systemUp = true;
+    char *page = radio.bufferSerial.packetBuffer->data;
+    page[OPENBCI_HOST_PRIVATE_POS_KEY] = (char)OPENBCI_HOST_PRIVATE_CMD_KEY;
+
+    test.it("should keep the table in flash with a row per built in command");
+    test.assertBoolean(radio.hostCommands[OPENBCI_HOST_CMD_POLL_TIME_SET_US].handler == &OpenBCI_Radios_Class::hostCommandPollTimeSetUs,true,"should index the row by code",__LINE__);
+    test.assertEqualInt(radio.hostCommands[OPENBCI_HOST_CMD_POLL_TIME_SET_US].payloadLength,4,"should take a four byte payload",__LINE__);
+    test.assertBoolean(radio.hostCommands[OPENBCI_HOST_CMD_TABLE_SIZE - 1].handler == NULL,true,"should leave codes past the last row empty",__LINE__);
+
+    test.it("should run a command with a multi byte payload");
+    page[OPENBCI_HOST_PRIVATE_POS_CODE] = (char)OPENBCI_HOST_CMD_POLL_TIME_SET_US;
+    page[OPENBCI_HOST_PRIVATE_POS_PAYLOAD] = 0x78;
+    page[OPENBCI_HOST_PRIVATE_POS_PAYLOAD + 1] = 0x56;
+    page[OPENBCI_HOST_PRIVATE_POS_PAYLOAD + 2] = 0x34;
+    page[OPENBCI_HOST_PRIVATE_POS_PAYLOAD + 3] = 0x12;
+    test.assertEqualInt(radio.hostCommandPayload(page,4),0x12345678,"should read the payload least significant byte first",__LINE__);
+    test.assertEqualInt(radio.hostCommandPayload(page,2),0x5678,"should read a two byte payload",__LINE__);
+    radio.printMessageToDriverFlag = false;
+    radio.bufferSerial.packetBuffer->positionWrite = OPENBCI_HOST_PRIVATE_POS_PAYLOAD + 4;
+    test.assertEqualByte(radio.processOutboundBuffer(radio.bufferSerial.packetBuffer),ACTION_RADIO_SEND_NONE,"should be handled on the Host",__LINE__);
+    test.assertEqualByte(radio.msgToPrint,radio.HOST_MESSAGE_POLL_TIME_VERIFY,"should run the handler",__LINE__);
+    test.assertEqualInt(radio.bufferSerial.packetBuffer->positionWrite,0x01,"should clear the serial buffer",__LINE__);
+
+    test.it("should send a page with the wrong payload length to the Device");
+    radio.printMessageToDriverFlag = false;
+    radio.bufferSerial.packetBuffer->positionWrite = OPENBCI_HOST_PRIVATE_POS_PAYLOAD + 2;
+    test.assertEqualByte(radio.processOutboundBuffer(radio.bufferSerial.packetBuffer),ACTION_RADIO_SEND_NORMAL,"should send it like normal",__LINE__);
+    test.assertBoolean(radio.printMessageToDriverFlag,false,"should not print",__LINE__);
+
+    test.it("should send a code without a row to the Device");
+    page[OPENBCI_HOST_PRIVATE_POS_CODE] = (char)(OPENBCI_HOST_CMD_TABLE_SIZE - 1);
+    radio.bufferSerial.packetBuffer->positionWrite = OPENBCI_HOST_PRIVATE_POS_PAYLOAD + 4;
+    test.assertEqualByte(radio.processOutboundBuffer(radio.bufferSerial.packetBuffer),ACTION_RADIO_SEND_NORMAL,"should send it like normal",__LINE__);
+
+    test.it("should answer comms down for a command that needs the link");
+    page[OPENBCI_HOST_PRIVATE_POS_CODE] = (char)OPENBCI_HOST_CMD_POLL_TIME_SET_US;
+    radio.systemUp = false;
+    radio.bufferSerial.packetBuffer->positionWrite = OPENBCI_HOST_PRIVATE_POS_PAYLOAD + 4;
+    test.assertEqualByte(radio.processOutboundBuffer(radio.bufferSerial.packetBuffer),ACTION_RADIO_SEND_NONE,"should not send",__LINE__);
+    test.assertEqualByte(radio.msgToPrint,radio.HOST_MESSAGE_COMMS_DOWN,"should print comms down",__LINE__);
+
+    radio.bufferSerialReset(OPENBCI_NUMBER_SERIAL_BUFFERS);
+    radio.printMessageToDriverFlag = false;
 }
 
 void testProcessOutboundBuffer() {
@@ -370,6 +857,7 @@ void testProcessOutboundBufferCharDouble() {
     testProcessOutboundBufferCharDouble_OPENBCI_HOST_CMD_BAUD_FAST();
     testProcessOutboundBufferCharDouble_OPENBCI_HOST_CMD_SYS_UP();
     testProcessOutboundBufferCharDouble_OPENBCI_HOST_CMD_POLL_TIME_GET();
+    testProcessOutboundBufferCharDouble_OPENBCI_HOST_CMD_TRACE_DUMP();
     testProcessOutboundBufferCharDouble_default();
 
 }
@@ -515,6 +1003,20 @@ void testProcessOutboundBufferCharDouble_OPENBCI_HOST_CMD_POLL_TIME_GET() {
 
 }
 
+void testProcessOutboundBufferCharDouble_OPENBCI_HOST_CMD_TRACE_DUMP() {
+    test.it("should return to print the trace and clear the serial buffer");
+    radio.systemUp = false;
+    radio.printMessageToDriverFlag = false;
+    radio.msgToPrint = 25;
+    radio.bufferSerial.packetBuffer->data[1] = (char)OPENBCI_HOST_PRIVATE_CMD_KEY;
+    radio.bufferSerial.packetBuffer->data[2] = (char)OPENBCI_HOST_CMD_TRACE_DUMP;
+    radio.bufferSerial.packetBuffer->positionWrite = 3;
+    test.assertEqualByte(radio.processOutboundBufferCharDouble(radio.bufferSerial.packetBuffer->data),ACTION_RADIO_SEND_NONE, "should not send any message", __LINE__);
+    test.assertEqualByte(radio.msgToPrint,radio.HOST_MESSAGE_TRACE, "should get the trace message code", __LINE__);
+    test.assertBoolean(radio.printMessageToDriverFlag,true,"sets the print flag to high", __LINE__);
+    test.assertEqualInt(radio.bufferSerial.packetBuffer->positionWrite,0x01, "should set position to 1", __LINE__);
+}
+
 void testProcessOutboundBufferCharDouble_default() {
     test.it("should do nothing if system is up");
     radio.systemUp = true;
@@ -674,6 +1176,9 @@ void testProcessOutboundBufferCharTriple_OPENBCI_HOST_CMD_CHANNEL_SET_OVERIDE()
     radio.previousRadioChannel = 0x30;
     test.assertEqualByte(radio.processOutboundBufferCharTriple(radio.bufferSerial.packetBuffer->data),ACTION_RADIO_SEND_NONE,"should send a private radio message", __LINE__);
     test.assertEqualInt((int)radio.radioChannel, newChannelNumber,"should capture new radio channel number", __LINE__);
+    test.assertBoolean(radio.flashCommitHasPending(),true,"should queue the channel for a flash commit", __LINE__);
+    test.assertEqualByte(radio.flashCommitMsgToPrint,radio.HOST_MESSAGE_CHAN_OVERRIDE, "should hold the override message until the commit", __LINE__);
+    flashCommitFlush();
     test.assertEqualByte(radio.msgToPrint,radio.HOST_MESSAGE_CHAN_OVERRIDE, "should change message to print to host channel override", __LINE__);
     test.assertBoolean(radio.printMessageToDriverFlag,true,"should change the print flag to true", __LINE__);
     test.assertEqualInt(radio.bufferSerial.packetBuffer->positionWrite,0x01, "should reset the write position to 1", __LINE__);
@@ -706,6 +1211,9 @@ void testProcessOutboundBufferCharTriple_OPENBCI_HOST_CMD_CHANNEL_SET_OVERIDE()
     radio.previousRadioChannel = 0x30;
     test.assertEqualByte(radio.processOutboundBufferCharTriple(radio.bufferSerial.packetBuffer->data),ACTION_RADIO_SEND_NONE,"should send a private radio message", __LINE__);
     test.assertEqualInt((int)radio.radioChannel, newChannelNumber,"should capture new radio channel number", __LINE__);
+    test.assertBoolean(radio.flashCommitHasPending(),true,"should queue the channel for a flash commit", __LINE__);
+    test.assertEqualByte(radio.flashCommitMsgToPrint,radio.HOST_MESSAGE_CHAN_OVERRIDE, "should hold the override message until the commit", __LINE__);
+    flashCommitFlush();
     test.assertEqualByte(radio.msgToPrint,radio.HOST_MESSAGE_CHAN_OVERRIDE, "should change message to print to host channel override", __LINE__);
     test.assertBoolean(radio.printMessageToDriverFlag,true,"should change the print flag to true", __LINE__);
     test.assertEqualInt(radio.bufferSerial.packetBuffer->positionWrite,0x01, "should reset the write position to 1", __LINE__);
@@ -836,3 +1344,344 @@ void testProcessOutboundBufferCharDoubleNormal() {
     // Will a single message be sent?
     test.assertEqualByte(actualRadioAction,ACTION_RADIO_SEND_NORMAL, "Radio will send normal msg", __LINE__);
 }
+
+void testOutput() {
+    test.describe("outputAdd - staging for the driver");
+    char data[OPENBCI_MAX_PACKET_SIZE_BYTES];
+    data[0] = radio.byteIdMake(true,0,data + 1,OPENBCI_MAX_DATA_BYTES_IN_PACKET);
+    for (int i = 1; i < OPENBCI_MAX_PACKET_SIZE_BYTES; i++) {
+        data[i] = (char)i;
+    }
+    radio.outputPositionRead = radio.outputPositionWrite;
+    radio.bufferStreamReset();
+
+    test.it("should stage a message and a number whole");
+    radio.outputPrint("Poll time: ");
+    radio.outputPrintNumber(80);
+    test.assertEqualInt(radio.outputFree(),OPENBCI_OUTPUT_BUFFER_LENGTH - 13,"should take all of it", __LINE__);
+    test.assertEqualChar(radio.outputBuffer[(radio.outputPositionWrite - 2) & (OPENBCI_OUTPUT_BUFFER_LENGTH - 1)],'8',"should write the number in decimal", __LINE__);
+
+    test.it("should not take part of a frame");
+    radio.outputPositionWrite = radio.outputPositionRead + OPENBCI_OUTPUT_BUFFER_LENGTH - 10;
+    test.assertBoolean(radio.outputAdd(data,OPENBCI_MAX_PACKET_SIZE_BYTES),false,"should refuse the frame", __LINE__);
+    test.assertEqualInt(radio.outputFree(),10,"should leave the output alone", __LINE__);
+
+    test.it("should hold a stream packet in the ring until there is room");
+    radio.bufferStreamAddData(data);
+    radio.bufferStreamFlushBuffers();
+    test.assertEqualByte(radio.streamPacketBufferTail,0,"should not move the tail", __LINE__);
+    radio.outputPositionRead = radio.outputPositionWrite;
+    radio.bufferStreamFlushBuffers();
+    test.assertEqualByte(radio.streamPacketBufferTail,1,"should flush the packet", __LINE__);
+    test.assertEqualByte(radio.outputBuffer[radio.outputPositionRead & (OPENBCI_OUTPUT_BUFFER_LENGTH - 1)],0xA0,"should start with the head byte", __LINE__);
+    test.assertEqualInt(radio.outputFree(),OPENBCI_OUTPUT_BUFFER_LENGTH - OPENBCI_MAX_PACKET_SIZE_STREAM_BYTES,"should stage the whole packet", __LINE__);
+
+    test.it("should not print from the radio callback");
+    radio.printMessageToDriverFlag = false;
+    radio.processRadioCharHost((char)ORPM_DEVICE_SERIAL_OVERFLOW);
+    test.assertBoolean(radio.printMessageToDriverFlag,true,"should set the print flag", __LINE__);
+    test.assertEqualByte(radio.msgToPrint,radio.HOST_MESSAGE_BOARD_OVERFLOW,"should print the overflow from loop()", __LINE__);
+
+    radio.printMessageToDriverFlag = false;
+    radio.packetInTXRadioBuffer = false;
+    radio.outputPositionRead = radio.outputPositionWrite;
+    radio.bufferStreamReset();
+}
+
+void testBufferStreamFlushBatch() {
+    test.describe("bufferStreamFlushBatch");
+    char data[OPENBCI_MAX_PACKET_SIZE_BYTES];
+    data[0] = radio.byteIdMake(true,0,data + 1,OPENBCI_MAX_DATA_BYTES_IN_PACKET);
+    for (int i = 2; i < OPENBCI_MAX_PACKET_SIZE_BYTES; i++) {
+        data[i] = (char)i;
+    }
+    // Start at the front of the output so the batch is in one piece
+    radio.outputPositionRead = 0;
+    radio.outputPositionWrite = 0;
+    radio.bufferStreamReset();
+
+    test.it("should turn batching on with a private command");
+    radio.bufferSerialReset(OPENBCI_NUMBER_SERIAL_BUFFERS);
+    radio.bufferSerialAddChar((char)OPENBCI_HOST_PRIVATE_CMD_KEY);
+    radio.bufferSerialAddChar((char)OPENBCI_HOST_CMD_BATCH_ON);
+    test.assertEqualByte(radio.processOutboundBuffer(radio.bufferSerial.packetBuffer),ACTION_RADIO_SEND_NONE,"should not send anything", __LINE__);
+    test.assertBoolean(radio.outputBatchEnabled,true,"should turn batching on", __LINE__);
+    test.assertEqualByte(radio.msgToPrint,radio.HOST_MESSAGE_BATCH_ON,"should print batching on", __LINE__);
+
+    test.it("should use a CRC-16/CCITT-FALSE");
+    test.assertEqualInt(radio.outputCrcUpdate(0xFFFF,"123456789",9),0x29B1,"should match the check value", __LINE__);
+
+    test.it("should hold a short batch for more packets");
+    for (int i = 0; i < 3; i++) {
+        data[1] = 20 + i;
+        radio.bufferStreamAddData(data);
+    }
+    radio.bufferStreamFlushBuffers();
+    test.assertEqualByte(radio.streamPacketBufferTail,0,"should not move the tail", __LINE__);
+    test.assertEqualInt(radio.outputFree(),OPENBCI_OUTPUT_BUFFER_LENGTH,"should not stage anything", __LINE__);
+
+    test.it("should stage the packets as one batch once the wait is over");
+    radio.outputBatchTimeFirst = micros() - OPENBCI_TIMEOUT_BATCH_uS;
+    radio.bufferStreamFlushBuffers();
+    test.assertEqualByte(radio.streamPacketBufferTail,3,"should flush all three", __LINE__);
+    test.assertEqualInt(radio.outputFree(),OPENBCI_OUTPUT_BUFFER_LENGTH - (OPENBCI_BATCH_HEADER_BYTES + 3 * OPENBCI_BATCH_PACKET_BYTES + OPENBCI_BATCH_CRC_BYTES),"should stage the header, packets and CRC", __LINE__);
+    char *batch = radio.outputBuffer + (radio.outputPositionRead & (OPENBCI_OUTPUT_BUFFER_LENGTH - 1));
+    test.assertEqualByte(batch[0],OPENBCI_BATCH_BYTE_START,"should start with the batch byte", __LINE__);
+    test.assertEqualByte(batch[1],3 * OPENBCI_BATCH_PACKET_BYTES,"should have the length", __LINE__);
+    test.assertEqualByte(batch[3],3,"should have the count", __LINE__);
+    test.assertEqualByte(batch[4],0,"should start the sequence at 0", __LINE__);
+    test.assertEqualByte(batch[OPENBCI_BATCH_HEADER_BYTES + OPENBCI_BATCH_PACKET_BYTES],21,"should put the packets in order", __LINE__);
+    test.assertEqualByte(batch[OPENBCI_BATCH_HEADER_BYTES + OPENBCI_BATCH_PACKET_BYTES - 1],0xC0,"should keep each stop byte", __LINE__);
+    uint16_t crc = radio.outputCrcUpdate(0xFFFF,batch + 1,OPENBCI_BATCH_HEADER_BYTES - 1 + 3 * OPENBCI_BATCH_PACKET_BYTES);
+    test.assertEqualByte(batch[OPENBCI_BATCH_HEADER_BYTES + 3 * OPENBCI_BATCH_PACKET_BYTES],crc & 0xFF,"should end with the CRC", __LINE__);
+    test.assertEqualInt(radio.outputBatchSequence,1,"should count the batch", __LINE__);
+
+    radio.outputBatchEnabled = false;
+    radio.printMessageToDriverFlag = false;
+    radio.outputPositionRead = radio.outputPositionWrite;
+    radio.bufferStreamReset();
+    radio.bufferSerialReset(OPENBCI_NUMBER_SERIAL_BUFFERS);
+}
+
+void testDecimateSet() {
+    test.describe("processOutboundBufferCharTriple - OPENBCI_HOST_CMD_DECIMATE_SET");
+    radio.streamDecimate = 0;
+    radio.txQueueReset();
+
+    test.it("should tell the Device to average every 4 packets into one");
+    radio.systemUp = true;
+    radio.bufferSerialReset(OPENBCI_NUMBER_SERIAL_BUFFERS);
+    radio.bufferSerialAddChar((char)OPENBCI_HOST_PRIVATE_CMD_KEY);
+    radio.bufferSerialAddChar((char)OPENBCI_HOST_CMD_DECIMATE_SET);
+    radio.bufferSerialAddChar((char)4);
+    test.assertEqualByte(radio.processOutboundBuffer(radio.bufferSerial.packetBuffer),ACTION_RADIO_SEND_NONE,"should not send a page", __LINE__);
+    test.assertEqualByte(radio.streamDecimate,4,"should keep the decimation", __LINE__);
+    test.assertEqualByte(radio.txQueueCount,1,"should add to the TX queue", __LINE__);
+    test.assertEqualByte(radio.txQueue[0].data[0],OPENBCI_STREAM_DECIMATE_BYTE_ID,"should set the decimate byteId", __LINE__);
+    test.assertEqualByte(radio.txQueue[0].data[1],4,"should send N", __LINE__);
+    test.assertEqualByte(radio.msgToPrint,radio.HOST_MESSAGE_DECIMATE,"should print the decimation", __LINE__);
+    test.assertEqualInt(radio.bufferSerial.packetBuffer->positionWrite,0x01, "should reset serial buffer", __LINE__);
+
+    test.it("should not allow more than OPENBCI_STREAM_DECIMATE_MAX");
+    radio.txQueueReset();
+    radio.bufferSerialAddChar((char)OPENBCI_HOST_PRIVATE_CMD_KEY);
+    radio.bufferSerialAddChar((char)OPENBCI_HOST_CMD_DECIMATE_SET);
+    radio.bufferSerialAddChar((char)(OPENBCI_STREAM_DECIMATE_MAX + 1));
+    radio.processOutboundBuffer(radio.bufferSerial.packetBuffer);
+    test.assertEqualByte(radio.streamDecimate,4,"should keep the old decimation", __LINE__);
+    test.assertEqualByte(radio.txQueueCount,0,"should not queue anything", __LINE__);
+    test.assertEqualByte(radio.msgToPrint,radio.HOST_MESSAGE_DECIMATE_VERIFY,"should print verify", __LINE__);
+
+    test.it("should not change the Host if the Device can't be told");
+    radio.txQueueCount = OPENBCI_NUMBER_TX_QUEUE;
+    radio.bufferSerialAddChar((char)OPENBCI_HOST_PRIVATE_CMD_KEY);
+    radio.bufferSerialAddChar((char)OPENBCI_HOST_CMD_DECIMATE_SET);
+    radio.bufferSerialAddChar((char)8);
+    radio.processOutboundBuffer(radio.bufferSerial.packetBuffer);
+    test.assertEqualByte(radio.streamDecimate,4,"should keep the old decimation", __LINE__);
+    test.assertEqualByte(radio.msgToPrint,radio.HOST_MESSAGE_TX_QUEUE_FULL,"should print a failure", __LINE__);
+
+    radio.streamDecimate = 0;
+    radio.systemUp = false;
+    radio.printMessageToDriverFlag = false;
+    radio.txQueueReset();
+    radio.bufferSerialReset(OPENBCI_NUMBER_SERIAL_BUFFERS);
+}
+
+void testLowPower() {
+    test.describe("processOutboundBufferCharTriple - OPENBCI_HOST_CMD_LOW_POWER_SET");
+    radio.lowPowerWaitMs = 0;
+    radio.txQueueReset();
+    radio.systemUp = true;
+
+    test.it("should tell the Device to hold stream packets for bursts");
+    radio.bufferSerialReset(OPENBCI_NUMBER_SERIAL_BUFFERS);
+    radio.bufferSerialAddChar((char)OPENBCI_HOST_PRIVATE_CMD_KEY);
+    radio.bufferSerialAddChar((char)OPENBCI_HOST_CMD_LOW_POWER_SET);
+    radio.bufferSerialAddChar((char)20);
+    test.assertEqualByte(radio.processOutboundBuffer(radio.bufferSerial.packetBuffer),ACTION_RADIO_SEND_NONE,"should not send a page", __LINE__);
+    test.assertEqualByte(radio.lowPowerWaitMs,20,"should keep the wait", __LINE__);
+    test.assertEqualByte(radio.txQueue[0].data[0],OPENBCI_LOW_POWER_BYTE_ID,"should set the low power byteId", __LINE__);
+    test.assertEqualByte(radio.txQueue[0].data[1],20,"should send the wait", __LINE__);
+    test.assertEqualByte(radio.msgToPrint,radio.HOST_MESSAGE_LOW_POWER,"should print the wait", __LINE__);
+
+    test.it("should not allow more than OPENBCI_LOW_POWER_WAIT_MAX_MS");
+    radio.txQueueReset();
+    radio.bufferSerialAddChar((char)OPENBCI_HOST_PRIVATE_CMD_KEY);
+    radio.bufferSerialAddChar((char)OPENBCI_HOST_CMD_LOW_POWER_SET);
+    radio.bufferSerialAddChar((char)(OPENBCI_LOW_POWER_WAIT_MAX_MS + 1));
+    radio.processOutboundBuffer(radio.bufferSerial.packetBuffer);
+    test.assertEqualByte(radio.txQueueCount,0,"should not queue anything", __LINE__);
+    test.assertEqualByte(radio.msgToPrint,radio.HOST_MESSAGE_LOW_POWER_VERIFY,"should print verify", __LINE__);
+
+    test.describe("processOutboundBufferCharDouble - OPENBCI_HOST_CMD_LOW_POWER_REPORT");
+    test.it("should ask the Device for its report");
+    radio.printMessageToDriverFlag = false;
+    radio.bufferSerialAddChar((char)OPENBCI_HOST_PRIVATE_CMD_KEY);
+    radio.bufferSerialAddChar((char)OPENBCI_HOST_CMD_LOW_POWER_REPORT);
+    radio.processOutboundBuffer(radio.bufferSerial.packetBuffer);
+    test.assertEqualByte(radio.txQueue[0].data[1],OPENBCI_LOW_POWER_REPORT,"should ask for the report", __LINE__);
+    test.assertBoolean(radio.printMessageToDriverFlag,false,"should wait for the Device", __LINE__);
+
+    test.it("should print the report from the Device");
+    char report[OPENBCI_LOW_POWER_REPORT_BYTES] = {(char)OPENBCI_LOW_POWER_BYTE_ID, 10,0,0,0, (char)0xE8,0x03,0,0, 2,0,0,0};
+    radio.processHostRadioCharData(DEVICE0,report,OPENBCI_LOW_POWER_REPORT_BYTES);
+    radio.rxQueueProcess();
+    test.assertEqualInt(radio.lowPowerPackets,10,"should read the packets", __LINE__);
+    test.assertEqualInt(radio.lowPowerRadioOnUs,1000,"should read the radio on time", __LINE__);
+    test.assertEqualInt(radio.lowPowerWakes,2,"should read the wakes", __LINE__);
+    test.assertEqualByte(radio.msgToPrint,radio.HOST_MESSAGE_LOW_POWER_REPORT,"should print the report from loop()", __LINE__);
+
+    radio.lowPowerWaitMs = 0;
+    radio.lowPowerReset();
+    radio.systemUp = false;
+    radio.printMessageToDriverFlag = false;
+    radio.txQueueReset();
+    radio.bufferSerialReset(OPENBCI_NUMBER_SERIAL_BUFFERS);
+}
+
+void testLinkState() {
+    test.describe("linkStateSave - warm start");
+    radio.txQueueReset();
+    radio.timerBaudRate = OPENBCI_BAUD_RATE_FAST;
+    radio.outputBatchEnabled = true;
+    radio.streamParityGroup = 4;
+    radio.streamDecimate = 2;
+    radio.lowPowerWaitMs = 20;
+
+    test.it("should pack the radio side settings into one word");
+    test.assertEqualInt(radio.linkStateMake(),0x14020400,"should have the parity, decimation and wait, not the serial modes",__LINE__);
+
+    test.it("should store the link state when it changes");
+    test.assertBoolean(radio.linkStateSave(),true,"should queue the link state",__LINE__);
+    flashCommitFlush();
+    test.assertEqualInt(radio.getLinkState(),0x14020400,"should be in flash",__LINE__);
+    test.assertBoolean(radio.linkStateSave(),false,"should not store it twice",__LINE__);
+
+    test.describe("linkStateApply - warm start");
+    test.it("should come back up in the stored link state at the default baud");
+    radio.timerBaudRate = OPENBCI_BAUD_RATE_DEFAULT;
+    radio.outputBatchEnabled = false;
+    radio.streamParityGroup = 0;
+    radio.streamDecimate = 0;
+    radio.lowPowerWaitMs = 0;
+    radio.linkStateApply(radio.getLinkState());
+    test.assertEqualInt(radio.timerBaudRate,OPENBCI_BAUD_RATE_DEFAULT,"should open at the default baud rate",__LINE__);
+    test.assertBoolean(radio.outputBatchEnabled,false,"should not batch",__LINE__);
+    test.assertBoolean(radio.serialFramingEnabled,false,"should not frame",__LINE__);
+    test.assertEqualByte(radio.streamParityGroup,4,"should restore the parity group",__LINE__);
+    test.assertEqualByte(radio.streamDecimate,2,"should restore the decimation",__LINE__);
+    test.assertEqualByte(radio.lowPowerWaitMs,20,"should restore the wait",__LINE__);
+
+    test.it("should not bring back serial modes stored by older firmware");
+    radio.linkStateApply(0x14020411);
+    test.assertEqualInt(radio.timerBaudRate,OPENBCI_BAUD_RATE_DEFAULT,"should stay at the default baud rate",__LINE__);
+    test.assertBoolean(radio.outputBatchEnabled,false,"should not batch",__LINE__);
+    test.assertEqualByte(radio.streamParityGroup,4,"should take the parity group",__LINE__);
+
+    test.it("should use the defaults when nothing was ever stored");
+    radio.linkStateApply(0xFFFFFFFF);
+    test.assertEqualInt(radio.timerBaudRate,OPENBCI_BAUD_RATE_DEFAULT,"should open at the default baud rate",__LINE__);
+    test.assertBoolean(radio.outputBatchEnabled,false,"should not batch",__LINE__);
+    test.assertEqualByte(radio.streamParityGroup,0,"should not use parity",__LINE__);
+
+    test.describe("linkStateSync - warm start");
+    test.it("should send the Device the link state when the system comes up");
+    radio.linkStateApply(0x14020411);
+    radio.linkStateSync();
+    test.assertEqualByte(radio.txQueueCount,1,"should queue one message",__LINE__);
+    test.assertEqualByte(radio.txQueue[0].length,OPENBCI_LINK_STATE_BYTES,"should be the byteId and the state",__LINE__);
+    test.assertEqualByte(radio.txQueue[0].data[0],OPENBCI_LINK_STATE_BYTE_ID,"should set the link state byteId",__LINE__);
+    test.assertEqualByte(radio.txQueue[0].data[1],0,"should leave the reserved byte 0",__LINE__);
+    test.assertEqualByte(radio.txQueue[0].data[2],4,"should send the parity group",__LINE__);
+    test.assertEqualByte(radio.txQueue[0].data[3],2,"should send the decimation",__LINE__);
+    test.assertEqualByte(radio.txQueue[0].data[4],20,"should send the wait",__LINE__);
+
+    // Back to the defaults, in flash too
+    radio.linkStateApply(OPENBCI_LINK_STATE_DEFAULT);
+    radio.linkStateSave();
+    flashCommitFlush();
+    radio.lowPowerReset();
+    radio.txQueueReset();
+}
+
+void testPollTimeUs() {
+    test.describe("processOutboundBuffer - OPENBCI_HOST_CMD_POLL_TIME_SET_US");
+    radio.txQueueReset();
+    radio.systemUp = true;
+
+    test.it("should store whole ms as ms and anything else as uS");
+    test.assertEqualInt(radio.pollTimeFromMicros(48000),48,"should store ms",__LINE__);
+    test.assertEqualInt(radio.pollTimeToMicros(48),48000,"should read ms",__LINE__);
+    test.assertEqualInt(radio.pollTimeToMicros(radio.pollTimeFromMicros(750)),750,"should read back uS",__LINE__);
+
+    test.it("should tell the Device to poll every 750uS");
+    radio.bufferSerialReset(OPENBCI_NUMBER_SERIAL_BUFFERS);
+    radio.bufferSerialAddChar((char)OPENBCI_HOST_PRIVATE_CMD_KEY);
+    radio.bufferSerialAddChar((char)OPENBCI_HOST_CMD_POLL_TIME_SET_US);
+    radio.bufferSerialAddChar((char)0xEE);
+    radio.bufferSerialAddChar((char)0x02);
+    radio.bufferSerialAddChar((char)0x00);
+    radio.bufferSerialAddChar((char)0x00);
+    test.assertEqualByte(radio.processOutboundBuffer(radio.bufferSerial.packetBuffer),ACTION_RADIO_SEND_NONE,"should not send a page", __LINE__);
+    test.assertEqualInt(radio.pollTimeUs,750,"should keep the poll time", __LINE__);
+    test.assertEqualInt(radio.getPollTime(),750 | OPENBCI_POLL_TIME_US_FLAG,"should store it in uS", __LINE__);
+    test.assertEqualByte(radio.txQueueCount,1,"should add to the TX queue", __LINE__);
+    test.assertEqualByte(radio.txQueue[0].data[0],OPENBCI_POLL_TIME_BYTE_ID,"should set the poll time byteId", __LINE__);
+    test.assertEqualByte(radio.txQueue[0].data[1],0xEE,"should send the low byte first", __LINE__);
+    test.assertEqualByte(radio.txQueue[0].data[2],0x02,"should send the next byte", __LINE__);
+    test.assertEqualByte(radio.msgToPrint,radio.HOST_MESSAGE_POLL_TIME_US,"should print the poll time", __LINE__);
+
+    test.it("should not allow less than OPENBCI_POLL_TIME_MIN_uS");
+    radio.txQueueReset();
+    radio.bufferSerialReset(OPENBCI_NUMBER_SERIAL_BUFFERS);
+    radio.bufferSerialAddChar((char)OPENBCI_HOST_PRIVATE_CMD_KEY);
+    radio.bufferSerialAddChar((char)OPENBCI_HOST_CMD_POLL_TIME_SET_US);
+    radio.bufferSerialAddChar((char)0x64);
+    radio.bufferSerialAddChar((char)0x00);
+    radio.bufferSerialAddChar((char)0x00);
+    radio.bufferSerialAddChar((char)0x00);
+    radio.processOutboundBuffer(radio.bufferSerial.packetBuffer);
+    test.assertEqualInt(radio.pollTimeUs,750,"should keep the old poll time", __LINE__);
+    test.assertEqualByte(radio.txQueueCount,0,"should not queue anything", __LINE__);
+    test.assertEqualByte(radio.msgToPrint,radio.HOST_MESSAGE_POLL_TIME_VERIFY,"should print verify", __LINE__);
+
+    test.it("should answer the poll time in uS without the Device");
+    radio.systemUp = false;
+    radio.bufferSerialReset(OPENBCI_NUMBER_SERIAL_BUFFERS);
+    radio.bufferSerialAddChar((char)OPENBCI_HOST_PRIVATE_CMD_KEY);
+    radio.bufferSerialAddChar((char)OPENBCI_HOST_CMD_POLL_TIME_GET_US);
+    test.assertEqualByte(radio.processOutboundBuffer(radio.bufferSerial.packetBuffer),ACTION_RADIO_SEND_NONE,"should not send", __LINE__);
+    test.assertEqualByte(radio.msgToPrint,radio.HOST_MESSAGE_POLL_TIME_US,"should print the poll time", __LINE__);
+
+    flashCommitFlush();
+    radio.revertToDefaultPollTime();
+    radio.pollTimeApply(radio.getPollTime());
+    radio.printMessageToDriverFlag = false;
+    radio.txQueueReset();
+    radio.bufferSerialReset(OPENBCI_NUMBER_SERIAL_BUFFERS);
+}
+
+void testLinkHostQuiet() {
+    test.describe("linkHostQuietMs - how long a stream can go quiet");
+    radio.pollTimeApply(OPENBCI_TIMEOUT_PACKET_POLL_MS);
+    radio.streamDecimate = 0;
+    radio.lowPowerWaitMs = 0;
+
+    test.it("should wait for an overdue poll before calling the link lost");
+    test.assertEqualInt(radio.linkHostQuietMs(false),OPENBCI_LINK_SAMPLE_MS + OPENBCI_TIMEOUT_LINK_LOST_MS,"should expect a sample",__LINE__);
+    test.assertEqualInt(radio.linkHostQuietMs(true),OPENBCI_TIMEOUT_PACKET_POLL_MS + OPENBCI_TIMEOUT_LINK_LOST_MS,"should expect a poll after a stream stops",__LINE__);
+
+    test.it("should scale with the decimation");
+    radio.streamDecimate = 16;
+    test.assertEqualInt(radio.linkHostQuietMs(false),16 * OPENBCI_LINK_SAMPLE_MS + OPENBCI_TIMEOUT_LINK_LOST_MS,"should expect one packet in 16 samples",__LINE__);
+    test.assertEqualInt(radio.linkHostQuietMs(true),16 * OPENBCI_LINK_SAMPLE_MS + OPENBCI_TIMEOUT_LINK_LOST_MS,"should be longer than the poll time",__LINE__);
+
+    test.it("should scale with a low power burst");
+    radio.streamDecimate = 0;
+    radio.lowPowerWaitMs = 100;
+    test.assertEqualInt(radio.linkHostQuietMs(true),100 + OPENBCI_TIMEOUT_LINK_LOST_MS,"should wait out a burst",__LINE__);
+
+    radio.lowPowerWaitMs = 0;
+    radio.pollTimeApply(radio.getPollTime());
+}
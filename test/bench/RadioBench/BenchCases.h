@@ -0,0 +1,303 @@
+/**
+* Name: BenchCases.h
+* Purpose: The microbenchmarks for the buffer and byteId primitives. Shared by
+*   the RFduino sketch in this folder and radio_bench.cpp on Linux, each of
+*   which supplies the clock before including this file:
+*
+*   uint32_t benchTicks(void)  - A free running counter, `BENCH_TICKS_PER_US`
+*                                ticks to the micro second
+*   void benchEvict(void)      - Pushes the cases' data out of any cache
+*   void benchDrain(void)      - Throws away what was written to `Serial`
+*   void benchPrint(const char *)
+*
+* Author: Push The World LLC (AJ Keller)
+*/
+
+#ifndef __OpenBCI_Radio_Bench_Cases__
+#define __OpenBCI_Radio_Bench_Cases__
+
+#include <stdio.h>
+
+#define BENCH_COLD_RUNS 31 // Cold result is the median of this many single ops
+#define BENCH_WARM_TRIES 5 // Warm result is the best of this many
+
+typedef struct {
+  const char *name;
+  uint8_t     bytesPerOp; // 0 when bytes/s means nothing
+  uint16_t    opsPerPrepare; // How many ops fit between calls to `prepare`
+  int         expect; // Result `op` has to leave in `benchResult`, -1 for any
+  void        (*prepare)(void);
+  void        (*op)(void);
+} BenchCase;
+
+typedef struct {
+  uint32_t warmTenthTicks; // Per op, in tenths of a tick
+  uint32_t coldTicks; // Per op
+  boolean  ok;
+} BenchResult;
+
+volatile uint32_t benchSink;
+int benchResult;
+uint16_t benchPosition;
+
+// A stream packet from the Pic, `0x41`, 31 bytes and a stop byte
+char benchPicPacket[OPENBCI_MAX_PACKET_SIZE_BYTES + 1];
+// A stream packet off the radio, a byteId and 31 bytes
+char benchStreamPacket[OPENBCI_MAX_PACKET_SIZE_BYTES];
+// Non stream packets off the radio, numbered 0 to 3
+char benchRadioPacket[4][OPENBCI_MAX_PACKET_SIZE_BYTES];
+
+void benchInit(void) {
+  benchPicPacket[0] = OPENBCI_STREAM_PACKET_HEAD;
+  for (int i = 1; i < OPENBCI_MAX_PACKET_SIZE_BYTES; i++) {
+    benchPicPacket[i] = (char)i;
+  }
+  benchPicPacket[OPENBCI_MAX_PACKET_SIZE_BYTES] = (char)OPENBCI_STREAM_PACKET_TAIL;
+  benchStreamPacket[0] = radio.byteIdMake(true, 0, NULL, 0);
+  for (int i = 1; i < OPENBCI_MAX_PACKET_SIZE_BYTES; i++) {
+    benchStreamPacket[i] = (char)i;
+  }
+  for (int p = 0; p < 4; p++) {
+    benchRadioPacket[p][0] = radio.byteIdMake(false, p, NULL, 0);
+    for (int i = 1; i < OPENBCI_MAX_PACKET_SIZE_BYTES; i++) {
+      benchRadioPacket[p][i] = (char)('a' + i);
+    }
+  }
+}
+
+/********************************************/
+/********          BYTEID          **********/
+/********************************************/
+
+void benchPrepareNone(void) {
+  benchPosition = 0;
+}
+
+void benchByteIdMake(void) {
+  benchSink += radio.byteIdMake(true, benchPosition++ & 0x0F, benchStreamPacket + 1, OPENBCI_MAX_DATA_BYTES_IN_PACKET);
+}
+
+void benchByteIdGetPacketNumber(void) {
+  benchSink += radio.byteIdGetPacketNumber(benchRadioPacket[benchPosition++ & 0x03][0]);
+}
+
+/********************************************/
+/********      SERIAL AND STREAM   **********/
+/********************************************/
+
+void benchPrepareStream(void) {
+  benchPosition = 0;
+  radio.bufferStreamReset(radio.streamPacketBuffer);
+}
+
+// One char of a Pic stream packet, the whole packet takes 33 ops
+void benchStreamAddChar(void) {
+  radio.bufferStreamAddChar(radio.streamPacketBuffer, benchPicPacket[benchPosition++]);
+}
+
+void benchPrepareSerial(void) {
+  benchPosition = 0;
+  radio.bufferSerialReset(OPENBCI_NUMBER_SERIAL_BUFFERS);
+}
+
+void benchSerialAddChar(void) {
+  benchSink += radio.bufferSerialAddChar(benchPicPacket[benchPosition++ & 0x1F]);
+}
+
+void benchStreamStoreData(void) {
+  radio.bufferStreamStoreData(radio.streamPacketBuffer, benchStreamPacket);
+}
+
+void benchPrepareFlush(void) {
+  benchDrain();
+  // Empty the Host's output so every op stages a whole packet
+  radio.outputPositionRead = radio.outputPositionWrite;
+  radio.bufferStreamStoreData(radio.streamPacketBuffer, benchStreamPacket);
+}
+
+void benchStreamFlush(void) {
+  radio.bufferStreamFlush(radio.streamPacketBuffer);
+}
+
+/********************************************/
+/********          RADIO           **********/
+/********************************************/
+
+void benchRadioReset(void) {
+  radio.bufferRadioReset(radio.bufferRadio);
+  radio.currentRadioBuffer = radio.bufferRadio;
+}
+
+void benchRadioAddData(void) {
+  benchSink += radio.bufferRadioAddData(radio.currentRadioBuffer, benchRadioPacket[0] + 1, OPENBCI_MAX_DATA_BYTES_IN_PACKET, false);
+}
+
+// Each outcome of `bufferRadioProcessPacket` is one op on a buffer set up by
+//  feeding it the packets before it
+void benchRadioPrepareOne(int packetNumber) {
+  benchRadioReset();
+  radio.bufferRadioProcessPacket(benchRadioPacket[packetNumber], OPENBCI_MAX_PACKET_SIZE_BYTES);
+}
+
+void benchRadioProcess(int packetNumber) {
+  benchResult = radio.bufferRadioProcessPacket(benchRadioPacket[packetNumber], OPENBCI_MAX_PACKET_SIZE_BYTES);
+}
+
+void benchPrepareAfter0(void) { benchRadioPrepareOne(0); }
+void benchPrepareAfter1(void) { benchRadioPrepareOne(1); }
+void benchPrepareAfter2(void) { benchRadioPrepareOne(2); }
+void benchPrepareAfter3(void) { benchRadioPrepareOne(3); }
+void benchProcess0(void) { benchRadioProcess(0); }
+void benchProcess1(void) { benchRadioProcess(1); }
+
+BenchCase benchCases[] = {
+  { "byteIdMake", 0, 256, -1, benchPrepareNone, benchByteIdMake },
+  { "byteIdGetPacketNumber", 0, 256, -1, benchPrepareNone, benchByteIdGetPacketNumber },
+  { "bufferStreamAddChar", 1, OPENBCI_MAX_PACKET_SIZE_BYTES + 1, -1, benchPrepareStream, benchStreamAddChar },
+  { "bufferSerialAddChar", 1, OPENBCI_NUMBER_SERIAL_BUFFERS * OPENBCI_MAX_DATA_BYTES_IN_PACKET, -1, benchPrepareSerial, benchSerialAddChar },
+  { "bufferRadioAddData", OPENBCI_MAX_DATA_BYTES_IN_PACKET, OPENBCI_BUFFER_LENGTH_MULTI / OPENBCI_MAX_DATA_BYTES_IN_PACKET, -1, benchRadioReset, benchRadioAddData },
+  { "bufferRadioProcessPacket PASS_LAST_SINGLE", OPENBCI_MAX_DATA_BYTES_IN_PACKET, 1, OPENBCI_PROCESS_RADIO_PASS_LAST_SINGLE, benchRadioReset, benchProcess0 },
+  { "bufferRadioProcessPacket PASS_NOT_LAST_FIRST", OPENBCI_MAX_DATA_BYTES_IN_PACKET, 1, OPENBCI_PROCESS_RADIO_PASS_NOT_LAST_FIRST, benchRadioReset, benchProcess1 },
+  { "bufferRadioProcessPacket PASS_LAST_MULTI", OPENBCI_MAX_DATA_BYTES_IN_PACKET, 1, OPENBCI_PROCESS_RADIO_PASS_LAST_MULTI, benchPrepareAfter1, benchProcess0 },
+  { "bufferRadioProcessPacket PASS_NOT_LAST_MIDDLE", OPENBCI_MAX_DATA_BYTES_IN_PACKET, 1, OPENBCI_PROCESS_RADIO_PASS_NOT_LAST_MIDDLE, benchPrepareAfter2, benchProcess1 },
+  { "bufferRadioProcessPacket FAIL_MISSED_LAST", 0, 1, OPENBCI_PROCESS_RADIO_FAIL_MISSED_LAST, benchPrepareAfter2, benchProcess0 },
+  { "bufferRadioProcessPacket FAIL_MISSED_NOT_LAST", 0, 1, OPENBCI_PROCESS_RADIO_FAIL_MISSED_NOT_LAST, benchPrepareAfter3, benchProcess1 },
+#if OPENBCI_NUMBER_RADIO_BUFFERS == 2
+  { "bufferRadioProcessPacket PASS_SWITCH_LAST", OPENBCI_MAX_DATA_BYTES_IN_PACKET, 1, OPENBCI_PROCESS_RADIO_PASS_SWITCH_LAST, benchPrepareAfter0, benchProcess0 },
+  { "bufferRadioProcessPacket PASS_SWITCH_NOT_LAST", OPENBCI_MAX_DATA_BYTES_IN_PACKET, 1, OPENBCI_PROCESS_RADIO_PASS_SWITCH_NOT_LAST, benchPrepareAfter0, benchProcess1 },
+#else
+  // With one radio buffer there is nothing to switch to, so these fail
+  { "bufferRadioProcessPacket FAIL_SWITCH_LAST", 0, 1, OPENBCI_PROCESS_RADIO_FAIL_SWITCH_LAST, benchPrepareAfter0, benchProcess0 },
+  { "bufferRadioProcessPacket FAIL_SWITCH_NOT_LAST", 0, 1, OPENBCI_PROCESS_RADIO_FAIL_SWITCH_NOT_LAST, benchPrepareAfter0, benchProcess1 },
+#endif
+  { "bufferStreamStoreData", OPENBCI_MAX_DATA_BYTES_IN_PACKET, 64, -1, benchPrepareNone, benchStreamStoreData },
+  { "bufferStreamFlush", OPENBCI_MAX_PACKET_SIZE_BYTES + 1, 16, -1, benchPrepareFlush, benchStreamFlush }
+};
+
+#define BENCH_NUMBER_CASES (sizeof(benchCases) / sizeof(benchCases[0]))
+
+uint32_t benchOverhead;
+
+static void benchSort(uint32_t *values, int count) {
+  for (int i = 1; i < count; i++) {
+    uint32_t v = values[i];
+    int j = i - 1;
+    while (j >= 0 && values[j] > v) {
+      values[j + 1] = values[j];
+      j--;
+    }
+    values[j + 1] = v;
+  }
+}
+
+/**
+* @description Finds the cost of reading the clock twice, taken off every
+*  measurement.
+*/
+void benchCalibrate(void) {
+  uint32_t runs[BENCH_COLD_RUNS];
+  for (int i = 0; i < BENCH_COLD_RUNS; i++) {
+    uint32_t start = benchTicks();
+    runs[i] = benchTicks() - start;
+  }
+  benchSort(runs, BENCH_COLD_RUNS);
+  benchOverhead = runs[BENCH_COLD_RUNS / 2];
+}
+
+static uint32_t benchLessOverhead(uint32_t ticks) {
+  return ticks > benchOverhead ? ticks - benchOverhead : 0;
+}
+
+/**
+* @description Runs one case. Warm is the mean over about `warmOps` ops, best
+*  of `BENCH_WARM_TRIES`, with the clock read around the ops after each
+*  prepare. Cold is the median of single ops each run right after
+*  `benchEvict`.
+* @param c {BenchCase *} - The case
+* @param warmOps {uint32_t} - Roughly how many ops to time warm
+* @param result {BenchResult *} - Filled in
+*/
+void benchRun(BenchCase *c, uint32_t warmOps, BenchResult *result) {
+  // Make sure the op does what it says before timing it
+  benchResult = -1;
+  c->prepare();
+  c->op();
+  result->ok = c->expect < 0 || benchResult == c->expect;
+
+  // Only the ops after each prepare are between the clock reads, the cost of
+  //  reading the clock is taken off each block. With one op per prepare that
+  //  times each op on its own. The best of a few tries keeps other work on
+  //  the machine out of it.
+  uint32_t rounds = (warmOps + c->opsPerPrepare - 1) / c->opsPerPrepare;
+  uint32_t best = 0xFFFFFFFF;
+  for (int t = 0; t < BENCH_WARM_TRIES; t++) {
+    uint32_t ticks = 0;
+    for (uint32_t r = 0; r < rounds; r++) {
+      c->prepare();
+      uint32_t start = benchTicks();
+      for (uint16_t i = 0; i < c->opsPerPrepare; i++) {
+        c->op();
+      }
+      ticks += benchLessOverhead(benchTicks() - start);
+    }
+    if (ticks < best) {
+      best = ticks;
+    }
+  }
+  result->warmTenthTicks = (uint32_t)((uint64_t)best * 10 / ((uint64_t)rounds * c->opsPerPrepare));
+
+  uint32_t runs[BENCH_COLD_RUNS];
+  for (int i = 0; i < BENCH_COLD_RUNS; i++) {
+    c->prepare();
+    benchEvict();
+    uint32_t start = benchTicks();
+    c->op();
+    runs[i] = benchLessOverhead(benchTicks() - start);
+  }
+  benchSort(runs, BENCH_COLD_RUNS);
+  result->coldTicks = runs[BENCH_COLD_RUNS / 2];
+}
+
+/**
+* @description Runs every case and prints a line for each: warm and cold ns
+*  per op, warm MB/s where the op moves bytes, and on the RFduino the warm
+*  cycles per op.
+*/
+void benchRunAll(uint32_t warmOps) {
+  char line[128];
+  BenchResult result;
+  benchInit();
+  benchCalibrate();
+#ifdef BENCH_CYCLES_PER_TICK
+  benchPrint("case                                            warm ns/op  cold ns/op      MB/s  cycles/op\n");
+#else
+  benchPrint("case                                            warm ns/op  cold ns/op      MB/s\n");
+#endif
+  for (unsigned i = 0; i < BENCH_NUMBER_CASES; i++) {
+    BenchCase *c = benchCases + i;
+    benchRun(c, warmOps, &result);
+    // Tenths of a ns
+    uint32_t warm = (uint32_t)((uint64_t)result.warmTenthTicks * 1000 / BENCH_TICKS_PER_US);
+    uint32_t cold = (uint32_t)((uint64_t)result.coldTicks * 1000 / BENCH_TICKS_PER_US);
+    int n = snprintf(line, sizeof(line), "%-46s %8lu.%lu %11lu", c->name,
+      (unsigned long)(warm / 10), (unsigned long)(warm % 10), (unsigned long)(cold / 10));
+    // Bytes per micro second is MB/s
+    if (c->bytesPerOp > 0 && warm > 0) {
+      uint32_t mbps = (uint32_t)((uint64_t)c->bytesPerOp * 100000 / warm);
+      n += snprintf(line + n, sizeof(line) - n, " %7lu.%02lu", (unsigned long)(mbps / 100), (unsigned long)(mbps % 100));
+    } else {
+      n += snprintf(line + n, sizeof(line) - n, " %10s", "-");
+    }
+#ifdef BENCH_CYCLES_PER_TICK
+    uint32_t cycles = result.warmTenthTicks * BENCH_CYCLES_PER_TICK;
+    n += snprintf(line + n, sizeof(line) - n, " %8lu.%lu", (unsigned long)(cycles / 10), (unsigned long)(cycles % 10));
+#endif
+    if (!result.ok) {
+      n += snprintf(line + n, sizeof(line) - n, "  UNEXPECTED RESULT %d", benchResult);
+    }
+    snprintf(line + n, sizeof(line) - n, "\n");
+    benchPrint(line);
+  }
+}
+
+#endif // __OpenBCI_Radio_Bench_Cases__
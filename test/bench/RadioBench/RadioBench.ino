@@ -0,0 +1,53 @@
+/*
+* Runs the microbenchmarks in BenchCases.h on the RFduino and prints them to
+* the serial port at 115200. Send any char to start a run.
+*
+* TIMER0 counts at 16MHz, the CPU clock, so one tick is one cycle. The radio
+* is never started so nothing else is using the timer.
+*
+* Written by Push The World LLC 2016. You should have recieved a copy of the
+*  license when you downloaded from github. Free to use and share. This code
+*  presented for use as-is.
+*/
+#include <RFduinoGZLL.h>
+#include "OpenBCI_Radios.h"
+
+#define BENCH_TICKS_PER_US 16
+#define BENCH_CYCLES_PER_TICK 1
+#define BENCH_WARM_OPS 4096
+
+uint32_t benchTicks(void) {
+  NRF_TIMER0->TASKS_CAPTURE[0] = 1;
+  return NRF_TIMER0->CC[0];
+}
+
+// No cache on the nRF51, cold only misses the branch history
+void benchEvict(void) {}
+
+void benchDrain(void) {
+  Serial.flush();
+}
+
+void benchPrint(const char *s) {
+  Serial.print(s);
+}
+
+#include "BenchCases.h"
+
+void setup() {
+  Serial.begin(115200);
+
+  NRF_TIMER0->TASKS_STOP = 1;
+  NRF_TIMER0->MODE = TIMER_MODE_MODE_Timer;
+  NRF_TIMER0->BITMODE = TIMER_BITMODE_BITMODE_32Bit;
+  NRF_TIMER0->PRESCALER = 0;
+  NRF_TIMER0->TASKS_CLEAR = 1;
+  NRF_TIMER0->TASKS_START = 1;
+}
+
+void loop() {
+  if (Serial.available()) {
+    Serial.read();
+    benchRunAll(BENCH_WARM_OPS);
+  }
+}
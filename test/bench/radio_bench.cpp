@@ -0,0 +1,54 @@
+/**
+* Name: radio_bench.cpp
+* Purpose: Runs the microbenchmarks in RadioBench/BenchCases.h on Linux,
+*   against the library as built for the simulator in test/sim. See README.md
+*   in this folder.
+*
+* Author: Push The World LLC (AJ Keller)
+*/
+
+#include <stdlib.h>
+#include <time.h>
+#include "sim.h"
+
+#define BENCH_TICKS_PER_US 1000 // Ticks are nano seconds
+#define BENCH_EVICT_BYTES (16 * 1024 * 1024) // Bigger than any last level cache
+
+static uint8_t benchEvictBuffer[BENCH_EVICT_BYTES];
+
+uint32_t benchTicks(void) {
+  struct timespec t;
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return (uint32_t)((uint64_t)t.tv_sec * 1000000000ULL + t.tv_nsec);
+}
+
+void benchEvict(void) {
+  for (uint32_t i = 0; i < BENCH_EVICT_BYTES; i += 64) {
+    benchEvictBuffer[i]++;
+  }
+}
+
+void benchPrint(const char *s) {
+  fputs(s, stdout);
+}
+
+// The Device's copy of the library from sim_roles.cpp
+namespace sim_device {
+extern HardwareSerial Serial;
+#include "OpenBCI_Radios.h"
+
+void benchDrain(void) {
+  Serial.txClear();
+}
+
+#include "RadioBench/BenchCases.h"
+}
+
+int main(int argc, char **argv) {
+  uint32_t warmOps = 1000000;
+  if (argc > 1) {
+    warmOps = strtoul(argv[1], NULL, 0);
+  }
+  sim_device::benchRunAll(warmOps);
+  return 0;
+}
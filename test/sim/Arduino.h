@@ -0,0 +1,86 @@
+/**
+* Name: Arduino.h
+* Purpose: Stands in for the RFduino core when the Host and Device sketches are
+*   built for the Linux simulator. Time comes from the simulated clock, the
+*   serial port is a pair of byte queues and flash is one page per role.
+*
+* Author: Push The World LLC (AJ Keller)
+*/
+
+#ifndef __OpenBCI_Radio_Sim_Arduino__
+#define __OpenBCI_Radio_Sim_Arduino__
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <deque>
+
+typedef bool boolean;
+typedef uint8_t byte;
+
+#define HIGH 1
+#define LOW 0
+#define INPUT 0
+#define OUTPUT 1
+#define OUTPUT_D0H1 2
+
+// Each role has its own flash page, see SIM_ROLE_PLATFORM in sim_roles.cpp
+#define ADDRESS_OF_PAGE(page) (simFlashPage)
+#define PAGE_FROM_ADDRESS(address) (251)
+
+unsigned long millis(void);
+unsigned long micros(void);
+void delay(unsigned long);
+void delayMicroseconds(unsigned int);
+void noInterrupts(void);
+void interrupts(void);
+void pinMode(int, int);
+void digitalWrite(int, int);
+int digitalRead(int);
+
+class HardwareSerial {
+public:
+  HardwareSerial(void);
+  void begin(unsigned long);
+  void begin(unsigned long, int, int);
+  void end(void) {}
+  int available(void);
+  int read(void);
+  size_t write(uint8_t);
+  size_t print(const char *);
+  size_t print(char);
+  size_t print(unsigned char);
+  size_t print(int);
+  size_t print(unsigned int);
+  size_t print(long);
+  size_t print(unsigned long);
+  size_t println(void);
+  size_t println(const char *);
+  size_t println(int);
+  size_t println(unsigned long);
+  void flush(void) {}
+
+  // Simulator side of the port
+  void inject(const uint8_t *, size_t);
+  int txAvailable(void);
+  int txRead(void);
+  uint64_t nextEventAt(void);
+  void txClear(void);
+
+  unsigned long baudRate;
+
+private:
+  typedef struct {
+    uint64_t at;
+    uint8_t value;
+  } SerialByte;
+
+  uint64_t byteTimeUs(void);
+
+  std::deque<SerialByte> rx;
+  std::deque<SerialByte> tx;
+  uint64_t rxFreeAt;
+  uint64_t txFreeAt;
+};
+
+#endif // __OpenBCI_Radio_Sim_Arduino__
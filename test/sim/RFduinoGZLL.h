@@ -0,0 +1,41 @@
+/**
+* Name: RFduinoGZLL.h
+* Purpose: Stands in for the RFduinoGZLL library when the Host and Device
+*   sketches are built for the Linux simulator. Sends go on the TX FIFOs of
+*   the simulated link in sim.h.
+*
+* Author: Push The World LLC (AJ Keller)
+*/
+
+#ifndef __OpenBCI_Radio_Sim_RFduinoGZLL__
+#define __OpenBCI_Radio_Sim_RFduinoGZLL__
+
+#include "Arduino.h"
+
+typedef enum {
+  HOST,
+  DEVICE0,
+  DEVICE1,
+  DEVICE2,
+  DEVICE3,
+  DEVICE4,
+  DEVICE5,
+  DEVICE6,
+  DEVICE7
+} device_t;
+
+class RFduinoGZLLClass {
+public:
+  RFduinoGZLLClass(void);
+  int begin(device_t);
+  void end(void);
+  bool sendToHost(const char *, int);
+  bool sendToDevice(device_t, const char *, int);
+
+  int channel;
+  int txPowerLevel;
+  boolean active;
+  device_t role;
+};
+
+#endif // __OpenBCI_Radio_Sim_RFduinoGZLL__
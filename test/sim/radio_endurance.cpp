@@ -0,0 +1,210 @@
+/**
+* Name: radio_endurance.cpp
+* Purpose: The endurance test from test/js/endurance-test.js, run against the
+*   simulated Host and Device instead of a board on a serial port. A Pic
+*   streams into the Device for hours of simulated time and the sample numbers
+*   the Host writes to the PC are checked for continuity, writing the same log
+*   as the JS test. The simulation steps from event to event so an hour takes
+*   seconds.
+*
+* Author: Push The World LLC (AJ Keller)
+*/
+
+#include <stdlib.h>
+#include <time.h>
+#include "sim.h"
+
+// The driver side of endurance-test.js, reads stream packets from the Host and
+//  counts samples that don't follow the last one
+class EnduranceCounter {
+public:
+  EnduranceCounter(FILE *l, uint32_t every) {
+    log = l;
+    summaryEvery = every;
+    rawSampleCount = 0;
+    goodPackets = 0;
+    badPackets = 0;
+    sampleReceivedCounter = 0;
+    framePosition = 0;
+  }
+
+  void run(HardwareSerial *serial) {
+    while (serial->txAvailable()) {
+      uint8_t b = (uint8_t)serial->txRead();
+      if (framePosition == 0 && b != 0xA0) {
+        continue;
+      }
+      frame[framePosition++] = b;
+      if (framePosition < SIM_STREAM_PACKET_SIZE_BYTES) {
+        continue;
+      }
+      framePosition = 0;
+      if ((frame[SIM_STREAM_PACKET_SIZE_BYTES - 1] & 0xF0) == 0xC0) {
+        sample(frame[1]);
+      }
+    }
+  }
+
+  void summary(void) {
+    fprintf(log, "\n\nSummary:\n\tTotal Packets: %llu\n\t\tGood Packets: %llu\n\t\tBad Packets: %llu\n\t",
+      rawSampleCount, goodPackets, badPackets);
+    writeDateAndTime();
+    fprintf(log, "\n\n");
+  }
+
+  void writeDate(void) {
+    char s[32];
+    time_t seconds = (time_t)(simNowUs / 1000000);
+    strftime(s, sizeof(s), "%Y-%m-%d %H:%M:%S", gmtime(&seconds));
+    fprintf(log, "%s", s);
+  }
+
+  void writeDateAndTime(void) {
+    fprintf(log, "Date and time: ");
+    writeDate();
+  }
+
+  unsigned long long rawSampleCount;
+  unsigned long long goodPackets;
+  unsigned long long badPackets;
+
+private:
+  void sample(uint8_t sampleNumber) {
+    if (rawSampleCount % summaryEvery == 0) {
+      summary();
+    }
+    rawSampleCount++;
+    if (sampleNumber == sampleReceivedCounter) {
+      goodPackets++;
+      sampleReceivedCounter++;
+    } else {
+      fprintf(log, "err: expected %u got %u at ", sampleReceivedCounter, sampleNumber);
+      writeDate();
+      fprintf(log, "\n");
+      badPackets++;
+      sampleReceivedCounter = sampleNumber + 1;
+    }
+    // Loop the counter back to 0
+    if (sampleReceivedCounter > 255) {
+      sampleReceivedCounter = 0;
+    }
+  }
+
+  FILE *log;
+  uint32_t summaryEvery;
+  uint32_t sampleReceivedCounter;
+  uint8_t frame[SIM_STREAM_PACKET_SIZE_BYTES];
+  uint8_t framePosition;
+};
+
+static void usage(const char *name) {
+  fprintf(stderr,
+    "usage: %s [options]\n"
+    "  --minutes N         how long the Pic streams (60)\n"
+    "  --rate-hz N         stream packets per second (250)\n"
+    "  --baud N            Pic to Device baud rate (115200)\n"
+    "  --poll-ms N         poll time on both radios (library default)\n"
+    "  --summary-every N   samples between summaries (1500)\n"
+    "  --max-bad N         fail if more bad packets than this\n"
+    "  --max-step-us N     longest step when nothing is happening (100)\n"
+    "  --log FILE          write the log here instead of stdout\n"
+    "  and the link options of radio_sim, --seed, --loss, --ge and so on\n",
+    name);
+  exit(2);
+}
+
+int main(int argc, char **argv) {
+  uint32_t minutes = 60;
+  uint32_t baud = 115200;
+  uint32_t pollMs = 0;
+  uint32_t summaryEvery = 1500;
+  long long maxBad = -1;
+  uint32_t maxStepUs = 100;
+  const char *logPath = NULL;
+  SimPic pic;
+
+  for (int i = 1; i < argc; i++) {
+    const char *arg = argv[i];
+    if (i + 1 >= argc) {
+      usage(argv[0]);
+    }
+    const char *value = argv[++i];
+    if (simLinkOption(arg, value)) {
+      continue;
+    } else if (!strcmp(arg, "--minutes")) {
+      minutes = atoi(value);
+    } else if (!strcmp(arg, "--rate-hz")) {
+      pic.rateHz = atoi(value);
+    } else if (!strcmp(arg, "--baud")) {
+      baud = atoi(value);
+    } else if (!strcmp(arg, "--poll-ms")) {
+      pollMs = atoi(value);
+    } else if (!strcmp(arg, "--summary-every")) {
+      summaryEvery = atoi(value);
+    } else if (!strcmp(arg, "--max-bad")) {
+      maxBad = atoll(value);
+    } else if (!strcmp(arg, "--max-step-us")) {
+      maxStepUs = atoi(value);
+    } else if (!strcmp(arg, "--log")) {
+      logPath = value;
+    } else {
+      usage(argv[0]);
+    }
+  }
+  if (pic.rateHz == 0 || summaryEvery == 0 || maxStepUs < 10) {
+    usage(argv[0]);
+  }
+
+  FILE *log = stdout;
+  if (logPath) {
+    log = fopen(logPath, "w");
+    if (log == NULL) {
+      fprintf(stderr, "can't open %s\n", logPath);
+      return 2;
+    }
+  }
+
+  simHost.setup();
+  simDevice.setup();
+  simDevice.setBaudRate(baud);
+  if (pollMs > 0) {
+    simHost.setPollTime(pollMs);
+    simDevice.setPollTime(pollMs);
+  }
+
+  EnduranceCounter counter(log, summaryEvery);
+  fprintf(log, "OpenBCI Endurance Test\nPush The World LLC\n");
+  fprintf(log, "START!\n");
+  counter.writeDateAndTime();
+
+  pic.startUs = 1000000;
+  pic.stopUs = pic.startUs + (uint64_t)minutes * 60 * 1000000;
+  uint64_t endUs = pic.stopUs + 500000;
+  while (simNowUs < endUs) {
+    simAdvance(simNextStepUs(pic.nextEventAt(), maxStepUs));
+    pic.run(simDevice.serial);
+    simLoops();
+    counter.run(simHost.serial);
+  }
+  counter.summary();
+  if (log != stdout) {
+    fclose(log);
+  }
+
+  // Samples the Host never wrote at the end of the run aren't seen by the
+  //  continuity check, so count them here
+  unsigned long long missing = pic.sent > counter.rawSampleCount ? pic.sent - counter.rawSampleCount : 0;
+  fprintf(stderr, "samples_sent: %u\n", pic.sent);
+  fprintf(stderr, "samples_received: %llu\n", counter.rawSampleCount);
+  fprintf(stderr, "samples_missing: %llu\n", missing);
+  fprintf(stderr, "good_packets: %llu\n", counter.goodPackets);
+  fprintf(stderr, "bad_packets: %llu\n", counter.badPackets);
+  fprintf(stderr, "link_dropped: %u\n", simLink.dropped);
+
+  if (maxBad >= 0 && (long long)counter.badPackets > maxBad) {
+    fprintf(stderr, "result: fail\n");
+    return 1;
+  }
+  fprintf(stderr, "result: pass\n");
+  return 0;
+}
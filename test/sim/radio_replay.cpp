@@ -0,0 +1,380 @@
+/**
+* Name: radio_replay.cpp
+* Purpose: Replays a session recorded by the scripts in test/js through the
+*   simulated Host and Device. The Pic's byte stream is rebuilt from the
+*   recording and written to the Device at the recorded times, then everything
+*   the Host writes to the PC is checked byte for byte against it. Sample gaps
+*   logged by an endurance test can be replayed as link drops. See README.md in
+*   this folder.
+*
+* Author: Push The World LLC (AJ Keller)
+*/
+
+#include <stdlib.h>
+#include <time.h>
+#include <algorithm>
+#include <deque>
+#include "sim.h"
+
+// How far ahead of the next expected packet a Host packet is looked for
+//  before it is called a mismatch
+#define REPLAY_SEARCH_PACKETS 512
+// A logged gap that hasn't been dropped within this long is given up on
+#define REPLAY_DROP_WINDOW_US 2000000
+
+typedef struct {
+  uint64_t at;
+  uint8_t data[SIM_STREAM_PACKET_SIZE_BYTES];
+} ReplayPacket;
+
+typedef struct {
+  uint64_t at;
+  uint32_t index;
+} ReplayDrop;
+
+static std::vector<ReplayPacket> replayPackets;
+static std::deque<ReplayDrop> replayDrops;
+static uint32_t replayDropsApplied = 0;
+static uint32_t replayDropsExpired = 0;
+
+static bool replayEarlier(const std::pair<unsigned long long, long> &a, const std::pair<unsigned long long, long> &b) {
+  return a.first < b.first;
+}
+
+/**
+* @description Loads a samples recording, `Time Stamp,<value>,Board Time` with
+*  one row per sample, as written by time-sync-validation.js and friends. Each
+*  row becomes a time stamped stream packet from the Pic: the value goes in the
+*  aux bytes and the board time in the last four, with a `0xC4` stop byte.
+* @param path {const char *} - The csv to load
+* @param startUs {uint64_t} - When the first packet is written
+* @param speed {double} - How much faster than recorded to play it
+* @return {boolean} - `false` if the file can't be read or has no samples
+*/
+static boolean replayLoadSamples(const char *path, uint64_t startUs, double speed) {
+  FILE *f = fopen(path, "r");
+  if (f == NULL) {
+    fprintf(stderr, "can't open %s\n", path);
+    return false;
+  }
+  char line[256];
+  std::vector<std::pair<unsigned long long, long> > rows;
+  while (fgets(line, sizeof(line), f)) {
+    unsigned long long stamp, boardTime;
+    long value;
+    if (sscanf(line, "%llu,%ld,%llu", &stamp, &value, &boardTime) == 3) {
+      rows.push_back(std::make_pair(boardTime, value));
+    }
+  }
+  // Rows are in the order the driver got them, the Pic sent them in board
+  //  time order. A row logged twice is one sample.
+  std::stable_sort(rows.begin(), rows.end(), replayEarlier);
+  rows.erase(std::unique(rows.begin(), rows.end()), rows.end());
+  for (size_t i = 0; i < rows.size(); i++) {
+    unsigned long long boardTime = rows[i].first;
+    long value = rows[i].second;
+    ReplayPacket packet;
+    packet.at = startUs + (uint64_t)((boardTime - rows[0].first) * 1000 / speed);
+    memset(packet.data, 0, sizeof(packet.data));
+    packet.data[0] = 0x41; // The Pic starts stream packets with 'A'
+    packet.data[1] = (uint8_t)i;
+    packet.data[26] = (uint8_t)(value >> 8);
+    packet.data[27] = (uint8_t)value;
+    for (int j = 0; j < 4; j++) {
+      packet.data[28 + j] = (uint8_t)(boardTime >> (8 * (3 - j)));
+    }
+    packet.data[SIM_STREAM_PACKET_SIZE_BYTES - 1] = 0xC4;
+    replayPackets.push_back(packet);
+  }
+  fclose(f);
+  if (replayPackets.empty()) {
+    fprintf(stderr, "no samples in %s\n", path);
+    return false;
+  }
+  return true;
+}
+
+static boolean replayParseDate(const char *s, struct tm *t) {
+  memset(t, 0, sizeof(*t));
+  if (sscanf(s, "%d-%d-%d %d:%d:%d", &t->tm_year, &t->tm_mon, &t->tm_mday, &t->tm_hour, &t->tm_min, &t->tm_sec) != 6) {
+    return false;
+  }
+  t->tm_year -= 1900;
+  t->tm_mon -= 1;
+  return true;
+}
+
+/**
+* @description Loads the gaps from an endurance test log, the `err: expected X
+*  got Y at <time>` lines. Each one becomes a run of `Y - X` samples dropped on
+*  the link, starting at the first sample numbered `X` in that second of the
+*  replay. Only whole seconds are logged so where a gap lands is approximate.
+* @param path {const char *} - The log to load
+* @param startUs {uint64_t} - When the replay starts
+* @param speed {double} - How much faster than recorded the replay plays
+* @return {boolean} - `false` if the file can't be read or has no start time
+*/
+static boolean replayLoadDrops(const char *path, uint64_t startUs, double speed) {
+  FILE *f = fopen(path, "r");
+  if (f == NULL) {
+    fprintf(stderr, "can't open %s\n", path);
+    return false;
+  }
+  char line[256];
+  boolean haveStart = false;
+  time_t start = 0;
+  size_t index = 0;
+  while (fgets(line, sizeof(line), f)) {
+    struct tm t;
+    unsigned expected, got;
+    char when[64];
+    if (!haveStart) {
+      if (!strncmp(line, "Date and time: ", 15) && replayParseDate(line + 15, &t)) {
+        start = mktime(&t);
+        haveStart = true;
+      }
+      continue;
+    }
+    if (sscanf(line, "err: expected %u got %u at %63[^\n]", &expected, &got, when) != 3 || !replayParseDate(when, &t)) {
+      continue;
+    }
+    uint64_t secondUs = startUs + (uint64_t)((mktime(&t) - start) * 1000000.0 / speed);
+    while (index < replayPackets.size() && (replayPackets[index].at < secondUs || (index & 0xFF) != expected)) {
+      index++;
+    }
+    uint8_t count = (uint8_t)(got - expected);
+    for (uint8_t i = 0; i < count && index < replayPackets.size(); i++, index++) {
+      ReplayDrop drop = { replayPackets[index].at, (uint32_t)index };
+      replayDrops.push_back(drop);
+    }
+  }
+  fclose(f);
+  if (!haveStart) {
+    fprintf(stderr, "no start time in %s\n", path);
+    return false;
+  }
+  return true;
+}
+
+/**
+* @description The link's drop hook. Drops the first try of the stream packet
+*  carrying the next logged gap's sample, so a resend can still get through.
+*/
+static boolean replayDrop(const SimPacket &packet) {
+  while (!replayDrops.empty() && simNowUs > replayDrops.front().at + REPLAY_DROP_WINDOW_US) {
+    replayDrops.pop_front();
+    replayDropsExpired++;
+  }
+  if (replayDrops.empty() || packet.length < 2) {
+    return false;
+  }
+  uint8_t byteId = (uint8_t)packet.data[0];
+  boolean isStream = byteId & 0x80;
+  boolean isParity = ((byteId >> 3) & 0x0F) == 0x0F;
+  ReplayDrop &drop = replayDrops.front();
+  if (!isStream || isParity || simNowUs < drop.at || (uint8_t)packet.data[1] != (uint8_t)drop.index) {
+    return false;
+  }
+  replayDrops.pop_front();
+  replayDropsApplied++;
+  return true;
+}
+
+// Writes the recording to the Device's serial port at the recorded times
+class ReplayPic {
+public:
+  ReplayPic(void) {
+    next = 0;
+  }
+
+  void run(HardwareSerial *serial) {
+    while (serial->txAvailable()) {
+      serial->txRead();
+    }
+    while (next < replayPackets.size() && replayPackets[next].at <= simNowUs) {
+      serial->inject(replayPackets[next].data, SIM_STREAM_PACKET_SIZE_BYTES);
+      next++;
+    }
+  }
+
+  boolean done(void) {
+    return next >= replayPackets.size();
+  }
+
+  size_t next;
+};
+
+// Checks what the Host writes to the PC against the recording. The Host must
+//  write each packet it gets as `0xA0` and the Pic's other 32 bytes unchanged,
+//  in order. Packets that never show up are counted as lost.
+class ReplayChecker {
+public:
+  ReplayChecker(void) {
+    expected = 0;
+    framePosition = 0;
+    matched = 0;
+    lost = 0;
+    mismatched = 0;
+    textBytes = 0;
+    firstMismatch = -1;
+  }
+
+  void run(HardwareSerial *serial) {
+    while (serial->txAvailable()) {
+      uint8_t b = (uint8_t)serial->txRead();
+      if (framePosition == 0 && b != 0xA0) {
+        textBytes++;
+        continue;
+      }
+      frame[framePosition++] = b;
+      if (framePosition == SIM_STREAM_PACKET_SIZE_BYTES) {
+        packet();
+        framePosition = 0;
+      }
+    }
+  }
+
+  size_t expected;
+  uint32_t matched;
+  uint32_t lost;
+  uint32_t mismatched;
+  uint32_t textBytes;
+  long firstMismatch;
+
+private:
+  boolean matches(size_t index) {
+    const uint8_t *want = replayPackets[index].data;
+    return frame[0] == 0xA0 && !memcmp(frame + 1, want + 1, SIM_STREAM_PACKET_SIZE_BYTES - 1);
+  }
+
+  void packet(void) {
+    for (size_t i = expected; i < replayPackets.size() && i < expected + REPLAY_SEARCH_PACKETS; i++) {
+      if (matches(i)) {
+        lost += i - expected;
+        expected = i + 1;
+        matched++;
+        return;
+      }
+    }
+    if (firstMismatch < 0) {
+      firstMismatch = (long)expected;
+      fprintf(stderr, "mismatch near packet %ld, got:", firstMismatch);
+      for (int i = 0; i < SIM_STREAM_PACKET_SIZE_BYTES; i++) {
+        fprintf(stderr, " %02X", frame[i]);
+      }
+      fprintf(stderr, "\n");
+    }
+    mismatched++;
+  }
+
+  uint8_t frame[SIM_STREAM_PACKET_SIZE_BYTES];
+  uint8_t framePosition;
+};
+
+static void usage(const char *name) {
+  fprintf(stderr,
+    "usage: %s --samples FILE [options]\n"
+    "  --samples FILE      samples csv from test/js/results to replay\n"
+    "  --drops FILE        endurance test log whose gaps are dropped on the link\n"
+    "  --speed X           play the recording X times faster (1)\n"
+    "  --baud N            baud rate of the Pic and PC ports (115200)\n"
+    "  --poll-ms N         poll time on both radios (library default)\n"
+    "  --drain-ms N        run on after the last packet (500)\n"
+    "  --step-us N         simulation step (10)\n"
+    "  and the link options of radio_sim, --seed, --loss, --ge and so on\n",
+    name);
+  exit(2);
+}
+
+int main(int argc, char **argv) {
+  const char *samplesPath = NULL;
+  const char *dropsPath = NULL;
+  double speed = 1;
+  uint32_t baud = 115200;
+  uint32_t pollMs = 0;
+  uint32_t drainMs = 500;
+  uint32_t stepUs = 10;
+  uint64_t startUs = 200000;
+
+  for (int i = 1; i < argc; i++) {
+    const char *arg = argv[i];
+    if (i + 1 >= argc) {
+      usage(argv[0]);
+    }
+    const char *value = argv[++i];
+    if (!strcmp(arg, "--samples")) {
+      samplesPath = value;
+    } else if (!strcmp(arg, "--drops")) {
+      dropsPath = value;
+    } else if (!strcmp(arg, "--speed")) {
+      speed = atof(value);
+    } else if (simLinkOption(arg, value)) {
+      continue;
+    } else if (!strcmp(arg, "--baud")) {
+      baud = atoi(value);
+    } else if (!strcmp(arg, "--poll-ms")) {
+      pollMs = atoi(value);
+    } else if (!strcmp(arg, "--drain-ms")) {
+      drainMs = atoi(value);
+    } else if (!strcmp(arg, "--step-us")) {
+      stepUs = atoi(value);
+    } else {
+      usage(argv[0]);
+    }
+  }
+  if (samplesPath == NULL || speed <= 0 || stepUs == 0) {
+    usage(argv[0]);
+  }
+  if (!replayLoadSamples(samplesPath, startUs, speed)) {
+    return 2;
+  }
+  if (dropsPath) {
+    if (!replayLoadDrops(dropsPath, startUs, speed)) {
+      return 2;
+    }
+    simLink.drop = replayDrop;
+  }
+  uint32_t dropsLogged = replayDrops.size();
+
+  simHost.setup();
+  simDevice.setup();
+  // Playing faster needs faster ports on both ends
+  simDevice.setBaudRate(baud);
+  simHost.setBaudRate(baud);
+  if (pollMs > 0) {
+    simHost.setPollTime(pollMs);
+    simDevice.setPollTime(pollMs);
+  }
+
+  ReplayPic pic;
+  ReplayChecker checker;
+  uint64_t endUs = replayPackets.back().at + (uint64_t)drainMs * 1000;
+  while (simNowUs < endUs || !pic.done()) {
+    simAdvance(stepUs);
+    pic.run(simDevice.serial);
+    simLoops();
+    checker.run(simHost.serial);
+  }
+  // Anything never written by the end is lost too
+  checker.lost += replayPackets.size() - checker.expected;
+
+  printf("recording: %s\n", samplesPath);
+  printf("speed: %g\n", speed);
+  printf("packets_replayed: %u\n", (unsigned)replayPackets.size());
+  printf("packets_matched: %u\n", checker.matched);
+  printf("packets_lost: %u\n", checker.lost);
+  printf("packets_mismatched: %u\n", checker.mismatched);
+  printf("text_bytes: %u\n", checker.textBytes);
+  if (dropsPath) {
+    printf("drops_logged: %u\n", dropsLogged);
+    printf("drops_applied: %u\n", replayDropsApplied);
+    printf("drops_expired: %u\n", replayDropsExpired + (uint32_t)replayDrops.size());
+  }
+  printf("link_dropped: %u\n", simLink.dropped);
+
+  // Only a clean link has to get everything through
+  boolean clean = dropsPath == NULL && simLink.forward.lossless() && simLink.backward.lossless();
+  boolean pass = checker.mismatched == 0 && checker.textBytes == 0 && (!clean || checker.lost == 0);
+  printf("result: %s\n", pass ? "pass" : "fail");
+  return pass ? 0 : 1;
+}
@@ -0,0 +1,206 @@
+/**
+* Name: radio_sim.cpp
+* Purpose: Runs the Host and Device over a simulated lossy GZLL link with a
+*   Pic streaming into the Device, then reports goodput, the gaps between the
+*   samples the PC got and the latency from the Pic to the PC. See README.md in
+*   this folder for the options.
+*
+* Author: Push The World LLC (AJ Keller)
+*/
+
+#include <stdlib.h>
+#include "sim.h"
+#include "OpenBCI_Radios_Definitions.h"
+
+static void usage(const char *name) {
+  fprintf(stderr,
+    "usage: %s [options]\n"
+    "  --seed N            random seed (1)\n"
+    "  --duration-ms N     how long the Pic streams (10000)\n"
+    "  --start-ms N        when the Pic starts streaming (200)\n"
+    "  --drain-ms N        run on after the Pic stops (500)\n"
+    "  --rate-hz N         stream packets per second (250)\n"
+    "  --baud N            Pic to Device baud rate (115200)\n"
+    "  --poll-ms N         poll time on both radios (library default)\n"
+    "  --loss P            Bernoulli loss for packets and acks\n"
+    "  --ge PGB,PBG,LG,LB  Gilbert-Elliott loss: good to bad, bad to good,\n"
+    "                      loss when good, loss when bad\n"
+    "  --air-us N          air time of one packet (300)\n"
+    "  --ack-us N          ack turnaround (130)\n"
+    "  --retry-us N        wait before a retry (600)\n"
+    "  --retries N         retries before a packet is dropped (15)\n"
+    "  --fifo N            TX FIFO depth on each radio (3)\n"
+    "  --step-us N         simulation step (10)\n"
+    "  --batch 0|1         have the Host batch stream packets (0)\n"
+    "  --low-power MS      have the Device send stream packets in bursts,\n"
+    "                      holding them at most MS (0 is off)\n"
+    "  --move-channel-at-ms N  move the Device to the next channel without\n"
+    "                      the Host, as if it missed a channel change\n"
+    "  --channel-at-ms N   have the driver move both radios to the next\n"
+    "                      channel\n"
+    "  --reset-at-ms N     reset both radios, keeping their flash, as if\n"
+    "                      the power browned out\n"
+    "  --trace FILE        ask the Host for a trace dump and write it here\n"
+    "  --trace-at-ms N     when to ask for it (when the Pic stops)\n",
+    name);
+  exit(1);
+}
+
+int main(int argc, char **argv) {
+  uint32_t durationMs = 10000;
+  uint32_t startMs = 200;
+  uint32_t drainMs = 500;
+  uint32_t baud = 115200;
+  uint32_t pollMs = 0;
+  uint32_t stepUs = 10;
+  const char *tracePath = NULL;
+  long long traceAtMs = -1;
+  boolean batch = false;
+  uint32_t lowPowerMs = 0;
+  long long moveChannelAtMs = -1;
+  long long channelAtMs = -1;
+  long long resetAtMs = -1;
+  uint32_t hostLinkSearches = 0;
+  uint32_t deviceLinkSearches = 0;
+  boolean hostLinkSearching = false;
+  boolean deviceLinkSearching = false;
+  SimPic pic;
+  SimDriver driver;
+
+  for (int i = 1; i < argc; i++) {
+    const char *arg = argv[i];
+    if (i + 1 >= argc) {
+      usage(argv[0]);
+    }
+    const char *value = argv[++i];
+    if (simLinkOption(arg, value)) {
+      continue;
+    } else if (!strcmp(arg, "--duration-ms")) {
+      durationMs = atoi(value);
+    } else if (!strcmp(arg, "--start-ms")) {
+      startMs = atoi(value);
+    } else if (!strcmp(arg, "--drain-ms")) {
+      drainMs = atoi(value);
+    } else if (!strcmp(arg, "--rate-hz")) {
+      pic.rateHz = atoi(value);
+    } else if (!strcmp(arg, "--baud")) {
+      baud = atoi(value);
+    } else if (!strcmp(arg, "--poll-ms")) {
+      pollMs = atoi(value);
+    } else if (!strcmp(arg, "--step-us")) {
+      stepUs = atoi(value);
+    } else if (!strcmp(arg, "--batch")) {
+      batch = atoi(value) != 0;
+    } else if (!strcmp(arg, "--low-power")) {
+      lowPowerMs = atoi(value);
+    } else if (!strcmp(arg, "--move-channel-at-ms")) {
+      moveChannelAtMs = atoll(value);
+    } else if (!strcmp(arg, "--channel-at-ms")) {
+      channelAtMs = atoll(value);
+    } else if (!strcmp(arg, "--reset-at-ms")) {
+      resetAtMs = atoll(value);
+    } else if (!strcmp(arg, "--trace")) {
+      tracePath = value;
+    } else if (!strcmp(arg, "--trace-at-ms")) {
+      traceAtMs = atoll(value);
+    } else {
+      usage(argv[0]);
+    }
+  }
+  if (pic.rateHz == 0 || stepUs == 0) {
+    usage(argv[0]);
+  }
+
+  simHost.setup();
+  simDevice.setup();
+  simDevice.setBaudRate(baud);
+  if (pollMs > 0) {
+    simHost.setPollTime(pollMs);
+    simDevice.setPollTime(pollMs);
+  }
+  if (batch) {
+    uint8_t command[] = {OPENBCI_HOST_PRIVATE_CMD_KEY, OPENBCI_HOST_CMD_BATCH_ON};
+    simHost.serial->inject(command, sizeof(command));
+  }
+
+  pic.startUs = (uint64_t)startMs * 1000;
+  pic.stopUs = pic.startUs + (uint64_t)durationMs * 1000;
+  uint64_t endUs = pic.stopUs + (uint64_t)drainMs * 1000;
+
+  // The trace dump is text from the Host, it goes to the file instead of
+  //  just being counted. Build with -DOPENBCI_TRACE_ENABLED=1 for records.
+  uint64_t traceAtUs = traceAtMs >= 0 ? (uint64_t)traceAtMs * 1000 : pic.stopUs;
+  boolean traceAsked = tracePath == NULL;
+  // The Host needs to have heard from the Device before it passes this on,
+  //  so it goes in when the Pic starts
+  boolean lowPowerAsked = lowPowerMs == 0;
+  if (tracePath) {
+    driver.text = fopen(tracePath, "w");
+    if (driver.text == NULL) {
+      fprintf(stderr, "can't open %s\n", tracePath);
+      return 1;
+    }
+    // The Device's records come in over the radio after the Host's, a
+    //  packet a poll once the Pic has stopped
+    if (endUs < traceAtUs + 3000000) {
+      endUs = traceAtUs + 3000000;
+    }
+  }
+
+  while (simNowUs < endUs) {
+    simStep(&pic, &driver, stepUs);
+    if (!lowPowerAsked && simNowUs >= pic.startUs) {
+      uint8_t command[] = {OPENBCI_HOST_PRIVATE_CMD_KEY, OPENBCI_HOST_CMD_LOW_POWER_SET, (uint8_t)lowPowerMs};
+      simHost.serial->inject(command, sizeof(command));
+      lowPowerAsked = true;
+    }
+    if (moveChannelAtMs >= 0 && simNowUs >= (uint64_t)moveChannelAtMs * 1000) {
+      simDevice.moveChannel((simDevice.gzll->channel + 1) % (RFDUINOGZLL_CHANNEL_LIMIT_UPPER + 1));
+      moveChannelAtMs = -1;
+    }
+    if (channelAtMs >= 0 && simNowUs >= (uint64_t)channelAtMs * 1000) {
+      uint8_t command[] = {OPENBCI_HOST_PRIVATE_CMD_KEY, OPENBCI_HOST_CMD_CHANNEL_SET, (uint8_t)((simHost.gzll->channel + 1) % (RFDUINOGZLL_CHANNEL_LIMIT_UPPER + 1))};
+      simHost.serial->inject(command, sizeof(command));
+      channelAtMs = -1;
+    }
+    if (simHost.linkSearching() != hostLinkSearching) {
+      hostLinkSearching = !hostLinkSearching;
+      hostLinkSearches += hostLinkSearching;
+    }
+    if (simDevice.linkSearching() != deviceLinkSearching) {
+      deviceLinkSearching = !deviceLinkSearching;
+      deviceLinkSearches += deviceLinkSearching;
+    }
+    if (resetAtMs >= 0 && simNowUs >= (uint64_t)resetAtMs * 1000) {
+      simHost.reset();
+      simDevice.reset();
+      resetAtMs = -1;
+    }
+    if (!traceAsked && simNowUs >= traceAtUs) {
+      uint8_t command[] = {OPENBCI_HOST_PRIVATE_CMD_KEY, OPENBCI_HOST_CMD_TRACE_DUMP};
+      simHost.serial->inject(command, sizeof(command));
+      traceAsked = true;
+    }
+  }
+  if (driver.text) {
+    fclose(driver.text);
+  }
+
+  printf("seed: %llu\n", (unsigned long long)simLink.seed);
+  printf("stream_ms: %u\n", durationMs);
+  printf("rate_hz: %u\n", pic.rateHz);
+  printf("ring_depth: %u\n", (unsigned)OPENBCI_NUMBER_STREAM_BUFFERS);
+  printf("fifo_depth: %u\n", simLink.fifoDepth);
+  driver.report(stdout, &pic, (uint64_t)durationMs * 1000);
+
+  // What the Device counted, the same numbers 0xF0 0x17 gets from the Host
+  uint32_t packets, radioOnUs, wakes;
+  simDevice.lowPower(&packets, &radioOnUs, &wakes);
+  printf("device_packets: %u\n", packets);
+  printf("device_wakes: %u\n", wakes);
+  printf("device_radio_on_us: %u\n", radioOnUs);
+  printf("device_radio_on_us_per_packet: %.1f\n", packets > 0 ? (double)radioOnUs / packets : 0.0);
+  printf("host_link_searches: %u\n", hostLinkSearches);
+  printf("device_link_searches: %u\n", deviceLinkSearches);
+  return 0;
+}
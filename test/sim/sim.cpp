@@ -0,0 +1,742 @@
+/**
+* Name: sim.cpp
+* Purpose: The simulated platform, link, Pic and driver. See sim.h.
+*
+* Author: Push The World LLC (AJ Keller)
+*/
+
+#include <stdlib.h>
+#include <algorithm>
+#include "sim.h"
+#include "OpenBCI_Radios_Definitions.h"
+
+uint64_t simNowUs = 0;
+SimLink simLink;
+
+/***************************************************/
+/** ARDUINO ****************************************/
+/***************************************************/
+
+unsigned long millis(void) {
+  return (unsigned long)(simNowUs / 1000);
+}
+
+unsigned long micros(void) {
+  return (unsigned long)simNowUs;
+}
+
+// A blocking delay holds up the whole simulation, just like it holds up the
+//  radio it was called on
+void delay(unsigned long ms) {
+  simNowUs += (uint64_t)ms * 1000;
+}
+
+void delayMicroseconds(unsigned int us) {
+  simNowUs += us;
+}
+
+// The radio callbacks only run between calls to `loop()`
+void noInterrupts(void) {}
+void interrupts(void) {}
+
+void pinMode(int, int) {}
+void digitalWrite(int, int) {}
+int digitalRead(int) {
+  return LOW;
+}
+
+HardwareSerial::HardwareSerial(void) {
+  baudRate = 115200;
+  rxFreeAt = 0;
+  txFreeAt = 0;
+}
+
+void HardwareSerial::begin(unsigned long baud) {
+  baudRate = baud;
+}
+
+void HardwareSerial::begin(unsigned long baud, int, int) {
+  baudRate = baud;
+}
+
+/**
+* @description Time for one byte on the wire, 8N1 is 10 bits a byte
+*/
+uint64_t HardwareSerial::byteTimeUs(void) {
+  return (10000000 + baudRate / 2) / baudRate;
+}
+
+int HardwareSerial::available(void) {
+  int count = 0;
+  for (size_t i = 0; i < rx.size() && rx[i].at <= simNowUs; i++) {
+    count++;
+  }
+  return count;
+}
+
+int HardwareSerial::read(void) {
+  if (rx.empty() || rx.front().at > simNowUs) {
+    return -1;
+  }
+  uint8_t value = rx.front().value;
+  rx.pop_front();
+  return value;
+}
+
+size_t HardwareSerial::write(uint8_t value) {
+  txFreeAt = std::max(txFreeAt, simNowUs) + byteTimeUs();
+  SerialByte b = { txFreeAt, value };
+  tx.push_back(b);
+  return 1;
+}
+
+size_t HardwareSerial::print(const char *s) {
+  size_t n = 0;
+  while (s[n]) {
+    write((uint8_t)s[n]);
+    n++;
+  }
+  return n;
+}
+
+size_t HardwareSerial::print(char c) {
+  return write((uint8_t)c);
+}
+
+size_t HardwareSerial::print(unsigned char b) {
+  return print((unsigned int)b);
+}
+
+size_t HardwareSerial::print(int n) {
+  return print((long)n);
+}
+
+size_t HardwareSerial::print(unsigned int n) {
+  return print((unsigned long)n);
+}
+
+size_t HardwareSerial::print(long n) {
+  char s[24];
+  snprintf(s, sizeof(s), "%ld", n);
+  return print(s);
+}
+
+size_t HardwareSerial::print(unsigned long n) {
+  char s[24];
+  snprintf(s, sizeof(s), "%lu", n);
+  return print(s);
+}
+
+size_t HardwareSerial::println(void) {
+  return print("\r\n");
+}
+
+size_t HardwareSerial::println(const char *s) {
+  return print(s) + println();
+}
+
+size_t HardwareSerial::println(int n) {
+  return print(n) + println();
+}
+
+size_t HardwareSerial::println(unsigned long n) {
+  return print(n) + println();
+}
+
+/**
+* @description Queues bytes to arrive at the radio at the baud rate, after any
+*  still on the wire.
+*/
+void HardwareSerial::inject(const uint8_t *data, size_t length) {
+  for (size_t i = 0; i < length; i++) {
+    rxFreeAt = std::max(rxFreeAt, simNowUs) + byteTimeUs();
+    SerialByte b = { rxFreeAt, data[i] };
+    rx.push_back(b);
+  }
+}
+
+int HardwareSerial::txAvailable(void) {
+  return !tx.empty() && tx.front().at <= simNowUs;
+}
+
+/**
+* @description When the next byte lands on either side of the port, or
+*  `UINT64_MAX` if the port is quiet.
+*/
+uint64_t HardwareSerial::nextEventAt(void) {
+  uint64_t at = UINT64_MAX;
+  if (!rx.empty()) {
+    at = rx.front().at;
+  }
+  if (!tx.empty()) {
+    at = std::min(at, tx.front().at);
+  }
+  return at;
+}
+
+void HardwareSerial::txClear(void) {
+  tx.clear();
+  txFreeAt = simNowUs;
+}
+
+int HardwareSerial::txRead(void) {
+  if (!txAvailable()) {
+    return -1;
+  }
+  uint8_t value = tx.front().value;
+  tx.pop_front();
+  return value;
+}
+
+/***************************************************/
+/** RFDUINOGZLL ************************************/
+/***************************************************/
+
+RFduinoGZLLClass::RFduinoGZLLClass(void) {
+  channel = 0;
+  txPowerLevel = 0;
+  active = false;
+  role = HOST;
+}
+
+int RFduinoGZLLClass::begin(device_t r) {
+  role = r;
+  active = true;
+  return 0;
+}
+
+void RFduinoGZLLClass::end(void) {
+  active = false;
+}
+
+bool RFduinoGZLLClass::sendToHost(const char *data, int length) {
+  return active && simLink.push(HOST, data, length);
+}
+
+bool RFduinoGZLLClass::sendToDevice(device_t, const char *data, int length) {
+  return active && simLink.push(DEVICE0, data, length);
+}
+
+/***************************************************/
+/** RANDOM AND LOSS ********************************/
+/***************************************************/
+
+void SimRandom::seed(uint64_t s) {
+  state = s ? s : 0x9E3779B97F4A7C15ULL;
+}
+
+double SimRandom::next(void) {
+  state ^= state >> 12;
+  state ^= state << 25;
+  state ^= state >> 27;
+  return ((state * 0x2545F4914F6CDD1DULL) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+SimLossModel::SimLossModel(void) {
+  bernoulli(0);
+}
+
+void SimLossModel::bernoulli(double p) {
+  goodToBad = 0;
+  badToGood = 1;
+  goodLoss = p;
+  badLoss = p;
+  bad = false;
+}
+
+boolean SimLossModel::lossless(void) {
+  return goodLoss == 0 && (goodToBad == 0 || badLoss == 0);
+}
+
+boolean SimLossModel::lost(SimRandom &random) {
+  if (bad) {
+    if (random.next() < badToGood) {
+      bad = false;
+    }
+  } else if (random.next() < goodToBad) {
+    bad = true;
+  }
+  return random.next() < (bad ? badLoss : goodLoss);
+}
+
+/***************************************************/
+/** LINK *******************************************/
+/***************************************************/
+
+SimLink::SimLink(void) {
+  fifoDepth = 3;
+  airUs = 300;
+  ackUs = 130;
+  retryUs = 600;
+  maxRetries = 15;
+  seed = 1;
+  random.seed(seed);
+  drop = NULL;
+  attempts = 0;
+  forwardLost = 0;
+  ackLost = 0;
+  dropped = 0;
+  deviceFifoFull = 0;
+  hostFifoFull = 0;
+  busy = false;
+  delivered = false;
+  ackHeld = false;
+  doneAt = 0;
+  nextAttemptAt = 0;
+  retries = 0;
+}
+
+/**
+* @description Puts a packet on the sender's TX FIFO.
+* @param to {device_t} - `HOST` when the Device sends, the Device otherwise
+* @return {boolean} - `false` if the FIFO is full
+*/
+boolean SimLink::push(device_t to, const char *data, int length) {
+  std::deque<SimPacket> &fifo = to == HOST ? deviceFifo : hostFifo;
+  if (fifo.size() >= fifoDepth) {
+    if (to == HOST) {
+      deviceFifoFull++;
+    } else {
+      hostFifoFull++;
+    }
+    return false;
+  }
+  SimPacket packet;
+  packet.length = (uint8_t)std::min(std::max(length, 0), SIM_PACKET_SIZE_BYTES);
+  if (packet.length > 0) {
+    memcpy(packet.data, data, packet.length);
+  }
+  fifo.push_back(packet);
+  return true;
+}
+
+/**
+* @description When the link next has something to do, or `UINT64_MAX` if the
+*  Device has nothing to send.
+*/
+uint64_t SimLink::nextEventAt(void) {
+  if (busy) {
+    return doneAt;
+  }
+  if (deviceFifo.empty()) {
+    return UINT64_MAX;
+  }
+  return nextAttemptAt;
+}
+
+void SimLink::retry(void) {
+  retries++;
+  if (retries > maxRetries) {
+    // Gazell gives up on the packet, and any ack payload that went with it
+    dropped++;
+    deviceFifo.pop_front();
+    retries = 0;
+    delivered = false;
+    ackHeld = false;
+    nextAttemptAt = simNowUs;
+    return;
+  }
+  nextAttemptAt = simNowUs + retryUs;
+}
+
+/**
+* @description Moves the packet at the head of the Device's TX FIFO along. An
+*  attempt takes the packet's air time, the turnaround and the ack's air time.
+*  The Host hears a packet once even if its ack is lost and it is sent again,
+*  and the ack payload it picked goes out again with it.
+*/
+void SimLink::run(void) {
+  if (!busy) {
+    if (deviceFifo.empty() || simNowUs < nextAttemptAt) {
+      return;
+    }
+    busy = true;
+    doneAt = simNowUs + airUs + ackUs + airUs;
+    return;
+  }
+  if (simNowUs < doneAt) {
+    return;
+  }
+  busy = false;
+  attempts++;
+
+  boolean linked = simHost.gzll->active && simDevice.gzll->active && simHost.gzll->channel == simDevice.gzll->channel;
+  if (!linked || forward.lost(random)) {
+    forwardLost++;
+    retry();
+    return;
+  }
+
+  SimPacket packet = deviceFifo.front();
+  if (!delivered && retries == 0 && drop && drop(packet)) {
+    // Lost on every try, as if Gazell ran out of retries
+    forwardLost++;
+    retries = maxRetries;
+    retry();
+    return;
+  }
+  if (!delivered) {
+    delivered = true;
+    // The ack carries what the Host queued before this packet came in
+    ackHeld = !hostFifo.empty();
+    if (ackHeld) {
+      ack = hostFifo.front();
+      hostFifo.pop_front();
+    }
+    simHost.onReceive(DEVICE0, 0, packet.data, packet.length);
+  }
+
+  if (backward.lost(random)) {
+    ackLost++;
+    retry();
+    return;
+  }
+
+  deviceFifo.pop_front();
+  delivered = false;
+  retries = 0;
+  nextAttemptAt = simNowUs;
+  SimPacket payload;
+  payload.length = 0;
+  if (ackHeld) {
+    payload = ack;
+    ackHeld = false;
+  }
+  simDevice.onReceive(HOST, 0, payload.data, payload.length);
+}
+
+/***************************************************/
+/** PIC ********************************************/
+/***************************************************/
+
+SimPic::SimPic(void) {
+  rateHz = 250;
+  startUs = 0;
+  stopUs = 0;
+  sent = 0;
+  bytesFromDevice = 0;
+  nextAt = 0;
+}
+
+uint64_t SimPic::nextEventAt(void) {
+  uint64_t at = std::max(nextAt, startUs);
+  return at < stopUs ? at : UINT64_MAX;
+}
+
+/**
+* @description Writes the stream packets that are due to the Device and reads
+*  anything the Device wrote to the Pic.
+*/
+void SimPic::run(HardwareSerial *serial) {
+  while (serial->txAvailable()) {
+    serial->txRead();
+    bytesFromDevice++;
+  }
+  if (simNowUs < startUs) {
+    return;
+  }
+  if (nextAt < startUs) {
+    nextAt = startUs;
+  }
+  while (nextAt <= simNowUs && nextAt < stopUs) {
+    uint8_t packet[SIM_STREAM_PACKET_SIZE_BYTES];
+    uint32_t made = (uint32_t)nextAt;
+    packet[0] = 0x41; // The Pic starts stream packets with 'A', the Host writes 0xA0
+    packet[1] = (uint8_t)sent;
+    for (int i = 0; i < 4; i++) {
+      packet[2 + i] = (uint8_t)(sent >> (8 * i));
+      packet[6 + i] = (uint8_t)(made >> (8 * i));
+    }
+    for (int i = 10; i < SIM_STREAM_PACKET_SIZE_BYTES - 1; i++) {
+      packet[i] = (uint8_t)(sent + i);
+    }
+    packet[SIM_STREAM_PACKET_SIZE_BYTES - 1] = 0xC0;
+    serial->inject(packet, sizeof(packet));
+    sent++;
+    nextAt = startUs + (uint64_t)sent * 1000000 / rateHz;
+  }
+}
+
+/***************************************************/
+/** DRIVER *****************************************/
+/***************************************************/
+
+SimDriver::SimDriver(void) {
+  packets = 0;
+  duplicates = 0;
+  outOfOrder = 0;
+  for (int i = 0; i < SIM_GAP_BUCKETS; i++) {
+    gaps[i] = 0;
+  }
+  textBytes = 0;
+  batches = 0;
+  batchErrors = 0;
+  text = NULL;
+  framePosition = 0;
+  haveLast = false;
+  lastSequence = 0;
+}
+
+/**
+* @description Reads what the Host wrote to the PC. Stream packets are
+*  `0xA0`, 31 bytes and a `0xCX` stop byte, or come several to a batch once
+*  batching is on, anything else counts as text.
+*/
+void SimDriver::run(HardwareSerial *serial) {
+  while (serial->txAvailable()) {
+    uint8_t b = (uint8_t)serial->txRead();
+    if (!batchBytes.empty()) {
+      batchBytes.push_back(b);
+      batch();
+      continue;
+    }
+    if (framePosition == 0) {
+      if (b == 0xA0) {
+        frame[framePosition++] = b;
+      } else if (b == OPENBCI_BATCH_BYTE_START) {
+        batchBytes.push_back(b);
+      } else {
+        textBytes++;
+        if (text) {
+          fputc(b, text);
+        }
+      }
+      continue;
+    }
+    frame[framePosition++] = b;
+    if (framePosition < SIM_STREAM_PACKET_SIZE_BYTES) {
+      continue;
+    }
+    if ((frame[SIM_STREAM_PACKET_SIZE_BYTES - 1] & 0xF0) == 0xC0) {
+      packet();
+      framePosition = 0;
+      continue;
+    }
+    // Not a packet, start again from the next start byte
+    uint8_t i = 1;
+    while (i < SIM_STREAM_PACKET_SIZE_BYTES && frame[i] != 0xA0) {
+      i++;
+    }
+    textBytes += i;
+    if (text) {
+      fwrite(frame, 1, i, text);
+    }
+    framePosition = SIM_STREAM_PACKET_SIZE_BYTES - i;
+    memmove(frame, frame + i, framePosition);
+  }
+}
+
+static uint16_t simCrc16(const uint8_t *data, size_t len) {
+  uint16_t crc = 0xFFFF;
+  for (size_t i = 0; i < len; i++) {
+    crc ^= (uint16_t)data[i] << 8;
+    for (int bit = 0; bit < 8; bit++) {
+      crc = crc & 0x8000 ? (crc << 1) ^ 0x1021 : crc << 1;
+    }
+  }
+  return crc;
+}
+
+/**
+* @description Called with each byte of a batch. Once the whole batch is in
+*  its CRC is checked and each packet in it is handled like one sent alone.
+*/
+void SimDriver::batch(void) {
+  if (batchBytes.size() < OPENBCI_BATCH_HEADER_BYTES) {
+    return;
+  }
+  uint16_t length = batchBytes[1] | (batchBytes[2] << 8);
+  uint8_t count = batchBytes[3];
+  if (length != count * OPENBCI_BATCH_PACKET_BYTES) {
+    batchErrors++;
+    batchBytes.clear();
+    return;
+  }
+  size_t total = OPENBCI_BATCH_HEADER_BYTES + length + OPENBCI_BATCH_CRC_BYTES;
+  if (batchBytes.size() < total) {
+    return;
+  }
+  uint16_t crc = batchBytes[total - 2] | (batchBytes[total - 1] << 8);
+  if (simCrc16(&batchBytes[1], total - 1 - OPENBCI_BATCH_CRC_BYTES) != crc) {
+    batchErrors++;
+    batchBytes.clear();
+    return;
+  }
+  batches++;
+  for (uint8_t i = 0; i < count; i++) {
+    frame[0] = 0xA0;
+    memcpy(frame + 1, &batchBytes[OPENBCI_BATCH_HEADER_BYTES + i * OPENBCI_BATCH_PACKET_BYTES], OPENBCI_BATCH_PACKET_BYTES);
+    packet();
+  }
+  batchBytes.clear();
+}
+
+static uint8_t simGapBucket(uint32_t gap) {
+  if (gap < 4) return (uint8_t)gap;
+  if (gap < 8) return 4;
+  if (gap < 16) return 5;
+  return 6;
+}
+
+void SimDriver::packet(void) {
+  uint32_t sequence = 0;
+  uint32_t made = 0;
+  for (int i = 0; i < 4; i++) {
+    sequence |= (uint32_t)frame[2 + i] << (8 * i);
+    made |= (uint32_t)frame[6 + i] << (8 * i);
+  }
+  if (sequence < seen.size() && seen[sequence]) {
+    duplicates++;
+    return;
+  }
+  if (sequence >= seen.size()) {
+    seen.resize(sequence + 1, false);
+  }
+  seen[sequence] = true;
+  packets++;
+  latencyUs.push_back((uint32_t)simNowUs - made);
+
+  if (!haveLast) {
+    gaps[simGapBucket(sequence)]++;
+    haveLast = true;
+    lastSequence = sequence;
+  } else if (sequence > lastSequence) {
+    gaps[simGapBucket(sequence - lastSequence - 1)]++;
+    lastSequence = sequence;
+  } else {
+    outOfOrder++;
+  }
+}
+
+static uint32_t simPercentile(std::vector<uint32_t> &sorted, double p) {
+  if (sorted.empty()) {
+    return 0;
+  }
+  size_t i = (size_t)(p * sorted.size());
+  if (i >= sorted.size()) {
+    i = sorted.size() - 1;
+  }
+  return sorted[i];
+}
+
+/**
+* @description Prints goodput, the gaps between delivered samples and the
+*  latency from the Pic to the PC.
+*/
+void SimDriver::report(FILE *out, SimPic *pic, uint64_t streamUs) {
+  static const char *bucketNames[SIM_GAP_BUCKETS] = { "0", "1", "2", "3", "4-7", "8-15", "16+" };
+  double seconds = streamUs / 1000000.0;
+  uint32_t lost = pic->sent > packets ? pic->sent - packets : 0;
+
+  fprintf(out, "packets_sent: %u\n", pic->sent);
+  fprintf(out, "packets_delivered: %u\n", packets);
+  fprintf(out, "packets_lost: %u\n", lost);
+  fprintf(out, "delivered_percent: %.3f\n", pic->sent ? 100.0 * packets / pic->sent : 0.0);
+  fprintf(out, "duplicates: %u\n", duplicates);
+  fprintf(out, "out_of_order: %u\n", outOfOrder);
+  fprintf(out, "goodput_bytes_per_s: %.1f\n", seconds > 0 ? packets * 31.0 / seconds : 0.0);
+  fprintf(out, "text_bytes: %u\n", textBytes);
+  fprintf(out, "batches: %u\n", batches);
+  fprintf(out, "batch_errors: %u\n", batchErrors);
+  fprintf(out, "gaps:");
+  for (int i = 0; i < SIM_GAP_BUCKETS; i++) {
+    fprintf(out, " %s=%u", bucketNames[i], gaps[i]);
+  }
+  fprintf(out, "\n");
+
+  std::vector<uint32_t> sorted(latencyUs);
+  std::sort(sorted.begin(), sorted.end());
+  fprintf(out, "latency_us: p50=%u p90=%u p99=%u p999=%u max=%u\n",
+    simPercentile(sorted, 0.5), simPercentile(sorted, 0.9),
+    simPercentile(sorted, 0.99), simPercentile(sorted, 0.999),
+    sorted.empty() ? 0 : sorted.back());
+
+  fprintf(out, "link_attempts: %u\n", simLink.attempts);
+  fprintf(out, "link_forward_lost: %u\n", simLink.forwardLost);
+  fprintf(out, "link_ack_lost: %u\n", simLink.ackLost);
+  fprintf(out, "link_dropped: %u\n", simLink.dropped);
+  fprintf(out, "device_fifo_full: %u\n", simLink.deviceFifoFull);
+  fprintf(out, "host_fifo_full: %u\n", simLink.hostFifoFull);
+}
+
+/**
+* @description Handles the link options shared by the simulator tools.
+* @param arg {const char *} - The option, e.g. `--loss`
+* @param value {const char *} - Its value
+* @return {boolean} - `false` if `arg` isn't a link option or `value` is bad
+*/
+boolean simLinkOption(const char *arg, const char *value) {
+  if (!strcmp(arg, "--seed")) {
+    simLink.seed = strtoull(value, NULL, 0);
+    simLink.random.seed(simLink.seed);
+  } else if (!strcmp(arg, "--loss")) {
+    simLink.forward.bernoulli(atof(value));
+    simLink.backward.bernoulli(atof(value));
+  } else if (!strcmp(arg, "--ge")) {
+    SimLossModel model;
+    if (sscanf(value, "%lf,%lf,%lf,%lf", &model.goodToBad, &model.badToGood, &model.goodLoss, &model.badLoss) != 4) {
+      return false;
+    }
+    simLink.forward = model;
+    simLink.backward = model;
+  } else if (!strcmp(arg, "--air-us")) {
+    simLink.airUs = atoi(value);
+  } else if (!strcmp(arg, "--ack-us")) {
+    simLink.ackUs = atoi(value);
+  } else if (!strcmp(arg, "--retry-us")) {
+    simLink.retryUs = atoi(value);
+  } else if (!strcmp(arg, "--retries")) {
+    simLink.maxRetries = atoi(value);
+  } else if (!strcmp(arg, "--fifo")) {
+    simLink.fifoDepth = atoi(value);
+    return simLink.fifoDepth > 0;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+/**
+* @description Moves the clock on by `stepUs` and runs the link, its callbacks
+*  stand in for interrupts so they go before either `loop()`.
+*/
+void simAdvance(uint32_t stepUs) {
+  simNowUs += stepUs;
+  simLink.run();
+}
+
+/**
+* @description Runs each radio's `loop()` once.
+*/
+void simLoops(void) {
+  simHost.loop();
+  simDevice.loop();
+}
+
+/**
+* @description How far to step so nothing is skipped: up to the next serial
+*  byte, link event or Pic packet, but at least `minStepUs` and never more
+*  than `maxStepUs` so timers in `loop()` still get looked at.
+* @param picAt {uint64_t} - When the Pic next writes
+*/
+uint32_t simNextStepUs(uint64_t picAt, uint32_t maxStepUs) {
+  static const uint32_t minStepUs = 10;
+  uint64_t at = std::min(picAt, simLink.nextEventAt());
+  at = std::min(at, simHost.serial->nextEventAt());
+  at = std::min(at, simDevice.serial->nextEventAt());
+  if (at <= simNowUs + minStepUs) {
+    return minStepUs;
+  }
+  return (uint32_t)std::min(at - simNowUs, (uint64_t)maxStepUs);
+}
+
+/**
+* @description Moves the whole simulation on by `stepUs`, with the Pic writing
+*  to the Device and the driver reading the Host.
+*/
+void simStep(SimPic *pic, SimDriver *driver, uint32_t stepUs) {
+  simAdvance(stepUs);
+  pic->run(simDevice.serial);
+  simLoops();
+  driver->run(simHost.serial);
+}
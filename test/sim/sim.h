@@ -0,0 +1,178 @@
+/**
+* Name: sim.h
+* Purpose: A simulated GZLL link, Pic and driver for running the Host and
+*   Device sketches together on Linux. Everything runs off one virtual clock
+*   and one seeded random generator, so a seed always gives the same run.
+*
+* Author: Push The World LLC (AJ Keller)
+*/
+
+#ifndef __OpenBCI_Radio_Sim__
+#define __OpenBCI_Radio_Sim__
+
+#include <stdio.h>
+#include <vector>
+#include "Arduino.h"
+#include "RFduinoGZLL.h"
+
+#define SIM_PACKET_SIZE_BYTES 32
+#define SIM_STREAM_PACKET_SIZE_BYTES 33
+#define SIM_GAP_BUCKETS 7 // 0, 1, 2, 3, 4-7, 8-15, 16+
+
+// The virtual clock, in micro seconds
+extern uint64_t simNowUs;
+
+// xorshift64* so a seed gives the same numbers on every machine
+class SimRandom {
+public:
+  void seed(uint64_t);
+  double next(void);
+private:
+  uint64_t state;
+};
+
+// Gilbert-Elliott burst loss. With goodToBad at 0 it is plain Bernoulli loss
+//  at goodLoss.
+class SimLossModel {
+public:
+  SimLossModel(void);
+  void bernoulli(double);
+  boolean lost(SimRandom &);
+  boolean lossless(void);
+
+  double goodToBad;
+  double badToGood;
+  double goodLoss;
+  double badLoss;
+  boolean bad;
+};
+
+typedef struct {
+  uint8_t length;
+  char data[SIM_PACKET_SIZE_BYTES];
+} SimPacket;
+
+// One role, the Host or the Device, built from its sketch in sim_roles.cpp
+typedef struct {
+  const char *name;
+  void (*setup)(void);
+  void (*loop)(void);
+  void (*onReceive)(device_t, int, char *, int);
+  void (*setPollTime)(uint32_t);
+  // The port and the library's output pacing, see outputSetBaudRate()
+  void (*setBaudRate)(uint32_t);
+  void (*lowPower)(uint32_t *, uint32_t *, uint32_t *);
+  void (*moveChannel)(uint32_t);
+  void (*reset)(void);
+  boolean (*linkSearching)(void);
+  HardwareSerial *serial;
+  RFduinoGZLLClass *gzll;
+} SimRole;
+
+extern SimRole simHost;
+extern SimRole simDevice;
+
+// The air between the two radios. The Device sends from its TX FIFO, the Host
+//  answers each packet it hears with an ack carrying the oldest packet in its
+//  own TX FIFO. Lost packets and lost acks are retried like Gazell does.
+class SimLink {
+public:
+  SimLink(void);
+  void run(void);
+  boolean push(device_t, const char *, int);
+  uint64_t nextEventAt(void);
+
+  // Config
+  uint8_t fifoDepth;
+  uint32_t airUs; // One packet on the air
+  uint32_t ackUs; // Turnaround from the end of a packet to its ack
+  uint32_t retryUs; // Wait before sending a packet again
+  uint32_t maxRetries;
+  uint64_t seed;
+  SimLossModel forward;
+  SimLossModel backward;
+  SimRandom random;
+  // When set, called on the first try of each packet from the Device, return
+  //  `true` to drop the packet outright
+  boolean (*drop)(const SimPacket &);
+
+  // Stats
+  uint32_t attempts;
+  uint32_t forwardLost;
+  uint32_t ackLost;
+  uint32_t dropped;
+  uint32_t deviceFifoFull;
+  uint32_t hostFifoFull;
+
+private:
+  void retry(void);
+
+  std::deque<SimPacket> deviceFifo;
+  std::deque<SimPacket> hostFifo;
+  boolean busy;
+  boolean delivered;
+  boolean ackHeld;
+  SimPacket ack;
+  uint64_t doneAt;
+  uint64_t nextAttemptAt;
+  uint32_t retries;
+};
+
+extern SimLink simLink;
+
+// The Pic on the Device's serial port, streams packets at `rateHz`. Each one
+//  carries its sample number, a 32 bit sequence and the time it was made.
+class SimPic {
+public:
+  SimPic(void);
+  void run(HardwareSerial *);
+  uint64_t nextEventAt(void);
+
+  uint32_t rateHz;
+  uint64_t startUs;
+  uint64_t stopUs;
+  uint32_t sent;
+  uint32_t bytesFromDevice;
+
+private:
+  uint64_t nextAt;
+};
+
+// The driver on the Host's serial port, picks stream packets out of what the
+//  Host writes and keeps the numbers for the report.
+class SimDriver {
+public:
+  SimDriver(void);
+  void run(HardwareSerial *);
+  void report(FILE *, SimPic *, uint64_t);
+
+  uint32_t packets;
+  uint32_t duplicates;
+  uint32_t outOfOrder;
+  uint32_t gaps[SIM_GAP_BUCKETS];
+  uint32_t textBytes;
+  uint32_t batches;
+  uint32_t batchErrors;
+  std::vector<uint32_t> latencyUs;
+  // Text the Host writes is copied here when set, e.g. a trace dump
+  FILE *text;
+
+private:
+  void batch(void);
+  void packet(void);
+
+  uint8_t frame[SIM_STREAM_PACKET_SIZE_BYTES];
+  uint8_t framePosition;
+  boolean haveLast;
+  uint32_t lastSequence;
+  std::vector<bool> seen;
+  std::vector<uint8_t> batchBytes;
+};
+
+boolean simLinkOption(const char *, const char *);
+void simAdvance(uint32_t);
+void simLoops(void);
+uint32_t simNextStepUs(uint64_t, uint32_t);
+void simStep(SimPic *, SimDriver *, uint32_t);
+
+#endif // __OpenBCI_Radio_Sim__
@@ -0,0 +1,107 @@
+/**
+* Name: sim_roles.cpp
+* Purpose: Builds the library twice, once with the Host sketch and once with
+*   the Device sketch, each in its own namespace with its own `radio`, serial
+*   port, radio and flash page. The sketches are used as they are, the library
+*   only gained a missing `return false` in processHostRadioCharData() and an
+*   #ifndef around OPENBCI_NUMBER_STREAM_BUFFERS, see README.md.
+*
+* Author: Push The World LLC (AJ Keller)
+*/
+
+#include "sim.h"
+
+#define SIM_ROLE_PLATFORM \
+  HardwareSerial Serial; \
+  RFduinoGZLLClass RFduinoGZLL; \
+  uint32_t simFlashPage[256]; \
+  int flashPageErase(uint8_t) { \
+    memset(simFlashPage, 0xFF, sizeof(simFlashPage)); \
+    return 0; \
+  } \
+  int flashWrite(uint32_t *address, uint32_t value) { \
+    *address = value; \
+    return 0; \
+  }
+
+#define SIM_ROLE_HOOKS \
+  void simSetup(void) { \
+    flashPageErase(0); \
+    setup(); \
+  } \
+  void simSetPollTime(uint32_t ms) { \
+    radio.pollTimeApply(ms); \
+  } \
+  void simSetBaudRate(uint32_t baud) { \
+    Serial.baudRate = baud; \
+    radio.outputSetBaudRate(baud); \
+  } \
+  void simLowPower(uint32_t *packets, uint32_t *radioOnUs, uint32_t *wakes) { \
+    *packets = radio.lowPowerPackets; \
+    *radioOnUs = radio.lowPowerRadioOnUs; \
+    *wakes = radio.lowPowerWakes; \
+  } \
+  void simMoveChannel(uint32_t channel) { \
+    radio.previousRadioChannel = radio.getChannelNumber(); \
+    radio.radioChannel = channel; \
+    radio.flashCommitAdd(OPENBCI_FLASH_COMMIT_CHANNEL, channel); \
+    RFduinoGZLL.end(); \
+    RFduinoGZLL.channel = channel; \
+    RFduinoGZLL.begin(RFduinoGZLL.role); \
+  } \
+  void simReset(void) { \
+    radio = OpenBCI_Radios_Class(); \
+    setup(); \
+  } \
+  boolean simLinkSearching(void) { \
+    return radio.linkSearching; \
+  }
+
+namespace sim_host {
+SIM_ROLE_PLATFORM
+#include "OpenBCI_Radios.h"
+#include "OpenBCI_Radios.cpp"
+#include "examples/RadioHost32bit/RadioHost32bit.ino"
+SIM_ROLE_HOOKS
+}
+
+// Let the header in again for the Device's copy of the class
+#undef __OpenBCI_Radios__
+
+namespace sim_device {
+SIM_ROLE_PLATFORM
+#include "OpenBCI_Radios.h"
+#include "OpenBCI_Radios.cpp"
+#include "examples/RadioDevice32bit/RadioDevice32bit.ino"
+SIM_ROLE_HOOKS
+}
+
+SimRole simHost = {
+  "host",
+  sim_host::simSetup,
+  sim_host::loop,
+  sim_host::RFduinoGZLL_onReceive,
+  sim_host::simSetPollTime,
+  sim_host::simSetBaudRate,
+  sim_host::simLowPower,
+  sim_host::simMoveChannel,
+  sim_host::simReset,
+  sim_host::simLinkSearching,
+  &sim_host::Serial,
+  &sim_host::RFduinoGZLL
+};
+
+SimRole simDevice = {
+  "device",
+  sim_device::simSetup,
+  sim_device::loop,
+  sim_device::RFduinoGZLL_onReceive,
+  sim_device::simSetPollTime,
+  sim_device::simSetBaudRate,
+  sim_device::simLowPower,
+  sim_device::simMoveChannel,
+  sim_device::simReset,
+  sim_device::simLinkSearching,
+  &sim_device::Serial,
+  &sim_device::RFduinoGZLL
+};
@@ -0,0 +1,440 @@
+/**
+* Name: trace_decode.cpp
+* Purpose: Turns a trace dump from the Host, written after the driver sends
+*   `0xF0 0x12` to a library built with OPENBCI_TRACE_ENABLED set to 1, into a
+*   timeline. Each record becomes a line with its time, the time since the
+*   record before it, which radio it came from and what happened, then a
+*   summary of each radio's records. See README.md in this folder.
+*
+* Author: Push The World LLC (AJ Keller)
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <algorithm>
+#include <vector>
+#include "OpenBCI_Radios_Definitions.h"
+
+#define TRACE_NUMBER_EVENTS (OPENBCI_TRACE_EVENT_RX_FULL + 1)
+
+typedef struct {
+  char side;
+  uint64_t time;
+  uint8_t event;
+  uint8_t arg;
+  uint16_t value;
+  size_t order;
+} TraceEvent;
+
+static const char *traceEventNames[TRACE_NUMBER_EVENTS] = {
+  "?",
+  "rx",
+  "rx done",
+  "tx",
+  "tx fail",
+  "ring head",
+  "ring tail",
+  "page reject",
+  "page missed",
+  "poll",
+  "flush",
+  "flush done",
+  "slow loop",
+  "link",
+  "masked",
+  "rx full"
+};
+
+static const char *traceMaskedWhere[] = {
+  "?",
+  "run",
+  "rx queue",
+  "serial page",
+  "fast command",
+  "stream down",
+  "link state",
+  "flash commit"
+};
+
+static const char *traceRadioMessages[] = {
+  "invalid code",
+  "page reject",
+  "packet missed",
+  "packet init",
+  "device serial overflow",
+  "change channel request",
+  "change channel ready",
+  "change poll time request",
+  "change poll time ready",
+  "get poll time",
+  "upload start",
+  "upload ready",
+  "upload end"
+};
+
+static bool traceEarlier(const TraceEvent &a, const TraceEvent &b) {
+  if (a.time != b.time) {
+    return a.time < b.time;
+  }
+  return a.order < b.order;
+}
+
+/**
+* @description Says what a packet is from its first byte and length, the way
+*  the library tells them apart.
+* @param byteId {uint8_t} - The first byte of the packet
+* @param length {uint16_t} - The length of the packet
+* @param output {char *} - Where the description goes
+* @param size {size_t} - The size of `output`
+*/
+static void traceDescribePacket(uint8_t byteId, uint16_t length, char *output, size_t size) {
+  if (length == 0) {
+    snprintf(output, size, "empty");
+  } else if (length == 1) {
+    if (byteId < sizeof(traceRadioMessages) / sizeof(traceRadioMessages[0])) {
+      snprintf(output, size, "message %s", traceRadioMessages[byteId]);
+    } else {
+      snprintf(output, size, "message 0x%02x", byteId);
+    }
+  } else if (byteId > 0x7F) {
+    uint8_t type = (byteId >> 3) & 0x0F;
+    if (type == OPENBCI_STREAM_PACKET_TYPE_PARITY) {
+      snprintf(output, size, "stream parity len %u", length);
+    } else {
+      snprintf(output, size, "stream type %u len %u", type, length);
+    }
+  } else if (byteId == OPENBCI_UPLOAD_BYTE_ID) {
+    snprintf(output, size, "upload len %u", length);
+  } else if (byteId == OPENBCI_UPLOAD_BYTE_ID_NACK) {
+    snprintf(output, size, "upload nack len %u", length);
+  } else if (byteId == OPENBCI_COMMAND_FAST_BYTE_ID) {
+    snprintf(output, size, "fast command len %u", length);
+  } else if (byteId == OPENBCI_TX_QUEUE_BYTE_ID) {
+    snprintf(output, size, "queue len %u", length);
+  } else if (byteId == OPENBCI_STREAM_NACK_BYTE_ID) {
+    snprintf(output, size, "stream nack len %u", length);
+  } else if (byteId == OPENBCI_STREAM_PARITY_BYTE_ID) {
+    snprintf(output, size, "parity group len %u", length);
+  } else if (byteId == OPENBCI_TRACE_BYTE_ID) {
+    snprintf(output, size, "trace len %u", length);
+  } else {
+    snprintf(output, size, "page packet %u len %u", (byteId >> 3) & 0x0F, length);
+  }
+}
+
+/**
+* @description Says what happened in a record, with the arg and value decoded
+*  as the definitions next to `OPENBCI_TRACE_EVENT_*` describe them.
+* @param e {const TraceEvent &} - The record
+* @param output {char *} - Where the description goes
+* @param size {size_t} - The size of `output`
+*/
+static void traceDescribe(const TraceEvent &e, char *output, size_t size) {
+  switch (e.event) {
+    case OPENBCI_TRACE_EVENT_RX_ENTER:
+    case OPENBCI_TRACE_EVENT_TX_OK:
+    case OPENBCI_TRACE_EVENT_TX_FAIL:
+      if (e.event != OPENBCI_TRACE_EVENT_RX_ENTER && e.value == 0) {
+        snprintf(output, size, "poll");
+      } else {
+        traceDescribePacket(e.arg, e.value, output, size);
+      }
+      break;
+    case OPENBCI_TRACE_EVENT_RX_EXIT:
+      snprintf(output, size, "%s", e.arg ? "sent a packet back" : "");
+      break;
+    case OPENBCI_TRACE_EVENT_RING_HEAD:
+    case OPENBCI_TRACE_EVENT_RING_TAIL:
+      snprintf(output, size, "%u, %u in the ring", e.arg, e.value);
+      break;
+    case OPENBCI_TRACE_EVENT_PAGE_REJECT:
+    case OPENBCI_TRACE_EVENT_PAGE_MISSED:
+      snprintf(output, size, "%s", e.arg ? "sent" : "received");
+      break;
+    case OPENBCI_TRACE_EVENT_POLL:
+      snprintf(output, size, "%s", e.arg ? "from loop" : "from the radio callback");
+      break;
+    case OPENBCI_TRACE_EVENT_FLUSH_START:
+    case OPENBCI_TRACE_EVENT_FLUSH_END:
+      if (e.value == OPENBCI_MAX_PACKET_SIZE_STREAM_BYTES) {
+        snprintf(output, size, "sample %u", e.arg);
+      } else {
+        snprintf(output, size, "page %u bytes", e.value);
+      }
+      break;
+    case OPENBCI_TRACE_EVENT_LOOP:
+      snprintf(output, size, "%u us%s", e.value, e.value == 0xFFFF ? " or more" : "");
+      break;
+    case OPENBCI_TRACE_EVENT_LINK:
+      snprintf(output, size, "%s channel %u", e.arg == 1 ? "lost on" : e.arg == 2 ? "trying" : "found on", e.value);
+      break;
+    case OPENBCI_TRACE_EVENT_MASKED:
+      snprintf(output, size, "%u us in %s", e.value, e.arg < sizeof(traceMaskedWhere) / sizeof(traceMaskedWhere[0]) ? traceMaskedWhere[e.arg] : "?");
+      break;
+    case OPENBCI_TRACE_EVENT_RX_FULL:
+      traceDescribePacket(e.arg, e.value, output, size);
+      break;
+    default:
+      snprintf(output, size, "arg 0x%02x value %u", e.arg, e.value);
+      break;
+  }
+}
+
+static const char *traceEventName(uint8_t event) {
+  return event < TRACE_NUMBER_EVENTS ? traceEventNames[event] : traceEventNames[0];
+}
+
+/**
+* @description Reads every record out of a capture of the Host's serial port.
+*  Anything that isn't a record line is skipped, so a whole session can be fed
+*  in. Record times are micros() on the radio that made them and wrap every
+*  71 minutes, they're unwrapped here in the order each radio dumped them.
+* @param f {FILE *} - The capture
+* @param events {std::vector<TraceEvent> &} - Where the records go
+* @param deviceOffsetUs {long long} - Added to the Device's times
+*/
+static void traceRead(FILE *f, std::vector<TraceEvent> &events, long long deviceOffsetUs) {
+  char line[256];
+  uint64_t last[2] = {0, 0};
+  uint32_t lastRaw[2] = {0, 0};
+  bool started[2] = {false, false};
+  while (fgets(line, sizeof(line), f)) {
+    // The EOT of one dump and the header of the next share a line
+    char *record = line;
+    char *eot;
+    while ((eot = strstr(record, "$$$")) != NULL) {
+      record = eot + 3;
+    }
+    // A new dump starts the radio's clock over, its records may overlap the
+    //  last dump's
+    if (strstr(record, "Trace host")) {
+      started[0] = false;
+    } else if (strstr(record, "Trace device")) {
+      started[1] = false;
+    }
+    char side;
+    unsigned int time, event, arg, value;
+    if (sscanf(record, "%c %8x %2x %2x %4x", &side, &time, &event, &arg, &value) != 5 || (side != 'H' && side != 'D')) {
+      continue;
+    }
+    int s = side == 'H' ? 0 : 1;
+    if (!started[s]) {
+      last[s] = time;
+      started[s] = true;
+    } else {
+      last[s] += (uint32_t)(time - lastRaw[s]);
+    }
+    lastRaw[s] = time;
+    TraceEvent e;
+    e.side = side;
+    e.time = last[s] + (side == 'D' ? deviceOffsetUs : 0);
+    e.event = (uint8_t)event;
+    e.arg = (uint8_t)arg;
+    e.value = (uint16_t)value;
+    e.order = events.size();
+    events.push_back(e);
+  }
+}
+
+/**
+* @description Writes the records as a timeline, one line each. Times are from
+*  the first record written, the step is from the record before it on the same
+*  radio. Steps of `gapUs` or more are marked.
+* @param events {const std::vector<TraceEvent> &} - The records, in order
+* @param gapUs {uint64_t} - Smallest step that is marked
+*/
+static void traceTimeline(const std::vector<TraceEvent> &events, uint64_t gapUs) {
+  if (events.empty()) {
+    return;
+  }
+  uint64_t start = events[0].time;
+  uint64_t last[2] = {0, 0};
+  bool started[2] = {false, false};
+  uint64_t flushStart[2] = {0, 0};
+  uint64_t rxStart[2] = {0, 0};
+  printf("%12s %10s  %-4s %s\n", "time_ms", "step_us", "side", "event");
+  for (size_t i = 0; i < events.size(); i++) {
+    const TraceEvent &e = events[i];
+    int s = e.side == 'H' ? 0 : 1;
+    uint64_t step = started[s] && e.time > last[s] ? e.time - last[s] : 0;
+    char description[80];
+    traceDescribe(e, description, sizeof(description));
+    if (e.event == OPENBCI_TRACE_EVENT_RX_ENTER) {
+      rxStart[s] = e.time;
+    } else if (e.event == OPENBCI_TRACE_EVENT_RX_EXIT && rxStart[s] > 0) {
+      size_t used = strlen(description);
+      snprintf(description + used, sizeof(description) - used, "%stook %llu us", used ? ", " : "", (unsigned long long)(e.time - rxStart[s]));
+      rxStart[s] = 0;
+    }
+    printf("%12.3f %10llu  %-4c %s", (e.time - start) / 1000.0, (unsigned long long)step, e.side, traceEventName(e.event));
+    if (description[0]) {
+      printf("%*s%s", 13 - (int)strlen(traceEventName(e.event)), "", description);
+    }
+    if (e.event == OPENBCI_TRACE_EVENT_FLUSH_START) {
+      flushStart[s] = e.time;
+    } else if (e.event == OPENBCI_TRACE_EVENT_FLUSH_END && flushStart[s] > 0) {
+      printf(", took %llu us", (unsigned long long)(e.time - flushStart[s]));
+      flushStart[s] = 0;
+    }
+    if (started[s] && step >= gapUs) {
+      printf("  <-- gap");
+    }
+    printf("\n");
+    last[s] = e.time;
+    started[s] = true;
+  }
+}
+
+/**
+* @description Writes how many of each event a radio traced, how many sends
+*  failed and the longest step between its records.
+* @param events {const std::vector<TraceEvent> &} - The records, in order
+* @param side {char} - `H` or `D`
+*/
+static void traceSummary(const std::vector<TraceEvent> &events, char side) {
+  uint32_t counts[TRACE_NUMBER_EVENTS + 1];
+  memset(counts, 0, sizeof(counts));
+  uint32_t records = 0;
+  uint64_t first = 0;
+  uint64_t last = 0;
+  uint64_t longestStep = 0;
+  uint64_t longestStepAt = 0;
+  uint16_t slowestLoop = 0;
+  uint16_t longestMasked = 0;
+  uint64_t rxStart = 0;
+  uint64_t slowestRx = 0;
+  for (size_t i = 0; i < events.size(); i++) {
+    const TraceEvent &e = events[i];
+    if (e.side != side) {
+      continue;
+    }
+    if (records == 0) {
+      first = e.time;
+    } else if (e.time > last && e.time - last > longestStep) {
+      longestStep = e.time - last;
+      longestStepAt = last;
+    }
+    last = e.time;
+    records++;
+    counts[e.event < TRACE_NUMBER_EVENTS ? e.event : TRACE_NUMBER_EVENTS]++;
+    if (e.event == OPENBCI_TRACE_EVENT_LOOP && e.value > slowestLoop) {
+      slowestLoop = e.value;
+    }
+    if (e.event == OPENBCI_TRACE_EVENT_MASKED && e.value > longestMasked) {
+      longestMasked = e.value;
+    }
+    // The radio callback runs from its rx record to its rx done
+    if (e.event == OPENBCI_TRACE_EVENT_RX_ENTER) {
+      rxStart = e.time;
+    } else if (e.event == OPENBCI_TRACE_EVENT_RX_EXIT && rxStart > 0) {
+      if (e.time - rxStart > slowestRx) {
+        slowestRx = e.time - rxStart;
+      }
+      rxStart = 0;
+    }
+  }
+  printf("\n%s: %u records over %.3f ms\n", side == 'H' ? "host" : "device", records, records ? (last - first) / 1000.0 : 0.0);
+  if (records == 0) {
+    return;
+  }
+  for (int i = 1; i < TRACE_NUMBER_EVENTS; i++) {
+    if (counts[i]) {
+      printf("  %-12s %u\n", traceEventNames[i], counts[i]);
+    }
+  }
+  if (counts[TRACE_NUMBER_EVENTS]) {
+    printf("  %-12s %u\n", "unknown", counts[TRACE_NUMBER_EVENTS]);
+  }
+  printf("  longest step %llu us after %.3f ms\n", (unsigned long long)longestStep, (longestStepAt - first) / 1000.0);
+  if (slowestLoop) {
+    printf("  slowest loop %u us\n", slowestLoop);
+  }
+  if (counts[OPENBCI_TRACE_EVENT_RX_EXIT]) {
+    printf("  slowest rx %llu us\n", (unsigned long long)slowestRx);
+  }
+  // A callback can wait out the longest window loop() held it off, windows
+  //  too short to be traced are counted at the most they could be
+  uint16_t masked = longestMasked > OPENBCI_TRACE_MASKED_SLOW_uS ? longestMasked : OPENBCI_TRACE_MASKED_SLOW_uS;
+  if (longestMasked) {
+    printf("  longest masked %u us\n", longestMasked);
+  }
+  if (counts[OPENBCI_TRACE_EVENT_RX_EXIT]) {
+    printf("  worst rx %llu us, the slowest rx held off %u us\n", (unsigned long long)slowestRx + masked, masked);
+  }
+}
+
+static void usage(const char *name) {
+  fprintf(stderr,
+    "usage: %s [options] [FILE]\n"
+    "  reads a capture of the Host's serial port from FILE or stdin\n"
+    "  --merge               one timeline for both radios, by time\n"
+    "  --device-offset-us N  add N to the Device's times before merging\n"
+    "  --gap-us N            mark steps this long or longer (10000)\n",
+    name);
+  exit(2);
+}
+
+int main(int argc, char **argv) {
+  const char *path = NULL;
+  bool merge = false;
+  long long deviceOffsetUs = 0;
+  uint64_t gapUs = 10000;
+
+  for (int i = 1; i < argc; i++) {
+    const char *arg = argv[i];
+    if (!strcmp(arg, "--merge")) {
+      merge = true;
+    } else if (!strcmp(arg, "--device-offset-us") && i + 1 < argc) {
+      deviceOffsetUs = atoll(argv[++i]);
+    } else if (!strcmp(arg, "--gap-us") && i + 1 < argc) {
+      gapUs = strtoull(argv[++i], NULL, 10);
+    } else if (arg[0] != '-' && path == NULL) {
+      path = arg;
+    } else {
+      usage(argv[0]);
+    }
+  }
+
+  FILE *f = stdin;
+  if (path) {
+    f = fopen(path, "r");
+    if (f == NULL) {
+      fprintf(stderr, "can't open %s\n", path);
+      return 2;
+    }
+  }
+  std::vector<TraceEvent> events;
+  traceRead(f, events, deviceOffsetUs);
+  if (f != stdin) {
+    fclose(f);
+  }
+  if (events.empty()) {
+    fprintf(stderr, "no trace records found\n");
+    return 1;
+  }
+
+  if (merge) {
+    std::stable_sort(events.begin(), events.end(), traceEarlier);
+    traceTimeline(events, gapUs);
+  } else {
+    // Each radio on its own, its clock has nothing to do with the other's
+    std::vector<TraceEvent> side;
+    for (int s = 0; s < 2; s++) {
+      side.clear();
+      for (size_t i = 0; i < events.size(); i++) {
+        if (events[i].side == (s == 0 ? 'H' : 'D')) {
+          side.push_back(events[i]);
+        }
+      }
+      if (!side.empty()) {
+        printf("%s%s\n", s == 0 ? "" : "\n", s == 0 ? "Host" : "Device");
+        traceTimeline(side, gapUs);
+      }
+    }
+  }
+  traceSummary(events, 'H');
+  traceSummary(events, 'D');
+  return 0;
+}